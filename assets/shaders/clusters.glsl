@@ -0,0 +1,77 @@
+// Light storage and froxel clusters, must match FrameInfo.hpp and vk::LightClusterSystem.
+// Include global_ubo.glsl first. Define CLUSTER_WRITE to get write access to the clusters (culling pass only).
+
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define MAX_LIGHTS_PER_CLUSTER 127
+
+struct PointLight
+{
+    vec4 position; // w = range
+    vec4 color;    // w = intensity
+    int shadowSlot; // -1 if the light casts no shadow, see point_shadows.glsl
+};
+
+struct Cluster
+{
+    uint lightCount;
+    uint lightIndices[MAX_LIGHTS_PER_CLUSTER];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer LightBuffer
+{
+    PointLight lights[];
+};
+
+#ifdef CLUSTER_WRITE
+layout(std430, set = 0, binding = 2) writeonly buffer ClusterBuffer
+#else
+layout(std430, set = 0, binding = 2) readonly buffer ClusterBuffer
+#endif
+{
+    Cluster clusters[];
+};
+
+// The planes are recovered from the projection matrix built by vk::Camera::setPerspectiveProjection
+float clusterNearPlane()
+{
+    return -ubo.projectionMatrix[3][2] / ubo.projectionMatrix[2][2];
+}
+
+float clusterFarPlane()
+{
+    return ubo.projectionMatrix[3][2] / (1.0 - ubo.projectionMatrix[2][2]);
+}
+
+// Depth slices are distributed exponentially, so froxels keep roughly the same proportions at every distance
+uint clusterSlice(float viewDepth)
+{
+    float near = clusterNearPlane();
+    float far = clusterFarPlane();
+    float slice = log(max(viewDepth, near) / near) / log(far / near) * float(CLUSTER_GRID_Z);
+
+    return uint(clamp(slice, 0.0, float(CLUSTER_GRID_Z - 1)));
+}
+
+float clusterSliceDepth(uint slice)
+{
+    float near = clusterNearPlane();
+    float far = clusterFarPlane();
+
+    return near * pow(far / near, float(slice) / float(CLUSTER_GRID_Z));
+}
+
+uint clusterIndex(uvec3 cluster)
+{
+    return cluster.x + cluster.y * CLUSTER_GRID_X + cluster.z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+}
+
+uint clusterIndexAt(vec2 fragCoord, float viewDepth)
+{
+    uvec2 tile = uvec2(fragCoord / ubo.screenSize * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y));
+    tile = min(tile, uvec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+
+    return clusterIndex(uvec3(tile, clusterSlice(viewDepth)));
+}
@@ -0,0 +1,16 @@
+// Objects drawn by the OcclusionCullingSystem, must match vk::OcclusionCullingSystem::CulledObjectData.
+// Their indirect draws start at the object's index, so vertex shaders find it at gl_InstanceIndex. Transforms are
+// read from the object buffer of the ObjectDataSystem (see object_data.glsl) through objectIndex.
+
+struct CulledObject
+{
+    vec4 boundingSphere; // world space, w = radius
+    uint objectIndex;    // element of the object buffer
+    uint group;          // every object of a group is drawn with the same model
+    uint visibilitySlot; // persistent across frames, unlike the index of the object
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer CulledObjectBuffer
+{
+    CulledObject objects[];
+};
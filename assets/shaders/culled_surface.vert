@@ -0,0 +1,31 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUv;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec2 fragUv;
+
+#include "global_ubo.glsl"
+#include "culled_objects.glsl"
+#include "object_data.glsl"
+
+// Same surface as render_system.vert, with the object found through the culled object of the instance. The push
+// constant of object_data.glsl is never read, the draw pipeline layout has none.
+void main()
+{
+   ObjectData object = objectData[objects[gl_InstanceIndex].objectIndex];
+
+   vec4 positionWorld = object.modelMatrix * vec4(inPosition, 1.0);
+   gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+
+   fragColor = inColor;
+   fragPosWorld = positionWorld.xyz;
+   fragNormalWorld = normalize(object.normalMatrix * inNormal);
+   fragUv = inUv;
+}
@@ -0,0 +1,18 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Depth only pass in front of the lit surfaces, reads nothing but the position
+
+layout(location = 0) in vec3 inPosition;
+
+// The surfaces test against this depth with EQUAL, so it must be computed exactly as in render_system.vert
+invariant gl_Position;
+
+#include "global_ubo.glsl"
+#include "object_data.glsl"
+
+void main()
+{
+   vec4 positionWorld = objectData[push.objectIndex].modelMatrix * vec4(inPosition, 1.0);
+   gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+}
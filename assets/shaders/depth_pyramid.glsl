@@ -0,0 +1,66 @@
+// One level of the depth pyramid of the OcclusionCullingSystem. Every texel keeps the farthest depth of the 2x2
+// texels below it, so anything behind that depth over a texel's whole footprint is hidden.
+// Mip levels are floor(size / 2), so the last texel of a row or column also covers the third texel of an odd source.
+// Define MULTISAMPLED to build the first level straight from a multisampled depth attachment.
+
+// Must match vk::OcclusionCullingSystem::PYRAMID_WORKGROUP_SIZE
+#define WORKGROUP_SIZE 8
+
+layout(local_size_x = WORKGROUP_SIZE, local_size_y = WORKGROUP_SIZE) in;
+
+#ifdef MULTISAMPLED
+layout(set = 0, binding = 0) uniform sampler2DMS source;
+#else
+layout(set = 0, binding = 0) uniform sampler2D source;
+#endif
+
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D destination;
+
+float farthestDepth(ivec2 position)
+{
+#ifdef MULTISAMPLED
+    float depth = 0.0;
+
+    for (int i = 0; i < textureSamples(source); i++)
+        depth = max(depth, texelFetch(source, position, i).r);
+
+    return depth;
+#else
+    return texelFetch(source, position, 0).r;
+#endif
+}
+
+ivec2 sourceSize()
+{
+#ifdef MULTISAMPLED
+    return textureSize(source);
+#else
+    return textureSize(source, 0);
+#endif
+}
+
+void main()
+{
+    ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(position, imageSize(destination))))
+        return;
+
+    ivec2 last = sourceSize() - 1;
+    ivec2 first = min(position * 2, last);
+    ivec2 end = min(first + 1, last);
+
+    if (position.x == imageSize(destination).x - 1)
+        end.x = last.x;
+
+    if (position.y == imageSize(destination).y - 1)
+        end.y = last.y;
+
+    float depth = 0.0;
+
+    for (int y = first.y; y <= end.y; y++)
+        for (int x = first.x; x <= end.x; x++)
+            depth = max(depth, farthestDepth(ivec2(x, y)));
+
+    imageStore(destination, position, vec4(depth));
+}
@@ -0,0 +1,12 @@
+// Global uniform buffer shared by every stage, must match vk::GlobalUBO
+
+layout(set = 0, binding = 0) uniform GlobalUbo
+{
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 inverseViewMatrix;
+    vec4 ambientLightColor;
+    vec2 screenSize;
+    int numLights;
+}
+ubo;
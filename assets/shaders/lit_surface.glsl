@@ -0,0 +1,121 @@
+// Blinn-Phong surface shading shared by render_system.frag, texture_render_system.frag and transparent_surface.frag.
+// Define TEXTURED before including it to sample the object texture from set 1, or TRANSPARENT to blend the surface
+// with the opacity from transparent_surface.vert (see vk::TransparentRenderSystem).
+
+#include "global_ubo.glsl"
+#include "clusters.glsl"
+#include "point_shadows.glsl"
+
+// Specialization constants, see vk::ShaderVariant
+layout(constant_id = 0) const int LIGHT_LIMIT = MAX_LIGHTS_PER_CLUSTER;
+layout(constant_id = 1) const bool SPECULAR = true;
+
+#ifdef TRANSPARENT
+// Writes to the accumulation and revealage targets of weighted blended transparency instead of blending in order
+layout(constant_id = 2) const bool WEIGHTED_BLENDED = false;
+#endif
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragPosWorld;
+layout(location = 2) in vec3 fragNormalWorld;
+layout(location = 3) in vec2 fragUv;
+
+#ifdef TRANSPARENT
+layout(location = 4) in float fragOpacity;
+#endif
+
+layout(location = 0) out vec4 outColor;
+
+#ifdef TRANSPARENT
+layout(location = 1) out float outRevealage;
+#endif
+
+layout(set = 0, binding = 3) uniform sampler2DArrayShadow pointShadowAtlas;
+
+#ifdef TEXTURED
+layout(set = 1, binding = 0) uniform sampler2D texSampler;
+#endif
+
+const float BLINN_TERM_FACTOR = 256.0; // higher values produce sharper specular highlights
+const float SHADOW_NORMAL_OFFSET = 0.02; // keeps surfaces from shadowing themselves where the texels are coarse
+
+void main()
+{
+    vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+    vec3 specularLight = vec3(0.0);
+    vec3 surfaceNormal = normalize(fragNormalWorld);
+
+    vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
+    vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
+
+    // Only the lights binned into this fragment's froxel by the culling pass are considered
+    float viewDepth = (ubo.viewMatrix * vec4(fragPosWorld, 1.0)).z;
+    uint cluster = clusterIndexAt(gl_FragCoord.xy, viewDepth);
+
+    // LIGHT_LIMIT is known when the pipeline is created, which lets the driver bound the loop
+    uint lightCount = min(clusters[cluster].lightCount, uint(LIGHT_LIMIT));
+
+    for (uint i = 0; i < lightCount; i++)
+    {
+        PointLight light = lights[clusters[cluster].lightIndices[i]];
+
+        // Diffuse light
+        vec3 directionToLight = light.position.xyz - fragPosWorld;
+        float distanceSquared = dot(directionToLight, directionToLight); // dot(vec, vec) = len(vec)²
+        float attenuation = 1.0 / distanceSquared;
+
+        // Fade out towards the range used for culling instead of cutting the light off
+        float rangeRatio = distanceSquared / (light.position.w * light.position.w);
+        float rangeWindow = clamp(1.0 - rangeRatio * rangeRatio, 0.0, 1.0);
+        attenuation *= rangeWindow * rangeWindow;
+
+        if (light.shadowSlot >= 0)
+        {
+            vec3 shadowPosition = fragPosWorld + surfaceNormal * SHADOW_NORMAL_OFFSET;
+            attenuation *= pointShadowFactor(pointShadowAtlas, light.shadowSlot, shadowPosition - light.position.xyz,
+                                             light.position.w);
+        }
+
+        directionToLight = normalize(directionToLight);
+
+        float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
+        vec3 intensity = light.color.xyz * light.color.w * attenuation;
+
+        diffuseLight += intensity * cosAngIncidence;
+
+        // Specular light
+        if (SPECULAR)
+        {
+            vec3 halfAngle = normalize(directionToLight + viewDirection);
+            float blinnTerm = dot(surfaceNormal, halfAngle);
+            blinnTerm = clamp(blinnTerm, 0.0, 1.0);
+            blinnTerm = pow(blinnTerm, BLINN_TERM_FACTOR);
+            specularLight += intensity * blinnTerm;
+        }
+    }
+
+    vec3 color = diffuseLight * fragColor + specularLight * fragColor;
+
+#ifdef TEXTURED
+    color *= texture(texSampler, fragUv).rgb;
+#endif
+
+#ifdef TRANSPARENT
+    if (WEIGHTED_BLENDED)
+    {
+        // Nearer layers weigh more, so they dominate the average where they overlap farther ones
+        float weight = clamp(fragOpacity * max(1e-2, min(3e3, 10.0 / (1e-5 + pow(viewDepth / 5.0, 2.0) +
+                                                                      pow(viewDepth / 200.0, 6.0)))),
+                             1e-2, 3e3);
+
+        outColor = vec4(color * fragOpacity, fragOpacity) * weight;
+        outRevealage = fragOpacity;
+    }
+    else
+    {
+        outColor = vec4(color, fragOpacity);
+    }
+#else
+    outColor = vec4(color, 1.0);
+#endif
+}
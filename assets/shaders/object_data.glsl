@@ -0,0 +1,20 @@
+// Objects written every frame by vk::ObjectDataSystem, must match vk::ObjectData and vk::ObjectPushConstantData.
+// Draws only push the index of their object.
+
+struct ObjectData
+{
+    mat4 modelMatrix;
+    mat3 normalMatrix; // columns padded to vec4 by std430
+    vec4 color;        // w = opacity
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer ObjectBuffer
+{
+    ObjectData objectData[];
+};
+
+layout(push_constant) uniform Push
+{
+    uint objectIndex;
+}
+push;
@@ -1,32 +1,9 @@
 #version 450
 
 layout(location = 0) in vec2 fragOffset;
-layout(location = 0) out vec4 outColor;
-
-struct PointLight
-{
-    vec3 position;
-    vec4 color; // w = intensity
-};
+layout(location = 1) in vec4 fragColor; // w = intensity
 
-layout(set = 0, binding = 0) uniform GlobalUbo
-{
-    mat4 projectionMatrix;
-    mat4 viewMatrix;
-    mat4 inverseViewMatrix;
-    vec4 ambientLightColor;
-    PointLight pointLights[10];
-    int numLights;
-}
-ubo;
-
-layout(push_constant) uniform Push
-{
-    vec3 position;
-    vec4 color;
-    float radius;
-}
-push;
+layout(location = 0) out vec4 outColor;
 
 const float M_PI = 3.141592653589793;
 
@@ -39,5 +16,5 @@ void main()
         discard;
 
     float cosDis = 0.5 * (cos(dis * M_PI) + 1.0);
-    outColor = vec4(push.color.xyz + cosDis, cosDis);
+    outColor = vec4(fragColor.xyz + cosDis, cosDis);
 }
@@ -1,31 +1,14 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout(location = 0) out vec2 fragOffset;
-
-struct PointLight
-{
-    vec3 position;
-    vec4 color; // w = intensity
-};
+// Per instance, see vk::PointLightSystem::PointLightInstance
+layout(location = 0) in vec4 inPosition; // w = radius
+layout(location = 1) in vec4 inColor;    // w = intensity
 
-layout(set = 0, binding = 0) uniform GlobalUbo
-{
-    mat4 projectionMatrix;
-    mat4 viewMatrix;
-    mat4 inverseViewMatrix;
-    vec4 ambientLightColor;
-    PointLight pointLights[10];
-    int numLights;
-}
-ubo;
+layout(location = 0) out vec2 fragOffset;
+layout(location = 1) out vec4 fragColor;
 
-layout(push_constant) uniform Push
-{
-    vec3 position;
-    vec4 color;
-    float radius;
-}
-push;
+#include "global_ubo.glsl"
 
 const vec2 OFFSETS[6] =
     vec2[](vec2(-1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
@@ -33,9 +16,10 @@ const vec2 OFFSETS[6] =
 void main()
 {
     fragOffset = OFFSETS[gl_VertexIndex];
+    fragColor = inColor;
 
-    vec4 lightInCameraSpace = ubo.viewMatrix * vec4(push.position, 1.0);
-    vec4 positionInCameraSpace = lightInCameraSpace + push.radius * vec4(fragOffset, 0.0, 0.0);
+    vec4 lightInCameraSpace = ubo.viewMatrix * vec4(inPosition.xyz, 1.0);
+    vec4 positionInCameraSpace = lightInCameraSpace + inPosition.w * vec4(fragOffset, 0.0, 0.0);
 
     gl_Position = ubo.projectionMatrix * positionInCameraSpace;
 }
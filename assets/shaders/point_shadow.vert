@@ -0,0 +1,32 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_multiview : require
+
+// Depth of a shadow caster around a point light, drawn into all six faces of the light's cube at once with multiview
+
+layout(location = 0) in vec3 inPosition;
+
+layout(push_constant) uniform Push
+{
+    mat4 modelMatrix;
+    vec4 light; // w = range
+    uint faceMask;
+}
+push;
+
+#include "point_shadows.glsl"
+
+void main()
+{
+    uint face = gl_ViewIndex;
+
+    // Culled from this face on the CPU, every vertex lands behind the near plane and the primitive is clipped
+    if ((push.faceMask & (1u << face)) == 0u)
+    {
+        gl_Position = vec4(0.0, 0.0, -1.0, 1.0);
+        return;
+    }
+
+    vec3 positionWorld = (push.modelMatrix * vec4(inPosition, 1.0)).xyz;
+    gl_Position = pointShadowProjection(pointShadowFaceView(face, positionWorld - push.light.xyz), push.light.w);
+}
@@ -0,0 +1,54 @@
+// Point light cube shadows in the atlas of vk::PointShadowSystem, must match it and point_shadow.vert.
+// Every shadowed light owns six consecutive layers of a 2D array, one per cube face, in the order
+// +x, -x, +y, -y, +z, -z.
+
+#define POINT_SHADOW_FACE_COUNT 6
+#define POINT_SHADOW_NEAR 0.05
+
+// Position relative to the light in the space of a face: xy spans the face, z is the distance along its axis
+vec3 pointShadowFaceView(uint face, vec3 relative)
+{
+    switch (face)
+    {
+    case 0u: return vec3(relative.y, relative.z, relative.x);
+    case 1u: return vec3(relative.y, relative.z, -relative.x);
+    case 2u: return vec3(relative.x, relative.z, relative.y);
+    case 3u: return vec3(relative.x, relative.z, -relative.y);
+    case 4u: return vec3(relative.x, relative.y, relative.z);
+    default: return vec3(relative.x, relative.y, -relative.z);
+    }
+}
+
+// The face whose 90° frustum contains the position
+uint pointShadowFace(vec3 relative)
+{
+    vec3 magnitude = abs(relative);
+
+    if (magnitude.x >= magnitude.y && magnitude.x >= magnitude.z)
+        return relative.x >= 0.0 ? 0u : 1u;
+
+    if (magnitude.y >= magnitude.z)
+        return relative.y >= 0.0 ? 2u : 3u;
+
+    return relative.z >= 0.0 ? 4u : 5u;
+}
+
+// Perspective with a 90° field of view, depth goes from 0 at the near plane to 1 at the range of the light
+vec4 pointShadowProjection(vec3 view, float range)
+{
+    float depthScale = range / (range - POINT_SHADOW_NEAR);
+
+    return vec4(view.xy, depthScale * (view.z - POINT_SHADOW_NEAR), view.z);
+}
+
+// 1 where the light reaches the position, 0 where a caster is in between, filtered by the compare sampler
+float pointShadowFactor(sampler2DArrayShadow atlas, int slot, vec3 relative, float range)
+{
+    uint face = pointShadowFace(relative);
+    vec4 clip = pointShadowProjection(pointShadowFaceView(face, relative), range);
+
+    vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+    float layer = float(slot * POINT_SHADOW_FACE_COUNT + int(face));
+
+    return texture(atlas, vec4(uv, layer, clip.z / clip.w));
+}
@@ -1,69 +1,4 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout(location = 0) in vec3 fragColor;
-layout(location = 1) in vec3 fragPosWorld;
-layout(location = 2) in vec3 fragNormalWorld;
-layout(location = 3) in vec2 fragUv;
-
-layout(location = 0) out vec4 outColor;
-
-layout(push_constant) uniform Push
-{
-    mat4 modelMatrix;
-    mat4 normalMatrix;
-}
-push;
-
-struct PointLight
-{
-    vec3 position;
-    vec4 color; // w = intensity
-};
-
-layout(set = 0, binding = 0) uniform GlobalUbo
-{
-    mat4 projectionMatrix;
-    mat4 viewMatrix;
-    mat4 inverseViewMatrix;
-    vec4 ambientLightColor;
-    PointLight pointLights[10];
-    int numLights;
-}
-ubo;
-
-const float BLINN_TERM_FACTOR = 256.0; // higher values produce sharper specular highlights
-
-void main()
-{
-    vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
-    vec3 specularLight = vec3(0.0);
-    vec3 surfaceNormal = normalize(fragNormalWorld);
-
-    vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
-    vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
-
-    for (int i = 0; i < ubo.numLights; i++)
-    {
-        PointLight light = ubo.pointLights[i];
-
-        // Diffuse light
-        vec3 directionToLight = light.position.xyz - fragPosWorld;
-        float attenuation = 1.0 / dot(directionToLight, directionToLight); // dot(vec, vec) = len(vec)²
-
-        directionToLight = normalize(directionToLight);
-
-        float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
-        vec3 intensity = light.color.xyz * light.color.w * attenuation;
-
-        diffuseLight += intensity * cosAngIncidence;
-
-        // Specular light
-        vec3 halfAngle = normalize(directionToLight + viewDirection);
-        float blinnTerm = dot(surfaceNormal, halfAngle);
-        blinnTerm = clamp(blinnTerm, 0.0, 1.0);
-        blinnTerm = pow(blinnTerm, BLINN_TERM_FACTOR);
-        specularLight += intensity * blinnTerm;
-    }
-
-    outColor = vec4(diffuseLight * fragColor + specularLight * fragColor, 1.0);
-}
+#include "lit_surface.glsl"
@@ -0,0 +1,21 @@
+#version 450
+
+// Written by the accumulation pass of vk::TransparentRenderSystem, resolved if it was multisampled
+layout(set = 0, binding = 0) uniform sampler2D accumulation;
+layout(set = 0, binding = 1) uniform sampler2D revealage;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float reveal = texelFetch(revealage, texel, 0).r;
+
+    // Nothing transparent covers this pixel
+    if (reveal >= 1.0)
+        discard;
+
+    // Average color of the layers, blended over the frame by how much they hide of it
+    vec4 accum = texelFetch(accumulation, texel, 0);
+    outColor = vec4(accum.rgb / max(accum.a, 1e-5), 1.0 - reveal);
+}
@@ -0,0 +1,477 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+vk::Benchmark::Benchmark(const Options &options) : options(options), cameraDistance(5.f)
+{
+    createWindow();
+    createDevice();
+    createRenderer();
+    createPipelineCompiler();
+    createGlobalPool();
+    createObjectTexturePool();
+    createTextureSampler();
+    loadScene();
+}
+
+void vk::Benchmark::run()
+{
+    SceneRenderer::Options scene_options = {};
+    scene_options.occlusionCulling = options.occlusionCulling;
+    scene_options.shadowedLights = options.shadowedLights;
+    scene_options.transparency = options.transparency;
+
+    // Same systems and passes as the App
+    SceneRenderer scene_renderer(*device, *renderer, *pipelineCompiler, *globalPool, *objectTexturePool,
+                                 *textureSampler, objects, scene_options);
+
+    if (options.depthPrepass)
+        scene_renderer.setDepthPrepass(true);
+
+    // Measuring frames drawn with fallback pipelines would make runs depend on compile times
+    pipelineCompiler->waitIdle();
+
+    Camera camera;
+
+    const uint32_t total_frames = options.warmupFrames + options.frames;
+    uint32_t frame = 0;
+
+    renderer->setLowLatency(options.lowLatency);
+
+    while (frame < total_frames)
+    {
+        // The camera stands in for input, so latency is measured from where it is updated
+        renderer->paceFrame();
+
+        if (window)
+        {
+            window->pollEvents();
+
+            if (window->shouldClose())
+                throw std::runtime_error("vk::Benchmark::run: WINDOW CLOSED BEFORE THE BENCHMARK FINISHED");
+        }
+
+        camera.setPerspectiveProjection(Angle::Rad45, renderer->getAspectRatio(), .01f, 1000.f);
+        updateCamera(camera, frame);
+
+        if (!scene_renderer.renderFrame(camera, DT))
+            continue;
+
+        ++frame;
+
+        if (frame == options.warmupFrames)
+        {
+            renderer->getFrameStats().reset();
+            renderer->getGpuProfiler().resetHistories();
+        }
+    }
+
+    vkDeviceWaitIdle(device->getLogicalDevice());
+
+    collectResults();
+}
+
+void vk::Benchmark::writeJson(std::ostream &stream) const
+{
+    const FrameStats::Frame &average = report.averageFrame;
+
+    stream << "{\n";
+    stream << "  \"scene\": \"" << getSceneName(options.scene) << "\",\n";
+    stream << "  \"count\": " << options.count << ",\n";
+    stream << "  \"frames\": " << report.frameCount << ",\n";
+    stream << "  \"warmupFrames\": " << options.warmupFrames << ",\n";
+    stream << "  \"width\": " << renderer->getExtent().width << ",\n";
+    stream << "  \"height\": " << renderer->getExtent().height << ",\n";
+    stream << "  \"headless\": " << (renderer->isHeadless() ? "true" : "false") << ",\n";
+    stream << "  \"framesInFlight\": " << renderer->getFramesInFlight() << ",\n";
+    stream << "  \"lowLatency\": " << (renderer->isLowLatency() ? "true" : "false") << ",\n";
+    stream << "  \"depthPrepass\": " << (options.depthPrepass ? "true" : "false") << ",\n";
+    stream << "  \"occlusionCulling\": " << (options.occlusionCulling ? "true" : "false") << ",\n";
+    stream << "  \"shadowedLights\": " << options.shadowedLights << ",\n";
+    stream << "  \"transparency\": \""
+           << (options.transparency == TransparentRenderSystem::Mode::WeightedBlended ? "weighted" : "sorted")
+           << "\",\n";
+    stream << "  \"msaaSamples\": " << static_cast<int>(device->getCurrentMsaaSamples()) << ",\n";
+    stream << "  \"device\": \"" << device->getProperties().deviceName << "\",\n";
+    stream << "  \"dedicatedTransferQueue\": " << (device->hasDedicatedTransferQueue() ? "true" : "false") << ",\n";
+    stream << "  \"dedicatedComputeQueue\": " << (device->hasDedicatedComputeQueue() ? "true" : "false") << ",\n";
+
+    if (loadResult)
+    {
+        const double seconds = loadResult->milliseconds / 1000.0;
+        const double megabytes = static_cast<double>(loadResult->bytes) / (1024.0 * 1024.0);
+
+        stream << "  \"load\": {\"milliseconds\": " << loadResult->milliseconds << ", \"bytes\": " << loadResult->bytes
+               << ", \"megabytesPerSecond\": " << (seconds > 0.0 ? megabytes / seconds : 0.0) << "},\n";
+    }
+
+    stream << "  \"frameTime\": {\"average\": " << report.average << ", \"p50\": " << report.p50
+           << ", \"p95\": " << report.p95 << ", \"p99\": " << report.p99 << ", \"max\": " << report.max << "},\n";
+
+    stream << "  \"gpuCompletionLatency\": {\"average\": " << report.gpuCompletionLatencyAverage
+           << ", \"p50\": " << report.gpuCompletionLatencyP50 << ", \"p99\": " << report.gpuCompletionLatencyP99
+           << ", \"max\": " << report.gpuCompletionLatencyMax << "},\n";
+
+    stream << "  \"cpu\": {\"recording\": " << average.cpuMilliseconds
+           << ", \"fenceWait\": " << average.timings.fenceWait << ", \"acquire\": " << average.timings.acquire
+           << ", \"submit\": " << average.timings.submit << ", \"present\": " << average.timings.present << "},\n";
+
+    stream << "  \"perFrame\": {\"drawCalls\": " << average.drawCalls << ", \"triangles\": " << average.triangles
+           << ", \"pipelineBinds\": " << average.pipelineBinds << ", \"descriptorBinds\": " << average.descriptorBinds
+           << ", \"vertexBufferBinds\": " << average.vertexBufferBinds << ", \"barriers\": " << average.barriers
+           << ", \"uploadBytes\": " << average.uploadBytes << "},\n";
+
+    stream << "  \"gpuPasses\": [";
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << passes[i].name
+               << "\", \"average\": " << passes[i].averageMilliseconds << ", \"max\": " << passes[i].maxMilliseconds;
+
+        if (passes[i].hasStatistics)
+            stream << ", \"vertexInvocations\": " << passes[i].statistics.vertexShaderInvocations
+                   << ", \"fragmentInvocations\": " << passes[i].statistics.fragmentShaderInvocations;
+
+        stream << "}";
+    }
+    stream << (passes.empty() ? "],\n" : "\n  ],\n");
+
+    stream << "  \"memoryHeaps\": [";
+    for (size_t i = 0; i < heaps.size(); ++i)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    {\"deviceLocal\": " << (heaps[i].deviceLocal ? "true" : "false")
+               << ", \"usage\": " << heaps[i].usage << ", \"budget\": " << heaps[i].budget
+               << ", \"allocationBytes\": " << heaps[i].allocationBytes << ", \"blockBytes\": " << heaps[i].blockBytes
+               << "}";
+    }
+    stream << (heaps.empty() ? "],\n" : "\n  ],\n");
+
+    stream << "  \"memoryCategories\": {";
+    for (size_t i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    \""
+               << MemoryTracker::getCategoryName(static_cast<MemoryTracker::Category>(i))
+               << "\": {\"allocations\": " << memoryCategories[i].allocationCount
+               << ", \"bytes\": " << memoryCategories[i].bytes << "}";
+    }
+    stream << "\n  }\n";
+
+    stream << "}";
+}
+
+const bool vk::Benchmark::parseScene(const std::string &name, Scene &scene)
+{
+    for (const Scene candidate :
+         {Scene::Cubes, Scene::TexturedObjects, Scene::PointLights, Scene::ObjImport, Scene::TextureUpload,
+          Scene::TransparentCubes})
+    {
+        if (name == getSceneName(candidate))
+        {
+            scene = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const std::string vk::Benchmark::getSceneName(const Scene &scene)
+{
+    switch (scene)
+    {
+    case Scene::Cubes:
+        return "cubes";
+    case Scene::TexturedObjects:
+        return "textured";
+    case Scene::PointLights:
+        return "lights";
+    case Scene::ObjImport:
+        return "obj-import";
+    case Scene::TextureUpload:
+        return "texture-upload";
+    case Scene::TransparentCubes:
+        return "transparent";
+    default:
+        return "unknown";
+    }
+}
+
+void vk::Benchmark::createWindow()
+{
+    if (!options.windowed)
+        return;
+
+    window = std::make_unique<Window>(static_cast<int>(options.extent.width), static_cast<int>(options.extent.height),
+                                      "SVKE Benchmark");
+}
+
+void vk::Benchmark::createDevice()
+{
+    if (window)
+        device = std::make_unique<Device>(*window, Device::MSAA::x2);
+    else
+        device = std::make_unique<Device>(Device::MSAA::x2);
+}
+
+void vk::Benchmark::createRenderer()
+{
+    // Immediate, so a windowed run measures the renderer and not the display
+    if (window)
+        renderer = std::make_unique<Renderer>(*device, *window, Swapchain::PresentMode::Immediate, COLOR_BLACK,
+                                              options.framesInFlight);
+    else
+        renderer = std::make_unique<Renderer>(*device, options.extent, COLOR_BLACK, options.framesInFlight);
+}
+
+void vk::Benchmark::createPipelineCompiler()
+{
+    pipelineCompiler = std::make_unique<PipelineCompiler>(*device);
+}
+
+void vk::Benchmark::createGlobalPool()
+{
+    const uint32_t frames_in_flight = static_cast<uint32_t>(renderer->getFramesInFlight());
+
+    globalPool = DescriptorPool::Builder(*device)
+                     .setMaxSets(frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frames_in_flight)
+                     .build();
+}
+
+void vk::Benchmark::createObjectTexturePool()
+{
+    // At most one set per textured object, objects sharing a texture share its set
+    const bool textured = options.scene == Scene::TexturedObjects || options.scene == Scene::TextureUpload;
+    const uint32_t set_count = textured ? std::max(options.count, 1u) : 1u;
+
+    objectTexturePool = DescriptorPool::Builder(*device)
+                            .setMaxSets(set_count)
+                            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, set_count)
+                            .build();
+}
+
+void vk::Benchmark::createTextureSampler()
+{
+    TextureSampler::Config sampler_config{};
+    TextureSampler::defaultTextureSamplerConfig(sampler_config);
+    sampler_config.anisotropyEnable = VK_TRUE;
+    sampler_config.maxAnisotropy = device->getProperties().limits.maxSamplerAnisotropy;
+
+    textureSampler = std::make_unique<TextureSampler>(*device, sampler_config);
+}
+
+void vk::Benchmark::loadScene()
+{
+    std::vector<std::shared_ptr<TextureImage>> texture_images;
+
+    switch (options.scene)
+    {
+    case Scene::Cubes:
+        loadCubes(texture_images);
+        break;
+
+    case Scene::TexturedObjects: {
+        Texture texture;
+        if (!texture.loadFromFile(options.texturePath))
+            throw std::runtime_error("vk::Benchmark::loadScene: FAILED TO LOAD " + options.texturePath);
+
+        auto texture_image = std::make_shared<TextureImage>(*device, texture);
+        texture_images.assign(options.count, texture_image);
+
+        loadCubes(texture_images);
+        break;
+    }
+
+    case Scene::PointLights:
+        loadPointLights();
+        break;
+
+    case Scene::ObjImport:
+        loadObjImport();
+        break;
+
+    case Scene::TextureUpload:
+        loadTextureUpload();
+        break;
+
+    case Scene::TransparentCubes: {
+        loadCubes(texture_images);
+
+        // A few tints, so overlapping layers can be told apart
+        const std::array<Color, 4> tints{Color(255, 96, 96, 96), Color(96, 255, 96, 96), Color(96, 96, 255, 96),
+                                         Color(255, 255, 96, 96)};
+
+        for (auto &[id, object] : objects)
+            object.setColor(tints[id % tints.size()]);
+        break;
+    }
+    }
+
+#ifndef NDEBUG
+    std::cout << "LOADED BENCHMARK SCENE " << getSceneName(options.scene) << " WITH " << objects.size()
+              << " OBJECTS" << std::endl;
+#endif
+}
+
+void vk::Benchmark::loadCubes(std::vector<std::shared_ptr<TextureImage>> &texture_images)
+{
+    std::shared_ptr<Model> cube_model = std::make_shared<Model>(*device);
+    if (!cube_model->loadFromFile("assets/models/cube_tex.obj"))
+        throw std::runtime_error("vk::Benchmark::loadCubes: FAILED TO LOAD CUBE MODEL");
+
+    // Smallest grid that fits every cube, centered on the origin
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(options.count))));
+    const float spacing = 1.f;
+    const float offset = (static_cast<float>(side) - 1.f) * spacing * .5f;
+
+    for (uint32_t i = 0; i < options.count; ++i)
+    {
+        const uint32_t x = i % side;
+        const uint32_t y = (i / side) % side;
+        const uint32_t z = i / (side * side);
+
+        Object cube;
+        cube.setModel(cube_model);
+        cube.setScale({.4f, .4f, .4f});
+        cube.setTranslation(Vec3f{x * spacing - offset, y * spacing - offset, z * spacing - offset});
+
+        if (!texture_images.empty())
+            cube.setTextureImage(texture_images[i]);
+
+        objects[cube.getId()] = std::move(cube);
+    }
+
+    cameraDistance = static_cast<float>(side) * spacing * 1.5f + 2.f;
+}
+
+void vk::Benchmark::loadPointLights()
+{
+    std::shared_ptr<Model> floor_model = std::make_shared<Model>(*device);
+    if (!floor_model->loadFromFile("assets/models/cube_tex.obj"))
+        throw std::runtime_error("vk::Benchmark::loadPointLights: FAILED TO LOAD FLOOR MODEL");
+
+    Object floor;
+    floor.setModel(floor_model);
+    floor.setColor(COLOR_WHITE);
+    floor.setScale({20.f, .02f, 20.f});
+    floor.setTranslation({0.f, 2.5f, 0.f});
+    objects[floor.getId()] = std::move(floor);
+
+    // Fixed seed, so every run places the lights the same way
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(-10.f, 10.f);
+    std::uniform_real_distribution<float> height(-1.f, 2.f);
+    std::uniform_int_distribution<int> channel(64, 255);
+
+    for (uint32_t i = 0; i < options.count; ++i)
+    {
+        Object point_light = Object::makePointLight(.02f, .02f);
+
+        point_light.setColor(Color(static_cast<uint8_t>(channel(random)), static_cast<uint8_t>(channel(random)),
+                                   static_cast<uint8_t>(channel(random))));
+        point_light.setTranslation({position(random), height(random), position(random)});
+        objects[point_light.getId()] = std::move(point_light);
+    }
+
+    cameraDistance = 16.f;
+}
+
+void vk::Benchmark::loadObjImport()
+{
+    const uint64_t file_size = std::filesystem::file_size(options.modelPath);
+
+    std::shared_ptr<Model> model;
+    LoadResult result = {};
+
+    for (uint32_t i = 0; i < std::max(options.count, 1u); ++i)
+    {
+        const auto time_point = std::chrono::steady_clock::now();
+
+        model = std::make_shared<Model>(*device);
+        if (!model->loadFromFile(options.modelPath))
+            throw std::runtime_error("vk::Benchmark::loadObjImport: FAILED TO LOAD " + options.modelPath);
+
+        // Uploads do not block, the graphics queue acquires the buffers last
+        device->getGraphicsTimeline().wait(device->getGraphicsTimeline().getSubmittedValue());
+
+        result.milliseconds += FrameStats::millisecondsSince(time_point);
+        result.bytes += file_size;
+    }
+
+    loadResult = result;
+
+    // Placed like the skull in the App, the default model
+    Object object;
+    object.setModel(model);
+    object.setScale({.05f, .05f, .05f});
+    object.setRotation({Angle::Rad90, 0.f, 0.f});
+    objects[object.getId()] = std::move(object);
+
+    cameraDistance = 3.f;
+}
+
+void vk::Benchmark::loadTextureUpload()
+{
+    // Decoding is not part of the measurement, only the upload to device local memory is
+    Texture texture;
+    if (!texture.loadFromFile(options.texturePath))
+        throw std::runtime_error("vk::Benchmark::loadTextureUpload: FAILED TO LOAD " + options.texturePath);
+
+    std::vector<std::shared_ptr<TextureImage>> texture_images(options.count);
+    LoadResult result = {};
+
+    const auto time_point = std::chrono::steady_clock::now();
+
+    for (auto &texture_image : texture_images)
+        texture_image = std::make_shared<TextureImage>(*device, texture);
+
+    // Uploads do not block, the graphics queue acquires the images last
+    device->getGraphicsTimeline().wait(device->getGraphicsTimeline().getSubmittedValue());
+
+    result.milliseconds = FrameStats::millisecondsSince(time_point);
+    result.bytes = texture.getSize() * options.count;
+
+    loadResult = result;
+
+    loadCubes(texture_images);
+}
+
+void vk::Benchmark::updateCamera(Camera &camera, const uint32_t frame)
+{
+    const uint32_t measured_frame = frame > options.warmupFrames ? frame - options.warmupFrames : 0;
+    const float progress = static_cast<float>(measured_frame) / static_cast<float>(std::max(options.frames, 1u));
+    const float angle = progress * Angle::Rad360;
+
+    // Slightly above the scene (-y is up) and looking at its center
+    const Vec3f position{cameraDistance * std::sin(angle), -cameraDistance * .4f, -cameraDistance * std::cos(angle)};
+    camera.setViewTarget(position, Vec3f{0.f, 0.f, 0.f});
+}
+
+void vk::Benchmark::collectResults()
+{
+    report = renderer->getFrameStats().getReport();
+
+    const GpuProfiler &gpu_profiler = renderer->getGpuProfiler();
+
+    passes.clear();
+    for (const auto &name : gpu_profiler.getScopeNames())
+    {
+        const auto *history = gpu_profiler.getHistory(name);
+        const auto &latest = history->getLatest();
+
+        passes.push_back({name, history->getAverage(), history->getMax(), latest.hasStatistics, latest.statistics});
+    }
+
+    MemoryTracker &memory_tracker = device->getMemoryTracker();
+    memory_tracker.update();
+
+    heaps = memory_tracker.getHeapBudgets();
+
+    for (size_t i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i)
+        memoryCategories[i] = memory_tracker.getCategoryUsage(static_cast<MemoryTracker::Category>(i));
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "SVKE/Core.hpp"
+#include "SVKE/Rendering.hpp"
+#include "SVKE/Utils.hpp"
+
+#include <array>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vk
+{
+// Renders one deterministic scene for a fixed number of frames along a fixed camera path and reports frame times,
+// GPU pass times and memory usage as JSON. Runs headless unless a window is asked for, so results do not depend on
+// the compositor or the display's refresh rate.
+class Benchmark
+{
+  public:
+    enum class Scene : int
+    {
+        Cubes,           // count untextured cubes sharing one model
+        TexturedObjects, // count textured cubes sharing one texture and its descriptor set
+        PointLights,     // count point lights above a floor, culled by the LightClusterSystem
+        ObjImport,       // loads the model count times, then renders the last one
+        TextureUpload,   // uploads the texture count times, then renders one cube per upload
+        TransparentCubes // count translucent untextured cubes, drawn by the TransparentRenderSystem
+    };
+
+    struct Options
+    {
+        Scene scene = Scene::Cubes;
+        uint32_t count = 1000;
+
+        // Warm-up frames are rendered first and left out of the results
+        uint32_t frames = 600;
+        uint32_t warmupFrames = 60;
+
+        VkExtent2D extent = {1280, 720};
+        bool windowed = false;
+
+        int framesInFlight = Swapchain::DEFAULT_FRAMES_IN_FLIGHT;
+        bool lowLatency = false;
+
+        // Surfaces are shaded after a DepthPrepassSystem pass, compare fragmentInvocations of runs with and without
+        bool depthPrepass = false;
+
+        // Untextured objects are drawn through the OcclusionCullingSystem, cannot be combined with depthPrepass
+        bool occlusionCulling = false;
+
+        // Point lights that cast shadows through the PointShadowSystem, none by default
+        uint32_t shadowedLights = 0;
+
+        // How the transparent objects are blended, compare both on the transparent scene
+        TransparentRenderSystem::Mode transparency = TransparentRenderSystem::Mode::Sorted;
+
+        std::string modelPath = "assets/models/skull.obj";
+        std::string texturePath = "assets/textures/skull.jpg";
+    };
+
+    // Timed loading done before the first frame, only for the import and upload scenes
+    struct LoadResult
+    {
+        double milliseconds = 0.0;
+        uint64_t bytes = 0;
+    };
+
+    struct PassResult
+    {
+        std::string name;
+        double averageMilliseconds = 0.0;
+        double maxMilliseconds = 0.0;
+
+        // Pipeline statistics of the last measured frame, if the device supports them
+        bool hasStatistics = false;
+        GpuProfiler::Statistics statistics;
+    };
+
+    Benchmark(const Options &options);
+    Benchmark(const Benchmark &) = delete;
+    Benchmark &operator=(const Benchmark &) = delete;
+
+    void run();
+
+    // One JSON object, valid after run
+    void writeJson(std::ostream &stream) const;
+
+    static const bool parseScene(const std::string &name, Scene &scene);
+
+    static const std::string getSceneName(const Scene &scene);
+
+  private:
+    static constexpr float DT = 1.f / 60.f;
+
+    Options options;
+
+    std::unique_ptr<Window> window;
+    std::unique_ptr<Device> device;
+    std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<PipelineCompiler> pipelineCompiler;
+    std::unique_ptr<DescriptorPool> globalPool;
+    std::unique_ptr<DescriptorPool> objectTexturePool;
+    std::unique_ptr<TextureSampler> textureSampler;
+    Object::Map objects;
+
+    // How far the camera orbits from the origin, set by the scene
+    float cameraDistance;
+
+    std::optional<LoadResult> loadResult;
+    FrameStats::Report report;
+    std::vector<PassResult> passes;
+    std::vector<MemoryTracker::HeapBudget> heaps;
+    std::array<MemoryTracker::CategoryUsage, MemoryTracker::CATEGORY_COUNT> memoryCategories;
+
+    void createWindow();
+
+    void createDevice();
+
+    void createRenderer();
+
+    void createPipelineCompiler();
+
+    void createGlobalPool();
+
+    void createObjectTexturePool();
+
+    void createTextureSampler();
+
+    void loadScene();
+
+    // Cubes on a grid around the origin, cube i gets texture_images[i] if there are any
+    void loadCubes(std::vector<std::shared_ptr<TextureImage>> &texture_images);
+
+    void loadPointLights();
+
+    void loadObjImport();
+
+    void loadTextureUpload();
+
+    // Orbits the origin once over the measured frames, warm-up frames stay at the start
+    void updateCamera(Camera &camera, const uint32_t frame);
+
+    void collectResults();
+};
+} // namespace vk
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " <cubes|textured|lights|obj-import|texture-upload|transparent>"
+              << " [--count <n>[,<n>...]] [--frames <n>] [--warmup <n>] [--size <width>x<height>] [--window]"
+              << " [--frames-in-flight <1-3>] [--low-latency] [--depth-prepass] [--occlusion-culling]"
+              << " [--shadowed-lights <n>] [--transparency <sorted|weighted>]"
+              << " [--model <file.obj>] [--texture <file>] [--output <file.json>]" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    vk::Benchmark::Options options = {};
+    std::vector<uint32_t> counts;
+    std::string output_path;
+
+    if (argc < 2 || !vk::Benchmark::parseScene(argv[1], options.scene))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+        {
+            // A list runs the scene once per count, e.g. 1000,10000,100000,1000000
+            std::stringstream list(argv[++i]);
+            std::string count;
+
+            while (std::getline(list, count, ','))
+                counts.push_back(static_cast<uint32_t>(std::stoul(count)));
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            options.warmupFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            const std::string size = argv[++i];
+            const size_t separator = size.find('x');
+
+            if (separator == std::string::npos)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+
+            options.extent.width = static_cast<uint32_t>(std::stoul(size.substr(0, separator)));
+            options.extent.height = static_cast<uint32_t>(std::stoul(size.substr(separator + 1)));
+        }
+        else if (std::strcmp(argv[i], "--window") == 0)
+        {
+            options.windowed = true;
+        }
+        else if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+        {
+            options.framesInFlight = std::clamp(std::stoi(argv[++i]), 1, vk::Swapchain::MAX_FRAMES_IN_FLIGHT);
+        }
+        else if (std::strcmp(argv[i], "--low-latency") == 0)
+        {
+            options.lowLatency = true;
+        }
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+        {
+            options.depthPrepass = true;
+        }
+        else if (std::strcmp(argv[i], "--occlusion-culling") == 0)
+        {
+            options.occlusionCulling = true;
+        }
+        else if (std::strcmp(argv[i], "--shadowed-lights") == 0 && i + 1 < argc)
+        {
+            options.shadowedLights = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--transparency") == 0 && i + 1 < argc)
+        {
+            const std::string mode = argv[++i];
+
+            if (mode == "sorted")
+                options.transparency = vk::TransparentRenderSystem::Mode::Sorted;
+            else if (mode == "weighted")
+                options.transparency = vk::TransparentRenderSystem::Mode::WeightedBlended;
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+        {
+            options.modelPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--texture") == 0 && i + 1 < argc)
+        {
+            options.texturePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.depthPrepass && options.occlusionCulling)
+    {
+        std::cerr << "--depth-prepass and --occlusion-culling cannot be combined" << std::endl;
+        return 1;
+    }
+
+    if (counts.empty())
+        counts.push_back(options.count);
+
+    std::stringstream json;
+    json << "{\"runs\": [\n";
+
+    try
+    {
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            options.count = counts[i];
+
+            // Every count gets a fresh device, so memory and caches of the previous run do not carry over
+            vk::Benchmark benchmark(options);
+            benchmark.run();
+
+            if (i > 0)
+                json << ",\n";
+
+            benchmark.writeJson(json);
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    json << "\n]}\n";
+
+    if (output_path.empty())
+    {
+        std::cout << json.str();
+        return 0;
+    }
+
+    std::ofstream file(output_path);
+    if (!file)
+    {
+        std::cerr << "Failed to open " << output_path << std::endl;
+        return 1;
+    }
+
+    file << json.str();
+
+    return 0;
+}
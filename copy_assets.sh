@@ -1,19 +1,32 @@
 #!/usr/bin/bash
 
+# Copies every asset folder but the shaders, which the build compiles into $2/assets/shaders itself
 if [[ -d $1 && -d $2 ]]
 then
-    differ=1
+    mkdir -p "$2/assets"
 
-    if [[ -d "$1/assets" && -d "$2/assets" ]]
-    then
-        diff -r -q "$1/assets" "$2/assets"
-        differ=$?
-    fi
+    for source in "$1"/assets/*/
+    do
+        name=$(basename "$source")
 
-    if [[ $differ -eq 1 ]]
-    then
-        echo "Copying assets folder"
-        rm -rf "$2/assets/"
-        cp -r "$1/assets/" "$2/"
-    fi
+        if [[ $name == "shaders" ]]
+        then
+            continue
+        fi
+
+        differ=1
+
+        if [[ -d "$2/assets/$name" ]]
+        then
+            diff -r -q "$source" "$2/assets/$name"
+            differ=$?
+        fi
+
+        if [[ $differ -ne 0 ]]
+        then
+            echo "Copying assets/$name"
+            rm -rf "$2/assets/$name"
+            cp -r "$source" "$2/assets/$name"
+        fi
+    done
 fi
@@ -9,7 +9,39 @@ namespace vk
 class App
 {
   public:
+    struct Options
+    {
+        // Adds that many small point lights and a floor to the scene, to stress the light culling
+        uint32_t stressLights = 0;
+
+        // Renders that many frames without a window, then writes the last one to headlessOutput
+        uint32_t headlessFrames = 0;
+        std::string headlessOutput = "svke_headless.ppm";
+
+        // Captures every frame from the start into this directory, F9 toggles capturing at any time
+        std::string captureDirectory;
+
+        // Between 1 and Swapchain::MAX_FRAMES_IN_FLIGHT
+        int framesInFlight = Swapchain::DEFAULT_FRAMES_IN_FLIGHT;
+
+        // Delays sampling input until just before the frame is recorded, F8 toggles it at any time
+        bool lowLatency = false;
+
+        // Lays down the depth of the scene before shading it, F7 toggles it at any time
+        bool depthPrepass = false;
+
+        // Draws the untextured objects through the OcclusionCullingSystem, cannot be combined with depthPrepass
+        bool occlusionCulling = false;
+
+        // Point lights closest to the camera that cast shadows, 0 leaves every light unshadowed
+        uint32_t shadowedLights = PointShadowSystem::DEFAULT_SHADOWED_LIGHT_COUNT;
+
+        // How the translucent objects are blended, F6 switches between both at any time
+        TransparentRenderSystem::Mode transparency = TransparentRenderSystem::Mode::Sorted;
+    };
+
     App();
+    App(const Options &options);
     App(const App &) = delete;
     App &operator=(const App &) = delete;
     App(App &&) = delete;
@@ -18,9 +50,23 @@ class App
     void run();
 
   private:
+    inline static const std::string TRACE_PATH = "svke_trace.json";
+    inline static const std::string CAPTURE_DIRECTORY = "svke_capture";
+    inline static const std::string MEMORY_PATH = "svke_memory.json";
+    static constexpr VkExtent2D EXTENT = {846, 484};
+
+    // Headless runs advance by a fixed step, so the same frame count always renders the same image
+    static constexpr float HEADLESS_DT = 1.f / 60.f;
+
+    Options options;
+
     std::unique_ptr<Window> window;
     std::unique_ptr<Device> device;
     std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<PipelineCompiler> pipelineCompiler;
+#ifdef SVKE_SHADER_HOT_RELOAD
+    std::unique_ptr<ShaderWatcher> shaderWatcher;
+#endif
     std::unique_ptr<DescriptorPool> globalPool;
     std::unique_ptr<DescriptorPool> objectTexturePool;
     std::unique_ptr<TextureSampler> textureSampler;
@@ -32,6 +78,10 @@ class App
 
     void createRenderer();
 
+    void createPipelineCompiler();
+
+    void createShaderWatcher();
+
     void createGlobalPool();
 
     void createObjectTexturePool();
@@ -39,5 +89,12 @@ class App
     void createTextureSampler();
 
     void loadObjects();
+
+    void loadStressLights();
+
+    // Binary PPM of the last headless frame, alpha is dropped
+    void writeHeadlessOutput();
+
+    const bool isHeadless() const;
 };
 } // namespace vk
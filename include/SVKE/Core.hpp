@@ -1,8 +1,11 @@
 #pragma once
 
 #include "SVKE/Core/Graphics/Color.hpp"
+#include "SVKE/Core/Graphics/ComputePipeline.hpp"
 #include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
 #include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Core/Graphics/ShaderWatcher.hpp"
 #include "SVKE/Core/Graphics/Texture.hpp"
 #include "SVKE/Core/Graphics/TextureImage.hpp"
 #include "SVKE/Core/Graphics/TextureSampler.hpp"
@@ -13,9 +16,21 @@
 #include "SVKE/Core/Math/Angle.hpp"
 #include "SVKE/Core/Math/Matrix.hpp"
 #include "SVKE/Core/Math/Vector.hpp"
+#include "SVKE/Core/System/CommandBufferManager.hpp"
 #include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/FrameCapture.hpp"
+#include "SVKE/Core/System/GpuProfiler.hpp"
 #include "SVKE/Core/System/Memory/Alignment.hpp"
+#include "SVKE/Core/System/Memory/AttachmentPool.hpp"
 #include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Memory/FrameBufferRing.hpp"
+#include "SVKE/Core/System/Memory/MemoryTracker.hpp"
+#include "SVKE/Core/System/OffscreenTarget.hpp"
+#include "SVKE/Core/System/RenderTarget.hpp"
 #include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Core/System/Timeline.hpp"
 #include "SVKE/Core/System/Window.hpp"
+#include "SVKE/Core/Time/FramePacer.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
 #include "SVKE/Core/Time/Timer.hpp"
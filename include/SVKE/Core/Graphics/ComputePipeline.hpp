@@ -0,0 +1,27 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+namespace vk
+{
+class ComputePipeline
+{
+  public:
+    ComputePipeline(Device &device, Shader &comp_shader, VkPipelineLayout pipeline_layout,
+                    VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+    ComputePipeline(const ComputePipeline &) = delete;
+    ComputePipeline &operator=(const ComputePipeline &) = delete;
+
+    ~ComputePipeline();
+
+    void bind(VkCommandBuffer &command_buffer);
+
+  private:
+    Device &device;
+    VkPipeline computePipeline;
+
+    void createComputePipeline(Shader &comp_shader, VkPipelineLayout pipeline_layout, VkPipelineCache pipeline_cache);
+};
+} // namespace vk
@@ -3,7 +3,9 @@
 #include "SVKE/Core/System/Device.hpp"
 #include "SVKE/Core/Graphics/Shader.hpp"
 #include "SVKE/Core/Graphics/Vertex.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
 
+#include <array>
 #include <string>
 #include <fstream>
 #include <vector>
@@ -16,6 +18,13 @@ namespace vk
 class Pipeline
 {
   public:
+    // Specialization constants of one shader stage. Every constant is 32 bits wide (int, uint, float or bool).
+    struct Specialization
+    {
+        std::vector<VkSpecializationMapEntry> mapEntries;
+        std::vector<uint32_t> data;
+    };
+
     struct Config
     {
         Config() = default;
@@ -35,8 +44,36 @@ class Pipeline
         std::vector<VkDynamicState> dynamicStatesEnable;
         VkPipelineDynamicStateCreateInfo dynamicStateInfo;
         VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-        VkRenderPass renderPass = VK_NULL_HANDLE;
-        uint32_t subpass = 0;
+
+        // Of the attachments the pipeline is drawn into with dynamic rendering, VK_FORMAT_UNDEFINED if there is none
+        VkFormat colorAttachmentFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+        // Color attachments following the first one, each blended as its entry in extraColorBlendAttachments
+        std::vector<VkFormat> extraColorAttachmentFormats;
+        std::vector<VkPipelineColorBlendAttachmentState> extraColorBlendAttachments;
+
+        // One bit per layer drawn by every draw with multiview, gl_ViewIndex tells the shader which one. 0 disables it.
+        uint32_t viewMask = 0;
+        Specialization vertSpecialization;
+        Specialization fragSpecialization;
+    };
+
+    // Creation info that points into itself and into a Config, both must outlive the vkCreateGraphicsPipelines call.
+    struct CreateInfo
+    {
+        CreateInfo() = default;
+        CreateInfo(const CreateInfo &) = delete;
+        CreateInfo &operator=(const CreateInfo &) = delete;
+
+        std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages;
+        std::array<VkSpecializationInfo, 2> specializationInfos;
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo;
+        std::vector<VkFormat> colorAttachmentFormats;
+        std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo;
+        VkPipelineRenderingCreateInfo renderingInfo;
+        VkGraphicsPipelineCreateInfo pipelineInfo;
     };
 
     Pipeline(Device &device, const std::string &vert_path, const std::string &frag_path);
@@ -45,6 +82,9 @@ class Pipeline
     Pipeline(Device &device, Shader &vert_shader, Shader &frag_shader);
     Pipeline(Device &device, Shader &vert_shader, Shader &frag_shader, const Config &config);
 
+    // Takes ownership of an already created pipeline (e.g. one built by the PipelineCompiler).
+    Pipeline(Device &device, VkPipeline pipeline);
+
     Pipeline(const Pipeline &) = delete;
     Pipeline &operator=(const Pipeline &) = delete;
 
@@ -56,6 +96,16 @@ class Pipeline
 
     static void enableAlphaBlending(Config &config);
 
+    // Sets constant_id to value, replacing the previous value if the constant was already set.
+    static void setSpecializationConstant(Specialization &specialization, const uint32_t constant_id,
+                                          const uint32_t value);
+
+    static void copyConfig(const Config &source, Config &destination);
+
+    // A VK_NULL_HANDLE frag_module leaves out the fragment stage, fragments then only write depth.
+    static void populateCreateInfo(const Config &config, VkShaderModule vert_module, VkShaderModule frag_module,
+                                   CreateInfo &create_info);
+
   private:
     Device &device;
     VkPipeline graphicsPipeline;
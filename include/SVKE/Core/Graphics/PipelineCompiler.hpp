@@ -0,0 +1,139 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vk
+{
+class PipelineCompiler
+{
+  public:
+    class Handle
+    {
+      public:
+        enum class State : int
+        {
+            Pending,
+            Ready,
+            Failed
+        };
+
+        Handle(std::shared_ptr<Handle> fallback = nullptr);
+        Handle(const Handle &) = delete;
+        Handle &operator=(const Handle &) = delete;
+
+        // Binds the compiled pipeline, or the fallback while it is still compiling.
+        // A pipeline being recompiled keeps binding its previous version until PipelineCompiler::update swaps it.
+        // Returns false if neither is available, in which case nothing should be drawn with it.
+        const bool bind(VkCommandBuffer &command_buffer);
+
+        [[nodiscard]]
+        const bool isReady() const;
+
+        [[nodiscard]]
+        const State getState() const;
+
+        // Waits for the pending compilation and, if any, the pending recompilation.
+        void wait() const;
+
+      private:
+        std::atomic<State> state;
+        std::unique_ptr<Pipeline> pipeline;
+        std::shared_ptr<Handle> fallback;
+        std::shared_ptr<Handle> replacement;
+
+        mutable std::mutex mutex;
+        mutable std::condition_variable condition;
+
+        void resolve(std::unique_ptr<Pipeline> compiled);
+
+        friend class PipelineCompiler;
+    };
+
+    // A worker_count of 0 picks half of the hardware threads (at least one).
+    PipelineCompiler(Device &device, const uint32_t worker_count = 0, const uint32_t max_batch_size = 16);
+    PipelineCompiler(const PipelineCompiler &) = delete;
+    PipelineCompiler &operator=(const PipelineCompiler &) = delete;
+
+    ~PipelineCompiler();
+
+    // The shaders must stay alive until the returned handle is no longer pending.
+    std::shared_ptr<Handle> compile(Shader &vert_shader, Shader &frag_shader, const Pipeline::Config &config,
+                                    std::shared_ptr<Handle> fallback = nullptr);
+
+    // Pipeline without a fragment stage, e.g. for depth only passes.
+    std::shared_ptr<Handle> compile(Shader &vert_shader, const Pipeline::Config &config,
+                                    std::shared_ptr<Handle> fallback = nullptr);
+
+    // Rebuilds the pipeline behind an existing handle, which keeps its current pipeline until the new one is ready.
+    // If the compilation fails, the current pipeline is kept.
+    void recompile(const std::shared_ptr<Handle> &handle, Shader &vert_shader, Shader &frag_shader,
+                   const Pipeline::Config &config);
+
+    void recompile(const std::shared_ptr<Handle> &handle, Shader &vert_shader, const Pipeline::Config &config);
+
+    // Must be called at a frame boundary: swaps in finished recompilations. Replaced pipelines are released
+    // through the graphics timeline once the frames that may reference them have finished. Retired shaders are
+    // destroyed once no compilation is queued or running.
+    void update();
+
+    // Keeps a shader that queued compilations may still reference, so it can be replaced without waiting for them
+    void retire(std::unique_ptr<Shader> shader);
+
+    void waitIdle();
+
+    VkPipelineCache getPipelineCache();
+
+  private:
+    struct Request
+    {
+        std::shared_ptr<Handle> handle;
+        VkShaderModule vertModule;
+        VkShaderModule fragModule;
+        Pipeline::Config config;
+        Pipeline::CreateInfo createInfo;
+    };
+
+    Device &device;
+    VkPipelineCache pipelineCache;
+    uint32_t maxBatchSize;
+
+    std::vector<std::thread> workers;
+    std::deque<std::unique_ptr<Request>> queue;
+    std::mutex queueMutex;
+    std::condition_variable workCondition;
+    std::condition_variable idleCondition;
+    uint32_t busyWorkers;
+    bool stopping;
+
+    // Only touched from the thread calling recompile() and update()
+    std::vector<std::shared_ptr<Handle>> recompiling;
+    std::vector<std::unique_ptr<Shader>> retiredShaders;
+
+    void createPipelineCache();
+
+    void replace(const std::shared_ptr<Handle> &handle, Shader &vert_shader, Shader *frag_shader,
+                 const Pipeline::Config &config);
+
+    // frag_shader is nullptr for vertex only pipelines
+    std::shared_ptr<Handle> enqueue(Shader &vert_shader, Shader *frag_shader, const Pipeline::Config &config,
+                                    std::shared_ptr<Handle> fallback);
+
+    void startWorkers(const uint32_t worker_count);
+
+    void workerLoop();
+
+    void compileBatch(std::vector<std::unique_ptr<Request>> &batch);
+};
+} // namespace vk
@@ -30,6 +30,10 @@ class Shader
 
     VkShaderModule &getModule();
 
+    // Whether one of the recompiled SPIR-V paths (see ShaderWatcher::pollChanges) is one of paths
+    static const bool isAnyChanged(const std::vector<std::string> &changed_paths,
+                                   const std::vector<std::string> &paths);
+
   private:
     Device &device;
     VkShaderModule module;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "SVKE/Core/Time/Profiler.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+namespace vk
+{
+// Watches a directory of GLSL sources with inotify and recompiles changed files in the background with glslc.
+// Only shaders that compiled successfully are reported, so a broken edit never replaces a working pipeline.
+class ShaderWatcher
+{
+  public:
+    ShaderWatcher(const std::string &source_dir, const std::string &output_dir, const std::string &compiler = "glslc");
+    ShaderWatcher(const ShaderWatcher &) = delete;
+    ShaderWatcher &operator=(const ShaderWatcher &) = delete;
+
+    ~ShaderWatcher();
+
+    // Returns the SPIR-V paths recompiled since the last call, e.g. "assets/shaders/render_system.frag.spv".
+    [[nodiscard]]
+    std::vector<std::string> pollChanges();
+
+    [[nodiscard]]
+    const bool isWatching() const;
+
+  private:
+    std::string sourceDir;
+    std::string outputDir;
+    std::string compiler;
+
+    int inotifyFd;
+    int watchDescriptor;
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::mutex changesMutex;
+    std::vector<std::string> changes;
+
+    void startWatching();
+
+    void watchLoop();
+
+    void readEvents(std::set<std::string> &changed_files);
+
+    void compileChanged(const std::set<std::string> &changed_files);
+
+    const bool compileShader(const std::string &file_name);
+
+    static const bool isShaderStage(const std::string &file_name);
+
+    static const bool isShaderInclude(const std::string &file_name);
+};
+} // namespace vk
@@ -29,8 +29,7 @@ class TextureImage
 
     void createImage(Texture &texture, const VkImageTiling tiling, const VkImageUsageFlags usage);
 
-    void transitionImageLayout(const VkImageLayout old_layout, const VkImageLayout new_layout);
-
+    // Uploaded through the transfer queue, see Device::endUploadCommands
     void copyTextureToImage(Texture &texture);
 
     void createImageView();
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Core/System/Timeline.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+// Command buffers of the frames in flight, taken from one pool per recording thread and frame. They are never freed
+// one by one: beginFrame resets every pool of the frame at once with vkResetCommandPool, once the timeline has reached
+// the frame's last submission, and the buffers they handed out before are handed out again. A thread only records
+// into buffers of its own pools, so threads can record a frame in parallel.
+class CommandBufferManager
+{
+  public:
+    CommandBufferManager(Device &device, const uint32_t queue_family, Timeline &timeline, const int frames_in_flight);
+    ~CommandBufferManager();
+
+    CommandBufferManager(const CommandBufferManager &) = delete;
+    CommandBufferManager &operator=(const CommandBufferManager &) = delete;
+
+    // Resets the pools of frame_index, waiting for its last submission if it has not finished. No thread may be
+    // recording a buffer of the manager.
+    void beginFrame(const int frame_index);
+
+    // The value of the frame's last submission, its pools are reset once the timeline has reached it
+    void endFrame(const uint64_t submitted_value);
+
+    // From the calling thread's pool of the current frame, not begun. Valid until the frame's pools are reset.
+    VkCommandBuffer acquirePrimary();
+
+    // Same as acquirePrimary, to be recorded with VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT or not and executed
+    // by a primary buffer of the same frame
+    VkCommandBuffer acquireSecondary();
+
+    // Allocated so far, over every thread and frame
+    const size_t getAllocatedCount() const;
+
+  private:
+    struct Pool
+    {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+
+        // The first ones of each level were handed out since the last reset, the others are free
+        std::vector<VkCommandBuffer> primaryBuffers;
+        std::vector<VkCommandBuffer> secondaryBuffers;
+        size_t primaryCount = 0;
+        size_t secondaryCount = 0;
+    };
+
+    // Of one thread, one per frame in flight
+    using FramePools = std::array<Pool, Swapchain::MAX_FRAMES_IN_FLIGHT>;
+
+    Device &device;
+    uint32_t queueFamily;
+    Timeline &timeline;
+    int framesInFlight;
+    int currentFrameIndex;
+    std::array<uint64_t, Swapchain::MAX_FRAMES_IN_FLIGHT> frameValues;
+
+    // A thread's pools are created the first time it asks for a buffer
+    mutable std::mutex threadsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<FramePools>> threads;
+
+    Pool &getThreadPool();
+
+    VkCommandBuffer acquire(Pool &pool, const VkCommandBufferLevel level);
+};
+} // namespace vk
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "SVKE/Core/System/Memory/MemoryTracker.hpp"
+#include "SVKE/Core/System/Timeline.hpp"
 #include "SVKE/Core/System/Window.hpp"
 
 #include <vk_mem_alloc.h>
@@ -10,10 +12,14 @@
 #include <iostream>
 #include <set>
 #include <map>
+#include <memory>
 #include <optional>
 
 namespace vk
 {
+class AttachmentPool;
+class GpuProfiler;
+
 class Device
 {
   public:
@@ -28,10 +34,14 @@ class Device
         std::vector<VkPresentModeKHR> presentModes;
     };
 
+    // Transfer and compute are only set for families of their own: a copy engine without graphics or compute, and
+    // compute without graphics. The graphics queue stands in for them otherwise.
     struct QueueFamilyIndices
     {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        std::optional<uint32_t> transferFamily;
+        std::optional<uint32_t> computeFamily;
         inline const bool isComplete() { return graphicsFamily.has_value() && presentFamily.has_value(); }
     };
 
@@ -48,6 +58,9 @@ class Device
 
     Device(Window &window, const MSAA &preferred_msaa_samples = MSAA::x1);
 
+    // Headless: no surface and no swapchain extension, for rendering into an OffscreenTarget only
+    Device(const MSAA &preferred_msaa_samples = MSAA::x1);
+
     Device(const Device &) = delete;
     Device &operator=(const Device &) = delete;
     Device(Device &&) = delete;
@@ -57,18 +70,70 @@ class Device
 
     VmaAllocator getAllocator();
 
+    const bool isHeadless() const;
+
     const VkPhysicalDeviceProperties &getProperties() const;
 
+    // Optional features are only enabled if the physical device supports them
+    const VkPhysicalDeviceFeatures &getEnabledFeatures() const;
+
+    // Same as getEnabledFeatures, for the features that became core in Vulkan 1.2
+    const VkPhysicalDeviceVulkan12Features &getEnabledVulkan12Features() const;
+
+    // And those of Vulkan 1.3
+    const VkPhysicalDeviceVulkan13Features &getEnabledVulkan13Features() const;
+
     VkDevice getLogicalDevice();
 
+    VkPhysicalDevice getPhysicalDevice();
+
     VkSurfaceKHR getSurface();
 
+    // Of the graphics family, for one-time commands only: frames are recorded from the Renderer's
+    // CommandBufferManager
     VkCommandPool getCommandPool();
 
+    // Of the transfer and compute families, the graphics pool without a dedicated family. Like it, they are only
+    // used from the thread the device was created on.
+    VkCommandPool getTransferCommandPool();
+
+    VkCommandPool getComputeCommandPool();
+
     VkQueue getGraphicsQueue();
 
     VkQueue getPresentQueue();
 
+    // The graphics queue without a dedicated family
+    VkQueue getTransferQueue();
+
+    VkQueue getComputeQueue();
+
+    // Every submission to the graphics queue goes through it
+    Timeline &getGraphicsTimeline();
+
+    // Those of the dedicated queues, the graphics timeline when they share its queue
+    Timeline &getTransferTimeline();
+
+    Timeline &getComputeTimeline();
+
+    // Single queue devices, such as lavapipe, have neither
+    const bool hasDedicatedTransferQueue() const;
+
+    const bool hasDedicatedComputeQueue() const;
+
+    // VK_EXT_swapchain_maintenance1, enabled when the instance and the device support it. Presentations then signal
+    // fences once the semaphores and images they used can be released, see Swapchain.
+    const bool hasSwapchainMaintenance1() const;
+
+    // Of the queues in use, unlike findPhysicalQueueFamilies it does not query the physical device again
+    const QueueFamilyIndices &getQueueFamilyIndices() const;
+
+    // Depth and multisampled color attachments of render targets are taken from and given back to it
+    AttachmentPool &getAttachmentPool();
+
+    // Usage per category and per heap of everything allocated from the allocator, see MemoryTracker
+    MemoryTracker &getMemoryTracker();
+
     SwapchainSupportDetails getSwapchainSupport();
 
     const VkSampleCountFlagBits &getMsaaMaxSamples() const;
@@ -86,24 +151,73 @@ class Device
 
     void endSingleTimeCommands(VkCommandBuffer command_buffer);
 
+    // Begins recording an upload for the transfer queue, to be submitted by endUploadCommands. Its GPU time goes to
+    // the upload profiler's history of name, if there is one.
+    VkCommandBuffer beginUploadCommands(const std::string &name = "Upload");
+
+    // Submits an upload without waiting for it and returns the graphics timeline value after which the uploaded
+    // resources can be used. The barriers hand them over to the graphics queue: their src stages and accesses are
+    // those of the upload, their dst ones those of the first use, their queue families are filled in. With a dedicated
+    // transfer queue, a submission to the graphics queue waits for the upload and acquires them. Otherwise the upload
+    // itself is submitted to the graphics queue. Either way, what is deferred on the graphics timeline afterwards,
+    // e.g. the staging buffer, is only released once the upload has finished.
+    const uint64_t endUploadCommands(VkCommandBuffer command_buffer,
+                                     const std::vector<VkBufferMemoryBarrier2> &buffer_barriers,
+                                     const std::vector<VkImageMemoryBarrier2> &image_barriers);
+
+    // Records the release half of a queue family ownership transfer into release_command_buffer and the acquire half
+    // into acquire_command_buffer, which must then be submitted after the release has finished. Layout transitions
+    // are part of both halves. If both families are the same, it is a single barrier in acquire_command_buffer.
+    static void recordOwnershipTransfer(VkCommandBuffer release_command_buffer, const uint32_t src_family,
+                                        VkCommandBuffer acquire_command_buffer, const uint32_t dst_family,
+                                        std::vector<VkBufferMemoryBarrier2> buffer_barriers,
+                                        std::vector<VkImageMemoryBarrier2> image_barriers);
+
+    // Tracked in the category, images created with it must be destroyed with destroyImage
     void createImageWithInfo(const VkImageCreateInfo &image_info, VkMemoryPropertyFlags properties, VkImage &image,
-                             VmaAllocation &image_memory);
+                             VmaAllocation &image_memory,
+                             const MemoryTracker::Category category = MemoryTracker::Category::Attachment);
+
+    void destroyImage(VkImage image, VmaAllocation image_memory);
+
+    // Times the uploads begun from then on, see GpuProfiler::beginUpload. nullptr stops timing them.
+    void setUploadProfiler(GpuProfiler *profiler);
 
     static const std::string getMsaaSamplesAsString(const MSAA &samples);
 
   private:
-    Window &window;
+    Window *window;
 
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
     VkSurfaceKHR surface;
     VkPhysicalDevice physicalDevice;
     VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceFeatures enabledFeatures;
+    VkPhysicalDeviceVulkan12Features enabledVulkan12Features;
+    VkPhysicalDeviceVulkan13Features enabledVulkan13Features;
     VkDevice device;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue transferQueue;
+    VkQueue computeQueue;
+    QueueFamilyIndices queueFamilyIndices;
     VmaAllocator allocator;
     VkCommandPool commandPool;
+    VkCommandPool transferCommandPool;
+    VkCommandPool computeCommandPool;
+    std::unique_ptr<Timeline> graphicsTimeline;
+    std::unique_ptr<Timeline> transferTimeline;
+    std::unique_ptr<Timeline> computeTimeline;
+    std::unique_ptr<AttachmentPool> attachmentPool;
+    std::unique_ptr<MemoryTracker> memoryTracker;
+    GpuProfiler *uploadProfiler;
+    bool surfaceMaintenance1;
+    bool swapchainMaintenance1;
+
+    // One-time command buffers that have finished, per pool, begun again instead of allocating new ones. Their
+    // pools reset them individually when they are begun.
+    std::map<VkCommandPool, std::vector<VkCommandBuffer>> freeCommandBuffers;
 
     VkSampleCountFlagBits msaaMaxSamples;
     VkSampleCountFlagBits currentMsaaSamples;
@@ -120,14 +234,25 @@ class Device
 
     void createLogicalDevice();
 
+    void createTimelines();
+
     void createVmaAllocator();
 
-    void createCommandPool();
+    void createCommandPools();
+
+    VkCommandPool createCommandPool(const uint32_t queue_family);
+
+    // From the pool's free command buffers, allocated when there are none
+    VkCommandBuffer beginCommands(VkCommandPool command_pool);
+
+    void recycleCommandBuffer(VkCommandPool command_pool, VkCommandBuffer command_buffer);
 
     const int rateDeviceSuitability(VkPhysicalDevice physical_device);
 
     const std::vector<const char *> getRequiredExtensions();
 
+    const std::vector<const char *> getRequiredDeviceExtensions() const;
+
     const bool checkValidationLayerSupport();
 
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
@@ -136,6 +261,10 @@ class Device
 
     const bool checkDeviceExtensionSupport(VkPhysicalDevice physical_device);
 
+    static const bool isInstanceExtensionSupported(const char *extension);
+
+    static const bool isDeviceExtensionSupported(VkPhysicalDevice physical_device, const char *extension);
+
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice physical_device);
 
     SwapchainSupportDetails querySwapchainSupport(VkPhysicalDevice physical_device);
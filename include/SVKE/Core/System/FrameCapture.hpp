@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vk
+{
+// Captures rendered frames to disk without stalling the frame loop. Each frame's image is copied into one of a ring
+// of host-visible buffers by the frame's own command buffer. Once the GPU is known to be done with that frame, the
+// buffer goes to a worker thread that encodes and writes it, and only then can the buffer be used again. If every
+// buffer is still busy, the frame is dropped instead of waited for.
+class FrameCapture
+{
+  public:
+    enum class Format
+    {
+        Png, // Uncompressed PNG, see writePng
+        Raw  // RGBA bytes, the extent is part of the file name
+    };
+
+    struct Options
+    {
+        std::string directory = "svke_capture";
+        Format format = Format::Png;
+
+        // More buffers tolerate slower encoding before frames are dropped
+        uint32_t bufferCount = 6;
+    };
+
+    FrameCapture(Device &device, const VkExtent2D &extent, const VkFormat &image_format, const Options &options);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    // Records the copy of image, which the render pass left in layout, and gives the image its layout back
+    void record(VkCommandBuffer &command_buffer, VkImage image, const VkImageLayout layout,
+                const uint64_t frame_number);
+
+    // Tags the copies recorded since the last call with the graphics timeline value of their submission
+    void submitted(const uint64_t timeline_value);
+
+    // Hands every buffer whose submission has finished on the GPU to the worker, never waits
+    void collect();
+
+    // Whether frames of a render target with that extent and image format fit the buffers
+    const bool fits(const VkExtent2D &extent, const VkFormat &image_format) const;
+
+    const Options &getOptions() const;
+
+    const uint64_t getWrittenCount() const;
+
+    const uint64_t getDroppedCount() const;
+
+  private:
+    enum class SlotState : uint8_t
+    {
+        Free,
+        Recorded, // Copy is in a command buffer that may still be executing
+        Encoding  // Owned by the worker
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<Buffer> buffer;
+        std::atomic<SlotState> state{SlotState::Free};
+        uint64_t frameNumber = 0;
+
+        // 0 while recorded but not yet submitted
+        uint64_t timelineValue = 0;
+    };
+
+    Device &device;
+    VkExtent2D extent;
+    VkFormat imageFormat;
+    bool swizzle;
+    Options options;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    size_t nextSlot;
+
+    std::atomic<uint64_t> writtenCount;
+    uint64_t droppedCount;
+
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Slot *> queue;
+    bool stopping;
+
+    void workerLoop();
+
+    void encode(Slot &slot, std::vector<uint8_t> &pixels);
+};
+} // namespace vk
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+// Measures GPU time spent in named scopes of a frame with timestamp queries, and optionally what the scope cost in
+// primitives and shader invocations with pipeline statistics queries. Every frame in flight owns its own query range.
+// Results are read back without waiting when the same frame index comes around again, so they lag as many frames as
+// are in flight, and are kept in a rolling history per scope name. Uploads recorded with Device::beginUploadCommands
+// are timed as well, in the history of the name they were begun with.
+class GpuProfiler
+{
+  public:
+    // Pipeline statistics of one scope, only available if the device supports pipelineStatisticsQuery
+    struct Statistics
+    {
+        uint64_t inputAssemblyPrimitives = 0;
+        uint64_t vertexShaderInvocations = 0;
+        uint64_t clippingPrimitives = 0;
+        uint64_t fragmentShaderInvocations = 0;
+        uint64_t computeShaderInvocations = 0;
+    };
+
+    struct Timing
+    {
+        std::string name;
+        double milliseconds;
+        bool hasStatistics;
+        Statistics statistics;
+    };
+
+    // The last results of one scope, oldest first
+    class History
+    {
+      public:
+        History(const size_t capacity);
+
+        void push(const Timing &timing);
+
+        const std::vector<double> getSamples() const;
+
+        const double getAverage() const;
+
+        const double getMax() const;
+
+        const Timing &getLatest() const;
+
+        const size_t size() const;
+
+      private:
+        std::vector<double> samples;
+        size_t next;
+        size_t count;
+        Timing latest;
+    };
+
+    // Records a scope for as long as it lives
+    class Scope
+    {
+      public:
+        Scope(GpuProfiler &profiler, VkCommandBuffer &command_buffer, const std::string &name,
+              const bool statistics = true);
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope();
+
+      private:
+        GpuProfiler &profiler;
+        VkCommandBuffer &commandBuffer;
+    };
+
+    GpuProfiler(Device &device, const uint32_t max_scopes = 32, const size_t history_length = 120,
+                const bool pipeline_statistics = true);
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+    ~GpuProfiler();
+
+    // Must be recorded first in the frame's command buffer, outside of a render pass.
+    void beginFrame(VkCommandBuffer &command_buffer, const int frame_index);
+
+    // Scopes can be nested. Scopes past max_scopes in a frame are ignored.
+    // Only one statistics query can be active at a time, so statistics are skipped for scopes nested in a scope that
+    // already collects them. A scope that begins inside a render pass must end in the same one.
+    void beginScope(VkCommandBuffer &command_buffer, const std::string &name, const bool statistics = true);
+
+    void endScope(VkCommandBuffer &command_buffer);
+
+    // Called by the Device for the uploads it records, the profiler registers itself as its upload profiler. Uploads
+    // are outside of frames and may be recorded for the transfer queue, so they have their own queries, reset from
+    // the host, and are collected by beginFrame once their graphics timeline value is reached. Uploads begun while
+    // MAX_PENDING_UPLOADS are waiting to be collected are not timed.
+    void beginUpload(VkCommandBuffer command_buffer, const std::string &name);
+
+    // Before the upload's own commands end, not its ownership transfer
+    void endUpload(VkCommandBuffer command_buffer);
+
+    // With the graphics timeline value the upload can be used after
+    void uploadSubmitted(const uint64_t graphics_value);
+
+    // Timings of the most recent frame whose results are available, in the order their scopes began.
+    const std::vector<Timing> &getTimings() const;
+
+    // nullptr if no result of that scope has been read back yet
+    const History *getHistory(const std::string &name) const;
+
+    // Every scope name that has a history, in the order they were first read back
+    const std::vector<std::string> &getScopeNames() const;
+
+    // Forgets every history and the results of the frames that were not read back yet, e.g. once warm-up frames
+    // are done. Must be called between frames.
+    void resetHistories();
+
+    const bool isSupported() const;
+
+    const bool isCollectingStatistics() const;
+
+    // Needs hostQueryReset and timestamps on the queue family the uploads are recorded for
+    const bool isTimingUploads() const;
+
+  private:
+    struct RecordedScope
+    {
+        std::string name;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+        uint32_t statisticsQuery;
+    };
+
+    struct FrameQueries
+    {
+        std::vector<RecordedScope> scopes;
+        uint32_t queryCount = 0;
+        uint32_t statisticsCount = 0;
+    };
+
+    struct PendingUpload
+    {
+        std::string name;
+        uint32_t beginQuery;
+        uint64_t graphicsValue;
+    };
+
+    static constexpr uint32_t NO_QUERY = UINT32_MAX;
+    static constexpr uint32_t STATISTICS_COUNT = 5;
+    static constexpr uint32_t MAX_PENDING_UPLOADS = 64;
+    static constexpr VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    Device &device;
+    VkQueryPool queryPool;
+    VkQueryPool statisticsPool;
+    VkQueryPool uploadPool;
+    uint32_t maxScopes;
+    size_t historyLength;
+    double timestampPeriod;
+    bool supported;
+    bool collectStatistics;
+    bool timeUploads;
+
+    std::array<FrameQueries, Swapchain::MAX_FRAMES_IN_FLIGHT> frames;
+    int currentFrame;
+    std::vector<size_t> openScopes;
+    bool statisticsActive;
+
+    // Pairs of upload queries are taken by their first query. The last pending upload is the one being recorded
+    // while recordingUpload, its graphics value is 0 until it is submitted.
+    std::vector<uint32_t> freeUploadQueries;
+    std::vector<PendingUpload> pendingUploads;
+    bool recordingUpload;
+
+    std::vector<Timing> timings;
+    std::unordered_map<std::string, History> histories;
+    std::vector<std::string> scopeNames;
+
+    void createQueryPools();
+
+    void createUploadQueryPool();
+
+    const bool hasUploadTimestamps();
+
+    void collectTimings(const int frame_index);
+
+    void collectUploads();
+
+    void pushHistory(const Timing &timing);
+};
+} // namespace vk
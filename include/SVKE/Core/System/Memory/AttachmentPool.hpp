@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef GLFW_INCLUDE_VULKAN
+#define GLFW_INCLUDE_VULKAN
+#endif
+
+#include <GLFW/glfw3.h>
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace vk
+{
+class Device;
+
+// Keeps render target attachments after their owner is gone, so resizing a window does not allocate every frame.
+// Extents are rounded up to buckets and an attachment serves any extent in its bucket: framebuffers may be smaller
+// than their attachments, the render pass only touches the area it covers.
+class AttachmentPool
+{
+  public:
+    static constexpr uint32_t BUCKET_SIZE = 128;
+
+    // Oldest free attachments beyond this are destroyed, so a long resize does not pile up memory
+    static constexpr size_t MAX_FREE_ATTACHMENTS = 8;
+
+    struct Attachment
+    {
+        VkImage image;
+        VmaAllocation allocation;
+        VkImageView view;
+
+        // Of the image, rounded up from the extent that was asked for
+        VkExtent2D extent;
+        VkFormat format;
+        VkImageUsageFlags usage;
+        VkSampleCountFlagBits samples;
+        VkImageAspectFlags aspect;
+    };
+
+    AttachmentPool(Device &device);
+    ~AttachmentPool();
+
+    AttachmentPool(const AttachmentPool &) = delete;
+    AttachmentPool &operator=(const AttachmentPool &) = delete;
+
+    // A free attachment of the same kind and bucket, or a new one
+    Attachment acquire(const VkFormat format, const VkImageUsageFlags usage, const VkSampleCountFlagBits samples,
+                       const VkImageAspectFlags aspect, const VkExtent2D &extent);
+
+    // Becomes free once the graphics queue has finished everything submitted so far
+    void release(const Attachment &attachment);
+
+    // Destroys every free attachment
+    void clear();
+
+    const size_t getFreeCount();
+
+  private:
+    Device &device;
+
+    std::mutex mutex;
+    std::deque<Attachment> freeAttachments;
+
+    void recycle(const Attachment &attachment);
+
+    void destroy(const Attachment &attachment);
+
+    static const uint32_t roundUpToBucket(const uint32_t size);
+};
+} // namespace vk
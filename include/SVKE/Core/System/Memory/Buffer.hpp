@@ -8,6 +8,7 @@
 #include <vk_mem_alloc.h>
 
 #include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
 
 namespace vk
 {
@@ -32,10 +33,18 @@ class Buffer
 
     void write(void *data, VkDeviceSize size);
 
-    void copyTo(Buffer &other, const VkDeviceSize &size);
+    // For buffers the GPU writes to, makes its writes visible to the host first
+    void read(void *data, VkDeviceSize size);
+
+    // Through the transfer queue and without waiting, other is handed over to the graphics queue.
+    // See Device::endUploadCommands, name is the upload's in the GPU profiler.
+    void copyTo(Buffer &other, const VkDeviceSize &size, const std::string &name = "Buffer upload");
 
     const VkDeviceSize &getSize() const;
 
+    // For writing a mapped buffer in place, the caller counts what it writes with FrameStats::countUpload
+    void *getMappedMemory();
+
     VkBuffer &getBuffer();
 
     VkDescriptorBufferInfo getDescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+
+namespace vk
+{
+// One persistently mapped, sequentially written buffer per frame in flight, for data written anew every frame. A
+// frame's buffer only grows, doubling its capacity, and is then replaced while the others keep theirs.
+class FrameBufferRing
+{
+  public:
+    // The name is only used in debug output
+    FrameBufferRing(Device &device, const std::string &name, const VkDeviceSize element_size,
+                    const size_t min_capacity, const VkBufferUsageFlags usage);
+
+    FrameBufferRing(const FrameBufferRing &) = delete;
+    FrameBufferRing &operator=(const FrameBufferRing &) = delete;
+
+    // Makes room for element_count elements in the frame's buffer. Returns true if it was replaced, descriptors of
+    // the frame referring to it have to be written again.
+    const bool reserve(const int frame_index, const size_t element_count);
+
+    // Only valid after the frame's first reserve
+    Buffer &getBuffer(const int frame_index);
+
+  private:
+    Device &device;
+    std::string name;
+    VkDeviceSize elementSize;
+    size_t minCapacity;
+    VkBufferUsageFlags usage;
+
+    std::array<std::unique_ptr<Buffer>, Swapchain::MAX_FRAMES_IN_FLIGHT> buffers;
+};
+} // namespace vk
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef GLFW_INCLUDE_VULKAN
+#define GLFW_INCLUDE_VULKAN
+#endif
+
+#include <GLFW/glfw3.h>
+#include <vk_mem_alloc.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace vk
+{
+// Memory telemetry of the device's allocator. Allocations are counted per category when they are made through
+// Buffer, TextureImage, Device::createImageWithInfo or the render graph, and the usage and budget of every heap
+// (VK_EXT_memory_budget) are queried once per frame. Crossing a fraction of a heap's budget calls the budget
+// callback, so caches can give memory back before allocations start to fail or spill into system memory.
+class MemoryTracker
+{
+  public:
+    enum class Category : uint32_t
+    {
+        Mesh,
+        Texture,
+        Staging,
+        Uniform,
+        Storage,
+        Attachment,
+        Other
+    };
+
+    static constexpr size_t CATEGORY_COUNT = 7;
+
+    // Of a heap's budget, the callback is called when its usage goes above it
+    static constexpr float DEFAULT_BUDGET_THRESHOLD = .9f;
+
+    struct HeapBudget
+    {
+        bool deviceLocal = false;
+
+        // Of the whole process, as reported by the driver, and how much it may use
+        VkDeviceSize usage = 0;
+        VkDeviceSize budget = 0;
+
+        // Of this allocator only, blocks include what is not allocated from them yet
+        VkDeviceSize allocationBytes = 0;
+        VkDeviceSize blockBytes = 0;
+    };
+
+    struct CategoryUsage
+    {
+        uint64_t allocationCount = 0;
+        VkDeviceSize bytes = 0;
+    };
+
+    // Called from update, once each time the heap goes above the threshold
+    using BudgetCallback = std::function<void(const uint32_t heap_index, const HeapBudget &heap_budget)>;
+
+    MemoryTracker(VmaAllocator allocator);
+
+    MemoryTracker(const MemoryTracker &) = delete;
+    MemoryTracker &operator=(const MemoryTracker &) = delete;
+
+    // Counts the allocation in the category, which is stored in its user data and name. Thread safe.
+    void track(VmaAllocation allocation, const Category category);
+
+    // Must be called before the allocation is freed, does nothing for allocations that were not tracked
+    void untrack(VmaAllocation allocation);
+
+    // Vertex and index buffers are meshes, transfer sources only are staging buffers
+    static const Category categorizeBuffer(const VkBufferUsageFlags usage);
+
+    static const char *getCategoryName(const Category category);
+
+    // Queries the heap budgets and calls the budget callback. Called by the Renderer when a frame begins.
+    void update();
+
+    void setBudgetCallback(BudgetCallback callback, const float threshold = DEFAULT_BUDGET_THRESHOLD);
+
+    // Of the last update, indexed by heap
+    const std::vector<HeapBudget> &getHeapBudgets() const;
+
+    const CategoryUsage getCategoryUsage(const Category category) const;
+
+    // Heaps, categories and the allocator's own statistics (vmaBuildStatsString) as one JSON object. The detailed map
+    // lists every allocation and block, it can be large.
+    void writeJson(std::ostream &stream, const bool detailed_map = false) const;
+
+  private:
+    VmaAllocator allocator;
+    uint32_t frameIndex;
+
+    std::array<std::atomic<uint64_t>, CATEGORY_COUNT> categoryCounts;
+    std::array<std::atomic<VkDeviceSize>, CATEGORY_COUNT> categoryBytes;
+
+    std::vector<HeapBudget> heapBudgets;
+
+    // Per heap, set while it is above the threshold so the callback is not called every frame
+    std::vector<bool> nearBudget;
+    BudgetCallback budgetCallback;
+    float budgetThreshold;
+
+    void queryHeapBudgets();
+};
+} // namespace vk
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/RenderTarget.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace vk
+{
+// Renders into images owned by the engine instead of a swapchain, for running without a display.
+// Every frame is copied into a host-visible buffer at the end of its command buffer, readPixels returns the latest.
+class OffscreenTarget : public RenderTarget
+{
+  public:
+    // RGBA with 8 bits per channel, so read back pixels can be written to image files as they are
+    static constexpr VkFormat IMAGE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+    static constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+    OffscreenTarget(Device &device, const VkExtent2D &extent,
+                    const int frames_in_flight = Swapchain::DEFAULT_FRAMES_IN_FLIGHT);
+    ~OffscreenTarget() override;
+
+    OffscreenTarget(const OffscreenTarget &) = delete;
+    OffscreenTarget &operator=(const OffscreenTarget &) = delete;
+
+    VkResult acquireNextImage(uint32_t &image_index) override;
+
+    void recordEndOfFrame(VkCommandBuffer &command_buffer, const uint32_t image_index) override;
+
+    VkResult submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index) override;
+
+    VkFormat getImageFormat() override;
+
+    VkFormat getDepthFormat() override;
+
+    VkExtent2D getExtent() override;
+
+    VkImage getImage(const int index) override;
+
+    VkImageView getImageView(const int index) override;
+
+    VkImage getColorImage() override;
+
+    VkImageView getColorImageView() override;
+
+    VkImage getDepthImage(const int index) override;
+
+    VkImageView getDepthImageView(const int index) override;
+
+    VkImageLayout getImageLayout() override;
+
+    const bool supportsImageCopy() override;
+
+    const FrameStats::Timings &getFrameTimings() const override;
+
+    // Waits for the last submitted frame and copies its pixels, rows top to bottom. False if none was submitted yet.
+    const bool readPixels(std::vector<uint8_t> &pixels);
+
+  private:
+    Device &device;
+
+    VkFormat depthFormat;
+    VkExtent2D extent;
+
+    std::vector<VkImage> images;
+    std::vector<VmaAllocation> imageAllocations;
+    std::vector<VkImageView> imageViews;
+
+    std::vector<VkImage> depthImages;
+    std::vector<VmaAllocation> depthImageAllocations;
+    std::vector<VkImageView> depthImageViews;
+
+    VkImage colorImage;
+    VmaAllocation colorImageAllocation;
+    VkImageView colorImageView;
+
+    std::vector<std::unique_ptr<Buffer>> readbackBuffers;
+
+    // Graphics timeline value of each frame's submission, 0 if there was none yet
+    std::vector<uint64_t> frameValues;
+    int framesInFlight;
+    size_t currentFrame;
+    int lastSubmitted;
+
+    FrameStats::Timings frameTimings;
+
+    void createImages();
+
+    void createColorResources();
+
+    void createDepthResources();
+
+    void createReadbackBuffers();
+
+    void createImage(VkFormat format, VkImageUsageFlags usage, VkSampleCountFlagBits samples,
+                     VkImageAspectFlags aspect, VkImage &image, VmaAllocation &allocation, VkImageView &view);
+};
+} // namespace vk
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+namespace vk
+{
+// What the Renderer draws into: the window's swapchain or an offscreen image. The Renderer begins dynamic rendering
+// on a target's attachments, pipelines only depend on their formats, so render systems work with any target.
+class RenderTarget
+{
+  public:
+    virtual ~RenderTarget() = default;
+
+    // Blocks until the frame slot is free again, then returns the image to render into
+    virtual VkResult acquireNextImage(uint32_t &image_index) = 0;
+
+    // Recorded after the last render pass, once the image is in getImageLayout, before the command buffer ends
+    virtual void recordEndOfFrame(VkCommandBuffer &command_buffer, const uint32_t image_index);
+
+    virtual VkResult submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index) = 0;
+
+    virtual VkFormat getImageFormat() = 0;
+
+    virtual VkFormat getDepthFormat() = 0;
+
+    virtual VkExtent2D getExtent() = 0;
+
+    virtual VkImage getImage(const int index) = 0;
+
+    virtual VkImageView getImageView(const int index) = 0;
+
+    // Multisampled color attachment that is resolved into the image, VK_NULL_HANDLE if MSAA is off
+    virtual VkImage getColorImage() = 0;
+
+    virtual VkImageView getColorImageView() = 0;
+
+    // Depth attachment rendered with the image at index, multisampled if MSAA is on. It can be sampled between the
+    // render pass and its continuation.
+    virtual VkImage getDepthImage(const int index) = 0;
+
+    virtual VkImageView getDepthImageView(const int index) = 0;
+
+    // Layout the Renderer leaves the images in at the end of a frame
+    virtual VkImageLayout getImageLayout() = 0;
+
+    // Whether the images can be the source of a transfer, e.g. to capture frames
+    virtual const bool supportsImageCopy() = 0;
+
+    // Where the last acquire, submit and present blocked the CPU
+    virtual const FrameStats::Timings &getFrameTimings() const = 0;
+
+    const uint32_t getWidth();
+
+    const uint32_t getHeight();
+
+    const float getExtentAspectRatio();
+
+  protected:
+    static VkFormat findDepthFormat(Device &device);
+};
+} // namespace vk
@@ -2,6 +2,9 @@
 
 #include "SVKE/Core/System/Window.hpp"
 #include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/AttachmentPool.hpp"
+#include "SVKE/Core/System/RenderTarget.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
 
 #include <array>
 #include <cstdlib>
@@ -14,10 +17,13 @@
 
 namespace vk
 {
-class Swapchain
+class Swapchain : public RenderTarget
 {
   public:
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    // Upper bound for per frame resources, how many frames are actually in flight is chosen at runtime.
+    // One frame has the lowest latency but leaves the GPU idle while the CPU records, three smooth out spikes.
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 3;
+    static constexpr int DEFAULT_FRAMES_IN_FLIGHT = 2;
 
     enum class PresentMode : int
     {
@@ -30,45 +36,62 @@ class Swapchain
         VSyncRelaxed = VK_PRESENT_MODE_FIFO_RELAXED_KHR
     };
 
-    Swapchain(Device &device, Window &window, const PresentMode &preferred_present_mode = PresentMode::Mailbox);
+    Swapchain(Device &device, Window &window, const PresentMode &preferred_present_mode = PresentMode::Mailbox,
+              const int frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT);
     Swapchain(Device &device, Window &window, std::shared_ptr<Swapchain> &previous,
-              const PresentMode &preferred_present_mode = PresentMode::Mailbox);
-    ~Swapchain();
+              const PresentMode &preferred_present_mode = PresentMode::Mailbox,
+              const int frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT);
+    ~Swapchain() override;
 
     Swapchain(const Swapchain &) = delete;
     Swapchain &operator=(const Swapchain &) = delete;
 
-    VkResult submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index);
+    VkResult submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index) override;
 
-    VkResult acquireNextImage(uint32_t &image_index);
+    VkResult acquireNextImage(uint32_t &image_index) override;
 
-    VkFormat findDepthFormat();
+    const FrameStats::Timings &getFrameTimings() const override;
 
     const bool compatibleWith(Swapchain &other) const;
 
     VkSwapchainKHR getHandle();
 
-    VkFramebuffer getFramebuffer(const int index);
+    VkImageView getImageView(const int index) override;
 
-    VkRenderPass getRenderPass();
+    const size_t getImageCount();
 
-    VkImageView getImageView(const int index);
+    VkFormat getImageFormat() override;
 
-    const size_t getImageCount();
+    VkFormat getDepthFormat() override;
+
+    VkExtent2D getExtent() override;
 
-    VkFormat getImageFormat();
+    VkImage getImage(const int index) override;
 
-    VkFormat getDepthFormat();
+    VkImage getColorImage() override;
 
-    VkExtent2D getExtent();
+    VkImageView getColorImageView() override;
 
-    const uint32_t getWidth();
+    VkImage getDepthImage(const int index) override;
 
-    const uint32_t getHeight();
+    VkImageView getDepthImageView(const int index) override;
 
-    const float getExtentAspectRatio();
+    VkImageLayout getImageLayout() override;
+
+    const bool supportsImageCopy() override;
 
   private:
+    // Handles of a replaced swapchain. Its last presentations may still be in the presentation engine after the
+    // timeline has passed them, so they are only destroyed once those are known to be done, see releaseRetired.
+    struct Retired
+    {
+        VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+        std::vector<VkImageView> imageViews;
+        std::vector<VkSemaphore> semaphores;
+        std::vector<VkFence> presentFences;
+        uint64_t value = 0;
+    };
+
     Device &device;
     Window &window;
 
@@ -76,29 +99,41 @@ class Swapchain
     VkFormat depthFormat;
     VkExtent2D extent;
 
-    std::vector<VkFramebuffer> framebuffers;
-    VkRenderPass renderPass;
-
-    std::vector<VkImage> depthImages;
-    std::vector<VmaAllocation> depthImageAllocations;
-    std::vector<VkImageView> depthImageViews;
+    // From the device's AttachmentPool, so a resize mostly gets back what the previous swapchain used
+    std::vector<AttachmentPool::Attachment> depthAttachments;
 
     std::vector<VkImage> images;
     std::vector<VkImageView> imageViews;
+    VkImageUsageFlags imageUsage;
 
-    VkImage colorImage;
-    VmaAllocation colorImageAllocation;
-    VkImageView colorImageView;
+    // Only acquired with multisampling, the image is resolved into the swapchain image
+    AttachmentPool::Attachment colorAttachment;
 
     VkSwapchainKHR swapchain;
     std::shared_ptr<Swapchain> oldSwapchain;
 
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    std::vector<VkFence> imagesInFlight;
+    // Values of the graphics timeline, 0 if nothing was submitted yet. The binary semaphores stay for acquire and
+    // present, which cannot use timeline semaphores.
+    std::vector<uint64_t> frameValues;
+    std::vector<uint64_t> imageValues;
+
+    // Per frame slot, signaled once the slot's last presentation no longer uses its semaphore and image. Only with
+    // VK_EXT_swapchain_maintenance1, created signaled.
+    std::vector<VkFence> presentFences;
+
+    // Swapchains this one replaced, with the ones they had not released yet. Without present fences they are released
+    // once every image of this swapchain was acquired, so every presentation queued before has finished.
+    std::vector<Retired> retiredSwapchains;
+    std::vector<bool> acquiredImages;
+    size_t acquiredImageCount;
+
+    int framesInFlight;
     size_t currentFrame;
 
+    FrameStats::Timings frameTimings;
+
     void init(const PresentMode &preferred_present_mode);
 
     void createSwapchain(const PresentMode &preferred_present_mode);
@@ -109,11 +144,14 @@ class Swapchain
 
     void createDepthResources();
 
-    void createRenderPass();
+    void createSyncObjects();
 
-    void createFramebuffers();
+    // Moves the handles out, the swapchain keeps its attachments
+    Retired retire();
 
-    void createSyncObjects();
+    void releaseRetired();
+
+    static void destroyRetired(VkDevice logical_device, const Retired &retired);
 
     VkSurfaceFormatKHR chooseSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &available_formats);
 
@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef GLFW_INCLUDE_VULKAN
+#define GLFW_INCLUDE_VULKAN
+#endif
+
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+// GPU progress of one queue as a single counter. Every submission through submit signals the next value of a timeline
+// semaphore, so the CPU can wait for exactly the submission it needs, and resources are released once the value of
+// the last submission that could use them has been reached, instead of per frame fences.
+// Signals of one timeline semaphore must increase in execution order, which is why every queue gets its own.
+class Timeline
+{
+  public:
+    // A value of another timeline a submission waits for, e.g. the graphics queue for an upload of the transfer queue
+    struct Wait
+    {
+        Timeline *timeline;
+        uint64_t value;
+        VkPipelineStageFlags stages;
+    };
+
+    Timeline(VkDevice device);
+    ~Timeline();
+
+    Timeline(const Timeline &) = delete;
+    Timeline &operator=(const Timeline &) = delete;
+
+    // Submits submit_info and signals the next value together with its own signal semaphores. Returns that value.
+    // The submission also waits for timeline_waits, next to the binary wait semaphores of submit_info.
+    const uint64_t submit(VkQueue queue, const VkSubmitInfo &submit_info, const std::vector<Wait> &timeline_waits = {});
+
+    // Reached once everything submitted so far has finished
+    const uint64_t getSubmittedValue() const;
+
+    const uint64_t getCompletedValue();
+
+    const bool isComplete(const uint64_t value);
+
+    // Blocks until exactly this value is reached, returns right away if it already was
+    void wait(const uint64_t value);
+
+    // Calls release once everything submitted until now has finished, the next collect after that
+    void defer(std::function<void()> release);
+
+    // Same as defer, but waits for the next submission as well, for what command buffers that are still recorded may
+    // use, e.g. a buffer destroyed while a frame is in progress
+    void deferPastNextSubmit(std::function<void()> release);
+
+    // Releases what was deferred until a value that has been reached, never waits
+    void collect();
+
+    // Waits for the last submission and releases everything deferred, nothing may be recorded anymore
+    void flush();
+
+    VkSemaphore getHandle();
+
+  private:
+    VkDevice device;
+    VkSemaphore semaphore;
+
+    std::mutex submitMutex;
+    std::atomic<uint64_t> submittedValue;
+    std::atomic<uint64_t> completedValue;
+
+    std::mutex deferredMutex;
+    std::deque<std::pair<uint64_t, std::function<void()>>> deferred;
+
+    void advanceCompletedValue(const uint64_t value);
+};
+} // namespace vk
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "SVKE/Core/System/Timeline.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace vk
+{
+// Measures how long it takes from sampling input until the GPU has finished the frame built from it, and in low
+// latency mode delays sampling input so the frame is submitted just as the GPU finishes the previous one, instead of
+// queueing up behind it. A watcher thread waits for every submission on the timeline, which times GPU completion
+// without the frame loop having to wait for it.
+class FramePacer
+{
+  public:
+    // Recording starts this much earlier than predicted, so small misses in the estimates do not idle the GPU
+    static constexpr double SLACK_MILLISECONDS = .5;
+
+    FramePacer(Timeline &timeline, FrameStats &frame_stats);
+    ~FramePacer();
+
+    FramePacer(const FramePacer &) = delete;
+    FramePacer &operator=(const FramePacer &) = delete;
+
+    // Must be called right before input is sampled. Waits in low latency mode, always marks the sampling time.
+    void wait();
+
+    // Called by the Renderer with the timeline value of the frame's submission
+    void submitted(const uint64_t timeline_value);
+
+    void setLowLatency(const bool low_latency);
+
+    const bool isLowLatency() const;
+
+    // Smoothed GPU time of one frame and CPU time from sampling input to submitting, in milliseconds
+    const double getGpuEstimate() const;
+
+    const double getCpuEstimate() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingFrame
+    {
+        uint64_t timelineValue;
+        Clock::time_point inputTime;
+        Clock::time_point submitTime;
+    };
+
+    struct CompletedFrame
+    {
+        double gpuMilliseconds;
+        double gpuCompletionLatencyMilliseconds;
+    };
+
+    // Weight of the newest sample in the smoothed estimates
+    static constexpr double SMOOTHING = .1;
+
+    Timeline &timeline;
+    FrameStats &frameStats;
+    bool lowLatency;
+
+    Clock::time_point inputTime;
+    bool inputSampled;
+
+    // Timeline values of the last two frames, other submissions to the queue fall in between
+    uint64_t previousValue;
+    uint64_t lastValue;
+    Clock::time_point lastSubmitTime;
+
+    double gpuEstimate;
+    double cpuEstimate;
+
+    std::thread watcher;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<PendingFrame> pending;
+    std::deque<CompletedFrame> completed;
+    bool stopping;
+
+    void watcherLoop();
+
+    // Moves what the watcher measured into the estimates and the frame stats, on the frame loop's thread
+    void collect();
+
+    static void sleepUntil(const Clock::time_point &time_point);
+};
+} // namespace vk
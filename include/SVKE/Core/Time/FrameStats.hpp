@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace vk
+{
+// Collects per-frame timings and command counts, and keeps a fixed-size histogram of frame times so stutter shows up
+// in the percentiles instead of disappearing in an average.
+class FrameStats
+{
+  public:
+    // Where the CPU spent one frame, in milliseconds
+    struct Timings
+    {
+        double fenceWait = 0.0;
+        double acquire = 0.0;
+        double submit = 0.0;
+        double present = 0.0;
+    };
+
+    struct Frame
+    {
+        // Time since the previous frame was presented, this is what the percentiles are computed from
+        double frameMilliseconds = 0.0;
+
+        // Time spent recording, between acquiring the image and submitting
+        double cpuMilliseconds = 0.0;
+
+        Timings timings;
+
+        uint32_t drawCalls = 0;
+        uint64_t triangles = 0;
+        uint32_t pipelineBinds = 0;
+        uint32_t descriptorBinds = 0;
+        uint32_t vertexBufferBinds = 0;
+        uint32_t barriers = 0;
+        uint64_t uploadBytes = 0;
+    };
+
+    struct Report
+    {
+        uint64_t frameCount = 0;
+        double average = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        // Averages over every recorded frame
+        Frame averageFrame;
+
+        // From sampling input to the GPU finishing the frame, only recorded while a FramePacer measures it
+        uint64_t gpuCompletionLatencyCount = 0;
+        double gpuCompletionLatencyAverage = 0.0;
+        double gpuCompletionLatencyP50 = 0.0;
+        double gpuCompletionLatencyP99 = 0.0;
+        double gpuCompletionLatencyMax = 0.0;
+    };
+
+    // 0.05 ms resolution up to 200 ms, slower frames land in the last bucket and only count towards max
+    static constexpr double BUCKET_MILLISECONDS = .05;
+    static constexpr size_t BUCKET_COUNT = 4000;
+
+    FrameStats();
+
+    // Called by the Renderer, counters recorded between two endFrame calls belong to the second frame
+    void beginRecording();
+
+    void endRecording();
+
+    void endFrame(const Timings &timings);
+
+    // From sampling input until the GPU has finished the frame, not until it is presented. Reported separately because
+    // it is only known once the GPU has finished the frame.
+    void recordGpuCompletionLatency(const double milliseconds);
+
+    // Forgets every recorded frame, e.g. once warm-up frames are done. The next frame is still timed from the last.
+    void reset();
+
+    const Frame &getLastFrame() const;
+
+    const Report getReport() const;
+
+    void print(std::ostream &stream) const;
+
+    // Counted from anywhere a command is recorded or data is uploaded, they apply to the frame in progress
+    static void countDraw(const uint64_t triangles);
+
+    static void countPipelineBind();
+
+    static void countDescriptorBinds(const uint32_t set_count);
+
+    // Vertex buffers of one model, together with its index buffer if it has one
+    static void countVertexBufferBind();
+
+    // Image and buffer barriers, however many vkCmdPipelineBarrier2 calls they were batched into
+    static void countBarriers(const uint32_t barrier_count);
+
+    static void countUpload(const uint64_t bytes);
+
+    static const double millisecondsSince(const std::chrono::steady_clock::time_point &time_point);
+
+  private:
+    struct Counters
+    {
+        std::atomic<uint32_t> drawCalls{0};
+        std::atomic<uint64_t> triangles{0};
+        std::atomic<uint32_t> pipelineBinds{0};
+        std::atomic<uint32_t> descriptorBinds{0};
+        std::atomic<uint32_t> vertexBufferBinds{0};
+        std::atomic<uint32_t> barriers{0};
+        std::atomic<uint64_t> uploadBytes{0};
+    };
+
+    struct Histogram
+    {
+        std::array<uint32_t, BUCKET_COUNT> buckets;
+        uint64_t count;
+        double total;
+        double max;
+
+        void add(const double milliseconds);
+
+        void clear();
+
+        const double getPercentile(const double percentile) const;
+    };
+
+    static Counters counters;
+
+    Histogram frameTimes;
+    Histogram gpuCompletionLatencies;
+
+    Frame lastFrame;
+    Frame totals;
+
+    bool hasPreviousFrame;
+    std::chrono::steady_clock::time_point previousFrameEnd;
+    std::chrono::steady_clock::time_point recordingBegin;
+};
+} // namespace vk
@@ -0,0 +1,179 @@
+#pragma once
+
+// CPU instrumentation, only compiled in when SVKE_PROFILING is defined (see CMakeLists.txt).
+// Otherwise every SVKE_PROFILE_* macro expands to a no-op and none of the code below exists.
+//
+//   SVKE_PROFILE_SCOPE("Name")       records a zone until the end of the enclosing scope, the name must be a literal
+//   SVKE_PROFILE_FUNCTION()          same, named after the enclosing function
+//   SVKE_PROFILE_THREAD("Name")      names the calling thread in the trace
+//   SVKE_PROFILE_FRAME_BEGIN/END()   frame markers, END also collects the zones of every thread
+//   SVKE_PROFILE_DUMP("trace.json")  writes the retained zones as Chrome trace_event JSON (chrome://tracing, Perfetto)
+
+#ifdef SVKE_PROFILING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace vk
+{
+// Every thread writes its zones into its own single-producer/single-consumer ring, so recording a zone is two
+// timestamp reads and a store without locks. The rings are drained into a bounded history at the end of each frame.
+class Profiler
+{
+  public:
+    struct Event
+    {
+        const char *name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    class ScopedZone
+    {
+      public:
+        explicit ScopedZone(const char *name) : name(name), begin(now())
+        {
+        }
+
+        ScopedZone(const ScopedZone &) = delete;
+        ScopedZone &operator=(const ScopedZone &) = delete;
+
+        ~ScopedZone()
+        {
+            Profiler::record(name, begin, now());
+        }
+
+      private:
+        const char *name;
+        uint64_t begin;
+    };
+
+    // Events per thread between two frame ends, the rest is dropped and counted
+    static constexpr size_t RING_CAPACITY = 1 << 14;
+
+    // Events kept for SVKE_PROFILE_DUMP, the oldest are discarded first
+    static constexpr size_t MAX_RETAINED_EVENTS = 1 << 19;
+
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    static Profiler &get();
+
+    // Ticks of the invariant TSC on x86-64, steady_clock nanoseconds elsewhere. Converted when the trace is written.
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static void record(const char *name, const uint64_t begin, const uint64_t end)
+    {
+        ThreadBuffer *buffer = threadBuffer ? threadBuffer : get().registerThread();
+
+        const size_t head = buffer->head.load(std::memory_order_relaxed);
+
+        // The consumer position is only reloaded when the ring looks full
+        if (head - buffer->cachedTail >= RING_CAPACITY)
+        {
+            buffer->cachedTail = buffer->tail.load(std::memory_order_acquire);
+
+            if (head - buffer->cachedTail >= RING_CAPACITY)
+            {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        buffer->events[head % RING_CAPACITY] = {name, begin, end};
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void setThreadName(const std::string &name);
+
+    void beginFrame();
+
+    void endFrame();
+
+    // Returns false if the file could not be written
+    const bool writeChromeTrace(const std::string &path);
+
+  private:
+    struct ThreadBuffer
+    {
+        std::array<Event, RING_CAPACITY> events;
+        alignas(64) std::atomic<size_t> head{0};
+        size_t cachedTail = 0;
+        alignas(64) std::atomic<size_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        uint32_t threadId = 0;
+        std::string threadName;
+    };
+
+    struct RetainedEvent
+    {
+        Event event;
+        uint32_t threadId;
+    };
+
+    inline static thread_local ThreadBuffer *threadBuffer = nullptr;
+
+    // Buffers outlive their threads, events of a finished thread are still collected
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::deque<RetainedEvent> retained;
+
+    uint64_t frameBegin;
+    uint64_t frameCount;
+
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+
+    Profiler();
+
+    ThreadBuffer *registerThread();
+
+    // Must be called with the mutex held
+    void collect();
+
+    const double getTicksPerMicrosecond() const;
+};
+} // namespace vk
+
+#define SVKE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SVKE_PROFILE_CONCAT(a, b) SVKE_PROFILE_CONCAT_IMPL(a, b)
+
+#define SVKE_PROFILE_SCOPE(name) ::vk::Profiler::ScopedZone SVKE_PROFILE_CONCAT(svke_profile_zone_, __LINE__)(name)
+#define SVKE_PROFILE_FUNCTION() SVKE_PROFILE_SCOPE(__func__)
+#define SVKE_PROFILE_THREAD(name) ::vk::Profiler::get().setThreadName(name)
+#define SVKE_PROFILE_FRAME_BEGIN() ::vk::Profiler::get().beginFrame()
+#define SVKE_PROFILE_FRAME_END() ::vk::Profiler::get().endFrame()
+#define SVKE_PROFILE_DUMP(path) ::vk::Profiler::get().writeChromeTrace(path)
+
+#else
+
+#define SVKE_PROFILE_SCOPE(name) ((void)0)
+#define SVKE_PROFILE_FUNCTION() ((void)0)
+#define SVKE_PROFILE_THREAD(name) ((void)0)
+#define SVKE_PROFILE_FRAME_BEGIN() ((void)0)
+#define SVKE_PROFILE_FRAME_END() ((void)0)
+#define SVKE_PROFILE_DUMP(path) ((void)0)
+
+#endif
@@ -5,9 +5,21 @@
 #include "SVKE/Rendering/Descriptors/DescriptorSet.hpp"
 #include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
 #include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+#include "SVKE/Rendering/Pipelines/PipelineVariantCache.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Resources/DrawList.hpp"
+#include "SVKE/Rendering/Resources/DrawOrder.hpp"
 #include "SVKE/Rendering/Resources/Model.hpp"
 #include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/DepthPrepassSystem.hpp"
+#include "SVKE/Rendering/Systems/LightClusterSystem.hpp"
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
+#include "SVKE/Rendering/Systems/OcclusionCullingSystem.hpp"
 #include "SVKE/Rendering/Systems/PointLightSystem.hpp"
+#include "SVKE/Rendering/Systems/PointShadowSystem.hpp"
 #include "SVKE/Rendering/Systems/Renderer.hpp"
 #include "SVKE/Rendering/Systems/RenderSystem.hpp"
+#include "SVKE/Rendering/Systems/SceneRenderer.hpp"
 #include "SVKE/Rendering/Systems/TextureRenderSystem.hpp"
+#include "SVKE/Rendering/Systems/TransparentRenderSystem.hpp"
@@ -6,18 +6,30 @@
 
 #include <GLFW/glfw3.h>
 
+#include "SVKE/Core/System/GpuProfiler.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
 #include "SVKE/Rendering/Camera.hpp"
 #include "SVKE/Rendering/Resources/Object.hpp"
 #include "SVKE/Core/System/Memory/Alignment.hpp"
 
-constexpr int MAX_LIGHTS = 10;
+#include <limits>
+#include <vector>
+
+// Froxel grid used by the light culling pass, must match clusters.glsl
+constexpr uint32_t CLUSTER_GRID_X = 16;
+constexpr uint32_t CLUSTER_GRID_Y = 9;
+constexpr uint32_t CLUSTER_GRID_Z = 24;
+constexpr uint32_t CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 127;
 
 namespace vk
 {
+// Element of the light storage buffer (std430)
 struct PointLight
 {
-    ALIGNAS_VEC3 Vec3f position{};
-    ALIGNAS_VEC4 Vec4f color{}; // w component is light intensity
+    ALIGNAS_VEC4 Vec4f position{}; // w component is the range, past which the light is culled
+    ALIGNAS_VEC4 Vec4f color{};    // w component is light intensity
+    ALIGNAS_SCLR(int) int shadowSlot = -1; // cube of the point shadow atlas, -1 if the light casts no shadow
 };
 
 struct GlobalUBO
@@ -26,10 +38,28 @@ struct GlobalUBO
     ALIGNAS_MAT4 Mat4f viewMatrix{1.f};
     ALIGNAS_MAT4 Mat4f inverseViewMatrix{1.f};
     ALIGNAS_VEC4 Vec4f ambientLightColor{1.f, 1.f, 1.f, .01f}; // w = intensity
-    ALIGNAS_NESTED_UNIFORM PointLight pointLights[MAX_LIGHTS];
+    ALIGNAS_VEC2 Vec2f screenSize{1.f, 1.f};
     ALIGNAS_SCLR(int) int numLights;
 };
 
+// Element of the object storage buffer (std430, global set, binding 4), must match object_data.glsl.
+// 128 bytes: the normal matrix is a mat3, whose columns std430 pads to vec4.
+struct ObjectData
+{
+    ALIGNAS_MAT4 Mat4f modelMatrix{1.f};
+    ALIGNAS_MAT3 Vec4f normalMatrix[3]{{1.f, 0.f, 0.f, 0.f}, {0.f, 1.f, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f}};
+    ALIGNAS_VEC4 Vec4f color{1.f};
+};
+
+// Of objects without an element in the object buffer, see FrameInfo::objectIndices
+constexpr uint32_t NO_OBJECT_INDEX = std::numeric_limits<uint32_t>::max();
+
+// Pushed by every draw reading the object buffer, to the vertex stage only
+struct ObjectPushConstantData
+{
+    ALIGNAS_SCLR(uint32_t) uint32_t objectIndex = 0;
+};
+
 struct FrameInfo
 {
     int frameIndex;
@@ -39,5 +69,7 @@ struct FrameInfo
     VkDescriptorSet &globalDescriptorSet;
     std::unordered_map<Object::objid_t, VkDescriptorSet> &objectDescriptorSets;
     Object::Map &objects;
+    const std::vector<uint32_t> &objectIndices; // by object id, into the object buffer, see ObjectDataSystem
+    GpuProfiler &gpuProfiler;
 };
 } // namespace vk
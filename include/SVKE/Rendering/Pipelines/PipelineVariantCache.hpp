@@ -0,0 +1,47 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace vk
+{
+// Compiles the variants of one pipeline lazily, the first time each is requested, and keeps them for reuse.
+class PipelineVariantCache
+{
+  public:
+    // Fills the parts of the config shared by every variant (layout, render pass, rasterization...)
+    using ConfigPopulator = std::function<void(Pipeline::Config &)>;
+
+    PipelineVariantCache(PipelineCompiler &pipeline_compiler, ConfigPopulator populate_config);
+    PipelineVariantCache(const PipelineVariantCache &) = delete;
+    PipelineVariantCache &operator=(const PipelineVariantCache &) = delete;
+
+    // The fallback is only used when the variant is not cached yet, see PipelineCompiler::compile.
+    const std::shared_ptr<PipelineCompiler::Handle> &get(const ShaderVariant &variant, Shader &vert_shader,
+                                                         Shader &frag_shader,
+                                                         std::shared_ptr<PipelineCompiler::Handle> fallback = nullptr);
+
+    // Rebuilds every cached variant, e.g. after the shaders were reloaded.
+    void recompileAll(Shader &vert_shader, Shader &frag_shader);
+
+    // Waits until no variant is being compiled, the shaders can then be destroyed.
+    void waitIdle() const;
+
+    [[nodiscard]]
+    const size_t size() const;
+
+  private:
+    PipelineCompiler &pipelineCompiler;
+    ConfigPopulator populateConfig;
+
+    std::unordered_map<ShaderVariant, std::shared_ptr<PipelineCompiler::Handle>> variants;
+
+    void populateVariantConfig(const ShaderVariant &variant, Pipeline::Config &config);
+};
+} // namespace vk
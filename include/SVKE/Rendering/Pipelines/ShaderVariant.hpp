@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Utils/HashCombine.hpp"
+
+#include <cstdint>
+
+namespace vk
+{
+// Runtime permutation of a pipeline. The lit surface shaders read the fields through specialization constants,
+// so every variant shares the same SPIR-V. Textured and untextured surfaces are compile-time permutations of
+// lit_surface.glsl instead, because the textured one needs an extra descriptor set.
+struct ShaderVariant
+{
+    enum SpecializationConstant : uint32_t
+    {
+        LightLimit = 0,
+        Specular = 1
+    };
+
+    int lightLimit = MAX_LIGHTS_PER_CLUSTER;
+    bool specular = true;
+    bool sampleShading = true;
+
+    // Depth was already written by the DepthPrepassSystem, so only the visible fragment of each sample passes
+    bool depthPrepass = false;
+
+    const bool operator==(const ShaderVariant &other) const;
+
+    // Writes the fragment specialization constants, the multisample and the depth state of this variant into config.
+    void apply(Pipeline::Config &config) const;
+};
+} // namespace vk
+
+namespace std
+{
+template <> struct hash<vk::ShaderVariant>
+{
+    inline const size_t operator()(vk::ShaderVariant const &variant) const
+    {
+        size_t seed = 0;
+
+        vk::hashCombine(seed, variant.lightLimit, variant.specular, variant.sampleShading, variant.depthPrepass);
+        return seed;
+    }
+};
+} // namespace std
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace vk
+{
+// The work of a frame as passes that declare which resources they read and write. compile orders the passes, drops
+// those whose results are never used, computes the barriers between them and places transient images whose
+// lifetimes do not overlap in the same memory. execute then records every pass behind a single barrier batch.
+// Barriers within a pass, e.g. between the levels of a mip chain it reduces, are left to the pass.
+// A graph is reset, declared, compiled and executed once per frame, transient images are kept across frames as long
+// as the same transient images with the same lifetimes are declared.
+class RenderGraph
+{
+  public:
+    using ResourceId = uint32_t;
+
+    // Decides the stages, accesses and image layout that the barriers around a pass wait for
+    enum class Usage
+    {
+        ColorAttachment,
+        DepthAttachment,
+        SampledFragment,
+        SampledCompute,
+        StorageFragment,
+        StorageCompute,
+        Indirect,
+        TransferSource,
+        TransferDestination
+    };
+
+    // Last access to an imported resource before the graph, the first pass using it waits for it
+    struct ResourceState
+    {
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 access = VK_ACCESS_2_NONE;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct ImageInfo
+    {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent = {0, 0};
+        uint32_t levelCount = 1;
+        VkImageUsageFlags usage = 0;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+        const bool operator==(const ImageInfo &other) const;
+    };
+
+    class PassBuilder
+    {
+      public:
+        PassBuilder(RenderGraph &graph, const uint32_t pass_index);
+
+        PassBuilder &read(const ResourceId resource, const Usage usage);
+
+        // Also covers what the usage reads, e.g. loaded attachments or atomics on a storage buffer
+        PassBuilder &write(const ResourceId resource, const Usage usage);
+
+        // Kept even if nothing in the graph reads what it writes, e.g. it draws into the swapchain
+        PassBuilder &setSideEffects();
+
+        PassBuilder &setExecute(std::function<void(VkCommandBuffer &)> execute);
+
+      private:
+        RenderGraph &graph;
+        uint32_t passIndex;
+    };
+
+    RenderGraph(Device &device);
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    // Forgets the passes and resources declared for the previous frame
+    void reset();
+
+    // Writes to imported resources are visible outside the graph, so passes writing them are never culled.
+    // Barriers cover all levels and layers of the image.
+    ResourceId importImage(const std::string &name, VkImage image, VkImageView view, const VkImageAspectFlags aspect,
+                           const ResourceState &state = {}, const uint32_t level_count = 1,
+                           const uint32_t layer_count = 1);
+
+    ResourceId importBuffer(const std::string &name, VkBuffer buffer, const ResourceState &state = {});
+
+    // Only lives from the first to the last pass using it, its contents are undefined before the first one
+    ResourceId createImage(const std::string &name, const ImageInfo &info);
+
+    PassBuilder addPass(const std::string &name);
+
+    void compile();
+
+    void execute(VkCommandBuffer &command_buffer);
+
+    // Of imported and transient resources, transient ones are only valid once the graph was compiled
+    VkImage getImage(const ResourceId resource) const;
+
+    VkImageView getImageView(const ResourceId resource) const;
+
+    // A single level of a transient image
+    VkImageView getLevelView(const ResourceId resource, const uint32_t level) const;
+
+    VkBuffer getBuffer(const ResourceId resource) const;
+
+    // Changes whenever the transient images were recreated, descriptor sets holding their views must be rewritten
+    const uint64_t getTransientGeneration() const;
+
+    // Of the last compile
+    const size_t getCulledPassCount() const;
+
+    // Of the current transient images, the memory they share and what they would take without aliasing
+    const VkDeviceSize getTransientMemorySize() const;
+
+    const VkDeviceSize getUnaliasedMemorySize() const;
+
+  private:
+    enum class ResourceType
+    {
+        ImportedImage,
+        ImportedBuffer,
+        TransientImage
+    };
+
+    struct Resource
+    {
+        std::string name;
+        ResourceType type;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = 0;
+        uint32_t levelCount = 1;
+        uint32_t layerCount = 1;
+
+        // Imported resources only
+        ResourceState initialState;
+
+        // Transient images only
+        ImageInfo info;
+        uint32_t transientIndex = 0;
+    };
+
+    struct Access
+    {
+        ResourceId resource;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 readAccess;
+        VkAccessFlags2 writeAccess;
+        VkImageLayout layout;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<Access> accesses;
+        std::function<void(VkCommandBuffer &)> execute;
+        bool sideEffects = false;
+
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    };
+
+    // Physical image of a transient resource, with the passes it lives between in the order they are recorded
+    struct TransientImage
+    {
+        ImageInfo info;
+        uint32_t firstPass;
+        uint32_t lastPass;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        std::vector<VkImageView> levelViews;
+        VkMemoryRequirements requirements = {};
+        uint32_t block = 0;
+    };
+
+    // Memory shared by transient images that are never alive at the same time
+    struct MemoryBlock
+    {
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkMemoryRequirements requirements = {};
+
+        // Accesses to the images placed in it since the last one began, the next one waits for them. Kept across
+        // frames, the first image of a frame may reuse the memory while the previous frame still uses it.
+        VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+    };
+
+    // Of a resource while the barriers are computed
+    struct State
+    {
+        VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+
+        // Readers since the last write, already made to wait for it
+        VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 readAccess = VK_ACCESS_2_NONE;
+
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool used = false;
+    };
+
+    Device &device;
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+
+    // Indices into passes in the order they are recorded, culled passes are left out
+    std::vector<uint32_t> schedule;
+
+    std::vector<TransientImage> transientImages;
+    std::vector<MemoryBlock> memoryBlocks;
+    uint64_t transientGeneration;
+
+    void addAccess(const uint32_t pass_index, const ResourceId resource, const Usage usage, const bool write);
+
+    // Returns which passes are kept
+    const std::vector<bool> cullPasses() const;
+
+    void schedulePasses(const std::vector<bool> &kept_passes);
+
+    // Recreates the transient images if they or their lifetimes changed since the last compile
+    void reserveTransientImages();
+
+    void releaseTransientImages();
+
+    void computeBarriers();
+
+    const bool isImage(const ResourceId resource) const;
+};
+} // namespace vk
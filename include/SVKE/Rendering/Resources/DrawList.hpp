@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/Resources/DrawOrder.hpp"
+#include "SVKE/Rendering/Resources/Model.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Utils/RadixSort.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+// Draws of one frame ordered by a 64 bit key, so consecutive draws share as much state as possible and record only
+// binds what changed between them. From the most to the least significant bits the key holds:
+//  - the object descriptor set (16 bits), e.g. the texture of a textured object
+//  - the model (16 bits), its vertex and index buffers
+//  - the view space depth (32 bits), nearest first, so the depth test still rejects hidden fragments within a batch
+// A list is recorded with one pipeline, bound by its system beforehand.
+// Sets and models are numbered in the order they are first added. Past the width of their field they share the last
+// number, which only costs binds: record compares the state itself, not the key.
+// Keep a DrawList around between frames, clear does not release what it has grown to.
+class DrawList
+{
+  public:
+    static constexpr uint32_t DESCRIPTOR_SET_BITS = 16;
+    static constexpr uint32_t MODEL_BITS = 16;
+    static constexpr uint32_t DEPTH_BITS = 32;
+
+    struct Draw
+    {
+        Model *model;
+        VkDescriptorSet descriptorSet;
+        uint32_t objectIndex;
+    };
+
+    void clear();
+
+    // The object must have a model, object_index is its element of the object buffer (see FrameInfo::objectIndices).
+    // descriptor_set is left out of the key and never bound if it is VK_NULL_HANDLE.
+    void add(const Mat4f &view, Object &object, const uint32_t object_index,
+             VkDescriptorSet descriptor_set = VK_NULL_HANDLE);
+
+    void sort();
+
+    // Records the sorted draws with the pipeline bound to command_buffer. The object descriptor sets are bound at
+    // descriptor_set_index of layout, which must have the push constant range of ObjectDataSystem.
+    void record(VkCommandBuffer &command_buffer, VkPipelineLayout layout, const uint32_t descriptor_set_index) const;
+
+    const size_t size() const;
+
+    const bool empty() const;
+
+  private:
+    std::vector<Draw> draws;
+    std::vector<std::pair<uint64_t, uint32_t>> items;
+    std::vector<std::pair<uint64_t, uint32_t>> scratch;
+
+    std::unordered_map<VkDescriptorSet, uint32_t> descriptorSetNumbers;
+    std::unordered_map<const Model *, uint32_t> modelNumbers;
+
+    static const uint64_t makeKey(const uint32_t descriptor_set, const uint32_t model, const uint32_t depth);
+};
+} // namespace vk
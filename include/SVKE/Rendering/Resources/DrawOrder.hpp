@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SVKE/Rendering/Camera.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Utils/RadixSort.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+using DrawItem = std::pair<uint32_t, Object *>;
+
+// Key of the view space depth of the object's origin, ascending with the distance in front of the camera
+inline const uint32_t viewDepthKey(const Mat4f &view, const Object &object)
+{
+    // Only the z row of the view matrix is needed, the camera looks down +z
+    const Vec3f &position = object.getTranslation();
+    const float depth = view[0][2] * position.x + view[1][2] * position.y + view[2][2] * position.z + view[3][2];
+
+    return floatToSortableKey(depth);
+}
+
+// Collects the objects accepted by filter, nearest first by the view space depth of their origin. Drawing opaque
+// objects in that order lets the depth test reject most of what they hide before it is shaded.
+// Keep items and scratch around between frames, see radixSort.
+template <typename Filter>
+void sortFrontToBack(const Camera &camera, Object::Map &objects, Filter filter, std::vector<DrawItem> &items,
+                     std::vector<DrawItem> &scratch)
+{
+    items.clear();
+
+    const Mat4f &view = camera.getViewMatrix();
+
+    for (auto &[_, object] : objects)
+        if (filter(object))
+            items.emplace_back(viewDepthKey(view, object), &object);
+
+    radixSort(items, scratch);
+}
+
+// Same as sortFrontToBack but farthest first, the order alpha blended objects have to be drawn in
+template <typename Filter>
+void sortBackToFront(const Camera &camera, Object::Map &objects, Filter filter, std::vector<DrawItem> &items,
+                     std::vector<DrawItem> &scratch)
+{
+    items.clear();
+
+    const Mat4f &view = camera.getViewMatrix();
+
+    for (auto &[_, object] : objects)
+        if (filter(object))
+            items.emplace_back(~viewDepthKey(view, object), &object);
+
+    radixSort(items, scratch);
+}
+} // namespace vk
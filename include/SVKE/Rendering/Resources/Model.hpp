@@ -2,6 +2,7 @@
 
 #include "SVKE/Core/System/Device.hpp"
 #include "SVKE/Core/Graphics/Vertex.hpp"
+#include "SVKE/Core/Math/Vector.hpp"
 #include "SVKE/Utils/HashCombine.hpp"
 #include "SVKE/Core/System/Memory/Buffer.hpp"
 
@@ -13,6 +14,8 @@
 #endif
 #include <glm/gtx/hash.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <memory>
 
@@ -52,6 +55,15 @@ class Model
 
     void draw(VkCommandBuffer &command_buffer);
 
+    // Encloses every vertex in model space, the radius is in w
+    const Vec4f getBoundingSphere() const;
+
+    const uint32_t getVertexCount() const;
+
+    const uint32_t getIndexCount() const;
+
+    const bool isIndexed() const;
+
     static std::unique_ptr<Model> createCubeModel(Device &device, const glm::vec3 &offset);
 
   private:
@@ -63,11 +75,15 @@ class Model
     std::unique_ptr<Buffer> indexBuffer;
     uint32_t indexCount;
 
+    Vec4f boundingSphere;
+
     bool loaded;
     bool hasIndexBuffer;
 
     void createVertexBuffers(const VertexArray &vertices);
     void createIndexBuffers(const IndexArray &indices);
+
+    void computeBoundingSphere(const VertexArray &vertices);
 };
 
 } // namespace vk
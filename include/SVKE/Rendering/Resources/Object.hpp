@@ -69,6 +69,10 @@ class Object
 
     const Vec3f &getRotation() const;
 
+    // Drawn by the TransparentRenderSystem instead of the opaque systems, with the alpha of its color as opacity.
+    // Textured objects are always opaque.
+    const bool isTransparent() const;
+
     void setModel(std::shared_ptr<Model> &model);
 
     void setTextureImage(std::shared_ptr<TextureImage> &tex_image);
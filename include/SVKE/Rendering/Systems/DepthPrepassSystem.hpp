@@ -0,0 +1,59 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/Resources/DrawList.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
+#include "SVKE/Rendering/Systems/Renderer.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+
+#include <string>
+#include <vector>
+
+namespace vk
+{
+// Lays down the depth of every opaque object before they are shaded, with a pipeline that has no fragment stage.
+// The RenderSystem and TextureRenderSystem then draw with a ShaderVariant::depthPrepass variant, which tests EQUAL
+// and writes no depth, so the lighting runs once per visible sample no matter how much the scene overdraws.
+class DepthPrepassSystem
+{
+  public:
+    DepthPrepassSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                       DescriptorSetLayout &global_set_layout);
+    DepthPrepassSystem(const DepthPrepassSystem &) = delete;
+    DepthPrepassSystem &operator=(const DepthPrepassSystem &) = delete;
+
+    ~DepthPrepassSystem();
+
+    // Must be recorded first in the render pass
+    void render(const FrameInfo &frame_info);
+
+    // Recompiles the pipeline if one of spv_paths is this system's shader
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+  private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/depth_prepass.vert.spv";
+
+    Device &device;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
+
+    VkPipelineLayout pipelineLayout;
+    PipelineCompiler &pipelineCompiler;
+    std::shared_ptr<PipelineCompiler::Handle> pipeline;
+
+    std::unique_ptr<Shader> vertShader;
+
+    // Reused every frame so it does not allocate once it has grown
+    DrawList drawList;
+
+    void loadShaders();
+
+    void createPipelineLayout(DescriptorSetLayout &global_set_layout);
+
+    void populatePipelineConfig(Pipeline::Config &pipeline_config);
+};
+} // namespace vk
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/ComputePipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Memory/FrameBufferRing.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+// Clustered forward lighting: every frame the point lights are uploaded to a storage buffer (global set, binding 1)
+// and a compute pass bins them into the froxels of the camera's perspective frustum (global set, binding 2).
+// Lit fragment shaders then only iterate over the lights of their own froxel, see clusters.glsl.
+class LightClusterSystem
+{
+  public:
+    // Must match light_cluster.comp
+    static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    // A light is culled where its contribution falls under this intensity, which bounds its range
+    static constexpr float LIGHT_CUTOFF = 1.f / 256.f;
+
+    static constexpr size_t MIN_LIGHT_CAPACITY = 64;
+
+    LightClusterSystem(Device &device, PipelineCompiler &pipeline_compiler, DescriptorSetLayout &global_set_layout,
+                       DescriptorPool &global_pool, std::vector<VkDescriptorSet> &global_descriptor_sets);
+    LightClusterSystem(const LightClusterSystem &) = delete;
+    LightClusterSystem &operator=(const LightClusterSystem &) = delete;
+
+    ~LightClusterSystem();
+
+    // Uploads the point lights to this frame's light buffer, growing it (and its descriptor) when needed.
+    // shadow_slots maps the lights that cast shadows to their cube in the point shadow atlas.
+    void update(const FrameInfo &frame_info, GlobalUBO &ubo,
+                const std::unordered_map<Object::objid_t, int> &shadow_slots = {});
+
+    // Distance at which the light falls under LIGHT_CUTOFF, lights are neither binned nor shadowed past it
+    static const float getLightRange(const Object &light);
+
+    // Records the culling pass, outside of a render pass. Barriers around it are left to the caller, see addCullPass.
+    void cull(const FrameInfo &frame_info);
+
+    // Adds a pass recording cull to the graph. Passes shading with the clusters must read the returned buffer.
+    const RenderGraph::ResourceId addCullPass(RenderGraph &render_graph, const FrameInfo &frame_info);
+
+    // Rebuilds the culling pipeline if one of spv_paths is its shader, keeping the current one if that fails
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+  private:
+    inline static const std::string COMP_SHADER_PATH = "assets/shaders/light_cluster.comp.spv";
+
+    Device &device;
+    PipelineCompiler &pipelineCompiler;
+    DescriptorSetLayout &globalSetLayout;
+    DescriptorPool &globalPool;
+
+    VkPipelineLayout pipelineLayout;
+    std::unique_ptr<Shader> compShader;
+    std::unique_ptr<ComputePipeline> pipeline;
+
+    FrameBufferRing lightBuffers;
+    std::array<std::unique_ptr<Buffer>, Swapchain::MAX_FRAMES_IN_FLIGHT> clusterBuffers;
+    std::vector<PointLight> lights;
+
+    void createPipelineLayout();
+
+    void createPipeline();
+
+    void createBuffers(std::vector<VkDescriptorSet> &global_descriptor_sets);
+
+    void reserveLights(const int frame_index, VkDescriptorSet &global_descriptor_set, const size_t light_count);
+};
+} // namespace vk
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Memory/FrameBufferRing.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <vector>
+
+namespace vk
+{
+// Every frame the transform and color of each object with a model are written to a persistently mapped storage
+// buffer (global set, binding 4, see object_data.glsl), in a single pass over the objects. The surface systems then
+// push nothing but the object's index (see FrameInfo::objectIndices) instead of its matrices.
+class ObjectDataSystem
+{
+  public:
+    static constexpr size_t MIN_OBJECT_CAPACITY = 256;
+
+    ObjectDataSystem(Device &device, DescriptorSetLayout &global_set_layout, DescriptorPool &global_pool,
+                     std::vector<VkDescriptorSet> &global_descriptor_sets);
+    ObjectDataSystem(const ObjectDataSystem &) = delete;
+    ObjectDataSystem &operator=(const ObjectDataSystem &) = delete;
+
+    // Writes the objects to this frame's buffer, growing it (and its descriptor) when needed. Must be called before
+    // anything of the frame is recorded with the indices.
+    void update(const FrameInfo &frame_info);
+
+    // Of the last update by object id, FrameInfo::objectIndices refers to them. Objects without a model have none.
+    const std::vector<uint32_t> &getObjectIndices() const;
+
+    // Of the pipeline layouts drawing with the object buffer
+    static const VkPushConstantRange getPushConstantRange();
+
+  private:
+    Device &device;
+    DescriptorSetLayout &globalSetLayout;
+    DescriptorPool &globalPool;
+
+    FrameBufferRing objectBuffers;
+
+    // Ids are handed out in order, so a vector indexed by them stays small and is reused every frame
+    std::vector<uint32_t> objectIndices;
+
+    void reserveObjects(const int frame_index, VkDescriptorSet &global_descriptor_set, const size_t object_count);
+};
+} // namespace vk
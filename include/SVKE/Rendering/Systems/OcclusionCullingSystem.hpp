@@ -0,0 +1,246 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/ComputePipeline.hpp"
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/Shader.hpp"
+#include "SVKE/Core/Graphics/TextureSampler.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Alignment.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+#include "SVKE/Rendering/Resources/Model.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/Renderer.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+// Hierarchical-Z occlusion culling of the untextured objects, drawn in place of the RenderSystem. Compute passes
+// test the bounding sphere of every object and compact the survivors into indirect draws, one per model.
+// The frame is drawn in two phases:
+//  - early: what was visible at the end of the last frame and is in the frustum is drawn into the render pass
+//  - late: a depth pyramid is built from that depth between endRenderPass and resumeRenderPass, every object is
+//    tested against it and those that became visible are drawn. The result is remembered for the next frame's
+//    early phase, and objects coming out from behind an occluder show up in the same frame instead of a frame late.
+// The compute passes are added to the frame's RenderGraph, which also owns the pyramid as a transient image.
+class OcclusionCullingSystem
+{
+    // Element of the culled object storage buffer (std430), must match culled_objects.glsl. The transforms are
+    // those of the object buffer, see ObjectDataSystem.
+    struct CulledObjectData
+    {
+        ALIGNAS_VEC4 Vec4f boundingSphere{}; // world space, w = radius
+        ALIGNAS_SCLR(uint32_t) uint32_t objectIndex = 0;
+        ALIGNAS_SCLR(uint32_t) uint32_t group = 0;
+        ALIGNAS_SCLR(uint32_t) uint32_t visibilitySlot = 0;
+    };
+
+    // Element of the group storage buffer (std430), must match occlusion_cull.comp
+    struct GroupData
+    {
+        uint32_t firstCommand = 0;
+        uint32_t elementCount = 0;
+        uint32_t indexed = 0;
+        uint32_t padding = 0;
+    };
+
+    // Must match occlusion_cull.comp
+    struct CullPushConstantData
+    {
+        ALIGNAS_VEC2 Vec2f depthSize{};
+        ALIGNAS_SCLR(uint32_t) uint32_t objectCount = 0;
+        ALIGNAS_SCLR(uint32_t) uint32_t groupCount = 0;
+        ALIGNAS_SCLR(uint32_t) uint32_t phase = 0;
+        ALIGNAS_SCLR(uint32_t) uint32_t pyramidLevelCount = 0;
+    };
+
+    enum Phase : uint32_t
+    {
+        Early = 0,
+        Late = 1
+    };
+
+    // Objects of a group share a model and are drawn with a single indirect draw per phase
+    struct Group
+    {
+        Model *model;
+        uint32_t firstObject;
+        uint32_t objectCount;
+    };
+
+    struct VisibilitySlot
+    {
+        uint32_t index;
+        uint64_t lastSeen;
+    };
+
+  public:
+    // Must match occlusion_cull.comp and depth_pyramid.glsl
+    static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+    static constexpr uint32_t PYRAMID_WORKGROUP_SIZE = 8;
+
+    // Enough for a first level of 32768 texels on a side
+    static constexpr uint32_t MAX_PYRAMID_LEVELS = 16;
+
+    static constexpr size_t MIN_OBJECT_CAPACITY = 256;
+    static constexpr size_t MIN_GROUP_CAPACITY = 16;
+
+    // Both VkDrawIndexedIndirectCommand and VkDrawIndirectCommand fit, see occlusion_cull.comp
+    static constexpr VkDeviceSize COMMAND_STRIDE = 5 * sizeof(uint32_t);
+
+    // Throws if the device cannot start indirect draws at an instance or issue several of them at once
+    OcclusionCullingSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                           DescriptorSetLayout &global_set_layout);
+    OcclusionCullingSystem(const OcclusionCullingSystem &) = delete;
+    OcclusionCullingSystem &operator=(const OcclusionCullingSystem &) = delete;
+
+    ~OcclusionCullingSystem();
+
+    // Gathers and uploads the objects. Must be outside of a render pass, before the frame's graph is executed, and
+    // after the ObjectDataSystem has written the objects of the frame.
+    void update(const FrameInfo &frame_info);
+
+    // Adds the culling of the objects that were visible last frame against the frustum, before the render pass
+    void addEarlyPasses(RenderGraph &render_graph, const FrameInfo &frame_info);
+
+    // Adds building the depth pyramid from what renderEarly drew into depth and testing every object against it,
+    // between the render pass and its continuation
+    void addLatePasses(RenderGraph &render_graph, const FrameInfo &frame_info, const RenderGraph::ResourceId depth);
+
+    // Render passes calling renderEarly or renderLate draw with the commands written by the passes above
+    void readDrawCommands(RenderGraph::PassBuilder &pass);
+
+    // Draws what the early culling kept. Must be recorded first in the render pass.
+    void renderEarly(const FrameInfo &frame_info);
+
+    // Draws what the late culling found visible that renderEarly did not draw. Must be recorded first in the
+    // resumed pass.
+    void renderLate(const FrameInfo &frame_info);
+
+    // Recompiles the draw pipeline or rebuilds the compute pipelines if spv_paths has one of this system's shaders
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+  private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/culled_surface.vert.spv";
+    inline static const std::string FRAG_SHADER_PATH = "assets/shaders/render_system.frag.spv";
+    inline static const std::string CULL_SHADER_PATH = "assets/shaders/occlusion_cull.comp.spv";
+    inline static const std::string PYRAMID_SHADER_PATH = "assets/shaders/depth_pyramid.comp.spv";
+    inline static const std::string PYRAMID_MS_SHADER_PATH = "assets/shaders/depth_pyramid_ms.comp.spv";
+
+    struct FrameResources
+    {
+        std::unique_ptr<Buffer> objectBuffer;
+        std::unique_ptr<Buffer> groupBuffer;
+        std::unique_ptr<Buffer> commandBuffer;
+        std::unique_ptr<Buffer> countBuffer;
+
+        VkDescriptorSet cullDescriptorSet = VK_NULL_HANDLE;
+        std::array<VkDescriptorSet, MAX_PYRAMID_LEVELS> pyramidDescriptorSets{};
+
+        // What the descriptor sets were last written with, the pyramid is that of RenderGraph::getTransientGeneration
+        uint64_t visibilityGeneration = 0;
+        uint64_t pyramidGeneration = 0;
+    };
+
+    Device &device;
+    Renderer &renderer;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
+    PipelineCompiler &pipelineCompiler;
+    DescriptorSetLayout &globalSetLayout;
+
+    std::unique_ptr<DescriptorSetLayout> cullSetLayout;
+    std::unique_ptr<DescriptorSetLayout> pyramidSetLayout;
+    std::unique_ptr<DescriptorPool> descriptorPool;
+
+    VkPipelineLayout drawPipelineLayout;
+    VkPipelineLayout cullPipelineLayout;
+    VkPipelineLayout pyramidPipelineLayout;
+
+    std::unique_ptr<Shader> vertShader;
+    std::unique_ptr<Shader> fragShader;
+    std::shared_ptr<PipelineCompiler::Handle> drawPipeline;
+
+    std::unique_ptr<Shader> cullShader;
+    std::unique_ptr<Shader> pyramidShader;
+    std::unique_ptr<Shader> pyramidMsShader;
+    std::unique_ptr<ComputePipeline> cullPipeline;
+    std::unique_ptr<ComputePipeline> pyramidPipeline;
+    std::unique_ptr<ComputePipeline> pyramidMsPipeline;
+
+    std::unique_ptr<TextureSampler> pyramidSampler;
+
+    std::array<FrameResources, Swapchain::MAX_FRAMES_IN_FLIGHT> frames;
+
+    // Written by the late phase of a frame and read by both phases of the next one, so it is shared by all frames
+    std::unique_ptr<Buffer> visibilityBuffer;
+    std::unique_ptr<Buffer> retiredVisibilityBuffer;
+    uint64_t visibilityGeneration;
+
+    // Of the transient pyramid, follows the extent of the render target
+    VkExtent2D pyramidExtent;
+    uint32_t pyramidLevelCount;
+
+    // Declared in the graph of the current frame
+    RenderGraph::ResourceId commandResource;
+    RenderGraph::ResourceId countResource;
+    RenderGraph::ResourceId visibilityResource;
+    RenderGraph::ResourceId pyramidResource;
+
+    // Sorted by model when they are gathered, so every group is a contiguous range
+    std::vector<std::pair<Model *, Object *>> drawObjects;
+    std::vector<CulledObjectData> culledObjects;
+    std::vector<GroupData> groupData;
+    std::vector<Group> groups;
+
+    std::unordered_map<Object::objid_t, VisibilitySlot> visibilitySlots;
+    std::vector<uint32_t> freeVisibilitySlots;
+    uint32_t visibilitySlotCount;
+    uint64_t frameCounter;
+
+    void loadShaders();
+
+    void createDescriptors();
+
+    void createPipelineLayouts();
+
+    void createComputePipelines();
+
+    void createPyramidSampler();
+
+    void populatePipelineConfig(Pipeline::Config &pipeline_config);
+
+    void gatherObjects(const FrameInfo &frame_info);
+
+    const uint32_t acquireVisibilitySlot(const Object::objid_t id);
+
+    void reserveFrameBuffers(const int frame_index, const size_t object_count, const size_t group_count);
+
+    // Grows the visibility buffer, keeping what the slots held so far
+    void reserveVisibility(VkCommandBuffer &command_buffer);
+
+    void updateDescriptorSets(const int frame_index, const RenderGraph &render_graph);
+
+    // Draws that are not written by the culling passes must not draw anything
+    void clearCommands(const FrameInfo &frame_info);
+
+    void buildPyramid(const FrameInfo &frame_info, const RenderGraph &render_graph);
+
+    void dispatchCull(const FrameInfo &frame_info, const Phase phase);
+
+    void drawIndirect(const FrameInfo &frame_info, const Phase phase);
+};
+} // namespace vk
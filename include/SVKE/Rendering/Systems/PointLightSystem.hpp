@@ -1,50 +1,92 @@
 #pragma once
 
 #include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
 #include "SVKE/Core/Math/Matrix.hpp"
 #include "SVKE/Core/Math/Vector.hpp"
 #include "SVKE/Core/System/Device.hpp"
 #include "SVKE/Core/System/Memory/Alignment.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Core/System/Memory/FrameBufferRing.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
 #include "SVKE/Rendering/Camera.hpp"
 #include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/Pipelines/PipelineVariantCache.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
 #include "SVKE/Rendering/Resources/Object.hpp"
 #include "SVKE/Rendering/Systems/Renderer.hpp"
 #include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Utils/RadixSort.hpp"
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace vk
 {
 class PointLightSystem
 {
   public:
-    struct PointLightPushConstant
+    // Per-instance vertex data of one billboard
+    struct PointLightInstance
     {
-        ALIGNAS_VEC3 Vec3f position{};
-        ALIGNAS_VEC4 Vec4f color; // w = intensity
-        ALIGNAS_SCLR(float) float radius;
+        ALIGNAS_VEC4 Vec4f position{}; // w = radius
+        ALIGNAS_VEC4 Vec4f color{};    // w = intensity
     };
 
-    PointLightSystem(Device &device, Renderer &renderer, DescriptorSetLayout &global_set_layout);
+    static constexpr size_t MIN_INSTANCE_CAPACITY = 64;
+
+    PointLightSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                     DescriptorSetLayout &global_set_layout);
     PointLightSystem(const PointLightSystem &) = delete;
     PointLightSystem &operator=(const PointLightSystem &) = delete;
 
     ~PointLightSystem();
 
-    void update(const FrameInfo &frame_info, GlobalUBO &ubo);
+    // Animates the point lights, their GPU data is uploaded by the LightClusterSystem
+    void update(const FrameInfo &frame_info);
+
+    // Draws every light back to front with a single instanced draw
     void render(const FrameInfo &frame_info);
 
+    // Recompiles the cached variants once if spv_paths has one or more of this system's shaders
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+    // Compiles the variant on first use, the current one keeps being drawn until it is ready
+    void setVariant(const ShaderVariant &shader_variant);
+
+    const ShaderVariant &getVariant() const;
+
   private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/point_light_system.vert.spv";
+    inline static const std::string FRAG_SHADER_PATH = "assets/shaders/point_light_system.frag.spv";
+
     Device &device;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
 
     VkPipelineLayout pipelineLayout;
-    std::unique_ptr<Pipeline> pipeline;
+    PipelineCompiler &pipelineCompiler;
+    PipelineVariantCache variants;
+    ShaderVariant variant;
+    std::shared_ptr<PipelineCompiler::Handle> pipeline;
 
     std::unique_ptr<Shader> vertShader;
     std::unique_ptr<Shader> fragShader;
 
+    FrameBufferRing instanceBuffers;
+
+    // Reused every frame so sorting does not allocate once they have grown
+    std::vector<PointLightInstance> unsortedInstances;
+    std::vector<PointLightInstance> sortedInstances;
+    std::vector<std::pair<uint32_t, uint32_t>> sortItems;
+    std::vector<std::pair<uint32_t, uint32_t>> sortScratch;
+
     void loadShaders();
 
     void createPipelineLayout(DescriptorSetLayout &global_set_layout);
 
-    void createPipeline(VkRenderPass render_pass);
+    void populatePipelineConfig(Pipeline::Config &pipeline_config);
 };
 } // namespace vk
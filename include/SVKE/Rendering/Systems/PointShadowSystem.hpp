@@ -0,0 +1,160 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/TextureSampler.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Alignment.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+// Cube shadow maps for the point lights closest to the camera. All of them share one atlas, a 2D array image with six
+// layers per light (global set, binding 3), sampled by lit_surface.glsl through point_shadows.glsl.
+// A light's cube is only drawn again when the light or one of the casters within its range changed, and then all six
+// faces are drawn at once with multiview. Casters are culled against every face on the CPU, faces they cannot reach
+// are skipped in the vertex shader.
+class PointShadowSystem
+{
+    struct PushConstantData
+    {
+        ALIGNAS_MAT4 Mat4f modelMatrix{1.f};
+        ALIGNAS_VEC4 Vec4f light{}; // w component is the range, which is also the far plane
+        ALIGNAS_SCLR(uint32_t) uint32_t faceMask = 0;
+    };
+
+  public:
+    // Must match point_shadows.glsl
+    static constexpr uint32_t FACE_COUNT = 6;
+    static constexpr float NEAR_PLANE = .05f;
+
+    static constexpr uint32_t DEFAULT_SHADOWED_LIGHT_COUNT = 4;
+    static constexpr uint32_t DEFAULT_RESOLUTION = 512;
+
+    // Counters the depth quantization along the surfaces, in addition to the normal offset of lit_surface.glsl
+    static constexpr float DEPTH_BIAS_CONSTANT = 1.25f;
+    static constexpr float DEPTH_BIAS_SLOPE = 1.75f;
+
+    // The atlas is written to the global descriptor sets, whose layout must have binding 3 for it
+    PointShadowSystem(Device &device, PipelineCompiler &pipeline_compiler, DescriptorSetLayout &global_set_layout,
+                      DescriptorPool &global_pool, std::vector<VkDescriptorSet> &global_descriptor_sets,
+                      const uint32_t shadowed_light_count = DEFAULT_SHADOWED_LIGHT_COUNT,
+                      const uint32_t resolution = DEFAULT_RESOLUTION);
+    PointShadowSystem(const PointShadowSystem &) = delete;
+    PointShadowSystem &operator=(const PointShadowSystem &) = delete;
+
+    ~PointShadowSystem();
+
+    // Picks the lights that cast shadows this frame and which of their cubes must be drawn again.
+    // Must be called before LightClusterSystem::update, which is given getShadowSlots.
+    void update(const FrameInfo &frame_info);
+
+    // Adds a pass drawing the cubes picked by update, or nothing if every cube is cached.
+    // Passes shading with the shadows must read the returned image as RenderGraph::Usage::SampledFragment.
+    const RenderGraph::ResourceId addShadowPass(RenderGraph &render_graph, const FrameInfo &frame_info);
+
+    // Cube of the atlas of every light casting shadows this frame
+    const std::unordered_map<Object::objid_t, int> &getShadowSlots() const;
+
+    // Of the last update, the rest were cached
+    const uint32_t getRedrawnLightCount() const;
+
+    // Recompiles the pipeline if one of spv_paths is this system's shader
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+  private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/point_shadow.vert.spv";
+
+    static constexpr uint32_t ALL_FACES_MASK = (1u << FACE_COUNT) - 1;
+
+    // Cube of the atlas, kept by the same light for as long as it stays among the shadowed lights
+    struct Slot
+    {
+        Object::objid_t light = 0;
+        bool used = false;
+
+        // Of the light and the casters within its range when the cube was last drawn
+        size_t signature = 0;
+        bool cached = false;
+    };
+
+    struct Caster
+    {
+        Object *object;
+        uint32_t faceMask;
+    };
+
+    // A cube to draw this frame
+    struct LightDraw
+    {
+        uint32_t slot;
+        Vec4f light;
+        std::vector<Caster> casters;
+    };
+
+    Device &device;
+    uint32_t shadowedLightCount;
+    uint32_t resolution;
+    VkFormat depthFormat;
+
+    VkImage atlasImage;
+    VmaAllocation atlasAllocation;
+    VkImageView atlasView;
+
+    // One view of six layers per slot, what a cube is drawn into
+    std::vector<VkImageView> slotViews;
+    std::unique_ptr<TextureSampler> sampler;
+
+    // The atlas is only transitioned away from VK_IMAGE_LAYOUT_UNDEFINED by the first pass
+    bool atlasInitialized;
+
+    VkPipelineLayout pipelineLayout;
+    PipelineCompiler &pipelineCompiler;
+    std::shared_ptr<PipelineCompiler::Handle> pipeline;
+
+    std::unique_ptr<Shader> vertShader;
+
+    std::vector<Slot> slots;
+    std::unordered_map<Object::objid_t, int> shadowSlots;
+
+    // Reused every frame so they do not allocate once they have grown
+    std::vector<std::pair<float, Object::objid_t>> candidates;
+    std::vector<LightDraw> lightDraws;
+    uint32_t redrawnLightCount;
+
+    // Casters of the light being gathered, and the caster lists of the previous frame's light draws, which the next
+    // light draws take over so copying the casters into them does not allocate either
+    std::vector<Caster> casters;
+    std::vector<std::vector<Caster>> spareCasterLists;
+
+    void loadShaders();
+
+    void createAtlas();
+
+    void createSampler();
+
+    void writeDescriptors(DescriptorSetLayout &global_set_layout, DescriptorPool &global_pool,
+                          std::vector<VkDescriptorSet> &global_descriptor_sets);
+
+    void createPipelineLayout();
+
+    void populatePipelineConfig(Pipeline::Config &pipeline_config);
+
+    void assignSlots(const FrameInfo &frame_info);
+
+    // Casters within range of the light, with the faces of its cube they reach, and returns their signature
+    const size_t gatherCasters(const FrameInfo &frame_info, const Vec4f &light, std::vector<Caster> &casters);
+
+    void render(const FrameInfo &frame_info);
+};
+} // namespace vk
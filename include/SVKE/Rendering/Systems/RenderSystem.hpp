@@ -1,28 +1,29 @@
 #pragma once
 
 #include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
 #include "SVKE/Core/System/Device.hpp"
-#include "SVKE/Core/System/Memory/Alignment.hpp"
 #include "SVKE/Rendering/Camera.hpp"
 #include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/Pipelines/PipelineVariantCache.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+#include "SVKE/Rendering/Resources/DrawList.hpp"
 #include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
 #include "SVKE/Rendering/Systems/Renderer.hpp"
 #include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
 
 #include <array>
+#include <string>
+#include <vector>
 
 namespace vk
 {
 class RenderSystem
 {
-    struct PushConstantData
-    {
-        ALIGNAS_MAT4 Mat4f modelMatrix{1.f};
-        ALIGNAS_MAT4 Mat4f normalMatrix{1.f};
-    };
-
   public:
-    RenderSystem(Device &device, Renderer &renderer, DescriptorSetLayout &global_set_layout);
+    RenderSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                 DescriptorSetLayout &global_set_layout);
     RenderSystem(const RenderSystem &) = delete;
     RenderSystem &operator=(const RenderSystem &) = delete;
 
@@ -30,19 +31,40 @@ class RenderSystem
 
     void render(const FrameInfo &frame_info);
 
+    // Recompiles the cached variants once if spv_paths has one or more of this system's shaders
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+    // Compiles the variant on first use, the current one keeps being drawn until it is ready
+    void setVariant(const ShaderVariant &shader_variant);
+
+    const ShaderVariant &getVariant() const;
+
+    const std::shared_ptr<PipelineCompiler::Handle> &getPipelineHandle() const;
+
   private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/render_system.vert.spv";
+    inline static const std::string FRAG_SHADER_PATH = "assets/shaders/render_system.frag.spv";
+
     Device &device;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
 
     VkPipelineLayout pipelineLayout;
-    std::unique_ptr<Pipeline> pipeline;
+    PipelineCompiler &pipelineCompiler;
+    PipelineVariantCache variants;
+    ShaderVariant variant;
+    std::shared_ptr<PipelineCompiler::Handle> pipeline;
 
     std::unique_ptr<Shader> vertShader;
     std::unique_ptr<Shader> fragShader;
 
+    // Reused every frame so it does not allocate once it has grown
+    DrawList drawList;
+
     void loadShaders();
 
     void createPipelineLayout(DescriptorSetLayout &global_set_layout);
 
-    void createPipeline(VkRenderPass render_pass);
+    void populatePipelineConfig(Pipeline::Config &pipeline_config);
 };
 } // namespace vk
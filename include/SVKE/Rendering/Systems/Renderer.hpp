@@ -1,9 +1,15 @@
 #pragma once
 
 #include "SVKE/Core/System/Window.hpp"
+#include "SVKE/Core/System/CommandBufferManager.hpp"
 #include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/FrameCapture.hpp"
+#include "SVKE/Core/System/GpuProfiler.hpp"
+#include "SVKE/Core/System/OffscreenTarget.hpp"
 #include "SVKE/Core/System/Swapchain.hpp"
 #include "SVKE/Core/Graphics/Color.hpp"
+#include "SVKE/Core/Time/FramePacer.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
 
 #include <array>
 
@@ -14,48 +20,124 @@ class Renderer
   public:
     Renderer(Device &device, Window &window,
              const Swapchain::PresentMode &preferred_present_mode = Swapchain::PresentMode::Mailbox,
-             const Color &clear_color = COLOR_BLACK);
+             const Color &clear_color = COLOR_BLACK, const int frames_in_flight = Swapchain::DEFAULT_FRAMES_IN_FLIGHT);
+
+    // Headless: renders into an OffscreenTarget of the given extent, the device must have been created headless
+    Renderer(Device &device, const VkExtent2D &extent, const Color &clear_color = COLOR_BLACK,
+             const int frames_in_flight = Swapchain::DEFAULT_FRAMES_IN_FLIGHT);
+
     Renderer(const Renderer &) = delete;
     Renderer &operator=(const Renderer &) = delete;
 
-    ~Renderer();
-
     VkCommandBuffer beginFrame();
 
     void endFrame();
 
+    // Begins dynamic rendering into the render target, clearing color and depth. Color is transitioned here, depth
+    // must already be in DEPTH_STENCIL_ATTACHMENT_OPTIMAL, see getDepthImage.
     void beginRenderPass(VkCommandBuffer &command_buffer);
 
+    // Continues the frame's render pass after endRenderPass, e.g. once compute work has read its depth. Color and
+    // depth are loaded instead of cleared, the same pipelines can be used.
+    void resumeRenderPass(VkCommandBuffer &command_buffer);
+
     void endRenderPass(VkCommandBuffer &command_buffer);
 
     const bool isFrameInProgress() const;
 
     const int getCurrentFrameIndex() const;
 
+    // Between 1 and Swapchain::MAX_FRAMES_IN_FLIGHT, per frame resources of systems are indexed up to this
+    const int getFramesInFlight() const;
+
+    // Must be called right before input for the next frame is sampled, see FramePacer
+    void paceFrame();
+
+    void setLowLatency(const bool low_latency);
+
+    const bool isLowLatency() const;
+
     VkCommandBuffer &getCurrentCommandBuffer();
 
-    VkRenderPass getRenderPass();
+    // The frame's command buffer is acquired from it. Systems may acquire secondary buffers of the current frame
+    // from it, on any thread, and execute them in the frame's buffer.
+    CommandBufferManager &getCommandBufferManager();
+
+    // Pipelines drawn between beginRenderPass and endRenderPass are created for it and getDepthFormat
+    VkFormat getImageFormat();
+
+    // Depth attachment of the current frame, its contents are undefined when the frame begins. Its layout is left to
+    // the caller, e.g. a RenderGraph pass writing it as a DepthAttachment.
+    VkImage getDepthImage();
+
+    VkImageView getDepthImageView();
+
+    VkFormat getDepthFormat();
+
+    // Includes the stencil aspect for formats that have one, layout transitions of the depth image must cover it
+    const VkImageAspectFlags getDepthAspect();
 
     const float getAspectRatio() const;
 
+    VkExtent2D getExtent() const;
+
+    // Frames and render passes are profiled automatically, systems add their own scopes inside
+    GpuProfiler &getGpuProfiler();
+
+    FrameStats &getFrameStats();
+
+    const FrameStats &getFrameStats() const;
+
+    const bool isHeadless() const;
+
+    // Only set when rendering headless
+    OffscreenTarget *getOffscreenTarget();
+
+    // Every following frame is captured until stopCapture, see FrameCapture
+    void startCapture(const FrameCapture::Options &options);
+
+    // Waits for the captured frames to be written
+    void stopCapture();
+
+    const bool isCapturing() const;
+
   private:
+    // How long the frame loop sleeps per iteration while the window is minimized
+    static constexpr double MINIMIZED_WAIT_SECONDS = .05;
+
     Device &device;
-    Window &window;
+    Window *window;
 
     Swapchain::PresentMode preferredPresentMode;
 
     Color clearColor;
 
     std::unique_ptr<Swapchain> swapchain;
+    std::unique_ptr<OffscreenTarget> offscreenTarget;
+    RenderTarget *renderTarget;
+    std::unique_ptr<CommandBufferManager> commandBufferManager;
     std::vector<VkCommandBuffer> commandBuffers;
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    std::unique_ptr<FrameCapture> frameCapture;
+    FrameStats frameStats;
+    std::unique_ptr<FramePacer> framePacer;
 
     uint32_t currentImageIndex;
+    uint64_t frameNumber;
+    int framesInFlight;
     int currentFrameIndex;
     bool frameInProgress;
 
-    void createCommandBuffers();
+    // Set while the window is minimized, the swapchain is recreated once it has a size again
+    bool swapchainOutOfDate;
 
-    void freeCommandBuffers();
+    void recordBeginRenderPass(VkCommandBuffer &command_buffer, const bool resume, const char *scope_name);
+
+    // Of the render target's image and, if include_multisampled and MSAA is on, its multisampled color image
+    void recordColorBarrier(VkCommandBuffer &command_buffer, const VkImageMemoryBarrier2 &barrier,
+                            const bool include_multisampled);
+
+    void createCommandBuffers();
 
     void recreateSwapchain();
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/TextureSampler.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Memory/Buffer.hpp"
+#include "SVKE/Rendering/Camera.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/DepthPrepassSystem.hpp"
+#include "SVKE/Rendering/Systems/LightClusterSystem.hpp"
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
+#include "SVKE/Rendering/Systems/OcclusionCullingSystem.hpp"
+#include "SVKE/Rendering/Systems/PointLightSystem.hpp"
+#include "SVKE/Rendering/Systems/PointShadowSystem.hpp"
+#include "SVKE/Rendering/Systems/RenderSystem.hpp"
+#include "SVKE/Rendering/Systems/Renderer.hpp"
+#include "SVKE/Rendering/Systems/TextureRenderSystem.hpp"
+#include "SVKE/Rendering/Systems/TransparentRenderSystem.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+// Draws frames of a scene with every render system, the same way for the App and the Benchmark. It owns the global
+// UBO and descriptor sets, one texture set per texture of the objects, the systems and the render graph they declare
+// their passes in. The textures of the objects are only looked at when it is created.
+class SceneRenderer
+{
+  public:
+    struct Options
+    {
+        // Draws the untextured objects through the OcclusionCullingSystem, cannot be combined with the depth pre-pass
+        bool occlusionCulling = false;
+
+        // Point lights closest to the camera that cast shadows, 0 leaves every light unshadowed
+        uint32_t shadowedLights = PointShadowSystem::DEFAULT_SHADOWED_LIGHT_COUNT;
+
+        TransparentRenderSystem::Mode transparency = TransparentRenderSystem::Mode::Sorted;
+    };
+
+    // The pools must have room for a global set per frame in flight and a set per texture of the objects
+    SceneRenderer(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                  DescriptorPool &global_pool, DescriptorPool &object_texture_pool, TextureSampler &texture_sampler,
+                  Object::Map &objects, const Options &options);
+    SceneRenderer(const SceneRenderer &) = delete;
+    SceneRenderer &operator=(const SceneRenderer &) = delete;
+
+    // Begins, records and ends a frame of the renderer. Returns false if no frame could be begun, e.g. while the
+    // swapchain is recreated.
+    const bool renderFrame(Camera &camera, const float dt);
+
+    // Both surface systems switch together. Their new variants are waited for: a fallback with the other depth state
+    // would not draw anything until they are ready.
+    void setDepthPrepass(const bool enabled);
+
+    const bool isDepthPrepass() const;
+
+    // See ShaderWatcher::pollChanges
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+    const bool hasOcclusionCulling() const;
+
+    TransparentRenderSystem &getTransparentRenderSystem();
+
+    const PointShadowSystem &getPointShadowSystem() const;
+
+  private:
+    Device &device;
+    Renderer &renderer;
+    PipelineCompiler &pipelineCompiler;
+    Object::Map &objects;
+
+    std::vector<std::unique_ptr<Buffer>> globalUboBuffers;
+    std::unique_ptr<DescriptorSetLayout> globalSetLayout;
+    std::unique_ptr<DescriptorSetLayout> objectSetLayout;
+    std::vector<VkDescriptorSet> globalDescriptorSets;
+
+    // Objects sharing a texture share its set, so the draws of a DrawList do not bind it again between them
+    std::unordered_map<Object::objid_t, VkDescriptorSet> objectDescriptorSets;
+
+    std::unique_ptr<RenderSystem> renderSystem;
+    std::unique_ptr<TextureRenderSystem> textureRenderSystem;
+    std::unique_ptr<PointLightSystem> pointLightSystem;
+    std::unique_ptr<LightClusterSystem> lightClusterSystem;
+    std::unique_ptr<ObjectDataSystem> objectDataSystem;
+    std::unique_ptr<DepthPrepassSystem> depthPrepassSystem;
+    std::unique_ptr<PointShadowSystem> pointShadowSystem;
+    std::unique_ptr<TransparentRenderSystem> transparentRenderSystem;
+
+    // Only created when used, it throws on devices without the indirect drawing features it needs
+    std::unique_ptr<OcclusionCullingSystem> occlusionCullingSystem;
+
+    // Declared anew every frame, keeps its transient images as long as they stay the same
+    RenderGraph renderGraph;
+
+    void createGlobalDescriptorSets(DescriptorPool &global_pool);
+
+    void createObjectDescriptorSets(DescriptorPool &object_texture_pool, TextureSampler &texture_sampler);
+
+    void createSystems(DescriptorPool &global_pool, const Options &options);
+
+    // Writes the frame's global UBO as well
+    void update(FrameInfo &frame_info);
+
+    // Passes declare what they use, the graph records the barriers between them
+    void addPasses(FrameInfo &frame_info);
+};
+} // namespace vk
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "SVKE/Core/Graphics/Pipeline.hpp"
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+#include "SVKE/Core/Graphics/TextureSampler.hpp"
+#include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/Swapchain.hpp"
+#include "SVKE/Rendering/FrameInfo.hpp"
+#include "SVKE/Rendering/RenderGraph.hpp"
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+#include "SVKE/Rendering/Resources/DrawList.hpp"
+#include "SVKE/Rendering/Resources/DrawOrder.hpp"
+#include "SVKE/Rendering/Resources/Object.hpp"
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
+#include "SVKE/Rendering/Systems/Renderer.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorPool.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorSetLayout.hpp"
+#include "SVKE/Rendering/Descriptors/DescriptorWriter.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vk
+{
+// Draws the transparent objects (see Object::isTransparent) after the opaque ones, lit like them and depth tested
+// against them without writing depth. Two ways of blending them are available:
+//  - Sorted: farthest first with regular alpha blending, inside the render pass. Correct as long as objects do not
+//    intersect, but the order is per object, not per fragment.
+//  - WeightedBlended: order independent. Every object is added into an accumulation and a revealage target in a pass
+//    of its own, weighted by its depth, and composite blends their average over the frame in the resumed pass. No
+//    sorting, at the cost of an approximation where many layers overlap.
+class TransparentRenderSystem
+{
+  public:
+    enum class Mode
+    {
+        Sorted,
+        WeightedBlended
+    };
+
+    // Must match lit_surface.glsl
+    static constexpr uint32_t WEIGHTED_BLENDED_CONSTANT_ID = 2;
+
+    static constexpr VkFormat ACCUMULATION_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+    static constexpr VkFormat REVEALAGE_FORMAT = VK_FORMAT_R16_SFLOAT;
+
+    TransparentRenderSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                            DescriptorSetLayout &global_set_layout, const Mode mode = Mode::Sorted);
+    TransparentRenderSystem(const TransparentRenderSystem &) = delete;
+    TransparentRenderSystem &operator=(const TransparentRenderSystem &) = delete;
+
+    ~TransparentRenderSystem();
+
+    // Sorted mode only. Must be recorded after the opaque objects, in the same render pass.
+    void render(const FrameInfo &frame_info);
+
+    // WeightedBlended mode only, adds the pass accumulating the objects after everything that writes depth.
+    // The pass reading the result must call readAccumulation and composite.
+    void addAccumulationPass(RenderGraph &render_graph, const FrameInfo &frame_info,
+                             const RenderGraph::ResourceId depth, const RenderGraph::ResourceId light_clusters,
+                             const RenderGraph::ResourceId point_shadows);
+
+    void readAccumulation(RenderGraph::PassBuilder &pass);
+
+    // Blends the accumulated objects over the frame, within a resumed render pass
+    void composite(const FrameInfo &frame_info);
+
+    // Recompiles each pipeline at most once, if spv_paths has one or more of its shaders
+    void reloadShaders(const std::vector<std::string> &spv_paths);
+
+    void setMode(const Mode mode);
+
+    const Mode getMode() const;
+
+    // Of the last frame
+    const size_t getTransparentObjectCount() const;
+
+  private:
+    inline static const std::string VERT_SHADER_PATH = "assets/shaders/transparent_surface.vert.spv";
+    inline static const std::string FRAG_SHADER_PATH = "assets/shaders/transparent_surface.frag.spv";
+    inline static const std::string COMPOSITE_VERT_SHADER_PATH = "assets/shaders/wboit_composite.vert.spv";
+    inline static const std::string COMPOSITE_FRAG_SHADER_PATH = "assets/shaders/wboit_composite.frag.spv";
+
+    struct FrameResources
+    {
+        VkDescriptorSet compositeDescriptorSet = VK_NULL_HANDLE;
+
+        // Of RenderGraph::getTransientGeneration when the set was last written
+        uint64_t transientGeneration = 0;
+    };
+
+    Device &device;
+    Renderer &renderer;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
+    Mode mode;
+
+    std::unique_ptr<DescriptorSetLayout> compositeSetLayout;
+    std::unique_ptr<DescriptorPool> descriptorPool;
+    std::unique_ptr<TextureSampler> compositeSampler;
+
+    VkPipelineLayout pipelineLayout;
+    VkPipelineLayout compositePipelineLayout;
+    PipelineCompiler &pipelineCompiler;
+    std::shared_ptr<PipelineCompiler::Handle> sortedPipeline;
+    std::shared_ptr<PipelineCompiler::Handle> accumulationPipeline;
+    std::shared_ptr<PipelineCompiler::Handle> compositePipeline;
+
+    std::unique_ptr<Shader> vertShader;
+    std::unique_ptr<Shader> fragShader;
+    std::unique_ptr<Shader> compositeVertShader;
+    std::unique_ptr<Shader> compositeFragShader;
+
+    std::array<FrameResources, Swapchain::MAX_FRAMES_IN_FLIGHT> frames;
+
+    // Declared in the graph of the current frame. The multisampled targets are only declared with MSAA, they are
+    // resolved into the others.
+    RenderGraph::ResourceId accumulationResource;
+    RenderGraph::ResourceId revealageResource;
+    RenderGraph::ResourceId accumulationMsResource;
+    RenderGraph::ResourceId revealageMsResource;
+    bool accumulated;
+
+    // Reused every frame so sorting does not allocate once they have grown. The accumulation does not depend on the
+    // order, its objects are only grouped by model.
+    std::vector<DrawItem> drawItems;
+    std::vector<DrawItem> drawScratch;
+    DrawList accumulationList;
+
+    void loadShaders();
+
+    void createDescriptors();
+
+    void createPipelineLayouts(DescriptorSetLayout &global_set_layout);
+
+    void createPipelines();
+
+    void populateSurfaceConfig(Pipeline::Config &pipeline_config);
+
+    void populateSortedConfig(Pipeline::Config &pipeline_config);
+
+    void populateAccumulationConfig(Pipeline::Config &pipeline_config);
+
+    void populateCompositeConfig(Pipeline::Config &pipeline_config);
+
+    void updateDescriptorSet(const int frame_index, const RenderGraph &render_graph);
+
+    void accumulate(const FrameInfo &frame_info, const RenderGraph &render_graph);
+};
+} // namespace vk
@@ -1,3 +1,5 @@
 #pragma once
 
 #include "SVKE/Utils/HashCombine.hpp"
+#include "SVKE/Utils/ImageWriter.hpp"
+#include "SVKE/Utils/RadixSort.hpp"
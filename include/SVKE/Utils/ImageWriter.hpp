@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace vk
+{
+// Writes 8-bit RGBA pixels, rows top to bottom, as a PNG. The image data is stored uncompressed (deflate "stored"
+// blocks), which keeps encoding as cheap as a copy at the cost of file size.
+const bool writePng(const std::string &path, const uint32_t width, const uint32_t height, const uint8_t *pixels);
+
+// Writes the pixels as they are, without any header
+const bool writeRaw(const std::string &path, const uint32_t width, const uint32_t height, const uint8_t *pixels);
+} // namespace vk
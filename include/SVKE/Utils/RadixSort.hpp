@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+// Maps a float to an unsigned key with the same ordering, negative values and -0.f included.
+inline uint32_t floatToSortableKey(const float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// Stable LSD radix sort of (key, value) pairs in ascending key order, one byte per pass.
+// scratch is resized to the size of items, keep both around between calls to avoid allocating every frame.
+// Passes in which every key has the same byte are skipped, so small key ranges sort in fewer passes.
+template <typename Key, typename Value>
+void radixSort(std::vector<std::pair<Key, Value>> &items, std::vector<std::pair<Key, Value>> &scratch)
+{
+    static_assert(std::is_unsigned<Key>::value, "RADIX SORT KEYS MUST BE UNSIGNED INTEGERS");
+
+    constexpr size_t PASS_COUNT = sizeof(Key);
+    constexpr size_t BUCKET_COUNT = 256;
+
+    if (items.size() < 2)
+        return;
+
+    scratch.resize(items.size());
+
+    // Histograms of every byte are built in a single read of the keys
+    std::array<std::array<size_t, BUCKET_COUNT>, PASS_COUNT> histograms = {};
+
+    for (const auto &item : items)
+    {
+        for (size_t pass = 0; pass < PASS_COUNT; ++pass)
+            ++histograms[pass][(item.first >> (pass * 8)) & 0xFF];
+    }
+
+    auto *source = &items;
+    auto *destination = &scratch;
+
+    for (size_t pass = 0; pass < PASS_COUNT; ++pass)
+    {
+        auto &histogram = histograms[pass];
+        const size_t shift = pass * 8;
+
+        if (histogram[(source->front().first >> shift) & 0xFF] == source->size())
+            continue;
+
+        // Exclusive prefix sum turns the counts into bucket offsets
+        size_t offset = 0;
+
+        for (auto &count : histogram)
+        {
+            const size_t bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+
+        for (auto &item : *source)
+            (*destination)[histogram[(item.first >> shift) & 0xFF]++] = std::move(item);
+
+        std::swap(source, destination);
+    }
+
+    if (source != &items)
+        items.swap(scratch);
+}
+} // namespace vk
@@ -1,10 +1,19 @@
 #include "App.hpp"
 
-vk::App::App()
+#include <fstream>
+#include <random>
+
+vk::App::App() : App(Options{})
+{
+}
+
+vk::App::App(const Options &options) : options(options)
 {
     createWindow();
     createDevice();
     createRenderer();
+    createPipelineCompiler();
+    createShaderWatcher();
     createGlobalPool();
     createObjectTexturePool();
     createTextureSampler();
@@ -13,151 +22,301 @@ vk::App::App()
 
 void vk::App::run()
 {
-    std::array<std::unique_ptr<Buffer>, Swapchain::MAX_FRAMES_IN_FLIGHT> global_ubo_buffers;
-    for (auto &buffer : global_ubo_buffers)
-    {
-        buffer = std::make_unique<Buffer>(*device, sizeof(GlobalUBO),
-                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                          VMA_MEMORY_USAGE_AUTO,
-                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
-                                              VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
-        buffer->map();
-    }
+    SVKE_PROFILE_THREAD("Main");
 
-    // Global Descriptor Set Layout
-    auto global_set_layout = DescriptorSetLayout::Builder(*device)
-                                 .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
-                                 .build();
+    SceneRenderer::Options scene_options = {};
+    scene_options.occlusionCulling = options.occlusionCulling;
+    scene_options.shadowedLights = options.shadowedLights;
+    scene_options.transparency = options.transparency;
 
-    // Object Descriptor Set Layout
-    auto object_set_layout = DescriptorSetLayout::Builder(*device)
-                                 .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-                                 .build();
+    // Pipelines compile in the background, see SceneRenderer
+    SceneRenderer scene_renderer(*device, *renderer, *pipelineCompiler, *globalPool, *objectTexturePool,
+                                 *textureSampler, objects, scene_options);
 
-    std::vector<VkDescriptorSetLayout> set_layouts = {global_set_layout->getDescriptorSetLayout(),
-                                                      object_set_layout->getDescriptorSetLayout()};
+    Camera camera;
+    Object viewer;
+    viewer.setTranslation({0.f, 0.f, -2.f});
+
+    // Input only exists with a window, headless runs keep the camera where it starts
+    std::unique_ptr<Keyboard> keyboard;
+    std::unique_ptr<Mouse> mouse;
+    std::unique_ptr<MovementController> camera_controller;
 
-    std::vector<VkDescriptorSet> global_descriptor_sets(Swapchain::MAX_FRAMES_IN_FLIGHT);
-    for (int i = 0; i < global_descriptor_sets.size(); ++i)
+    if (!isHeadless())
     {
-        auto buffer_info = global_ubo_buffers[i]->getDescriptorInfo();
-        DescriptorWriter(*global_set_layout, *globalPool).writeBuffer(0, buffer_info).build(global_descriptor_sets[i]);
+        keyboard = std::make_unique<Keyboard>(*window);
+        mouse = std::make_unique<Mouse>(*window);
+        camera_controller = std::make_unique<MovementController>(*keyboard, *mouse);
     }
 
-    std::unordered_map<Object::objid_t, VkDescriptorSet> object_descriptor_sets;
-    for (auto &[id, object] : objects)
-    {
-        if (!object.getTextureImage())
-            continue;
+    GpuProfiler &gpu_profiler = renderer->getGpuProfiler();
 
-        auto image_info = object.getTextureImage()->getDescriptorInfo(*textureSampler);
-        DescriptorWriter(*object_set_layout, *objectTexturePool)
-            .writeImage(0, image_info)
-            .build(object_descriptor_sets[id]);
-    }
+    auto print_stats = [&]() {
+        renderer->getFrameStats().print(std::cout);
 
-    Camera camera;
-    Object viewer;
-    viewer.setTranslation({0.f, 0.f, -2.f});
+        const PointShadowSystem &point_shadow_system = scene_renderer.getPointShadowSystem();
+
+        std::cout << point_shadow_system.getRedrawnLightCount() << " of "
+                  << point_shadow_system.getShadowSlots().size() << " shadowed lights redrawn last frame" << std::endl;
+
+        for (const auto &name : gpu_profiler.getScopeNames())
+        {
+            const auto *history = gpu_profiler.getHistory(name);
+            const auto &latest = history->getLatest();
+
+            std::cout << "GPU time of " << name << " over " << history->size() << " frames: " << history->getAverage()
+                      << " ms average, " << history->getMax() << " ms max" << std::endl;
+
+            if (latest.hasStatistics)
+                std::cout << "    " << latest.statistics.inputAssemblyPrimitives << " primitives, "
+                          << latest.statistics.vertexShaderInvocations << " vertex, "
+                          << latest.statistics.fragmentShaderInvocations << " fragment and "
+                          << latest.statistics.computeShaderInvocations << " compute invocations" << std::endl;
+        }
+
+        const MemoryTracker &memory_tracker = device->getMemoryTracker();
+        const auto &heap_budgets = memory_tracker.getHeapBudgets();
+
+        for (size_t i = 0; i < heap_budgets.size(); ++i)
+            std::cout << "Memory heap " << i << (heap_budgets[i].deviceLocal ? " (device local): " : ": ")
+                      << heap_budgets[i].usage / (1024 * 1024) << " of " << heap_budgets[i].budget / (1024 * 1024)
+                      << " MiB" << std::endl;
+
+        for (size_t i = 0; i < MemoryTracker::CATEGORY_COUNT; ++i)
+        {
+            const auto category = static_cast<MemoryTracker::Category>(i);
+            const MemoryTracker::CategoryUsage usage = memory_tracker.getCategoryUsage(category);
 
-    Keyboard keyboard(*window);
-    Mouse mouse(*window);
-    MovementController camera_controller(keyboard, mouse);
+            std::cout << "    " << MemoryTracker::getCategoryName(category) << ": " << usage.allocationCount
+                      << " allocations, " << usage.bytes / 1024 << " KiB" << std::endl;
+        }
+    };
+
+    // The free attachments kept for resizing are given back first, nothing else holds memory it can do without
+    device->getMemoryTracker().setBudgetCallback(
+        [this](const uint32_t heap_index, const MemoryTracker::HeapBudget &heap_budget) {
+            std::cerr << "Memory heap " << heap_index << " is near its budget (" << heap_budget.usage << " of "
+                      << heap_budget.budget << " bytes), releasing " << device->getAttachmentPool().getFreeCount()
+                      << " free attachments" << std::endl;
 
-    RenderSystem render_system(*device, *renderer, *global_set_layout);
-    TextureRenderSystem texture_render_system(*device, *renderer, set_layouts);
-    PointLightSystem point_light_system(*device, *renderer, *global_set_layout);
+            device->getAttachmentPool().clear();
+        });
 
     Timer delta_timer;
+    bool trace_key_held = false;
+    bool stats_key_held = false;
+    bool capture_key_held = false;
+    bool latency_key_held = false;
+    bool prepass_key_held = false;
+    bool transparency_key_held = false;
+    bool memory_key_held = false;
+    uint32_t frame_count = 0;
+
+    // Every frame of a headless run is drawn with the final pipelines, not with fallbacks that happen to be ready
+    if (isHeadless())
+        pipelineCompiler->waitIdle();
+
+    if (!options.captureDirectory.empty())
+    {
+        FrameCapture::Options capture_options = {};
+        capture_options.directory = options.captureDirectory;
+        renderer->startCapture(capture_options);
+    }
 
-    if (Mouse::isRawMotionSupported())
+    if (mouse && Mouse::isRawMotionSupported())
     {
-        mouse.setRawMode(true);
-        mouse.setCursorMode(Mouse::CursorMode::Disabled);
+        mouse->setRawMode(true);
+        mouse->setCursorMode(Mouse::CursorMode::Disabled);
     }
-    else
+    else if (mouse)
     {
         std::cerr << "Mouse raw mode is not supported" << std::endl;
     }
 
-    while (!window->shouldClose())
-    {
-        window->pollEvents();
+    auto should_close = [&]() {
+        return isHeadless() ? frame_count >= options.headlessFrames : window->shouldClose();
+    };
 
-        if (keyboard.isKeyPressed(Keyboard::Key::Escape))
-            mouse.setCursorMode(Mouse::CursorMode::Normal);
+    renderer->setLowLatency(options.lowLatency);
 
-        else if (keyboard.isKeyPressed(Keyboard::Key::Enter))
-            mouse.setCursorMode(Mouse::CursorMode::Disabled);
+    if (options.depthPrepass)
+        scene_renderer.setDepthPrepass(true);
 
-        if (keyboard.isKeyPressed(Keyboard::Key::F11) && !window->isFullscreen())
-            window->setFullscreen(true);
+    while (!should_close())
+    {
+        // Input is sampled from here on, in low latency mode as late as the GPU allows
+        renderer->paceFrame();
 
-        const float aspect_ratio = renderer->getAspectRatio();
-        camera.setPerspectiveProjection(Angle::Rad45, aspect_ratio, .01f, 1000.f);
+        if (window)
+            window->pollEvents();
 
-        const float dt = glm::min(delta_timer.getElapsedTimeAsSeconds(), 0.25f);
-        delta_timer.restart();
+#ifdef SVKE_SHADER_HOT_RELOAD
+        // Passed at once, so a system whose stages share a changed include is only recompiled once
+        if (const auto spv_paths = shaderWatcher->pollChanges(); !spv_paths.empty())
+            scene_renderer.reloadShaders(spv_paths);
+#endif
 
-        mouse.updateCursorData();
-        camera_controller.moveInPlaneXZ(dt, viewer);
-        camera.setViewYXZ(viewer.getTranslation(), viewer.getRotation());
+        // Swaps in recompiled pipelines between frames, never while one is being recorded
+        pipelineCompiler->update();
 
-        if (auto command_buffer = renderer->beginFrame())
+        if (keyboard)
         {
-            auto current_frame_index = renderer->getCurrentFrameIndex();
+            if (keyboard->isKeyPressed(Keyboard::Key::Escape))
+                mouse->setCursorMode(Mouse::CursorMode::Normal);
 
-            FrameInfo frame_info{
-                current_frame_index,    dt,     command_buffer, camera, global_descriptor_sets[current_frame_index],
-                object_descriptor_sets, objects};
+            else if (keyboard->isKeyPressed(Keyboard::Key::Enter))
+                mouse->setCursorMode(Mouse::CursorMode::Disabled);
 
-            // Update
-            GlobalUBO ubo = {};
-            ubo.projectionMatrix = camera.getProjectionMatrix();
-            ubo.viewMatrix = camera.getViewMatrix();
-            ubo.inverseViewMatrix = camera.getInverseViewMatrix();
+            if (keyboard->isKeyPressed(Keyboard::Key::F11) && !window->isFullscreen())
+                window->setFullscreen(true);
 
-            point_light_system.update(frame_info, ubo);
+            // Writes the CPU zones of the last frames, only does something in builds with SVKE_PROFILING
+            const bool trace_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F12);
+            if (trace_key_pressed && !trace_key_held)
+                SVKE_PROFILE_DUMP(TRACE_PATH);
+            trace_key_held = trace_key_pressed;
 
-            global_ubo_buffers[current_frame_index]->write((void *)&ubo, sizeof(ubo));
+            const bool stats_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F10);
+            if (stats_key_pressed && !stats_key_held)
+                print_stats();
+            stats_key_held = stats_key_pressed;
 
-            // Render
-            renderer->beginRenderPass(command_buffer);
+            const bool capture_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F9);
+            if (capture_key_pressed && !capture_key_held)
+            {
+                if (renderer->isCapturing())
+                {
+                    renderer->stopCapture();
+                }
+                else
+                {
+                    FrameCapture::Options capture_options = {};
+                    capture_options.directory = CAPTURE_DIRECTORY;
+                    renderer->startCapture(capture_options);
+                }
+            }
+            capture_key_held = capture_key_pressed;
 
-            // Order matters!
-            render_system.render(frame_info);
-            texture_render_system.render(frame_info);
-            point_light_system.render(frame_info);
+            const bool latency_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F8);
+            if (latency_key_pressed && !latency_key_held)
+            {
+                renderer->setLowLatency(!renderer->isLowLatency());
+                std::cout << "Low latency mode " << (renderer->isLowLatency() ? "enabled" : "disabled") << std::endl;
+            }
+            latency_key_held = latency_key_pressed;
+
+            // The fragment invocations printed by F10 before and after show what the pre-pass saves
+            const bool prepass_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F7);
+            if (prepass_key_pressed && !prepass_key_held && scene_renderer.hasOcclusionCulling())
+            {
+                std::cout << "Depth pre-pass is not available with occlusion culling" << std::endl;
+            }
+            else if (prepass_key_pressed && !prepass_key_held)
+            {
+                scene_renderer.setDepthPrepass(!scene_renderer.isDepthPrepass());
+                std::cout << "Depth pre-pass " << (scene_renderer.isDepthPrepass() ? "enabled" : "disabled")
+                          << std::endl;
+            }
+            prepass_key_held = prepass_key_pressed;
+
+            const bool transparency_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F6);
+            if (transparency_key_pressed && !transparency_key_held)
+            {
+                TransparentRenderSystem &transparent_render_system = scene_renderer.getTransparentRenderSystem();
+                const bool sorted = transparent_render_system.getMode() == TransparentRenderSystem::Mode::Sorted;
+                transparent_render_system.setMode(sorted ? TransparentRenderSystem::Mode::WeightedBlended
+                                                         : TransparentRenderSystem::Mode::Sorted);
+                std::cout << "Transparency " << (sorted ? "weighted blended" : "sorted") << std::endl;
+            }
+            transparency_key_held = transparency_key_pressed;
 
-            renderer->endRenderPass(command_buffer);
-            renderer->endFrame();
+            const bool memory_key_pressed = keyboard->isKeyPressed(Keyboard::Key::F5);
+            if (memory_key_pressed && !memory_key_held)
+            {
+                std::ofstream memory_file(MEMORY_PATH);
+                device->getMemoryTracker().writeJson(memory_file, true);
+                std::cout << "Memory statistics written to " << MEMORY_PATH << std::endl;
+            }
+            memory_key_held = memory_key_pressed;
         }
 
-        if (window->shouldClose())
-            std::cout << "Last recorded FPS: " << 1.f / dt << std::endl;
+        const float aspect_ratio = renderer->getAspectRatio();
+        camera.setPerspectiveProjection(Angle::Rad45, aspect_ratio, .01f, 1000.f);
+
+        const float dt = isHeadless() ? HEADLESS_DT : glm::min(delta_timer.getElapsedTimeAsSeconds(), 0.25f);
+        delta_timer.restart();
+
+        if (camera_controller)
+        {
+            mouse->updateCursorData();
+            camera_controller->moveInPlaneXZ(dt, viewer);
+        }
+
+        camera.setViewYXZ(viewer.getTranslation(), viewer.getRotation());
+
+        if (scene_renderer.renderFrame(camera, dt))
+            ++frame_count;
+
+        if (should_close())
+            print_stats();
     }
+
+    // Pipelines no longer wait for the device on destruction
+    vkDeviceWaitIdle(device->getLogicalDevice());
+
+    renderer->stopCapture();
+
+    if (isHeadless())
+        writeHeadlessOutput();
 }
 
 void vk::App::createWindow()
 {
-    window = std::make_unique<Window>(846, 484, "Simple Vulkan Engine");
+    if (isHeadless())
+        return;
+
+    window = std::make_unique<Window>(static_cast<int>(EXTENT.width), static_cast<int>(EXTENT.height),
+                                      "Simple Vulkan Engine");
 }
 
 void vk::App::createDevice()
 {
-    device = std::make_unique<Device>(*window, Device::MSAA::x2);
+    if (isHeadless())
+        device = std::make_unique<Device>(Device::MSAA::x2);
+    else
+        device = std::make_unique<Device>(*window, Device::MSAA::x2);
 }
 
 void vk::App::createRenderer()
 {
-    renderer = std::make_unique<Renderer>(*device, *window, Swapchain::PresentMode::Immediate);
+    if (isHeadless())
+        renderer = std::make_unique<Renderer>(*device, EXTENT, COLOR_BLACK, options.framesInFlight);
+    else
+        renderer = std::make_unique<Renderer>(*device, *window, Swapchain::PresentMode::Immediate, COLOR_BLACK,
+                                              options.framesInFlight);
+}
+
+void vk::App::createPipelineCompiler()
+{
+    pipelineCompiler = std::make_unique<PipelineCompiler>(*device);
+}
+
+void vk::App::createShaderWatcher()
+{
+#ifdef SVKE_SHADER_HOT_RELOAD
+    shaderWatcher = std::make_unique<ShaderWatcher>(SVKE_SHADER_SOURCE_DIR, "assets/shaders", SVKE_SHADER_COMPILER);
+#endif
 }
 
 void vk::App::createGlobalPool()
 {
+    const uint32_t frames_in_flight = static_cast<uint32_t>(renderer->getFramesInFlight());
+
     globalPool = DescriptorPool::Builder(*device)
-                     .setMaxSets(Swapchain::MAX_FRAMES_IN_FLIGHT)
-                     .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, Swapchain::MAX_FRAMES_IN_FLIGHT)
+                     .setMaxSets(frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * frames_in_flight)
+                     .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frames_in_flight)
                      .build();
 }
 
@@ -227,6 +386,19 @@ void vk::App::loadObjects()
         }
     }
 
+    // Untextured with an alpha below 255, so they are drawn by the TransparentRenderSystem in front of the cubes
+    std::vector<Color> pane_colors{Color(255, 64, 64, 96), Color(64, 255, 64, 128), Color(64, 64, 255, 160)};
+
+    for (int i = 0; i < pane_colors.size(); i++)
+    {
+        Object pane;
+        pane.setModel(cube_model);
+        pane.setColor(pane_colors[i]);
+        pane.setScale({.3f, .3f, .02f});
+        pane.setTranslation({.8f + .5f * i, 1.2f, .1f - .15f * i});
+        objects[pane.getId()] = std::move(pane);
+    }
+
     std::vector<Color> light_colors{COLOR_RED,  COLOR_ORANGE, COLOR_YELLOW, COLOR_GREEN,
                                     COLOR_CYAN, COLOR_BLUE,   COLOR_PURPLE};
 
@@ -242,4 +414,68 @@ void vk::App::loadObjects()
         point_light.setTranslation(Vec3f(rotate_light * Vec4f(-1.5f, -1.f, -1.5f, 1.f)));
         objects[point_light.getId()] = std::move(point_light);
     }
+
+    if (options.stressLights > 0)
+        loadStressLights();
+}
+
+void vk::App::loadStressLights()
+{
+    std::shared_ptr<Model> floor_model = std::make_shared<Model>(*device);
+    if (!floor_model->loadFromFile("assets/models/cube_tex.obj"))
+        throw std::runtime_error("vl::App::loadStressLights: Failed to load Floor model");
+
+    Object floor;
+    floor.setModel(floor_model);
+    floor.setColor(COLOR_WHITE);
+    floor.setScale({20.f, .02f, 20.f});
+    floor.setTranslation({0.f, 2.5f, 0.f});
+    objects[floor.getId()] = std::move(floor);
+
+    // Fixed seed, so runs can be compared
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(-10.f, 10.f);
+    std::uniform_real_distribution<float> height(-1.f, 2.f);
+    std::uniform_int_distribution<int> channel(64, 255);
+
+    for (uint32_t i = 0; i < options.stressLights; ++i)
+    {
+        Object point_light = Object::makePointLight(.02f, .02f);
+
+        point_light.setColor(Color(static_cast<uint8_t>(channel(random)), static_cast<uint8_t>(channel(random)),
+                                   static_cast<uint8_t>(channel(random))));
+        point_light.setTranslation({position(random), height(random), position(random)});
+        objects[point_light.getId()] = std::move(point_light);
+    }
+
+#ifndef NDEBUG
+    std::cout << "LOADED " << options.stressLights << " STRESS LIGHTS" << std::endl;
+#endif
+}
+
+void vk::App::writeHeadlessOutput()
+{
+    std::vector<uint8_t> pixels;
+    if (!renderer->getOffscreenTarget()->readPixels(pixels))
+    {
+        std::cerr << "No headless frame was rendered" << std::endl;
+        return;
+    }
+
+    std::ofstream file(options.headlessOutput, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("vk::App::writeHeadlessOutput: FAILED TO OPEN " + options.headlessOutput);
+
+    const VkExtent2D extent = renderer->getExtent();
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+    for (size_t i = 0; i < pixels.size(); i += OffscreenTarget::BYTES_PER_PIXEL)
+        file.write(reinterpret_cast<const char *>(&pixels[i]), 3);
+
+    std::cout << "Wrote frame " << options.headlessFrames << " to " << options.headlessOutput << std::endl;
+}
+
+const bool vk::App::isHeadless() const
+{
+    return options.headlessFrames > 0;
 }
@@ -0,0 +1,43 @@
+#include "SVKE/Core/Graphics/ComputePipeline.hpp"
+
+vk::ComputePipeline::ComputePipeline(Device &device, Shader &comp_shader, VkPipelineLayout pipeline_layout,
+                                     VkPipelineCache pipeline_cache)
+    : device(device), computePipeline(VK_NULL_HANDLE)
+{
+    createComputePipeline(comp_shader, pipeline_layout, pipeline_cache);
+}
+
+vk::ComputePipeline::~ComputePipeline()
+{
+    // Owners are responsible for the GPU no longer using the pipeline
+    vkDestroyPipeline(device.getLogicalDevice(), computePipeline, nullptr);
+}
+
+void vk::ComputePipeline::bind(VkCommandBuffer &command_buffer)
+{
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    FrameStats::countPipelineBind();
+}
+
+void vk::ComputePipeline::createComputePipeline(Shader &comp_shader, VkPipelineLayout pipeline_layout,
+                                                VkPipelineCache pipeline_cache)
+{
+    assert(pipeline_layout != VK_NULL_HANDLE && "PIPELINE LAYOUT WAS NOT PROVIDED OR IS A VK_NULL_HANDLE");
+
+    VkPipelineShaderStageCreateInfo shader_stage = {};
+    shader_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shader_stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shader_stage.module = comp_shader.getModule();
+    shader_stage.pName = "main";
+
+    VkComputePipelineCreateInfo pipeline_info = {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage = shader_stage;
+    pipeline_info.layout = pipeline_layout;
+    pipeline_info.basePipelineIndex = -1;
+    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateComputePipelines(device.getLogicalDevice(), pipeline_cache, 1, &pipeline_info, nullptr,
+                                 &computePipeline) != VK_SUCCESS)
+        throw std::runtime_error("vk::ComputePipeline::createComputePipeline: FAILED TO CREATE COMPUTE PIPELINE");
+}
@@ -33,15 +33,21 @@ vk::Pipeline::Pipeline(Device &device, Shader &vert_shader, Shader &frag_shader,
     createGraphicsPipeline(config, vert_shader, frag_shader);
 }
 
+vk::Pipeline::Pipeline(Device &device, VkPipeline pipeline) : device(device), graphicsPipeline(pipeline)
+{
+    assert(pipeline != VK_NULL_HANDLE && "CANNOT ADOPT A VK_NULL_HANDLE PIPELINE");
+}
+
 vk::Pipeline::~Pipeline()
 {
-    vkDeviceWaitIdle(device.getLogicalDevice());
+    // Owners are responsible for the GPU no longer using the pipeline (see PipelineCompiler::update)
     vkDestroyPipeline(device.getLogicalDevice(), graphicsPipeline, nullptr);
 }
 
 void vk::Pipeline::bind(VkCommandBuffer &command_buffer)
 {
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    FrameStats::countPipelineBind();
 }
 
 void vk::Pipeline::defaultPipelineConfig(Config &config)
@@ -140,58 +146,167 @@ void vk::Pipeline::enableAlphaBlending(Config &config)
     config.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 }
 
-void vk::Pipeline::createGraphicsPipeline(const Config &config, Shader &vert_shader, Shader &frag_shader)
+void vk::Pipeline::setSpecializationConstant(Specialization &specialization, const uint32_t constant_id,
+                                             const uint32_t value)
+{
+    for (const auto &map_entry : specialization.mapEntries)
+    {
+        if (map_entry.constantID == constant_id)
+        {
+            specialization.data[map_entry.offset / sizeof(uint32_t)] = value;
+            return;
+        }
+    }
+
+    VkSpecializationMapEntry map_entry = {};
+    map_entry.constantID = constant_id;
+    map_entry.offset = static_cast<uint32_t>(specialization.data.size() * sizeof(uint32_t));
+    map_entry.size = sizeof(uint32_t);
+
+    specialization.mapEntries.push_back(map_entry);
+    specialization.data.push_back(value);
+}
+
+void vk::Pipeline::copyConfig(const Config &source, Config &destination)
+{
+    destination.attributeDescriptions = source.attributeDescriptions;
+    destination.bindingDescriptions = source.bindingDescriptions;
+    destination.viewportInfo = source.viewportInfo;
+    destination.inputAssemblyInfo = source.inputAssemblyInfo;
+    destination.rasterizationInfo = source.rasterizationInfo;
+    destination.multisampleInfo = source.multisampleInfo;
+    destination.colorBlendAttachment = source.colorBlendAttachment;
+    destination.colorBlendInfo = source.colorBlendInfo;
+    destination.depthStencilInfo = source.depthStencilInfo;
+    destination.dynamicStatesEnable = source.dynamicStatesEnable;
+    destination.dynamicStateInfo = source.dynamicStateInfo;
+    destination.pipelineLayout = source.pipelineLayout;
+    destination.colorAttachmentFormat = source.colorAttachmentFormat;
+    destination.depthAttachmentFormat = source.depthAttachmentFormat;
+    destination.extraColorAttachmentFormats = source.extraColorAttachmentFormats;
+    destination.extraColorBlendAttachments = source.extraColorBlendAttachments;
+    destination.viewMask = source.viewMask;
+    destination.vertSpecialization = source.vertSpecialization;
+    destination.fragSpecialization = source.fragSpecialization;
+
+    // Re-point the members that reference storage inside the config itself
+    if (source.colorBlendInfo.pAttachments == &source.colorBlendAttachment)
+        destination.colorBlendInfo.pAttachments = &destination.colorBlendAttachment;
+
+    destination.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(destination.dynamicStatesEnable.size());
+    destination.dynamicStateInfo.pDynamicStates = destination.dynamicStatesEnable.data();
+}
+
+void vk::Pipeline::populateCreateInfo(const Config &config, VkShaderModule vert_module, VkShaderModule frag_module,
+                                      CreateInfo &create_info)
 {
     assert(config.pipelineLayout != VK_NULL_HANDLE && "PIPELINE LAYOUT WAS NOT PROVIDED OR IS A VK_NULL_HANDLE");
-    assert(config.renderPass != VK_NULL_HANDLE && "PIPELINE RENDER PASS WAS NOT PROVIDED OR IS A VK_NULL_HANDLE");
+    assert((config.colorAttachmentFormat != VK_FORMAT_UNDEFINED ||
+            config.depthAttachmentFormat != VK_FORMAT_UNDEFINED) &&
+           "PIPELINE ATTACHMENT FORMATS WERE NOT PROVIDED");
+
+    auto populate_specialization_info = [](const Specialization &specialization, VkSpecializationInfo &info) {
+        info = {};
+        info.mapEntryCount = static_cast<uint32_t>(specialization.mapEntries.size());
+        info.pMapEntries = specialization.mapEntries.data();
+        info.dataSize = specialization.data.size() * sizeof(uint32_t);
+        info.pData = specialization.data.data();
+
+        return specialization.mapEntries.empty() ? nullptr : &info;
+    };
 
-    VkPipelineShaderStageCreateInfo shader_stages[2];
+    auto &specialization_infos = create_info.specializationInfos;
+    auto &shader_stages = create_info.shaderStages;
     shader_stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    shader_stages[0].module = vert_shader.getModule();
+    shader_stages[0].module = vert_module;
     shader_stages[0].pName = "main";
     shader_stages[0].flags = 0;
     shader_stages[0].pNext = nullptr;
-    shader_stages[0].pSpecializationInfo = nullptr;
+    shader_stages[0].pSpecializationInfo =
+        populate_specialization_info(config.vertSpecialization, specialization_infos[0]);
 
     shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    shader_stages[1].module = frag_shader.getModule();
+    shader_stages[1].module = frag_module;
     shader_stages[1].pName = "main";
     shader_stages[1].flags = 0;
     shader_stages[1].pNext = nullptr;
-    shader_stages[1].pSpecializationInfo = nullptr;
+    shader_stages[1].pSpecializationInfo =
+        populate_specialization_info(config.fragSpecialization, specialization_infos[1]);
 
-    VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
+    auto &vertex_input_info = create_info.vertexInputInfo;
     auto &attribute_descriptions = config.attributeDescriptions;
     auto &binding_descriptions = config.bindingDescriptions;
+    vertex_input_info = {};
     vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
     vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size());
     vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data();
     vertex_input_info.pVertexBindingDescriptions = binding_descriptions.data();
 
-    VkGraphicsPipelineCreateInfo pipeline_info = {};
+    assert(config.extraColorAttachmentFormats.size() == config.extraColorBlendAttachments.size() &&
+           "EVERY EXTRA COLOR ATTACHMENT NEEDS A BLEND STATE");
+    assert((config.extraColorAttachmentFormats.empty() || config.colorAttachmentFormat != VK_FORMAT_UNDEFINED) &&
+           "EXTRA COLOR ATTACHMENTS NEED A FIRST ONE");
+
+    // The first color attachment is described by the config's own members, the extra ones follow it
+    auto &color_formats = create_info.colorAttachmentFormats;
+    color_formats.clear();
+    if (config.colorAttachmentFormat != VK_FORMAT_UNDEFINED)
+        color_formats.push_back(config.colorAttachmentFormat);
+    color_formats.insert(color_formats.end(), config.extraColorAttachmentFormats.begin(),
+                         config.extraColorAttachmentFormats.end());
+
+    auto &color_blend_attachments = create_info.colorBlendAttachments;
+    color_blend_attachments.assign(config.colorBlendInfo.pAttachments,
+                                   config.colorBlendInfo.pAttachments + config.colorBlendInfo.attachmentCount);
+    color_blend_attachments.insert(color_blend_attachments.end(), config.extraColorBlendAttachments.begin(),
+                                   config.extraColorBlendAttachments.end());
+
+    auto &color_blend_info = create_info.colorBlendInfo;
+    color_blend_info = config.colorBlendInfo;
+    color_blend_info.attachmentCount = static_cast<uint32_t>(color_blend_attachments.size());
+    color_blend_info.pAttachments = color_blend_attachments.data();
+
+    // Takes the place of a render pass, the stencil aspect of a depth format is never attached
+    auto &rendering_info = create_info.renderingInfo;
+    rendering_info = {};
+    rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    rendering_info.viewMask = config.viewMask;
+    rendering_info.colorAttachmentCount = static_cast<uint32_t>(color_formats.size());
+    rendering_info.pColorAttachmentFormats = color_formats.data();
+    rendering_info.depthAttachmentFormat = config.depthAttachmentFormat;
+    rendering_info.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+    auto &pipeline_info = create_info.pipelineInfo;
+    pipeline_info = {};
     pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipeline_info.stageCount = 2;
-    pipeline_info.pStages = shader_stages;
+    pipeline_info.pNext = &rendering_info;
+    pipeline_info.stageCount = frag_module != VK_NULL_HANDLE ? 2 : 1;
+    pipeline_info.pStages = shader_stages.data();
     pipeline_info.pVertexInputState = &vertex_input_info;
     pipeline_info.pInputAssemblyState = &config.inputAssemblyInfo;
     pipeline_info.pViewportState = &config.viewportInfo;
     pipeline_info.pRasterizationState = &config.rasterizationInfo;
     pipeline_info.pMultisampleState = &config.multisampleInfo;
-    pipeline_info.pColorBlendState = &config.colorBlendInfo;
+    pipeline_info.pColorBlendState = &color_blend_info;
     pipeline_info.pDepthStencilState = &config.depthStencilInfo;
     pipeline_info.pDynamicState = &config.dynamicStateInfo;
 
     pipeline_info.layout = config.pipelineLayout;
-    pipeline_info.renderPass = config.renderPass;
-    pipeline_info.subpass = config.subpass;
+    pipeline_info.renderPass = VK_NULL_HANDLE;
 
     pipeline_info.basePipelineIndex = -1;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+}
+
+void vk::Pipeline::createGraphicsPipeline(const Config &config, Shader &vert_shader, Shader &frag_shader)
+{
+    CreateInfo create_info;
+    populateCreateInfo(config, vert_shader.getModule(), frag_shader.getModule(), create_info);
 
-    if (vkCreateGraphicsPipelines(device.getLogicalDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
+    if (vkCreateGraphicsPipelines(device.getLogicalDevice(), VK_NULL_HANDLE, 1, &create_info.pipelineInfo, nullptr,
                                   &graphicsPipeline) != VK_SUCCESS)
-        throw std::runtime_error("vk::Pipeline::defaultPipelineConfig: FAILED TO CREATE GRAPHICS PIPELINE");
+        throw std::runtime_error("vk::Pipeline::createGraphicsPipeline: FAILED TO CREATE GRAPHICS PIPELINE");
 }
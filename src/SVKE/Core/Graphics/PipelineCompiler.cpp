@@ -0,0 +1,311 @@
+#include "SVKE/Core/Graphics/PipelineCompiler.hpp"
+
+#include <algorithm>
+
+vk::PipelineCompiler::Handle::Handle(std::shared_ptr<Handle> fallback)
+    : state(State::Pending), fallback(std::move(fallback))
+{
+}
+
+const bool vk::PipelineCompiler::Handle::bind(VkCommandBuffer &command_buffer)
+{
+    if (state.load(std::memory_order_acquire) == State::Ready)
+    {
+        pipeline->bind(command_buffer);
+        return true;
+    }
+
+    if (fallback)
+        return fallback->bind(command_buffer);
+
+    return false;
+}
+
+const bool vk::PipelineCompiler::Handle::isReady() const
+{
+    return state.load(std::memory_order_acquire) == State::Ready;
+}
+
+const vk::PipelineCompiler::Handle::State vk::PipelineCompiler::Handle::getState() const
+{
+    return state.load(std::memory_order_acquire);
+}
+
+void vk::PipelineCompiler::Handle::wait() const
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return state.load(std::memory_order_acquire) != State::Pending; });
+    }
+
+    if (replacement)
+        replacement->wait();
+}
+
+void vk::PipelineCompiler::Handle::resolve(std::unique_ptr<Pipeline> compiled)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        pipeline = std::move(compiled);
+        state.store(pipeline ? State::Ready : State::Failed, std::memory_order_release);
+    }
+
+    condition.notify_all();
+}
+
+vk::PipelineCompiler::PipelineCompiler(Device &device, const uint32_t worker_count, const uint32_t max_batch_size)
+    : device(device), pipelineCache(VK_NULL_HANDLE), maxBatchSize(std::max(max_batch_size, 1u)), busyWorkers(0),
+      stopping(false)
+{
+    createPipelineCache();
+    startWorkers(worker_count);
+}
+
+vk::PipelineCompiler::~PipelineCompiler()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+
+    workCondition.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+
+    vkDestroyPipelineCache(device.getLogicalDevice(), pipelineCache, nullptr);
+}
+
+std::shared_ptr<vk::PipelineCompiler::Handle> vk::PipelineCompiler::compile(Shader &vert_shader, Shader &frag_shader,
+                                                                            const Pipeline::Config &config,
+                                                                            std::shared_ptr<Handle> fallback)
+{
+    return enqueue(vert_shader, &frag_shader, config, std::move(fallback));
+}
+
+std::shared_ptr<vk::PipelineCompiler::Handle> vk::PipelineCompiler::compile(Shader &vert_shader,
+                                                                            const Pipeline::Config &config,
+                                                                            std::shared_ptr<Handle> fallback)
+{
+    return enqueue(vert_shader, nullptr, config, std::move(fallback));
+}
+
+void vk::PipelineCompiler::recompile(const std::shared_ptr<Handle> &handle, Shader &vert_shader, Shader &frag_shader,
+                                     const Pipeline::Config &config)
+{
+    replace(handle, vert_shader, &frag_shader, config);
+}
+
+void vk::PipelineCompiler::recompile(const std::shared_ptr<Handle> &handle, Shader &vert_shader,
+                                     const Pipeline::Config &config)
+{
+    replace(handle, vert_shader, nullptr, config);
+}
+
+void vk::PipelineCompiler::update()
+{
+    SVKE_PROFILE_SCOPE("PipelineCompiler::update");
+
+    for (auto it = recompiling.begin(); it != recompiling.end();)
+    {
+        auto &handle = *it;
+        const auto replacement_state = handle->replacement->getState();
+
+        if (replacement_state == Handle::State::Pending)
+        {
+            ++it;
+            continue;
+        }
+
+        if (replacement_state == Handle::State::Ready)
+        {
+            std::lock_guard<std::mutex> lock(handle->mutex);
+
+            // Frames recorded before the swap may still be executing with the old pipeline
+            if (handle->pipeline)
+                device.getGraphicsTimeline().defer(
+                    [retired = std::shared_ptr<Pipeline>(std::move(handle->pipeline))] {});
+
+            handle->pipeline = std::move(handle->replacement->pipeline);
+            handle->state.store(Handle::State::Ready, std::memory_order_release);
+
+#ifndef NDEBUG
+            std::cout << "SWAPPED RECOMPILED PIPELINE" << std::endl;
+#endif
+        }
+        else
+        {
+            std::cerr << "vk::PipelineCompiler::update: RECOMPILATION FAILED, KEEPING THE PREVIOUS PIPELINE"
+                      << std::endl;
+        }
+
+        handle->replacement = nullptr;
+        it = recompiling.erase(it);
+    }
+
+    if (retiredShaders.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    // Modules are only read while pipelines are created, the pipelines themselves do not need them
+    if (queue.empty() && busyWorkers == 0)
+        retiredShaders.clear();
+}
+
+void vk::PipelineCompiler::retire(std::unique_ptr<Shader> shader)
+{
+    if (shader)
+        retiredShaders.push_back(std::move(shader));
+}
+
+void vk::PipelineCompiler::replace(const std::shared_ptr<Handle> &handle, Shader &vert_shader, Shader *frag_shader,
+                                   const Pipeline::Config &config)
+{
+    assert(handle && "CANNOT RECOMPILE A NULL PIPELINE HANDLE");
+
+    // A superseded replacement is dropped without waiting for it, the worker compiling it still owns it
+    if (!handle->replacement)
+        recompiling.push_back(handle);
+
+    handle->replacement = enqueue(vert_shader, frag_shader, config, nullptr);
+}
+
+std::shared_ptr<vk::PipelineCompiler::Handle> vk::PipelineCompiler::enqueue(Shader &vert_shader, Shader *frag_shader,
+                                                                            const Pipeline::Config &config,
+                                                                            std::shared_ptr<Handle> fallback)
+{
+    auto request = std::make_unique<Request>();
+    request->handle = std::make_shared<Handle>(std::move(fallback));
+    request->vertModule = vert_shader.getModule();
+
+    // Vertex only pipelines, e.g. depth only passes, have no fragment stage
+    request->fragModule = frag_shader ? frag_shader->getModule() : VK_NULL_HANDLE;
+
+    Pipeline::copyConfig(config, request->config);
+    Pipeline::populateCreateInfo(request->config, request->vertModule, request->fragModule, request->createInfo);
+
+    auto handle = request->handle;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(request));
+    }
+
+    workCondition.notify_one();
+
+    return handle;
+}
+
+void vk::PipelineCompiler::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+    idleCondition.wait(lock, [this] { return queue.empty() && busyWorkers == 0; });
+}
+
+VkPipelineCache vk::PipelineCompiler::getPipelineCache()
+{
+    return pipelineCache;
+}
+
+void vk::PipelineCompiler::createPipelineCache()
+{
+    VkPipelineCacheCreateInfo cache_info = {};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = 0;
+    cache_info.pInitialData = nullptr;
+
+    if (vkCreatePipelineCache(device.getLogicalDevice(), &cache_info, nullptr, &pipelineCache) != VK_SUCCESS)
+        throw std::runtime_error("vk::PipelineCompiler::createPipelineCache: FAILED TO CREATE PIPELINE CACHE");
+}
+
+void vk::PipelineCompiler::startWorkers(const uint32_t worker_count)
+{
+    uint32_t count = worker_count;
+
+    if (count == 0)
+        count = std::max(std::thread::hardware_concurrency() / 2, 1u);
+
+    workers.reserve(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+        workers.emplace_back(&PipelineCompiler::workerLoop, this);
+
+#ifndef NDEBUG
+    std::cout << "PIPELINE COMPILER STARTED WITH " << count << " WORKER(S)" << std::endl;
+#endif
+}
+
+void vk::PipelineCompiler::workerLoop()
+{
+    SVKE_PROFILE_THREAD("Pipeline compiler");
+
+    std::vector<std::unique_ptr<Request>> batch;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            workCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (stopping && queue.empty())
+                return;
+
+            // Split the backlog evenly so every worker gets a batch instead of the first one taking everything
+            const size_t share = (queue.size() + workers.size() - 1) / workers.size();
+            const size_t batch_size = std::min<size_t>(std::max<size_t>(share, 1), maxBatchSize);
+
+            for (size_t i = 0; i < batch_size; ++i)
+            {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+
+            ++busyWorkers;
+        }
+
+        compileBatch(batch);
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            --busyWorkers;
+        }
+
+        idleCondition.notify_all();
+    }
+}
+
+void vk::PipelineCompiler::compileBatch(std::vector<std::unique_ptr<Request>> &batch)
+{
+    SVKE_PROFILE_SCOPE("PipelineCompiler::compileBatch");
+
+    std::vector<VkGraphicsPipelineCreateInfo> create_infos;
+    std::vector<VkPipeline> pipelines(batch.size(), VK_NULL_HANDLE);
+
+    create_infos.reserve(batch.size());
+
+    for (auto &request : batch)
+        create_infos.push_back(request->createInfo.pipelineInfo);
+
+    // On failure the implementation leaves the failed entries as VK_NULL_HANDLE, the others are still valid.
+    VkResult result =
+        vkCreateGraphicsPipelines(device.getLogicalDevice(), pipelineCache, static_cast<uint32_t>(create_infos.size()),
+                                  create_infos.data(), nullptr, pipelines.data());
+
+    if (result != VK_SUCCESS)
+        std::cerr << "vk::PipelineCompiler::compileBatch: FAILED TO CREATE ONE OR MORE GRAPHICS PIPELINES" << std::endl;
+
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        if (pipelines[i] != VK_NULL_HANDLE)
+            batch[i]->handle->resolve(std::make_unique<Pipeline>(device, pipelines[i]));
+        else
+            batch[i]->handle->resolve(nullptr);
+    }
+
+#ifndef NDEBUG
+    std::cout << "COMPILED " << batch.size() << " PIPELINE(S) IN ONE BATCH" << std::endl;
+#endif
+}
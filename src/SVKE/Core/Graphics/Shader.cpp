@@ -1,5 +1,7 @@
 #include "SVKE/Core/Graphics/Shader.hpp"
 
+#include <algorithm>
+
 vk::Shader::Shader(Device &device, const std::string &path) : device(device)
 {
     SPIRVBinary spirv_bin = readShaderFile(path);
@@ -23,6 +25,14 @@ VkShaderModule &vk::Shader::getModule()
     return module;
 }
 
+const bool vk::Shader::isAnyChanged(const std::vector<std::string> &changed_paths,
+                                    const std::vector<std::string> &paths)
+{
+    return std::any_of(paths.begin(), paths.end(), [&](const std::string &path) {
+        return std::find(changed_paths.begin(), changed_paths.end(), path) != changed_paths.end();
+    });
+}
+
 vk::Shader::SPIRVBinary vk::Shader::readShaderFile(const std::string &path)
 {
     std::ifstream file(path, std::ios::ate | std::ios::binary);
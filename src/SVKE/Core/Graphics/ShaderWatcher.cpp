@@ -0,0 +1,298 @@
+#include "SVKE/Core/Graphics/ShaderWatcher.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+vk::ShaderWatcher::ShaderWatcher(const std::string &source_dir, const std::string &output_dir,
+                                 const std::string &compiler)
+    : sourceDir(source_dir), outputDir(output_dir), compiler(compiler), inotifyFd(-1), watchDescriptor(-1),
+      running(false)
+{
+    startWatching();
+}
+
+vk::ShaderWatcher::~ShaderWatcher()
+{
+    running = false;
+
+    if (thread.joinable())
+        thread.join();
+
+#ifdef __linux__
+    if (watchDescriptor >= 0)
+        inotify_rm_watch(inotifyFd, watchDescriptor);
+
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+#endif
+}
+
+std::vector<std::string> vk::ShaderWatcher::pollChanges()
+{
+    std::lock_guard<std::mutex> lock(changesMutex);
+
+    std::vector<std::string> recompiled;
+    recompiled.swap(changes);
+
+    return recompiled;
+}
+
+const bool vk::ShaderWatcher::isWatching() const
+{
+    return running;
+}
+
+void vk::ShaderWatcher::startWatching()
+{
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotifyFd < 0)
+    {
+        std::cerr << "vk::ShaderWatcher::startWatching: FAILED TO INITIALIZE INOTIFY" << std::endl;
+        return;
+    }
+
+    // Editors either write in place or write a temporary file and rename it over the original
+    watchDescriptor = inotify_add_watch(inotifyFd, sourceDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (watchDescriptor < 0)
+    {
+        std::cerr << "vk::ShaderWatcher::startWatching: FAILED TO WATCH DIRECTORY " << sourceDir << std::endl;
+        return;
+    }
+
+    running = true;
+    thread = std::thread(&ShaderWatcher::watchLoop, this);
+
+#ifndef NDEBUG
+    std::cout << "WATCHING SHADERS IN " << sourceDir << std::endl;
+#endif
+#else
+    std::cerr << "vk::ShaderWatcher::startWatching: SHADER HOT-RELOAD IS ONLY SUPPORTED ON LINUX" << std::endl;
+#endif
+}
+
+void vk::ShaderWatcher::watchLoop()
+{
+#ifdef __linux__
+    SVKE_PROFILE_THREAD("Shader watcher");
+
+    pollfd poll_fd = {};
+    poll_fd.fd = inotifyFd;
+    poll_fd.events = POLLIN;
+
+    while (running)
+    {
+        // Time out regularly so the destructor does not have to wait for a file event
+        if (poll(&poll_fd, 1, 200) <= 0)
+            continue;
+
+        std::set<std::string> changed_files;
+        readEvents(changed_files);
+
+        // A single save often produces several events, give the editor a moment to finish
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        readEvents(changed_files);
+
+        SVKE_PROFILE_SCOPE("ShaderWatcher::compileChanged");
+        compileChanged(changed_files);
+    }
+#endif
+}
+
+void vk::ShaderWatcher::readEvents(std::set<std::string> &changed_files)
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+
+        if (length <= 0)
+            return;
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+
+            if (event->len > 0)
+                changed_files.insert(event->name);
+
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+}
+
+void vk::ShaderWatcher::compileChanged(const std::set<std::string> &changed_files)
+{
+    std::set<std::string> to_compile;
+
+    for (const auto &file_name : changed_files)
+    {
+        if (isShaderStage(file_name))
+        {
+            to_compile.insert(file_name);
+        }
+        else if (isShaderInclude(file_name))
+        {
+            // Dependencies are not tracked, so an include change rebuilds every stage in the directory. Nothing on
+            // this thread may throw, a failure only leaves the stages that were not listed yet out.
+            std::error_code error;
+
+            for (auto it = std::filesystem::directory_iterator(sourceDir, error);
+                 !error && it != std::filesystem::directory_iterator(); it.increment(error))
+            {
+                const std::string name = it->path().filename().string();
+
+                if (isShaderStage(name))
+                    to_compile.insert(name);
+            }
+
+            if (error)
+                std::cerr << "vk::ShaderWatcher::compileChanged: FAILED TO LIST " << sourceDir << ": "
+                          << error.message() << std::endl;
+        }
+    }
+
+    std::vector<std::string> recompiled;
+
+    for (const auto &file_name : to_compile)
+    {
+        if (compileShader(file_name))
+            recompiled.push_back(outputDir + "/" + file_name + ".spv");
+    }
+
+    if (recompiled.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(changesMutex);
+    changes.insert(changes.end(), recompiled.begin(), recompiled.end());
+}
+
+const bool vk::ShaderWatcher::compileShader(const std::string &file_name)
+{
+#ifdef __linux__
+    const std::string source_path = sourceDir + "/" + file_name;
+    const std::string output_path = outputDir + "/" + file_name + ".spv";
+    const std::string temp_path = output_path + ".tmp";
+
+    const std::string include_dir = "-I" + sourceDir;
+    const std::string output_flag = "-o";
+
+    // Built before forking: the child of a multithreaded process must not allocate before exec. File names come
+    // from inotify, so they are passed as arguments and never go through a shell.
+    std::vector<char *> arguments = {const_cast<char *>(compiler.c_str()), const_cast<char *>(include_dir.c_str()),
+                                     const_cast<char *>(source_path.c_str()), const_cast<char *>(output_flag.c_str()),
+                                     const_cast<char *>(temp_path.c_str()), nullptr};
+
+    int output_pipe[2];
+
+    if (pipe2(output_pipe, O_CLOEXEC) != 0)
+    {
+        std::cerr << "vk::ShaderWatcher::compileShader: FAILED TO CREATE PIPE" << std::endl;
+        return false;
+    }
+
+    const pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        close(output_pipe[0]);
+        close(output_pipe[1]);
+
+        std::cerr << "vk::ShaderWatcher::compileShader: FAILED TO RUN " << compiler << std::endl;
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // The compiler's diagnostics go to the parent, which prints them if compiling fails
+        dup2(output_pipe[1], STDOUT_FILENO);
+        dup2(output_pipe[1], STDERR_FILENO);
+
+        execvp(arguments[0], arguments.data());
+        _exit(127);
+    }
+
+    close(output_pipe[1]);
+
+    std::string output;
+    char buffer[512];
+    ssize_t length;
+
+    while ((length = read(output_pipe[0], buffer, sizeof(buffer))) != 0)
+    {
+        if (length < 0 && errno == EINTR)
+            continue;
+
+        if (length < 0)
+            break;
+
+        output.append(buffer, static_cast<size_t>(length));
+    }
+
+    close(output_pipe[0]);
+
+    int status = 0;
+
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        ;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "vk::ShaderWatcher::compileShader: FAILED TO COMPILE " << file_name << ", KEEPING PREVIOUS BINARY"
+                  << std::endl
+                  << output;
+
+        std::error_code error;
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    // Replace atomically so a loader never sees a partially written binary
+    std::error_code error;
+    std::filesystem::rename(temp_path, output_path, error);
+
+    if (error)
+    {
+        std::cerr << "vk::ShaderWatcher::compileShader: FAILED TO REPLACE " << output_path << ", KEEPING PREVIOUS "
+                  << "BINARY: " << error.message() << std::endl;
+
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+#ifndef NDEBUG
+    std::cout << "RECOMPILED SHADER " << source_path << std::endl;
+#endif
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+const bool vk::ShaderWatcher::isShaderStage(const std::string &file_name)
+{
+    const auto extension = std::filesystem::path(file_name).extension();
+
+    return extension == ".vert" || extension == ".frag" || extension == ".comp";
+}
+
+const bool vk::ShaderWatcher::isShaderInclude(const std::string &file_name)
+{
+    return std::filesystem::path(file_name).extension() == ".glsl";
+}
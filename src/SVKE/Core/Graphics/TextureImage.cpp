@@ -3,15 +3,14 @@
 vk::TextureImage::TextureImage(Device &device, Texture &texture) : device(device), format(VK_FORMAT_R8G8B8A8_SRGB)
 {
     createImage(texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
-    transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
     copyTextureToImage(texture);
-    transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     createImageView();
 }
 
 vk::TextureImage::~TextureImage()
 {
     vkDestroyImageView(device.getLogicalDevice(), imageView, nullptr);
+    device.getMemoryTracker().untrack(allocation);
     vmaDestroyImage(device.getAllocator(), image, allocation);
 }
 
@@ -60,16 +59,31 @@ void vk::TextureImage::createImage(Texture &texture, const VkImageTiling tiling,
 
     if (result != VK_SUCCESS)
         throw std::runtime_error("vk::TextureImage::Image: FAILED TO CREATE IMAGE");
+
+    device.getMemoryTracker().track(allocation, MemoryTracker::Category::Texture);
 }
 
-void vk::TextureImage::transitionImageLayout(const VkImageLayout old_layout, const VkImageLayout new_layout)
+void vk::TextureImage::copyTextureToImage(Texture &texture)
 {
-    auto command_buffer = device.beginSingleTimeCommands();
+    Buffer staging_buffer(device, texture.getSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                          VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                              VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
 
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = old_layout;
-    barrier.newLayout = new_layout;
+    staging_buffer.map();
+    staging_buffer.write((void *)texture.getPixels(), texture.getSize());
+    staging_buffer.unmap();
+
+    // Recorded for the transfer queue, the whole image is written so its previous contents are discarded
+    auto command_buffer = device.beginUploadCommands("Texture upload");
+
+    VkImageMemoryBarrier2 barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image;
@@ -78,50 +92,13 @@ void vk::TextureImage::transitionImageLayout(const VkImageLayout old_layout, con
     barrier.subresourceRange.levelCount = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = 0; // TODO
-    barrier.dstAccessMask = 0; // TODO
-
-    VkPipelineStageFlags source_stage;
-    VkPipelineStageFlags destination_stage;
-
-    if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-             new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else
-    {
-        throw std::invalid_argument("vk::TextureImage::transitionImageLayout: UNSUPPORTED LAYOUT TRANSITION");
-    }
-
-    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    device.endSingleTimeCommands(command_buffer);
-}
 
-void vk::TextureImage::copyTextureToImage(Texture &texture)
-{
-    Buffer staging_buffer(device, texture.getSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
-                          VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
-                              VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+    VkDependencyInfo dependency_info = {};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.imageMemoryBarrierCount = 1;
+    dependency_info.pImageMemoryBarriers = &barrier;
 
-    staging_buffer.map();
-    staging_buffer.write((void *)texture.getPixels(), texture.getSize());
-    staging_buffer.unmap();
-
-    auto command_buffer = device.beginSingleTimeCommands();
+    vkCmdPipelineBarrier2(command_buffer, &dependency_info);
 
     VkBufferImageCopy region{};
     region.bufferOffset = 0;
@@ -139,7 +116,16 @@ void vk::TextureImage::copyTextureToImage(Texture &texture)
     vkCmdCopyBufferToImage(command_buffer, staging_buffer.getBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
                            &region);
 
-    device.endSingleTimeCommands(command_buffer);
+    // Handed over to the graphics queue, in the layout it is sampled in
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // The staging buffer is released on the graphics timeline, after the upload
+    device.endUploadCommands(command_buffer, {}, {barrier});
 }
 
 void vk::TextureImage::createImageView()
@@ -0,0 +1,137 @@
+#include "SVKE/Core/System/CommandBufferManager.hpp"
+
+#include <cassert>
+
+vk::CommandBufferManager::CommandBufferManager(Device &device, const uint32_t queue_family, Timeline &timeline,
+                                               const int frames_in_flight)
+    : device(device), queueFamily(queue_family), timeline(timeline), framesInFlight(frames_in_flight),
+      currentFrameIndex(0), frameValues{}
+{
+    assert(frames_in_flight >= 1 && frames_in_flight <= Swapchain::MAX_FRAMES_IN_FLIGHT &&
+           "FRAMES IN FLIGHT ARE OUT OF BOUNDS");
+}
+
+vk::CommandBufferManager::~CommandBufferManager()
+{
+    // Frames may still be in flight, their pools are destroyed once the last of them has finished
+    std::vector<VkCommandPool> command_pools;
+
+    for (auto &[thread_id, frame_pools] : threads)
+        for (int i = 0; i < framesInFlight; ++i)
+            command_pools.push_back((*frame_pools)[i].commandPool);
+
+    timeline.defer([device = device.getLogicalDevice(), command_pools]() {
+        for (auto command_pool : command_pools)
+            vkDestroyCommandPool(device, command_pool, nullptr);
+    });
+}
+
+void vk::CommandBufferManager::beginFrame(const int frame_index)
+{
+    assert(frame_index >= 0 && frame_index < framesInFlight && "FRAME INDEX IS OUT OF BOUNDS");
+
+    // Usually returns right away, the render target has waited for the frame's previous submission
+    timeline.wait(frameValues[frame_index]);
+
+    std::lock_guard<std::mutex> lock(threadsMutex);
+
+    // Every buffer of a pool is reset at once, the buffers handed out before become free again
+    for (auto &[thread_id, frame_pools] : threads)
+    {
+        Pool &pool = (*frame_pools)[frame_index];
+
+        if (pool.primaryCount == 0 && pool.secondaryCount == 0)
+            continue;
+
+        if (vkResetCommandPool(device.getLogicalDevice(), pool.commandPool, 0) != VK_SUCCESS)
+            throw std::runtime_error("vk::CommandBufferManager::beginFrame: FAILED TO RESET COMMAND POOL");
+
+        pool.primaryCount = 0;
+        pool.secondaryCount = 0;
+    }
+
+    currentFrameIndex = frame_index;
+}
+
+void vk::CommandBufferManager::endFrame(const uint64_t submitted_value)
+{
+    frameValues[currentFrameIndex] = submitted_value;
+}
+
+VkCommandBuffer vk::CommandBufferManager::acquirePrimary()
+{
+    return acquire(getThreadPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+}
+
+VkCommandBuffer vk::CommandBufferManager::acquireSecondary()
+{
+    return acquire(getThreadPool(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+}
+
+const size_t vk::CommandBufferManager::getAllocatedCount() const
+{
+    std::lock_guard<std::mutex> lock(threadsMutex);
+
+    size_t count = 0;
+
+    for (auto &[thread_id, frame_pools] : threads)
+        for (int i = 0; i < framesInFlight; ++i)
+            count += (*frame_pools)[i].primaryBuffers.size() + (*frame_pools)[i].secondaryBuffers.size();
+
+    return count;
+}
+
+vk::CommandBufferManager::Pool &vk::CommandBufferManager::getThreadPool()
+{
+    std::lock_guard<std::mutex> lock(threadsMutex);
+
+    auto &frame_pools = threads[std::this_thread::get_id()];
+
+    if (!frame_pools)
+    {
+        frame_pools = std::make_unique<FramePools>();
+
+        // Buffers are only reset with their pool, never one by one
+        VkCommandPoolCreateInfo pool_info = {};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.queueFamilyIndex = queueFamily;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        for (int i = 0; i < framesInFlight; ++i)
+            if (vkCreateCommandPool(device.getLogicalDevice(), &pool_info, nullptr, &(*frame_pools)[i].commandPool) !=
+                VK_SUCCESS)
+                throw std::runtime_error("vk::CommandBufferManager::getThreadPool: FAILED TO CREATE COMMAND POOL");
+
+#ifndef NDEBUG
+        std::cout << "COMMAND POOLS CREATED FOR THREAD " << std::this_thread::get_id() << std::endl;
+#endif
+    }
+
+    // The map may rehash while other threads register, the pools themselves do not move
+    return (*frame_pools)[currentFrameIndex];
+}
+
+VkCommandBuffer vk::CommandBufferManager::acquire(Pool &pool, const VkCommandBufferLevel level)
+{
+    const bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    auto &command_buffers = primary ? pool.primaryBuffers : pool.secondaryBuffers;
+    auto &count = primary ? pool.primaryCount : pool.secondaryCount;
+
+    if (count == command_buffers.size())
+    {
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level = level;
+        alloc_info.commandPool = pool.commandPool;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+
+        if (vkAllocateCommandBuffers(device.getLogicalDevice(), &alloc_info, &command_buffer) != VK_SUCCESS)
+            throw std::runtime_error("vk::CommandBufferManager::acquire: FAILED TO ALLOCATE COMMAND BUFFER");
+
+        command_buffers.push_back(command_buffer);
+    }
+
+    return command_buffers[count++];
+}
@@ -1,6 +1,8 @@
 #include "SVKE/Core/System/Device.hpp"
+#include "SVKE/Core/System/GpuProfiler.hpp"
+#include "SVKE/Core/System/Memory/AttachmentPool.hpp"
 
-vk::Device::Device(Window &window, const MSAA &preferred_msaa_samples) : window(window)
+vk::Device::Device(Window &window, const MSAA &preferred_msaa_samples) : window(&window)
 {
     nullifyHandles();
     createInstance();
@@ -8,12 +10,46 @@ vk::Device::Device(Window &window, const MSAA &preferred_msaa_samples) : window(
     createSurface();
     pickAdequatePhysicalDevice(preferred_msaa_samples);
     createLogicalDevice();
+    createTimelines();
     createVmaAllocator();
-    createCommandPool();
+    createCommandPools();
+
+    memoryTracker = std::make_unique<MemoryTracker>(allocator);
+    attachmentPool = std::make_unique<AttachmentPool>(*this);
+}
+
+vk::Device::Device(const MSAA &preferred_msaa_samples) : window(nullptr)
+{
+    nullifyHandles();
+    createInstance();
+    setupDebugMessenger();
+    createSurface();
+    pickAdequatePhysicalDevice(preferred_msaa_samples);
+    createLogicalDevice();
+    createTimelines();
+    createVmaAllocator();
+    createCommandPools();
+
+    memoryTracker = std::make_unique<MemoryTracker>(allocator);
+    attachmentPool = std::make_unique<AttachmentPool>(*this);
 }
 
 vk::Device::~Device()
 {
+    // Releases deferred on the timeline may still destroy objects of this device or give attachments back
+    vkDeviceWaitIdle(device);
+    graphicsTimeline.reset();
+    transferTimeline.reset();
+    computeTimeline.reset();
+    attachmentPool.reset();
+    memoryTracker.reset();
+
+    if (transferCommandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(device, transferCommandPool, nullptr);
+
+    if (computeCommandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(device, computeCommandPool, nullptr);
+
     vkDestroyCommandPool(device, commandPool, nullptr);
     vmaDestroyAllocator(allocator);
     vkDestroyDevice(device, nullptr);
@@ -31,16 +67,41 @@ VmaAllocator vk::Device::getAllocator()
     return allocator;
 }
 
+const bool vk::Device::isHeadless() const
+{
+    return window == nullptr;
+}
+
 const VkPhysicalDeviceProperties &vk::Device::getProperties() const
 {
     return properties;
 }
 
+const VkPhysicalDeviceFeatures &vk::Device::getEnabledFeatures() const
+{
+    return enabledFeatures;
+}
+
+const VkPhysicalDeviceVulkan12Features &vk::Device::getEnabledVulkan12Features() const
+{
+    return enabledVulkan12Features;
+}
+
+const VkPhysicalDeviceVulkan13Features &vk::Device::getEnabledVulkan13Features() const
+{
+    return enabledVulkan13Features;
+}
+
 VkDevice vk::Device::getLogicalDevice()
 {
     return device;
 }
 
+VkPhysicalDevice vk::Device::getPhysicalDevice()
+{
+    return physicalDevice;
+}
+
 VkSurfaceKHR vk::Device::getSurface()
 {
     return surface;
@@ -51,6 +112,16 @@ VkCommandPool vk::Device::getCommandPool()
     return commandPool;
 }
 
+VkCommandPool vk::Device::getTransferCommandPool()
+{
+    return transferCommandPool != VK_NULL_HANDLE ? transferCommandPool : commandPool;
+}
+
+VkCommandPool vk::Device::getComputeCommandPool()
+{
+    return computeCommandPool != VK_NULL_HANDLE ? computeCommandPool : commandPool;
+}
+
 VkQueue vk::Device::getGraphicsQueue()
 {
     return graphicsQueue;
@@ -61,6 +132,61 @@ VkQueue vk::Device::getPresentQueue()
     return presentQueue;
 }
 
+VkQueue vk::Device::getTransferQueue()
+{
+    return transferQueue;
+}
+
+VkQueue vk::Device::getComputeQueue()
+{
+    return computeQueue;
+}
+
+vk::Timeline &vk::Device::getGraphicsTimeline()
+{
+    return *graphicsTimeline;
+}
+
+vk::Timeline &vk::Device::getTransferTimeline()
+{
+    return transferTimeline ? *transferTimeline : *graphicsTimeline;
+}
+
+vk::Timeline &vk::Device::getComputeTimeline()
+{
+    return computeTimeline ? *computeTimeline : *graphicsTimeline;
+}
+
+const bool vk::Device::hasDedicatedTransferQueue() const
+{
+    return queueFamilyIndices.transferFamily.has_value();
+}
+
+const bool vk::Device::hasDedicatedComputeQueue() const
+{
+    return queueFamilyIndices.computeFamily.has_value();
+}
+
+const bool vk::Device::hasSwapchainMaintenance1() const
+{
+    return swapchainMaintenance1;
+}
+
+const vk::Device::QueueFamilyIndices &vk::Device::getQueueFamilyIndices() const
+{
+    return queueFamilyIndices;
+}
+
+vk::AttachmentPool &vk::Device::getAttachmentPool()
+{
+    return *attachmentPool;
+}
+
+vk::MemoryTracker &vk::Device::getMemoryTracker()
+{
+    return *memoryTracker;
+}
+
 const VkSampleCountFlagBits &vk::Device::getMsaaMaxSamples() const
 {
     return msaaMaxSamples;
@@ -127,40 +253,166 @@ VkFormat vk::Device::findSupportedFormat(const std::vector<VkFormat> &candidates
 
 VkCommandBuffer vk::Device::beginSingleTimeCommands()
 {
-    VkCommandBufferAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = commandPool;
-    alloc_info.commandBufferCount = 1;
+    return beginCommands(commandPool);
+}
 
-    VkCommandBuffer command_buffer;
-    vkAllocateCommandBuffers(device, &alloc_info, &command_buffer);
+void vk::Device::endSingleTimeCommands(VkCommandBuffer command_buffer)
+{
+    vkEndCommandBuffer(command_buffer);
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+
+    // Waits for this submission only, not for frames that are still in flight on the same queue
+    graphicsTimeline->wait(graphicsTimeline->submit(graphicsQueue, submit_info));
+
+    recycleCommandBuffer(commandPool, command_buffer);
+}
+
+VkCommandBuffer vk::Device::beginUploadCommands(const std::string &name)
+{
+    VkCommandBuffer command_buffer = beginCommands(getTransferCommandPool());
+
+    if (uploadProfiler)
+        uploadProfiler->beginUpload(command_buffer, name);
 
-    vkBeginCommandBuffer(command_buffer, &begin_info);
     return command_buffer;
 }
 
-void vk::Device::endSingleTimeCommands(VkCommandBuffer command_buffer)
+const uint64_t vk::Device::endUploadCommands(VkCommandBuffer command_buffer,
+                                             const std::vector<VkBufferMemoryBarrier2> &buffer_barriers,
+                                             const std::vector<VkImageMemoryBarrier2> &image_barriers)
 {
-    vkEndCommandBuffer(command_buffer);
+    const uint32_t graphics_family = *queueFamilyIndices.graphicsFamily;
+
+    // Only the upload's own commands are timed, not the ownership transfer
+    if (uploadProfiler)
+        uploadProfiler->endUpload(command_buffer);
 
     VkSubmitInfo submit_info{};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submit_info.commandBufferCount = 1;
+
+    if (!hasDedicatedTransferQueue())
+    {
+        recordOwnershipTransfer(command_buffer, graphics_family, command_buffer, graphics_family, buffer_barriers,
+                                image_barriers);
+        vkEndCommandBuffer(command_buffer);
+
+        submit_info.pCommandBuffers = &command_buffer;
+        const uint64_t value = graphicsTimeline->submit(graphicsQueue, submit_info);
+
+        graphicsTimeline->defer([this, command_buffer]() { recycleCommandBuffer(commandPool, command_buffer); });
+
+        if (uploadProfiler)
+            uploadProfiler->uploadSubmitted(value);
+
+        return value;
+    }
+
+    VkCommandBuffer acquire_command_buffer = beginCommands(commandPool);
+
+    recordOwnershipTransfer(command_buffer, *queueFamilyIndices.transferFamily, acquire_command_buffer,
+                            graphics_family, buffer_barriers, image_barriers);
+    vkEndCommandBuffer(command_buffer);
+    vkEndCommandBuffer(acquire_command_buffer);
+
     submit_info.pCommandBuffers = &command_buffer;
+    const uint64_t upload_value = transferTimeline->submit(transferQueue, submit_info);
+
+    // Waited for at every stage: the acquire has no first scope of its own, the semaphore is its dependency
+    submit_info.pCommandBuffers = &acquire_command_buffer;
+    const uint64_t value = graphicsTimeline->submit(
+        graphicsQueue, submit_info, {{transferTimeline.get(), upload_value, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT}});
+
+    // The acquire waits for the upload, so both have finished once it has
+    graphicsTimeline->defer([this, command_buffer, acquire_command_buffer]() {
+        recycleCommandBuffer(transferCommandPool, command_buffer);
+        recycleCommandBuffer(commandPool, acquire_command_buffer);
+    });
+
+    if (uploadProfiler)
+        uploadProfiler->uploadSubmitted(value);
+
+    return value;
+}
+
+void vk::Device::recordOwnershipTransfer(VkCommandBuffer release_command_buffer, const uint32_t src_family,
+                                         VkCommandBuffer acquire_command_buffer, const uint32_t dst_family,
+                                         std::vector<VkBufferMemoryBarrier2> buffer_barriers,
+                                         std::vector<VkImageMemoryBarrier2> image_barriers)
+{
+    const bool same_family = src_family == dst_family;
+
+    for (auto &barrier : buffer_barriers)
+    {
+        barrier.srcQueueFamilyIndex = same_family ? VK_QUEUE_FAMILY_IGNORED : src_family;
+        barrier.dstQueueFamilyIndex = same_family ? VK_QUEUE_FAMILY_IGNORED : dst_family;
+    }
+
+    for (auto &barrier : image_barriers)
+    {
+        barrier.srcQueueFamilyIndex = same_family ? VK_QUEUE_FAMILY_IGNORED : src_family;
+        barrier.dstQueueFamilyIndex = same_family ? VK_QUEUE_FAMILY_IGNORED : dst_family;
+    }
+
+    VkDependencyInfo dependency_info = {};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers.size());
+    dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size());
+
+    if (same_family)
+    {
+        dependency_info.pBufferMemoryBarriers = buffer_barriers.data();
+        dependency_info.pImageMemoryBarriers = image_barriers.data();
+
+        vkCmdPipelineBarrier2(acquire_command_buffer, &dependency_info);
+        return;
+    }
+
+    // The release only makes the writes available and the acquire only makes them visible, the dst scope of one and
+    // the src scope of the other are ignored
+    std::vector<VkBufferMemoryBarrier2> release_buffer_barriers = buffer_barriers;
+    std::vector<VkImageMemoryBarrier2> release_image_barriers = image_barriers;
 
-    vkQueueSubmit(graphicsQueue, 1, &submit_info, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+    for (auto &barrier : release_buffer_barriers)
+    {
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+    }
+
+    for (auto &barrier : release_image_barriers)
+    {
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+    }
+
+    dependency_info.pBufferMemoryBarriers = release_buffer_barriers.data();
+    dependency_info.pImageMemoryBarriers = release_image_barriers.data();
+    vkCmdPipelineBarrier2(release_command_buffer, &dependency_info);
 
-    vkFreeCommandBuffers(device, commandPool, 1, &command_buffer);
+    for (auto &barrier : buffer_barriers)
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    }
+
+    for (auto &barrier : image_barriers)
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    }
+
+    dependency_info.pBufferMemoryBarriers = buffer_barriers.data();
+    dependency_info.pImageMemoryBarriers = image_barriers.data();
+    vkCmdPipelineBarrier2(acquire_command_buffer, &dependency_info);
 }
 
 void vk::Device::createImageWithInfo(const VkImageCreateInfo &image_info, VkMemoryPropertyFlags properties,
-                                     VkImage &image, VmaAllocation &image_memory)
+                                     VkImage &image, VmaAllocation &image_memory,
+                                     const MemoryTracker::Category category)
 {
     // Define VMA allocation create info
     VmaAllocationCreateInfo alloc_create_info = {};
@@ -178,6 +430,19 @@ void vk::Device::createImageWithInfo(const VkImageCreateInfo &image_info, VkMemo
 
     if (result != VK_SUCCESS)
         throw std::runtime_error("vk::Device::createImageWithInfo: FAILED TO CREATE IMAGE WITH VMA");
+
+    memoryTracker->track(image_memory, category);
+}
+
+void vk::Device::destroyImage(VkImage image, VmaAllocation image_memory)
+{
+    memoryTracker->untrack(image_memory);
+    vmaDestroyImage(allocator, image, image_memory);
+}
+
+void vk::Device::setUploadProfiler(GpuProfiler *profiler)
+{
+    uploadProfiler = profiler;
 }
 
 const std::string vk::Device::getMsaaSamplesAsString(const MSAA &samples)
@@ -212,8 +477,15 @@ void vk::Device::nullifyHandles()
     device = VK_NULL_HANDLE;
     graphicsQueue = VK_NULL_HANDLE;
     presentQueue = VK_NULL_HANDLE;
+    transferQueue = VK_NULL_HANDLE;
+    computeQueue = VK_NULL_HANDLE;
     allocator = VK_NULL_HANDLE;
     commandPool = VK_NULL_HANDLE;
+    transferCommandPool = VK_NULL_HANDLE;
+    computeCommandPool = VK_NULL_HANDLE;
+    uploadProfiler = nullptr;
+    surfaceMaintenance1 = false;
+    swapchainMaintenance1 = false;
 }
 
 void vk::Device::createInstance()
@@ -272,7 +544,10 @@ void vk::Device::setupDebugMessenger()
 
 void vk::Device::createSurface()
 {
-    window.createSurface(instance, surface);
+    if (isHeadless())
+        return;
+
+    window->createSurface(instance, surface);
 }
 
 void vk::Device::pickAdequatePhysicalDevice(const MSAA &preferred_msaa_samples)
@@ -325,6 +600,12 @@ void vk::Device::createLogicalDevice()
     std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
     std::set<uint32_t> unique_queue_families = {*indices.graphicsFamily, *indices.presentFamily};
 
+    if (indices.transferFamily)
+        unique_queue_families.insert(*indices.transferFamily);
+
+    if (indices.computeFamily)
+        unique_queue_families.insert(*indices.computeFamily);
+
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : unique_queue_families)
     {
@@ -336,19 +617,89 @@ void vk::Device::createLogicalDevice()
         queue_create_infos.push_back(queue_create_info);
     }
 
+    VkPhysicalDeviceVulkan13Features supported_vulkan13_features = {};
+    supported_vulkan13_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceVulkan12Features supported_vulkan12_features = {};
+    supported_vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    supported_vulkan12_features.pNext = &supported_vulkan13_features;
+
+    // Only chained when the extension is there, it also needs VK_EXT_surface_maintenance1 on the instance
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT supported_swapchain_maintenance1_features = {};
+    supported_swapchain_maintenance1_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+
+    const bool swapchain_maintenance1_supported =
+        surfaceMaintenance1 &&
+        isDeviceExtensionSupported(physicalDevice, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+
+    if (swapchain_maintenance1_supported)
+        supported_vulkan13_features.pNext = &supported_swapchain_maintenance1_features;
+
+    VkPhysicalDeviceFeatures2 supported_features2 = {};
+    supported_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features2.pNext = &supported_vulkan12_features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supported_features2);
+
+    swapchainMaintenance1 = supported_swapchain_maintenance1_features.swapchainMaintenance1 == VK_TRUE;
+
+    const VkPhysicalDeviceFeatures &supported_features = supported_features2.features;
+
     VkPhysicalDeviceFeatures device_features = {};
     device_features.samplerAnisotropy = VK_TRUE;
     device_features.sampleRateShading = VK_TRUE;
+    device_features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
+    device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+    device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+
+    // Timeline semaphores are required by rateDeviceSuitability
+    VkPhysicalDeviceVulkan12Features vulkan12_features = {};
+    vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12_features.timelineSemaphore = VK_TRUE;
+    vulkan12_features.drawIndirectCount = supported_vulkan12_features.drawIndirectCount;
+    vulkan12_features.hostQueryReset = supported_vulkan12_features.hostQueryReset;
+
+    // Likewise synchronization2, the RenderGraph records its barriers with vkCmdPipelineBarrier2, and dynamic
+    // rendering, the Renderer begins its render passes with vkCmdBeginRendering
+    VkPhysicalDeviceVulkan13Features vulkan13_features = {};
+    vulkan13_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13_features.synchronization2 = VK_TRUE;
+    vulkan13_features.dynamicRendering = VK_TRUE;
+    vulkan12_features.pNext = &vulkan13_features;
+
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchain_maintenance1_features = {};
+    swapchain_maintenance1_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+    swapchain_maintenance1_features.swapchainMaintenance1 = VK_TRUE;
+
+    if (swapchainMaintenance1)
+        vulkan13_features.pNext = &swapchain_maintenance1_features;
+
+    // Multiview, which the PointShadowSystem renders the six faces of a cube with, is core since 1.1 and mandatory
+    VkPhysicalDeviceVulkan11Features vulkan11_features = {};
+    vulkan11_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    vulkan11_features.multiview = VK_TRUE;
+    vulkan11_features.pNext = &vulkan12_features;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan11_features;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     createInfo.pQueueCreateInfos = queue_create_infos.data();
 
     createInfo.pEnabledFeatures = &device_features;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-    createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+    enabledFeatures = device_features;
+    enabledVulkan12Features = vulkan12_features;
+    enabledVulkan12Features.pNext = nullptr;
+    enabledVulkan13Features = vulkan13_features;
+    enabledVulkan13Features.pNext = nullptr;
+
+    auto device_extensions = getRequiredDeviceExtensions();
+    if (swapchainMaintenance1)
+        device_extensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+    createInfo.ppEnabledExtensionNames = device_extensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -366,6 +717,37 @@ void vk::Device::createLogicalDevice()
 
     vkGetDeviceQueue(device, *indices.graphicsFamily, 0, &graphicsQueue);
     vkGetDeviceQueue(device, *indices.presentFamily, 0, &presentQueue);
+
+    transferQueue = graphicsQueue;
+    if (indices.transferFamily)
+        vkGetDeviceQueue(device, *indices.transferFamily, 0, &transferQueue);
+
+    computeQueue = graphicsQueue;
+    if (indices.computeFamily)
+        vkGetDeviceQueue(device, *indices.computeFamily, 0, &computeQueue);
+
+    queueFamilyIndices = indices;
+
+#ifndef NDEBUG
+    std::cout << "TRANSFER QUEUE: "
+              << (indices.transferFamily ? "FAMILY " + std::to_string(*indices.transferFamily) : "GRAPHICS QUEUE")
+              << std::endl;
+    std::cout << "COMPUTE QUEUE: "
+              << (indices.computeFamily ? "FAMILY " + std::to_string(*indices.computeFamily) : "GRAPHICS QUEUE")
+              << std::endl;
+#endif
+}
+
+void vk::Device::createTimelines()
+{
+    graphicsTimeline = std::make_unique<Timeline>(device);
+
+    // Queues shared with the graphics queue share its timeline too, their submissions are ordered with its own
+    if (queueFamilyIndices.transferFamily)
+        transferTimeline = std::make_unique<Timeline>(device);
+
+    if (queueFamilyIndices.computeFamily)
+        computeTimeline = std::make_unique<Timeline>(device);
 }
 
 void vk::Device::createVmaAllocator()
@@ -385,17 +767,66 @@ void vk::Device::createVmaAllocator()
         throw std::runtime_error("vk::Device::createVmaAllocator: FAILED TO CREATE VMA ALLOCATOR");
 }
 
-void vk::Device::createCommandPool()
+void vk::Device::createCommandPools()
 {
-    QueueFamilyIndices queue_family_indices = findPhysicalQueueFamilies();
+    commandPool = createCommandPool(*queueFamilyIndices.graphicsFamily);
+
+    if (queueFamilyIndices.transferFamily)
+        transferCommandPool = createCommandPool(*queueFamilyIndices.transferFamily);
+
+    if (queueFamilyIndices.computeFamily)
+        computeCommandPool = createCommandPool(*queueFamilyIndices.computeFamily);
+}
 
+VkCommandPool vk::Device::createCommandPool(const uint32_t queue_family)
+{
     VkCommandPoolCreateInfo pool_info = {};
     pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    pool_info.queueFamilyIndex = *queue_family_indices.graphicsFamily;
+    pool_info.queueFamilyIndex = queue_family;
     pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-    if (vkCreateCommandPool(device, &pool_info, nullptr, &commandPool) != VK_SUCCESS)
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+
+    if (vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS)
         throw std::runtime_error("vk::Device::createCommandPool FAILED TO CREATE COMMAND POOL");
+
+    return command_pool;
+}
+
+VkCommandBuffer vk::Device::beginCommands(VkCommandPool command_pool)
+{
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    auto &free_command_buffers = freeCommandBuffers[command_pool];
+
+    if (free_command_buffers.empty())
+    {
+        VkCommandBufferAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool = command_pool;
+        alloc_info.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) != VK_SUCCESS)
+            throw std::runtime_error("vk::Device::beginCommands: FAILED TO ALLOCATE COMMAND BUFFER");
+    }
+    else
+    {
+        command_buffer = free_command_buffers.back();
+        free_command_buffers.pop_back();
+    }
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    // Resets a recycled command buffer, its pool allows it
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+    return command_buffer;
+}
+
+void vk::Device::recycleCommandBuffer(VkCommandPool command_pool, VkCommandBuffer command_buffer)
+{
+    freeCommandBuffers[command_pool].push_back(command_buffer);
 }
 
 const int vk::Device::rateDeviceSuitability(VkPhysicalDevice physical_device)
@@ -427,12 +858,30 @@ const int vk::Device::rateDeviceSuitability(VkPhysicalDevice physical_device)
     if (!features.samplerAnisotropy)
         score = -1;
 
+    // Require timeline semaphores, all submissions are tracked by them, synchronization2 for the RenderGraph and
+    // dynamic rendering for the Renderer.
+    VkPhysicalDeviceVulkan13Features vulkan13_features = {};
+    vulkan13_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceVulkan12Features vulkan12_features = {};
+    vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12_features.pNext = &vulkan13_features;
+
+    VkPhysicalDeviceFeatures2 features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &vulkan12_features;
+    vkGetPhysicalDeviceFeatures2(physical_device, &features2);
+
+    if (!vulkan12_features.timelineSemaphore || !vulkan13_features.synchronization2 ||
+        !vulkan13_features.dynamicRendering)
+        score = -1;
+
     // Require a device with a valid queue familiy.
     if (!findQueueFamilies(physical_device).isComplete())
         score = -1;
 
     // Require that swap chain is adequate
-    if (extension_support)
+    if (extension_support && !isHeadless())
     {
         SwapchainSupportDetails details = querySwapchainSupport(physical_device);
         if (details.formats.empty() || details.presentModes.empty())
@@ -448,12 +897,28 @@ const int vk::Device::rateDeviceSuitability(VkPhysicalDevice physical_device)
 
 const std::vector<const char *> vk::Device::getRequiredExtensions()
 {
-    uint32_t glfw_extension_count = 0;
-    const char **glfw_extensions;
+    std::vector<const char *> extensions;
+
+    // Without a window GLFW is never initialized and no surface extensions are needed
+    if (!isHeadless())
+    {
+        uint32_t glfw_extension_count = 0;
+        const char **glfw_extensions;
 
-    glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
 
-    std::vector<const char *> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+        extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+    }
+
+    // Optional, lets the device enable VK_EXT_swapchain_maintenance1
+    surfaceMaintenance1 = !isHeadless() && isInstanceExtensionSupported(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) &&
+                          isInstanceExtensionSupported(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+
+    if (surfaceMaintenance1)
+    {
+        extensions.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+    }
 
 #ifndef NDEBUG
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -462,6 +927,22 @@ const std::vector<const char *> vk::Device::getRequiredExtensions()
     return std::move(extensions);
 }
 
+const std::vector<const char *> vk::Device::getRequiredDeviceExtensions() const
+{
+    if (!isHeadless())
+        return DEVICE_EXTENSIONS;
+
+    std::vector<const char *> extensions;
+
+    for (auto *extension : DEVICE_EXTENSIONS)
+    {
+        if (strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0)
+            extensions.push_back(extension);
+    }
+
+    return extensions;
+}
+
 const bool vk::Device::checkValidationLayerSupport()
 {
     uint32_t layer_count;
@@ -568,7 +1049,8 @@ const bool vk::Device::checkDeviceExtensionSupport(VkPhysicalDevice physical_dev
     std::vector<VkExtensionProperties> available_extensions(extension_count);
     vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, available_extensions.data());
 
-    std::set<std::string> required_extensions(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+    const auto device_extensions = getRequiredDeviceExtensions();
+    std::set<std::string> required_extensions(device_extensions.begin(), device_extensions.end());
 
     for (const auto &extension : available_extensions)
         required_extensions.erase(extension.extensionName);
@@ -576,6 +1058,40 @@ const bool vk::Device::checkDeviceExtensionSupport(VkPhysicalDevice physical_dev
     return required_extensions.empty();
 }
 
+const bool vk::Device::isInstanceExtensionSupported(const char *extension)
+{
+    uint32_t extension_count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extension_count, available_extensions.data());
+
+    for (const auto &available_extension : available_extensions)
+    {
+        if (strcmp(available_extension.extensionName, extension) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+const bool vk::Device::isDeviceExtensionSupported(VkPhysicalDevice physical_device, const char *extension)
+{
+    uint32_t extension_count = 0;
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &extension_count, available_extensions.data());
+
+    for (const auto &available_extension : available_extensions)
+    {
+        if (strcmp(available_extension.extensionName, extension) == 0)
+            return true;
+    }
+
+    return false;
+}
+
 VkSampleCountFlagBits vk::Device::queryMaxUsableSampleCount(VkPhysicalDevice physical_device)
 {
     VkPhysicalDeviceProperties properties;
@@ -615,24 +1131,42 @@ vk::Device::QueueFamilyIndices vk::Device::findQueueFamilies(VkPhysicalDevice ph
     std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
     vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_families.data());
 
-    int i = 0;
-    for (const auto &queue_family : queue_families)
+    // Every family is looked at, the dedicated ones usually come after the graphics family
+    for (uint32_t i = 0; i < queue_family_count; ++i)
     {
-        if (queue_family.queueCount > 0 && queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        const auto &queue_family = queue_families[i];
+
+        if (queue_family.queueCount == 0)
+            continue;
+
+        const bool graphics = queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+        const bool compute = queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT;
+        const bool transfer = queue_family.queueFlags & VK_QUEUE_TRANSFER_BIT;
+
+        if (graphics && !indices.graphicsFamily)
             indices.graphicsFamily = i;
 
+        if (compute && !graphics && !indices.computeFamily)
+            indices.computeFamily = i;
+
+        if (transfer && !graphics && !compute && !indices.transferFamily)
+            indices.transferFamily = i;
+
+        // Nothing is presented without a surface, the graphics queue stands in for the present queue
+        if (isHeadless())
+            continue;
+
         VkBool32 present_support = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, surface, &present_support);
 
-        if (queue_family.queueCount > 0 && present_support)
+        // Presenting from the graphics family is preferred, frames then need no other queue
+        if (present_support && (!indices.presentFamily || indices.graphicsFamily == i))
             indices.presentFamily = i;
-
-        if (indices.isComplete())
-            break;
-
-        i++;
     }
 
+    if (isHeadless())
+        indices.presentFamily = indices.graphicsFamily;
+
     return indices;
 }
 
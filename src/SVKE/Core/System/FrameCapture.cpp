@@ -0,0 +1,281 @@
+#include "SVKE/Core/System/FrameCapture.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
+#include "SVKE/Utils/ImageWriter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+vk::FrameCapture::FrameCapture(Device &device, const VkExtent2D &extent, const VkFormat &image_format,
+                               const Options &options)
+    : device(device), extent(extent), imageFormat(image_format), swizzle(false), options(options), nextSlot(0),
+      writtenCount(0), droppedCount(0), stopping(false)
+{
+    switch (image_format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        break;
+
+    // Usual swapchain formats, swapped to RGBA by the worker
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        swizzle = true;
+        break;
+
+    default:
+        throw std::runtime_error("vk::FrameCapture::FrameCapture: UNSUPPORTED IMAGE FORMAT");
+    }
+
+    std::filesystem::create_directories(options.directory);
+
+    const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    slots.resize(std::max(options.bufferCount, 1u));
+    for (auto &slot : slots)
+    {
+        slot = std::make_unique<Slot>();
+        slot->buffer = std::make_unique<Buffer>(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_AUTO,
+                                                VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT);
+        slot->buffer->map();
+    }
+
+    worker = std::thread(&FrameCapture::workerLoop, this);
+}
+
+vk::FrameCapture::~FrameCapture()
+{
+    // Frames that were recorded are still written, so a capture always ends with the last frame. Only the submission
+    // of the last one is waited for, not whatever was submitted after it.
+    uint64_t last_value = 0;
+    for (auto &slot : slots)
+    {
+        if (slot->state.load(std::memory_order_relaxed) == SlotState::Recorded)
+            last_value = std::max(last_value, slot->timelineValue);
+    }
+
+    if (last_value > 0)
+        device.getGraphicsTimeline().wait(last_value);
+
+    collect();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+
+    queueCondition.notify_all();
+    worker.join();
+
+#ifndef NDEBUG
+    std::cout << "CAPTURED " << writtenCount.load() << " FRAMES TO " << options.directory << ", DROPPED "
+              << droppedCount << std::endl;
+#endif
+}
+
+void vk::FrameCapture::record(VkCommandBuffer &command_buffer, VkImage image, const VkImageLayout layout,
+                              const uint64_t frame_number)
+{
+    // Never waits, a slow disk costs frames of the capture and not frames of the application
+    Slot *slot = nullptr;
+    for (size_t i = 0; i < slots.size() && !slot; ++i)
+    {
+        Slot &candidate = *slots[(nextSlot + i) % slots.size()];
+
+        if (candidate.state.load(std::memory_order_acquire) == SlotState::Free)
+        {
+            slot = &candidate;
+            nextSlot = (nextSlot + i + 1) % slots.size();
+        }
+    }
+
+    if (!slot)
+    {
+        ++droppedCount;
+        return;
+    }
+
+    slot->frameNumber = frame_number;
+    slot->timelineValue = 0;
+    slot->state.store(SlotState::Recorded, std::memory_order_relaxed);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer->getBuffer(), 1,
+                           &region);
+
+    // The worker reads the buffer once collect has seen the frame's timeline value, the copy has to be available to
+    // the host by then. Buffer::read invalidates the mapping if it is not coherent.
+    VkBufferMemoryBarrier buffer_barrier = {};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = slot->buffer->getBuffer();
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+                         &buffer_barrier, 0, nullptr);
+
+    if (layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        return;
+
+    // Presentation waits on a semaphore signaled after the whole submission, no later stage has to wait here
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+}
+
+void vk::FrameCapture::submitted(const uint64_t timeline_value)
+{
+    for (auto &slot : slots)
+    {
+        if (slot->state.load(std::memory_order_relaxed) == SlotState::Recorded && slot->timelineValue == 0)
+            slot->timelineValue = timeline_value;
+    }
+}
+
+void vk::FrameCapture::collect()
+{
+    Timeline &timeline = device.getGraphicsTimeline();
+
+    bool collected = false;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+
+        for (auto &slot : slots)
+        {
+            if (slot->state.load(std::memory_order_relaxed) != SlotState::Recorded || slot->timelineValue == 0 ||
+                !timeline.isComplete(slot->timelineValue))
+                continue;
+
+            slot->state.store(SlotState::Encoding, std::memory_order_relaxed);
+            queue.push_back(slot.get());
+            collected = true;
+        }
+
+        // Frames are written in order, the slots are not necessarily in frame order
+        std::sort(queue.begin(), queue.end(),
+                  [](const Slot *lhs, const Slot *rhs) { return lhs->frameNumber < rhs->frameNumber; });
+    }
+
+    if (collected)
+        queueCondition.notify_one();
+}
+
+const bool vk::FrameCapture::fits(const VkExtent2D &extent, const VkFormat &image_format) const
+{
+    return extent.width == this->extent.width && extent.height == this->extent.height && image_format == imageFormat;
+}
+
+const vk::FrameCapture::Options &vk::FrameCapture::getOptions() const
+{
+    return options;
+}
+
+const uint64_t vk::FrameCapture::getWrittenCount() const
+{
+    return writtenCount.load(std::memory_order_relaxed);
+}
+
+const uint64_t vk::FrameCapture::getDroppedCount() const
+{
+    return droppedCount;
+}
+
+void vk::FrameCapture::workerLoop()
+{
+    SVKE_PROFILE_THREAD("Frame capture");
+
+    std::vector<uint8_t> pixels;
+
+    while (true)
+    {
+        Slot *slot = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            // Stopping only once the queue is drained
+            if (queue.empty())
+                return;
+
+            slot = queue.front();
+            queue.pop_front();
+        }
+
+        encode(*slot, pixels);
+
+        slot->state.store(SlotState::Free, std::memory_order_release);
+    }
+}
+
+void vk::FrameCapture::encode(Slot &slot, std::vector<uint8_t> &pixels)
+{
+    SVKE_PROFILE_SCOPE("FrameCapture::encode");
+
+    pixels.resize(static_cast<size_t>(slot.buffer->getSize()));
+    slot.buffer->read(pixels.data(), pixels.size());
+
+    if (swizzle)
+    {
+        for (size_t i = 0; i < pixels.size(); i += 4)
+            std::swap(pixels[i], pixels[i + 2]);
+    }
+
+    char name[64];
+    bool written;
+
+    if (options.format == Format::Png)
+    {
+        std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(slot.frameNumber));
+        written = writePng(options.directory + "/" + name, extent.width, extent.height, pixels.data());
+    }
+    else
+    {
+        std::snprintf(name, sizeof(name), "frame_%06llu_%ux%u.rgba", static_cast<unsigned long long>(slot.frameNumber),
+                      extent.width, extent.height);
+        written = writeRaw(options.directory + "/" + name, extent.width, extent.height, pixels.data());
+    }
+
+    if (written)
+        writtenCount.fetch_add(1, std::memory_order_relaxed);
+    else
+        std::cerr << "vk::FrameCapture::encode: FAILED TO WRITE " << options.directory << "/" << name << std::endl;
+}
@@ -0,0 +1,451 @@
+#include "SVKE/Core/System/GpuProfiler.hpp"
+
+#include <algorithm>
+
+vk::GpuProfiler::History::History(const size_t capacity)
+    : samples(std::max<size_t>(capacity, 1), 0.0), next(0), count(0), latest{"", 0.0, false, {}}
+{
+}
+
+void vk::GpuProfiler::History::push(const Timing &timing)
+{
+    samples[next] = timing.milliseconds;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, samples.size());
+    latest = timing;
+}
+
+const std::vector<double> vk::GpuProfiler::History::getSamples() const
+{
+    std::vector<double> ordered;
+    ordered.reserve(count);
+
+    const size_t oldest = (next + samples.size() - count) % samples.size();
+
+    for (size_t i = 0; i < count; ++i)
+        ordered.push_back(samples[(oldest + i) % samples.size()]);
+
+    return ordered;
+}
+
+const double vk::GpuProfiler::History::getAverage() const
+{
+    if (count == 0)
+        return 0.0;
+
+    double sum = 0.0;
+
+    // Unfilled slots are zero, so summing everything is the same as summing the valid samples
+    for (const double sample : samples)
+        sum += sample;
+
+    return sum / static_cast<double>(count);
+}
+
+const double vk::GpuProfiler::History::getMax() const
+{
+    return *std::max_element(samples.begin(), samples.end());
+}
+
+const vk::GpuProfiler::Timing &vk::GpuProfiler::History::getLatest() const
+{
+    return latest;
+}
+
+const size_t vk::GpuProfiler::History::size() const
+{
+    return count;
+}
+
+vk::GpuProfiler::Scope::Scope(GpuProfiler &profiler, VkCommandBuffer &command_buffer, const std::string &name,
+                              const bool statistics)
+    : profiler(profiler), commandBuffer(command_buffer)
+{
+    profiler.beginScope(commandBuffer, name, statistics);
+}
+
+vk::GpuProfiler::Scope::~Scope()
+{
+    profiler.endScope(commandBuffer);
+}
+
+vk::GpuProfiler::GpuProfiler(Device &device, const uint32_t max_scopes, const size_t history_length,
+                             const bool pipeline_statistics)
+    : device(device), queryPool(VK_NULL_HANDLE), statisticsPool(VK_NULL_HANDLE), uploadPool(VK_NULL_HANDLE),
+      maxScopes(max_scopes), historyLength(history_length), currentFrame(0), statisticsActive(false),
+      recordingUpload(false)
+{
+    const auto &limits = device.getProperties().limits;
+
+    // Nanoseconds per tick
+    timestampPeriod = static_cast<double>(limits.timestampPeriod);
+    supported = limits.timestampComputeAndGraphics == VK_TRUE && timestampPeriod > 0.0;
+    collectStatistics = supported && pipeline_statistics && device.getEnabledFeatures().pipelineStatisticsQuery;
+    timeUploads = supported && device.getEnabledVulkan12Features().hostQueryReset && hasUploadTimestamps();
+
+    if (supported)
+        createQueryPools();
+#ifndef NDEBUG
+    else
+        std::cout << "GPU TIMESTAMPS ARE NOT SUPPORTED, GPU PROFILING IS DISABLED" << std::endl;
+
+    if (supported && pipeline_statistics && !collectStatistics)
+        std::cout << "PIPELINE STATISTICS QUERIES ARE NOT SUPPORTED, ONLY GPU TIMES ARE PROFILED" << std::endl;
+
+    if (supported && !timeUploads)
+        std::cout << "UPLOAD TIMESTAMPS ARE NOT SUPPORTED, UPLOADS ARE NOT PROFILED" << std::endl;
+#endif
+
+    if (timeUploads)
+    {
+        createUploadQueryPool();
+        device.setUploadProfiler(this);
+    }
+}
+
+vk::GpuProfiler::~GpuProfiler()
+{
+    if (timeUploads)
+        device.setUploadProfiler(nullptr);
+
+    if (uploadPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device.getLogicalDevice(), uploadPool, nullptr);
+
+    if (queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device.getLogicalDevice(), queryPool, nullptr);
+
+    if (statisticsPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device.getLogicalDevice(), statisticsPool, nullptr);
+}
+
+void vk::GpuProfiler::beginFrame(VkCommandBuffer &command_buffer, const int frame_index)
+{
+    assert(frame_index >= 0 && frame_index < Swapchain::MAX_FRAMES_IN_FLIGHT && "FRAME INDEX IS OUT OF BOUNDS");
+    assert(openScopes.empty() && "GPU PROFILER SCOPE WAS NOT CLOSED IN THE PREVIOUS FRAME");
+
+    if (!supported)
+        return;
+
+    // The last submission of this frame index was waited on, so its previous queries have completed
+    collectTimings(frame_index);
+
+    if (timeUploads)
+        collectUploads();
+
+    currentFrame = frame_index;
+    frames[currentFrame].scopes.clear();
+    frames[currentFrame].queryCount = 0;
+    frames[currentFrame].statisticsCount = 0;
+
+    vkCmdResetQueryPool(command_buffer, queryPool, currentFrame * maxScopes * 2, maxScopes * 2);
+
+    if (collectStatistics)
+        vkCmdResetQueryPool(command_buffer, statisticsPool, currentFrame * maxScopes, maxScopes);
+}
+
+void vk::GpuProfiler::beginScope(VkCommandBuffer &command_buffer, const std::string &name, const bool statistics)
+{
+    auto &frame = frames[currentFrame];
+
+    if (!supported || frame.queryCount + 2 > maxScopes * 2)
+    {
+        openScopes.push_back(SIZE_MAX);
+        return;
+    }
+
+    const uint32_t first_query = currentFrame * maxScopes * 2;
+
+    RecordedScope scope = {};
+    scope.name = name;
+    scope.beginQuery = first_query + frame.queryCount++;
+    scope.endQuery = first_query + frame.queryCount++;
+    scope.statisticsQuery = NO_QUERY;
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, scope.beginQuery);
+
+    if (statistics && collectStatistics && !statisticsActive)
+    {
+        scope.statisticsQuery = currentFrame * maxScopes + frame.statisticsCount++;
+        statisticsActive = true;
+
+        vkCmdBeginQuery(command_buffer, statisticsPool, scope.statisticsQuery, 0);
+    }
+
+    openScopes.push_back(frame.scopes.size());
+    frame.scopes.push_back(std::move(scope));
+}
+
+void vk::GpuProfiler::endScope(VkCommandBuffer &command_buffer)
+{
+    assert(!openScopes.empty() && "CANNOT END GPU PROFILER SCOPE THAT WAS NOT BEGUN");
+
+    const size_t scope_index = openScopes.back();
+    openScopes.pop_back();
+
+    if (scope_index == SIZE_MAX)
+        return;
+
+    const auto &scope = frames[currentFrame].scopes[scope_index];
+
+    if (scope.statisticsQuery != NO_QUERY)
+    {
+        vkCmdEndQuery(command_buffer, statisticsPool, scope.statisticsQuery);
+        statisticsActive = false;
+    }
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, scope.endQuery);
+}
+
+void vk::GpuProfiler::beginUpload(VkCommandBuffer command_buffer, const std::string &name)
+{
+    assert(!recordingUpload && "GPU PROFILER UPLOAD WAS NOT SUBMITTED");
+
+    if (!timeUploads || freeUploadQueries.empty())
+        return;
+
+    const uint32_t begin_query = freeUploadQueries.back();
+    freeUploadQueries.pop_back();
+
+    // Its previous results were read, or it was never used
+    vkResetQueryPool(device.getLogicalDevice(), uploadPool, begin_query, 2);
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, uploadPool, begin_query);
+
+    pendingUploads.push_back({name, begin_query, 0});
+    recordingUpload = true;
+}
+
+void vk::GpuProfiler::endUpload(VkCommandBuffer command_buffer)
+{
+    if (!recordingUpload)
+        return;
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, uploadPool,
+                        pendingUploads.back().beginQuery + 1);
+}
+
+void vk::GpuProfiler::uploadSubmitted(const uint64_t graphics_value)
+{
+    if (!recordingUpload)
+        return;
+
+    pendingUploads.back().graphicsValue = graphics_value;
+    recordingUpload = false;
+}
+
+const std::vector<vk::GpuProfiler::Timing> &vk::GpuProfiler::getTimings() const
+{
+    return timings;
+}
+
+const vk::GpuProfiler::History *vk::GpuProfiler::getHistory(const std::string &name) const
+{
+    auto it = histories.find(name);
+
+    if (it == histories.end())
+        return nullptr;
+
+    return &it->second;
+}
+
+const std::vector<std::string> &vk::GpuProfiler::getScopeNames() const
+{
+    return scopeNames;
+}
+
+void vk::GpuProfiler::resetHistories()
+{
+    assert(openScopes.empty() && "CANNOT RESET GPU PROFILER HISTORIES DURING A FRAME");
+
+    // Their queries are reset when their frame index is used again
+    for (auto &frame : frames)
+    {
+        frame.scopes.clear();
+        frame.queryCount = 0;
+        frame.statisticsCount = 0;
+    }
+
+    timings.clear();
+    histories.clear();
+    scopeNames.clear();
+}
+
+const bool vk::GpuProfiler::isSupported() const
+{
+    return supported;
+}
+
+const bool vk::GpuProfiler::isCollectingStatistics() const
+{
+    return collectStatistics;
+}
+
+const bool vk::GpuProfiler::isTimingUploads() const
+{
+    return timeUploads;
+}
+
+void vk::GpuProfiler::createQueryPools()
+{
+    VkQueryPoolCreateInfo query_pool_info = {};
+    query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = Swapchain::MAX_FRAMES_IN_FLIGHT * maxScopes * 2;
+
+    if (vkCreateQueryPool(device.getLogicalDevice(), &query_pool_info, nullptr, &queryPool) != VK_SUCCESS)
+        throw std::runtime_error("vk::GpuProfiler::createQueryPools: FAILED TO CREATE TIMESTAMP QUERY POOL");
+
+    if (!collectStatistics)
+        return;
+
+    VkQueryPoolCreateInfo statistics_pool_info = {};
+    statistics_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    statistics_pool_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    statistics_pool_info.queryCount = Swapchain::MAX_FRAMES_IN_FLIGHT * maxScopes;
+    statistics_pool_info.pipelineStatistics = STATISTICS_FLAGS;
+
+    if (vkCreateQueryPool(device.getLogicalDevice(), &statistics_pool_info, nullptr, &statisticsPool) != VK_SUCCESS)
+        throw std::runtime_error("vk::GpuProfiler::createQueryPools: FAILED TO CREATE PIPELINE STATISTICS QUERY POOL");
+}
+
+void vk::GpuProfiler::createUploadQueryPool()
+{
+    VkQueryPoolCreateInfo query_pool_info = {};
+    query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = MAX_PENDING_UPLOADS * 2;
+
+    if (vkCreateQueryPool(device.getLogicalDevice(), &query_pool_info, nullptr, &uploadPool) != VK_SUCCESS)
+        throw std::runtime_error("vk::GpuProfiler::createUploadQueryPool: FAILED TO CREATE UPLOAD QUERY POOL");
+
+    freeUploadQueries.reserve(MAX_PENDING_UPLOADS);
+    pendingUploads.reserve(MAX_PENDING_UPLOADS);
+
+    for (uint32_t i = 0; i < MAX_PENDING_UPLOADS; ++i)
+        freeUploadQueries.push_back((MAX_PENDING_UPLOADS - 1 - i) * 2);
+}
+
+const bool vk::GpuProfiler::hasUploadTimestamps()
+{
+    // Uploads are recorded for the transfer family if there is one, which does not necessarily support timestamps
+    const auto &queue_family_indices = device.getQueueFamilyIndices();
+    const uint32_t upload_family = device.hasDedicatedTransferQueue() ? *queue_family_indices.transferFamily
+                                                                      : *queue_family_indices.graphicsFamily;
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &family_count, nullptr);
+
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &family_count, families.data());
+
+    return families[upload_family].timestampValidBits > 0;
+}
+
+void vk::GpuProfiler::collectTimings(const int frame_index)
+{
+    auto &frame = frames[frame_index];
+
+    if (frame.queryCount == 0)
+        return;
+
+    std::vector<uint64_t> results(frame.queryCount);
+    const uint32_t first_query = frame_index * maxScopes * 2;
+
+    VkResult result = vkGetQueryPoolResults(device.getLogicalDevice(), queryPool, first_query, frame.queryCount,
+                                            results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+
+    // VK_NOT_READY: keep the previous timings rather than reporting garbage
+    if (result != VK_SUCCESS)
+        return;
+
+    // Values are written in the order of the statistic bits, which is the order of the Statistics fields
+    std::vector<uint64_t> statistics_results(frame.statisticsCount * STATISTICS_COUNT);
+    const uint32_t first_statistics_query = frame_index * maxScopes;
+
+    if (frame.statisticsCount > 0)
+    {
+        result = vkGetQueryPoolResults(device.getLogicalDevice(), statisticsPool, first_statistics_query,
+                                       frame.statisticsCount, statistics_results.size() * sizeof(uint64_t),
+                                       statistics_results.data(), STATISTICS_COUNT * sizeof(uint64_t),
+                                       VK_QUERY_RESULT_64_BIT);
+
+        if (result != VK_SUCCESS)
+            return;
+    }
+
+    timings.clear();
+
+    for (const auto &scope : frame.scopes)
+    {
+        const uint64_t begin = results[scope.beginQuery - first_query];
+        const uint64_t end = results[scope.endQuery - first_query];
+
+        Timing timing = {};
+        timing.name = scope.name;
+        timing.milliseconds = static_cast<double>(end - begin) * timestampPeriod / 1e6;
+        timing.hasStatistics = scope.statisticsQuery != NO_QUERY;
+
+        if (timing.hasStatistics)
+        {
+            const uint64_t *values =
+                &statistics_results[(scope.statisticsQuery - first_statistics_query) * STATISTICS_COUNT];
+
+            timing.statistics.inputAssemblyPrimitives = values[0];
+            timing.statistics.vertexShaderInvocations = values[1];
+            timing.statistics.clippingPrimitives = values[2];
+            timing.statistics.fragmentShaderInvocations = values[3];
+            timing.statistics.computeShaderInvocations = values[4];
+        }
+
+        pushHistory(timing);
+        timings.push_back(std::move(timing));
+    }
+}
+
+void vk::GpuProfiler::collectUploads()
+{
+    Timeline &timeline = device.getGraphicsTimeline();
+
+    size_t kept = 0;
+
+    for (size_t i = 0; i < pendingUploads.size(); ++i)
+    {
+        PendingUpload &upload = pendingUploads[i];
+
+        // Not submitted yet or still running, kept in order
+        if (upload.graphicsValue == 0 || !timeline.isComplete(upload.graphicsValue))
+        {
+            if (kept != i)
+                pendingUploads[kept] = std::move(upload);
+
+            ++kept;
+            continue;
+        }
+
+        std::array<uint64_t, 2> results = {};
+        const VkResult result =
+            vkGetQueryPoolResults(device.getLogicalDevice(), uploadPool, upload.beginQuery, 2, sizeof(results),
+                                  results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        if (result == VK_SUCCESS)
+            pushHistory({upload.name, static_cast<double>(results[1] - results[0]) * timestampPeriod / 1e6, false, {}});
+
+        freeUploadQueries.push_back(upload.beginQuery);
+    }
+
+    pendingUploads.resize(kept);
+}
+
+void vk::GpuProfiler::pushHistory(const Timing &timing)
+{
+    auto it = histories.find(timing.name);
+
+    if (it == histories.end())
+    {
+        it = histories.emplace(timing.name, History(historyLength)).first;
+        scopeNames.push_back(timing.name);
+    }
+
+    it->second.push(timing);
+}
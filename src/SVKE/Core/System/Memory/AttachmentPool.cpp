@@ -0,0 +1,129 @@
+#include "SVKE/Core/System/Memory/AttachmentPool.hpp"
+#include "SVKE/Core/System/Device.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+vk::AttachmentPool::AttachmentPool(Device &device) : device(device)
+{
+}
+
+vk::AttachmentPool::~AttachmentPool()
+{
+    clear();
+}
+
+vk::AttachmentPool::Attachment vk::AttachmentPool::acquire(const VkFormat format, const VkImageUsageFlags usage,
+                                                           const VkSampleCountFlagBits samples,
+                                                           const VkImageAspectFlags aspect, const VkExtent2D &extent)
+{
+    const VkExtent2D bucket_extent = {roundUpToBucket(extent.width), roundUpToBucket(extent.height)};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto matches = [&](const Attachment &attachment) {
+            return attachment.format == format && attachment.usage == usage && attachment.samples == samples &&
+                   attachment.aspect == aspect && attachment.extent.width == bucket_extent.width &&
+                   attachment.extent.height == bucket_extent.height;
+        };
+
+        auto it = std::find_if(freeAttachments.begin(), freeAttachments.end(), matches);
+        if (it != freeAttachments.end())
+        {
+            Attachment attachment = *it;
+            freeAttachments.erase(it);
+            return attachment;
+        }
+    }
+
+    Attachment attachment = {};
+    attachment.extent = bucket_extent;
+    attachment.format = format;
+    attachment.usage = usage;
+    attachment.samples = samples;
+    attachment.aspect = aspect;
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent.width = bucket_extent.width;
+    image_info.extent.height = bucket_extent.height;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.format = format;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = usage;
+    image_info.samples = samples;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.flags = 0;
+
+    device.createImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, attachment.image,
+                               attachment.allocation);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = attachment.image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = aspect;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &attachment.view) != VK_SUCCESS)
+    {
+        device.destroyImage(attachment.image, attachment.allocation);
+        throw std::runtime_error("vk::AttachmentPool::acquire: FAILED TO CREATE ATTACHMENT IMAGE VIEW");
+    }
+
+    return attachment;
+}
+
+void vk::AttachmentPool::release(const Attachment &attachment)
+{
+    device.getGraphicsTimeline().defer([this, attachment] { recycle(attachment); });
+}
+
+void vk::AttachmentPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &attachment : freeAttachments)
+        destroy(attachment);
+
+    freeAttachments.clear();
+}
+
+const size_t vk::AttachmentPool::getFreeCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return freeAttachments.size();
+}
+
+void vk::AttachmentPool::recycle(const Attachment &attachment)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    freeAttachments.push_back(attachment);
+
+    while (freeAttachments.size() > MAX_FREE_ATTACHMENTS)
+    {
+        destroy(freeAttachments.front());
+        freeAttachments.pop_front();
+    }
+}
+
+void vk::AttachmentPool::destroy(const Attachment &attachment)
+{
+    vkDestroyImageView(device.getLogicalDevice(), attachment.view, nullptr);
+    device.destroyImage(attachment.image, attachment.allocation);
+}
+
+const uint32_t vk::AttachmentPool::roundUpToBucket(const uint32_t size)
+{
+    return std::max<uint32_t>((size + BUCKET_SIZE - 1) / BUCKET_SIZE, 1) * BUCKET_SIZE;
+}
@@ -1,7 +1,7 @@
 #include "SVKE/Core/System/Memory/Buffer.hpp"
 
 vk::Buffer::Buffer(Device &device, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage)
-    : device(device), buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), size(0), mappedMem(nullptr)
+    : device(device), buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), size(size), mappedMem(nullptr)
 {
     VkBufferCreateInfo buffer_info = {};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -13,11 +13,13 @@ vk::Buffer::Buffer(Device &device, VkDeviceSize size, VkBufferUsageFlags usage,
 
     if (vmaCreateBuffer(device.getAllocator(), &buffer_info, &alloc_info, &buffer, &allocation, nullptr) != VK_SUCCESS)
         throw std::runtime_error("vk::Buffer::Buffer: FAILED TO CREATE BUFFER");
+
+    device.getMemoryTracker().track(allocation, MemoryTracker::categorizeBuffer(usage));
 }
 
 vk::Buffer::Buffer(Device &device, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memory_usage,
                    VmaAllocationCreateFlags flags)
-    : device(device), buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), size(0), mappedMem(nullptr)
+    : device(device), buffer(VK_NULL_HANDLE), allocation(VK_NULL_HANDLE), size(size), mappedMem(nullptr)
 {
     VkBufferCreateInfo buffer_info = {};
     buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -31,16 +33,23 @@ vk::Buffer::Buffer(Device &device, VkDeviceSize size, VkBufferUsageFlags usage,
 
     if (vmaCreateBuffer(device.getAllocator(), &buffer_info, &alloc_info, &buffer, &allocation, nullptr) != VK_SUCCESS)
         throw std::runtime_error("vk::Buffer::Buffer: FAILED TO CREATE BUFFER");
+
+    device.getMemoryTracker().track(allocation, MemoryTracker::categorizeBuffer(usage));
 }
 
 vk::Buffer::~Buffer()
 {
-    vkDeviceWaitIdle(device.getLogicalDevice());
-
     if (mappedMem != nullptr)
         unmap();
 
-    vmaDestroyBuffer(device.getAllocator(), buffer, allocation);
+    // Submissions may still read the buffer, as may a frame that is being recorded and only submitted later, so it is
+    // destroyed once the next submission has finished as well
+    device.getGraphicsTimeline().deferPastNextSubmit(
+        [&memory_tracker = device.getMemoryTracker(), allocator = device.getAllocator(), buffer = buffer,
+         allocation = allocation] {
+            memory_tracker.untrack(allocation);
+            vmaDestroyBuffer(allocator, buffer, allocation);
+        });
 }
 
 void vk::Buffer::map()
@@ -64,11 +73,20 @@ void vk::Buffer::write(void *data, VkDeviceSize size)
     assert(mappedMem != nullptr && "CANNOT WRITE TO NOT MAPPED BUFFER");
 
     memcpy(mappedMem, data, size);
+    FrameStats::countUpload(size);
 }
 
-void vk::Buffer::copyTo(Buffer &other, const VkDeviceSize &size)
+void vk::Buffer::read(void *data, VkDeviceSize size)
 {
-    VkCommandBuffer command_buffer = device.beginSingleTimeCommands();
+    assert(mappedMem != nullptr && "CANNOT READ FROM NOT MAPPED BUFFER");
+
+    vmaInvalidateAllocation(device.getAllocator(), allocation, 0, size);
+    memcpy(data, mappedMem, size);
+}
+
+void vk::Buffer::copyTo(Buffer &other, const VkDeviceSize &size, const std::string &name)
+{
+    VkCommandBuffer command_buffer = device.beginUploadCommands(name);
 
     VkBufferCopy copy_region = {};
     copy_region.srcOffset = 0;
@@ -76,7 +94,18 @@ void vk::Buffer::copyTo(Buffer &other, const VkDeviceSize &size)
     copy_region.size = size;
     vkCmdCopyBuffer(command_buffer, this->buffer, other.getBuffer(), 1, &copy_region);
 
-    device.endSingleTimeCommands(command_buffer);
+    // What other is used for is not known here, any later read waits for the copy
+    VkBufferMemoryBarrier2 barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+    barrier.buffer = other.getBuffer();
+    barrier.offset = 0;
+    barrier.size = size;
+
+    device.endUploadCommands(command_buffer, {barrier}, {});
 }
 
 const VkDeviceSize &vk::Buffer::getSize() const
@@ -84,6 +113,13 @@ const VkDeviceSize &vk::Buffer::getSize() const
     return size;
 }
 
+void *vk::Buffer::getMappedMemory()
+{
+    assert(mappedMem != nullptr && "CANNOT ACCESS MEMORY OF NOT MAPPED BUFFER");
+
+    return mappedMem;
+}
+
 VkBuffer &vk::Buffer::getBuffer()
 {
     return buffer;
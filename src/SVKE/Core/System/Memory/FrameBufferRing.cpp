@@ -0,0 +1,47 @@
+#include "SVKE/Core/System/Memory/FrameBufferRing.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+vk::FrameBufferRing::FrameBufferRing(Device &device, const std::string &name, const VkDeviceSize element_size,
+                                     const size_t min_capacity, const VkBufferUsageFlags usage)
+    : device(device), name(name), elementSize(element_size), minCapacity(std::max<size_t>(min_capacity, 1)),
+      usage(usage)
+{
+}
+
+const bool vk::FrameBufferRing::reserve(const int frame_index, const size_t element_count)
+{
+    assert(frame_index >= 0 && frame_index < Swapchain::MAX_FRAMES_IN_FLIGHT && "FRAME INDEX IS OUT OF BOUNDS");
+
+    auto &buffer = buffers[frame_index];
+    const VkDeviceSize required_size = std::max<size_t>(element_count, 1) * elementSize;
+
+    if (buffer && buffer->getSize() >= required_size)
+        return false;
+
+    VkDeviceSize capacity = buffer ? buffer->getSize() : minCapacity * elementSize;
+
+    while (capacity < required_size)
+        capacity *= 2;
+
+    // The previous buffer of this frame index is released once the submissions that may still read it have finished
+    buffer = std::make_unique<Buffer>(device, capacity, usage, VMA_MEMORY_USAGE_AUTO,
+                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+    buffer->map();
+
+#ifndef NDEBUG
+    std::cout << name << " BUFFER " << frame_index << " RESIZED TO " << capacity / elementSize << " ELEMENTS"
+              << std::endl;
+#endif
+
+    return true;
+}
+
+vk::Buffer &vk::FrameBufferRing::getBuffer(const int frame_index)
+{
+    assert(buffers[frame_index] && "FRAME BUFFER WAS NOT RESERVED YET");
+
+    return *buffers[frame_index];
+}
@@ -0,0 +1,191 @@
+#include "SVKE/Core/System/Memory/MemoryTracker.hpp"
+
+#include <cassert>
+#include <iostream>
+
+vk::MemoryTracker::MemoryTracker(VmaAllocator allocator)
+    : allocator(allocator), frameIndex(0), budgetThreshold(DEFAULT_BUDGET_THRESHOLD)
+{
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        categoryCounts[i] = 0;
+        categoryBytes[i] = 0;
+    }
+
+    queryHeapBudgets();
+    nearBudget.assign(heapBudgets.size(), false);
+}
+
+void vk::MemoryTracker::track(VmaAllocation allocation, const Category category)
+{
+    const size_t index = static_cast<size_t>(category);
+    assert(index < CATEGORY_COUNT && "MEMORY CATEGORY IS OUT OF BOUNDS");
+
+    // Stored off by one, so allocations without user data are not mistaken for the first category
+    vmaSetAllocationUserData(allocator, allocation, reinterpret_cast<void *>(index + 1));
+    vmaSetAllocationName(allocator, allocation, getCategoryName(category));
+
+    VmaAllocationInfo allocation_info = {};
+    vmaGetAllocationInfo(allocator, allocation, &allocation_info);
+
+    categoryCounts[index] += 1;
+    categoryBytes[index] += allocation_info.size;
+}
+
+void vk::MemoryTracker::untrack(VmaAllocation allocation)
+{
+    VmaAllocationInfo allocation_info = {};
+    vmaGetAllocationInfo(allocator, allocation, &allocation_info);
+
+    const size_t tag = reinterpret_cast<size_t>(allocation_info.pUserData);
+
+    if (tag == 0 || tag > CATEGORY_COUNT)
+        return;
+
+    categoryCounts[tag - 1] -= 1;
+    categoryBytes[tag - 1] -= allocation_info.size;
+}
+
+const vk::MemoryTracker::Category vk::MemoryTracker::categorizeBuffer(const VkBufferUsageFlags usage)
+{
+    if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+        return Category::Mesh;
+
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+        return Category::Uniform;
+
+    if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+        return Category::Storage;
+
+    if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+        return Category::Staging;
+
+    // Readback buffers
+    return Category::Other;
+}
+
+const char *vk::MemoryTracker::getCategoryName(const Category category)
+{
+    switch (category)
+    {
+    case Category::Mesh:
+        return "mesh";
+    case Category::Texture:
+        return "texture";
+    case Category::Staging:
+        return "staging";
+    case Category::Uniform:
+        return "uniform";
+    case Category::Storage:
+        return "storage";
+    case Category::Attachment:
+        return "attachment";
+    default:
+        return "other";
+    }
+}
+
+void vk::MemoryTracker::update()
+{
+    // Lets the allocator refresh its budget from the driver now and then, instead of on every query
+    vmaSetCurrentFrameIndex(allocator, ++frameIndex);
+    queryHeapBudgets();
+
+    for (uint32_t i = 0; i < heapBudgets.size(); ++i)
+    {
+        const HeapBudget &heap_budget = heapBudgets[i];
+        const double threshold_bytes = static_cast<double>(heap_budget.budget) * budgetThreshold;
+        const bool near_budget = heap_budget.budget > 0 && static_cast<double>(heap_budget.usage) >= threshold_bytes;
+
+        if (near_budget && !nearBudget[i])
+        {
+#ifndef NDEBUG
+            std::cout << "MEMORY HEAP " << i << " IS NEAR ITS BUDGET: " << heap_budget.usage << " OF "
+                      << heap_budget.budget << " BYTES" << std::endl;
+#endif
+
+            if (budgetCallback)
+                budgetCallback(i, heap_budget);
+        }
+
+        nearBudget[i] = near_budget;
+    }
+}
+
+void vk::MemoryTracker::setBudgetCallback(BudgetCallback callback, const float threshold)
+{
+    assert(threshold > 0.f && threshold <= 1.f && "BUDGET THRESHOLD MUST BE IN (0, 1]");
+
+    budgetCallback = std::move(callback);
+    budgetThreshold = threshold;
+
+    // Heaps already above the new threshold are reported at the next update
+    nearBudget.assign(heapBudgets.size(), false);
+}
+
+const std::vector<vk::MemoryTracker::HeapBudget> &vk::MemoryTracker::getHeapBudgets() const
+{
+    return heapBudgets;
+}
+
+const vk::MemoryTracker::CategoryUsage vk::MemoryTracker::getCategoryUsage(const Category category) const
+{
+    const size_t index = static_cast<size_t>(category);
+    assert(index < CATEGORY_COUNT && "MEMORY CATEGORY IS OUT OF BOUNDS");
+
+    return {categoryCounts[index].load(), categoryBytes[index].load()};
+}
+
+void vk::MemoryTracker::writeJson(std::ostream &stream, const bool detailed_map) const
+{
+    stream << "{\n";
+
+    stream << "  \"heaps\": [";
+    for (size_t i = 0; i < heapBudgets.size(); ++i)
+    {
+        stream << (i == 0 ? "\n" : ",\n") << "    {\"deviceLocal\": "
+               << (heapBudgets[i].deviceLocal ? "true" : "false") << ", \"usage\": " << heapBudgets[i].usage
+               << ", \"budget\": " << heapBudgets[i].budget << ", \"allocationBytes\": "
+               << heapBudgets[i].allocationBytes << ", \"blockBytes\": " << heapBudgets[i].blockBytes << "}";
+    }
+    stream << (heapBudgets.empty() ? "],\n" : "\n  ],\n");
+
+    stream << "  \"categories\": {";
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i)
+    {
+        const CategoryUsage usage = getCategoryUsage(static_cast<Category>(i));
+
+        stream << (i == 0 ? "\n" : ",\n") << "    \"" << getCategoryName(static_cast<Category>(i))
+               << "\": {\"allocations\": " << usage.allocationCount << ", \"bytes\": " << usage.bytes << "}";
+    }
+    stream << "\n  },\n";
+
+    char *stats_string = nullptr;
+    vmaBuildStatsString(allocator, &stats_string, detailed_map ? VK_TRUE : VK_FALSE);
+
+    stream << "  \"allocator\": " << stats_string << "\n";
+    stream << "}\n";
+
+    vmaFreeStatsString(allocator, stats_string);
+}
+
+void vk::MemoryTracker::queryHeapBudgets()
+{
+    const VkPhysicalDeviceMemoryProperties *memory_properties = nullptr;
+    vmaGetMemoryProperties(allocator, &memory_properties);
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(allocator, budgets.data());
+
+    heapBudgets.resize(memory_properties->memoryHeapCount);
+
+    for (uint32_t i = 0; i < memory_properties->memoryHeapCount; ++i)
+    {
+        HeapBudget &heap_budget = heapBudgets[i];
+        heap_budget.deviceLocal = (memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heap_budget.usage = budgets[i].usage;
+        heap_budget.budget = budgets[i].budget;
+        heap_budget.allocationBytes = budgets[i].statistics.allocationBytes;
+        heap_budget.blockBytes = budgets[i].statistics.blockBytes;
+    }
+}
@@ -0,0 +1,281 @@
+#include "SVKE/Core/System/OffscreenTarget.hpp"
+
+vk::OffscreenTarget::OffscreenTarget(Device &device, const VkExtent2D &extent, const int frames_in_flight)
+    : device(device), extent(extent), colorImage(VK_NULL_HANDLE), colorImageAllocation(VK_NULL_HANDLE),
+      colorImageView(VK_NULL_HANDLE), frameValues(frames_in_flight, 0), framesInFlight(frames_in_flight),
+      currentFrame(0), lastSubmitted(-1)
+{
+    depthFormat = findDepthFormat(device);
+
+    createImages();
+    createColorResources();
+    createDepthResources();
+    createReadbackBuffers();
+}
+
+vk::OffscreenTarget::~OffscreenTarget()
+{
+    vkDeviceWaitIdle(device.getLogicalDevice());
+
+    readbackBuffers.clear();
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        vkDestroyImageView(device.getLogicalDevice(), imageViews[i], nullptr);
+        device.destroyImage(images[i], imageAllocations[i]);
+
+        vkDestroyImageView(device.getLogicalDevice(), depthImageViews[i], nullptr);
+        device.destroyImage(depthImages[i], depthImageAllocations[i]);
+    }
+
+    if (colorImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(device.getLogicalDevice(), colorImageView, nullptr);
+        device.destroyImage(colorImage, colorImageAllocation);
+    }
+}
+
+VkResult vk::OffscreenTarget::acquireNextImage(uint32_t &image_index)
+{
+    frameTimings = {};
+    auto time_point = std::chrono::steady_clock::now();
+
+    // One image per frame in flight, so the image is free as soon as its frame's submission is
+    device.getGraphicsTimeline().wait(frameValues[currentFrame]);
+
+    frameTimings.fenceWait = FrameStats::millisecondsSince(time_point);
+
+    image_index = static_cast<uint32_t>(currentFrame);
+
+    return VK_SUCCESS;
+}
+
+void vk::OffscreenTarget::recordEndOfFrame(VkCommandBuffer &command_buffer, const uint32_t image_index)
+{
+    // The Renderer left the image in TRANSFER_SRC_OPTIMAL, only its writes have to be made visible
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = images[image_index];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(command_buffer, images[image_index], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readbackBuffers[image_index]->getBuffer(), 1, &region);
+
+    // Makes the copy available to the host once the timeline value of the frame is reached, readPixels then only has
+    // to invalidate the mapping (see Buffer::read)
+    VkBufferMemoryBarrier buffer_barrier = {};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = readbackBuffers[image_index]->getBuffer();
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+                         &buffer_barrier, 0, nullptr);
+}
+
+VkResult vk::OffscreenTarget::submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index)
+{
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &buffers;
+
+    auto time_point = std::chrono::steady_clock::now();
+
+    frameValues[currentFrame] = device.getGraphicsTimeline().submit(device.getGraphicsQueue(), submit_info);
+
+    frameTimings.submit = FrameStats::millisecondsSince(time_point);
+
+    lastSubmitted = static_cast<int>(image_index);
+    currentFrame = (currentFrame + 1) % framesInFlight;
+
+    return VK_SUCCESS;
+}
+
+VkFormat vk::OffscreenTarget::getImageFormat()
+{
+    return IMAGE_FORMAT;
+}
+
+VkFormat vk::OffscreenTarget::getDepthFormat()
+{
+    return depthFormat;
+}
+
+VkExtent2D vk::OffscreenTarget::getExtent()
+{
+    return extent;
+}
+
+const vk::FrameStats::Timings &vk::OffscreenTarget::getFrameTimings() const
+{
+    return frameTimings;
+}
+
+const bool vk::OffscreenTarget::readPixels(std::vector<uint8_t> &pixels)
+{
+    if (lastSubmitted < 0)
+        return false;
+
+    device.getGraphicsTimeline().wait(frameValues[lastSubmitted]);
+
+    pixels.resize(static_cast<size_t>(extent.width) * extent.height * BYTES_PER_PIXEL);
+    readbackBuffers[lastSubmitted]->read(pixels.data(), pixels.size());
+
+    return true;
+}
+
+VkImage vk::OffscreenTarget::getImage(const int index)
+{
+    return images[index];
+}
+
+VkImageView vk::OffscreenTarget::getImageView(const int index)
+{
+    return imageViews[index];
+}
+
+VkImage vk::OffscreenTarget::getColorImage()
+{
+    return colorImage;
+}
+
+VkImageView vk::OffscreenTarget::getColorImageView()
+{
+    return colorImageView;
+}
+
+VkImage vk::OffscreenTarget::getDepthImage(const int index)
+{
+    return depthImages[index];
+}
+
+VkImageView vk::OffscreenTarget::getDepthImageView(const int index)
+{
+    return depthImageViews[index];
+}
+
+VkImageLayout vk::OffscreenTarget::getImageLayout()
+{
+    // Nothing is presented, so the image is left ready to be copied from
+    return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+}
+
+const bool vk::OffscreenTarget::supportsImageCopy()
+{
+    return true;
+}
+
+void vk::OffscreenTarget::createImages()
+{
+    images.resize(framesInFlight);
+    imageAllocations.resize(framesInFlight);
+    imageViews.resize(framesInFlight);
+
+    for (size_t i = 0; i < images.size(); i++)
+        createImage(IMAGE_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                    VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_ASPECT_COLOR_BIT, images[i], imageAllocations[i], imageViews[i]);
+}
+
+void vk::OffscreenTarget::createColorResources()
+{
+    // Without MSAA the Renderer draws straight into the images
+    if (device.getCurrentMsaaSamples() == VK_SAMPLE_COUNT_1_BIT)
+        return;
+
+    createImage(IMAGE_FORMAT, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                device.getCurrentMsaaSamples(), VK_IMAGE_ASPECT_COLOR_BIT, colorImage, colorImageAllocation,
+                colorImageView);
+}
+
+void vk::OffscreenTarget::createDepthResources()
+{
+    depthImages.resize(images.size());
+    depthImageAllocations.resize(images.size());
+    depthImageViews.resize(images.size());
+
+    // Sampled to build the depth pyramid of the OcclusionCullingSystem
+    for (size_t i = 0; i < depthImages.size(); i++)
+        createImage(depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    device.getCurrentMsaaSamples(), VK_IMAGE_ASPECT_DEPTH_BIT, depthImages[i],
+                    depthImageAllocations[i], depthImageViews[i]);
+}
+
+void vk::OffscreenTarget::createReadbackBuffers()
+{
+    const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * BYTES_PER_PIXEL;
+
+    readbackBuffers.resize(images.size());
+
+    for (auto &buffer : readbackBuffers)
+    {
+        buffer = std::make_unique<Buffer>(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_AUTO,
+                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT);
+        buffer->map();
+    }
+}
+
+void vk::OffscreenTarget::createImage(VkFormat format, VkImageUsageFlags usage, VkSampleCountFlagBits samples,
+                                      VkImageAspectFlags aspect, VkImage &image, VmaAllocation &allocation,
+                                      VkImageView &view)
+{
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent.width = extent.width;
+    image_info.extent.height = extent.height;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.format = format;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = usage;
+    image_info.samples = samples;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.flags = 0;
+
+    device.createImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, allocation);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = aspect;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &view) != VK_SUCCESS)
+        throw std::runtime_error("vk::OffscreenTarget::createImage: FAILED TO CREATE IMAGE VIEW");
+}
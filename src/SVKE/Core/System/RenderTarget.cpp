@@ -0,0 +1,29 @@
+#include "SVKE/Core/System/RenderTarget.hpp"
+
+void vk::RenderTarget::recordEndOfFrame(VkCommandBuffer &command_buffer, const uint32_t image_index)
+{
+}
+
+const uint32_t vk::RenderTarget::getWidth()
+{
+    return getExtent().width;
+}
+
+const uint32_t vk::RenderTarget::getHeight()
+{
+    return getExtent().height;
+}
+
+const float vk::RenderTarget::getExtentAspectRatio()
+{
+    const VkExtent2D extent = getExtent();
+    return static_cast<float>(extent.width) / static_cast<float>(extent.height);
+}
+
+VkFormat vk::RenderTarget::findDepthFormat(Device &device)
+{
+    return device.findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+                                      VK_IMAGE_TILING_OPTIMAL,
+                                      VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+}
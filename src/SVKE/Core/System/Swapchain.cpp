@@ -1,68 +1,92 @@
 #include "SVKE/Core/System/Swapchain.hpp"
 
-vk::Swapchain::Swapchain(Device &device, Window &window, const PresentMode &preferred_present_mode)
-    : device(device), window(window), currentFrame(0)
+vk::Swapchain::Swapchain(Device &device, Window &window, const PresentMode &preferred_present_mode,
+                         const int frames_in_flight)
+    : device(device), window(window), colorAttachment{}, acquiredImageCount(0), framesInFlight(frames_in_flight),
+      currentFrame(0)
 {
     init(preferred_present_mode);
 }
 
 vk::Swapchain::Swapchain(Device &device, Window &window, std::shared_ptr<Swapchain> &previous,
-                         const PresentMode &preferred_present_mode)
-    : device(device), window(window), oldSwapchain(previous), currentFrame(0)
+                         const PresentMode &preferred_present_mode, const int frames_in_flight)
+    : device(device), window(window), colorAttachment{}, oldSwapchain(previous), acquiredImageCount(0),
+      framesInFlight(frames_in_flight), currentFrame(0)
 {
+    // The previous swapchain is not waited for, frame slots are only reused once their last submission has finished
+    if (previous->framesInFlight == framesInFlight)
+    {
+        frameValues = previous->frameValues;
+        currentFrame = previous->currentFrame;
+    }
+    else
+    {
+        device.getGraphicsTimeline().wait(device.getGraphicsTimeline().getSubmittedValue());
+    }
+
     init(preferred_present_mode);
 
+    // The previous swapchain is destroyed right after, its handles are released by this one
+    retiredSwapchains = std::move(previous->retiredSwapchains);
+    previous->retiredSwapchains.clear();
+    retiredSwapchains.push_back(previous->retire());
+
     // Give up ownership
     oldSwapchain = nullptr;
 }
 
 vk::Swapchain::~Swapchain()
 {
-    vkDeviceWaitIdle(device.getLogicalDevice());
+    // Frames in flight may still render to this swapchain, so nothing is destroyed before they have finished and
+    // the device does not have to go idle
+    AttachmentPool &attachment_pool = device.getAttachmentPool();
 
-    for (auto imageView : imageViews)
-    {
-        vkDestroyImageView(device.getLogicalDevice(), imageView, nullptr);
-    }
+    if (colorAttachment.image != VK_NULL_HANDLE)
+        attachment_pool.release(colorAttachment);
 
-    if (swapchain != nullptr)
-    {
-        vkDestroySwapchainKHR(device.getLogicalDevice(), swapchain, nullptr);
-        swapchain = nullptr;
-    }
+    for (const auto &depth_attachment : depthAttachments)
+        attachment_pool.release(depth_attachment);
 
-    for (int i = 0; i < depthImages.size(); i++)
-    {
-        vkDestroyImageView(device.getLogicalDevice(), depthImageViews[i], nullptr);
-        vmaDestroyImage(device.getAllocator(), depthImages[i], depthImageAllocations[i]);
-    }
+    // Handed over to a swapchain that replaced this one
+    if (swapchain == VK_NULL_HANDLE)
+        return;
 
-    vkDestroyImageView(device.getLogicalDevice(), colorImageView, nullptr);
-    vmaDestroyImage(device.getAllocator(), colorImage, colorImageAllocation);
+    std::vector<Retired> retired = std::move(retiredSwapchains);
+    retired.push_back(retire());
 
-    for (auto framebuffer : framebuffers)
-    {
-        vkDestroyFramebuffer(device.getLogicalDevice(), framebuffer, nullptr);
-    }
+    // Nothing replaces this swapchain, so its presentations are waited for once the timeline has passed its frames
+    device.getGraphicsTimeline().defer([logical_device = device.getLogicalDevice(),
+                                        present_queue = device.getPresentQueue(), retired = std::move(retired)] {
+        bool has_present_fences = true;
 
-    vkDestroyRenderPass(device.getLogicalDevice(), renderPass, nullptr);
+        for (const auto &retired_swapchain : retired)
+        {
+            has_present_fences = has_present_fences && !retired_swapchain.presentFences.empty();
 
-    // cleanup synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        vkDestroySemaphore(device.getLogicalDevice(), renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(device.getLogicalDevice(), imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(device.getLogicalDevice(), inFlightFences[i], nullptr);
-    }
+            if (!retired_swapchain.presentFences.empty())
+            {
+                vkWaitForFences(logical_device, static_cast<uint32_t>(retired_swapchain.presentFences.size()),
+                                retired_swapchain.presentFences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+            }
+        }
+
+        if (!has_present_fences)
+            vkQueueWaitIdle(present_queue);
+
+        for (const auto &retired_swapchain : retired)
+            destroyRetired(logical_device, retired_swapchain);
+    });
 }
 
 VkResult vk::Swapchain::submitCommandBuffers(const VkCommandBuffer &buffers, uint32_t &image_index)
 {
-    if (imagesInFlight[image_index] != VK_NULL_HANDLE)
-    {
-        vkWaitForFences(device.getLogicalDevice(), 1, &imagesInFlight[image_index], VK_TRUE, UINT64_MAX);
-    }
-    imagesInFlight[image_index] = inFlightFences[currentFrame];
+    auto time_point = std::chrono::steady_clock::now();
+
+    // Only the submission that last rendered to this image has to be finished, not a whole frame slot
+    if (imageValues[image_index] != 0)
+        device.getGraphicsTimeline().wait(imageValues[image_index]);
+
+    frameTimings.fenceWait += FrameStats::millisecondsSince(time_point);
 
     VkSubmitInfo submit_info = {};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -80,9 +104,13 @@ VkResult vk::Swapchain::submitCommandBuffers(const VkCommandBuffer &buffers, uin
     submit_info.signalSemaphoreCount = 1;
     submit_info.pSignalSemaphores = signal_semaphores;
 
-    vkResetFences(device.getLogicalDevice(), 1, &inFlightFences[currentFrame]);
-    if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submit_info, inFlightFences[currentFrame]) != VK_SUCCESS)
-        throw std::runtime_error("vk::Swapchain::submitCommandBuffers: FAILED TO SUBMIT COMMAND BUFFER");
+    time_point = std::chrono::steady_clock::now();
+
+    const uint64_t value = device.getGraphicsTimeline().submit(device.getGraphicsQueue(), submit_info);
+    frameValues[currentFrame] = value;
+    imageValues[image_index] = value;
+
+    frameTimings.submit = FrameStats::millisecondsSince(time_point);
 
     VkPresentInfoKHR present_info = {};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -96,29 +124,62 @@ VkResult vk::Swapchain::submitCommandBuffers(const VkCommandBuffer &buffers, uin
 
     present_info.pImageIndices = &image_index;
 
+    // The slot's previous presentation has long been waited for by the timeline, this rarely blocks
+    VkSwapchainPresentFenceInfoEXT present_fence_info = {};
+    if (!presentFences.empty())
+    {
+        vkWaitForFences(device.getLogicalDevice(), 1, &presentFences[currentFrame], VK_TRUE,
+                        std::numeric_limits<uint64_t>::max());
+        vkResetFences(device.getLogicalDevice(), 1, &presentFences[currentFrame]);
+
+        present_fence_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT;
+        present_fence_info.swapchainCount = 1;
+        present_fence_info.pFences = &presentFences[currentFrame];
+        present_info.pNext = &present_fence_info;
+    }
+
+    time_point = std::chrono::steady_clock::now();
+
     auto result = vkQueuePresentKHR(device.getPresentQueue(), &present_info);
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    frameTimings.present = FrameStats::millisecondsSince(time_point);
+
+    currentFrame = (currentFrame + 1) % framesInFlight;
 
     return result;
 }
 
 VkResult vk::Swapchain::acquireNextImage(uint32_t &image_index)
 {
-    vkWaitForFences(device.getLogicalDevice(), 1, &inFlightFences[currentFrame], VK_TRUE,
-                    std::numeric_limits<uint64_t>::max());
+    frameTimings = {};
+    auto time_point = std::chrono::steady_clock::now();
+
+    device.getGraphicsTimeline().wait(frameValues[currentFrame]);
+
+    frameTimings.fenceWait = FrameStats::millisecondsSince(time_point);
+    time_point = std::chrono::steady_clock::now();
 
     VkResult result = vkAcquireNextImageKHR(device.getLogicalDevice(), swapchain, std::numeric_limits<uint64_t>::max(),
                                             imageAvailableSemaphores[currentFrame], // must be a not signaled semaphore
                                             VK_NULL_HANDLE, &image_index);
 
+    frameTimings.acquire = FrameStats::millisecondsSince(time_point);
+
+    if ((result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) && !acquiredImages[image_index])
+    {
+        acquiredImages[image_index] = true;
+        acquiredImageCount += 1;
+    }
+
+    if (!retiredSwapchains.empty())
+        releaseRetired();
+
     return result;
 }
 
-VkFormat vk::Swapchain::findDepthFormat()
+const vk::FrameStats::Timings &vk::Swapchain::getFrameTimings() const
 {
-    return device.findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-                                      VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    return frameTimings;
 }
 
 const bool vk::Swapchain::compatibleWith(Swapchain &other) const
@@ -131,16 +192,6 @@ VkSwapchainKHR vk::Swapchain::getHandle()
     return swapchain;
 }
 
-VkFramebuffer vk::Swapchain::getFramebuffer(const int index)
-{
-    return framebuffers[index];
-}
-
-VkRenderPass vk::Swapchain::getRenderPass()
-{
-    return renderPass;
-}
-
 VkImageView vk::Swapchain::getImageView(const int index)
 {
     return imageViews[index];
@@ -166,29 +217,47 @@ VkExtent2D vk::Swapchain::getExtent()
     return extent;
 }
 
-const float vk::Swapchain::getExtentAspectRatio()
+VkImage vk::Swapchain::getImage(const int index)
+{
+    return images[index];
+}
+
+VkImage vk::Swapchain::getColorImage()
+{
+    return colorAttachment.image;
+}
+
+VkImageView vk::Swapchain::getColorImageView()
+{
+    return colorAttachment.view;
+}
+
+VkImage vk::Swapchain::getDepthImage(const int index)
+{
+    return depthAttachments[index].image;
+}
+
+VkImageView vk::Swapchain::getDepthImageView(const int index)
 {
-    return static_cast<float>(extent.width) / static_cast<float>(extent.height);
+    return depthAttachments[index].view;
 }
 
-const uint32_t vk::Swapchain::getWidth()
+VkImageLayout vk::Swapchain::getImageLayout()
 {
-    return extent.width;
+    return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 }
 
-const uint32_t vk::Swapchain::getHeight()
+const bool vk::Swapchain::supportsImageCopy()
 {
-    return extent.height;
+    return (imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
 }
 
 void vk::Swapchain::init(const PresentMode &preferred_present_mode)
 {
     createSwapchain(preferred_present_mode);
     createImageViews();
-    createRenderPass();
     createColorResources();
     createDepthResources();
-    createFramebuffers();
     createSyncObjects();
 }
 
@@ -213,7 +282,13 @@ void vk::Swapchain::createSwapchain(const PresentMode &preferred_present_mode)
     swapchain_info.imageColorSpace = surfaceFormat.colorSpace;
     swapchain_info.imageExtent = extent;
     swapchain_info.imageArrayLayers = 1;
-    swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    // Copying out of the images is only needed for frame capture, so it is optional
+    imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (swapchainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+        imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    swapchain_info.imageUsage = imageUsage;
 
     Device::QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
     uint32_t queueFamilyIndices[] = {*indices.graphicsFamily, *indices.presentFamily};
@@ -276,226 +351,127 @@ void vk::Swapchain::createImageViews()
     }
 }
 
-void vk::Swapchain::createRenderPass()
-{
-    VkAttachmentDescription depth_attachment{};
-    depth_attachment.format = findDepthFormat();
-    depth_attachment.samples = device.getCurrentMsaaSamples();
-    depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference depth_attachment_ref{};
-    depth_attachment_ref.attachment = 1;
-    depth_attachment_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentDescription color_attachment = {};
-    color_attachment.format = getImageFormat();
-    color_attachment.samples = device.getCurrentMsaaSamples();
-    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT
-                                       ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-                                       : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference color_attachment_ref = {};
-    color_attachment_ref.attachment = 0;
-    color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentDescription color_attachment_resolve{};
-    color_attachment_resolve.format = getImageFormat();
-    color_attachment_resolve.samples = VK_SAMPLE_COUNT_1_BIT;
-    color_attachment_resolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color_attachment_resolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    color_attachment_resolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color_attachment_resolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color_attachment_resolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment_resolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference color_attachment_resolve_ref{};
-    color_attachment_resolve_ref.attachment = 2;
-    color_attachment_resolve_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass = {};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &color_attachment_ref;
-    subpass.pDepthStencilAttachment = &depth_attachment_ref;
-
-    if (device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT)
-        subpass.pResolveAttachments = &color_attachment_resolve_ref;
-
-    VkSubpassDependency dependency = {};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.srcAccessMask = 0;
-    dependency.srcStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstSubpass = 0;
-    dependency.dstStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-    std::vector<VkAttachmentDescription> attachments = {color_attachment, depth_attachment};
-
-    if (device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT)
-        attachments.push_back(color_attachment_resolve);
-
-    VkRenderPassCreateInfo render_pass_info = {};
-    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
-    render_pass_info.pAttachments = attachments.data();
-    render_pass_info.subpassCount = 1;
-    render_pass_info.pSubpasses = &subpass;
-    render_pass_info.dependencyCount = 1;
-    render_pass_info.pDependencies = &dependency;
-
-    if (vkCreateRenderPass(device.getLogicalDevice(), &render_pass_info, nullptr, &renderPass) != VK_SUCCESS)
-        throw std::runtime_error("vk::Swapchain::createRenderPass: FAILED TO CREATE RENDER PASS");
-}
-
-void vk::Swapchain::createFramebuffers()
-{
-    framebuffers.resize(getImageCount());
-
-    for (size_t i = 0; i < getImageCount(); i++)
-    {
-        std::vector<VkImageView> attachments;
-
-        if (device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT)
-            attachments = {colorImageView, depthImageViews[i], imageViews[i]};
-        else
-            attachments = {imageViews[i], depthImageViews[i]};
-
-        VkExtent2D swapchain_extent = getExtent();
-        VkFramebufferCreateInfo framebuffer_info = {};
-        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebuffer_info.renderPass = renderPass;
-        framebuffer_info.attachmentCount = static_cast<uint32_t>(attachments.size());
-        framebuffer_info.pAttachments = attachments.data();
-        framebuffer_info.width = swapchain_extent.width;
-        framebuffer_info.height = swapchain_extent.height;
-        framebuffer_info.layers = 1;
-
-        if (vkCreateFramebuffer(device.getLogicalDevice(), &framebuffer_info, nullptr, &framebuffers[i]) != VK_SUCCESS)
-            throw std::runtime_error("vk::Swapchain::createFramebuffers: FAILED TO CREATE FRAMEBUFFERS");
-    }
-}
-
 void vk::Swapchain::createColorResources()
 {
-    auto color_format = this->imageFormat;
-    VkExtent2D swapchain_extent = getExtent();
-
-    VkImageCreateInfo image_info{};
-    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    image_info.imageType = VK_IMAGE_TYPE_2D;
-    image_info.extent.width = swapchain_extent.width;
-    image_info.extent.height = swapchain_extent.height;
-    image_info.extent.depth = 1;
-    image_info.mipLevels = 1;
-    image_info.arrayLayers = 1;
-    image_info.format = color_format;
-    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-    image_info.samples = device.getCurrentMsaaSamples();
-    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    image_info.flags = 0;
-
-    device.createImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, colorImage, colorImageAllocation);
-
-    VkImageViewCreateInfo view_info{};
-    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    view_info.image = colorImage;
-    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    view_info.format = color_format;
-    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    view_info.subresourceRange.baseMipLevel = 0;
-    view_info.subresourceRange.levelCount = 1;
-    view_info.subresourceRange.baseArrayLayer = 0;
-    view_info.subresourceRange.layerCount = 1;
-
-    if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &colorImageView) != VK_SUCCESS)
-        throw std::runtime_error("vk::Swapchain::createColorResources: FAILED TO CREATE COLOR IMAGE VIEW");
+    if (device.getCurrentMsaaSamples() == VK_SAMPLE_COUNT_1_BIT)
+        return;
+
+    colorAttachment = device.getAttachmentPool().acquire(
+        imageFormat, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        device.getCurrentMsaaSamples(), VK_IMAGE_ASPECT_COLOR_BIT, getExtent());
 }
 
 void vk::Swapchain::createDepthResources()
 {
-    depthFormat = findDepthFormat();
-    VkExtent2D swapchain_extent = getExtent();
+    depthFormat = findDepthFormat(device);
+    depthAttachments.resize(getImageCount());
 
-    depthImages.resize(getImageCount());
-    depthImageAllocations.resize(getImageCount());
-    depthImageViews.resize(getImageCount());
-
-    for (int i = 0; i < depthImages.size(); i++)
+    for (auto &depth_attachment : depthAttachments)
     {
-        VkImageCreateInfo image_info{};
-        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        image_info.imageType = VK_IMAGE_TYPE_2D;
-        image_info.extent.width = swapchain_extent.width;
-        image_info.extent.height = swapchain_extent.height;
-        image_info.extent.depth = 1;
-        image_info.mipLevels = 1;
-        image_info.arrayLayers = 1;
-        image_info.format = depthFormat;
-        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-        image_info.samples = device.getCurrentMsaaSamples();
-        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        image_info.flags = 0;
-
-        device.createImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImages[i],
-                                   depthImageAllocations[i]);
-
-        VkImageViewCreateInfo view_info{};
-        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        view_info.image = depthImages[i];
-        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        view_info.format = depthFormat;
-        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        view_info.subresourceRange.baseMipLevel = 0;
-        view_info.subresourceRange.levelCount = 1;
-        view_info.subresourceRange.baseArrayLayer = 0;
-        view_info.subresourceRange.layerCount = 1;
-
-        if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &depthImageViews[i]) != VK_SUCCESS)
-            throw std::runtime_error("vk::Swapchain::createDepthResources: FAILED TO CREATE DEPTH IMAGE VIEW");
+        // Sampled to build the depth pyramid of the OcclusionCullingSystem
+        depth_attachment = device.getAttachmentPool().acquire(
+            depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            device.getCurrentMsaaSamples(), VK_IMAGE_ASPECT_DEPTH_BIT, getExtent());
     }
 }
 
 void vk::Swapchain::createSyncObjects()
 {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(getImageCount(), VK_NULL_HANDLE);
+    imageAvailableSemaphores.resize(framesInFlight);
+    renderFinishedSemaphores.resize(framesInFlight);
+    frameValues.resize(framesInFlight, 0);
+    imageValues.resize(getImageCount(), 0);
+    acquiredImages.resize(getImageCount(), false);
 
     VkSemaphoreCreateInfo semaphore_info = {};
     semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fence_info = {};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (int i = 0; i < framesInFlight; i++)
     {
         if (vkCreateSemaphore(device.getLogicalDevice(), &semaphore_info, nullptr, &imageAvailableSemaphores[i]) !=
                 VK_SUCCESS ||
             vkCreateSemaphore(device.getLogicalDevice(), &semaphore_info, nullptr, &renderFinishedSemaphores[i]) !=
-                VK_SUCCESS ||
-            vkCreateFence(device.getLogicalDevice(), &fence_info, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+                VK_SUCCESS)
         {
             throw std::runtime_error("vk::Swapchain::createSyncObjects: FAILED TO CREATE SYNCRONIZATION OBJECTS");
         }
     }
+
+    if (!device.hasSwapchainMaintenance1())
+        return;
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    presentFences.resize(framesInFlight);
+
+    for (int i = 0; i < framesInFlight; i++)
+    {
+        if (vkCreateFence(device.getLogicalDevice(), &fence_info, nullptr, &presentFences[i]) != VK_SUCCESS)
+            throw std::runtime_error("vk::Swapchain::createSyncObjects: FAILED TO CREATE PRESENT FENCE");
+    }
+}
+
+vk::Swapchain::Retired vk::Swapchain::retire()
+{
+    Retired retired;
+    retired.swapchain = swapchain;
+    retired.imageViews = std::move(imageViews);
+    retired.semaphores = std::move(imageAvailableSemaphores);
+    retired.semaphores.insert(retired.semaphores.end(), renderFinishedSemaphores.begin(),
+                              renderFinishedSemaphores.end());
+    retired.presentFences = std::move(presentFences);
+    retired.value = device.getGraphicsTimeline().getSubmittedValue();
+
+    swapchain = VK_NULL_HANDLE;
+    imageViews.clear();
+    imageAvailableSemaphores.clear();
+    renderFinishedSemaphores.clear();
+    presentFences.clear();
+
+    return retired;
+}
+
+void vk::Swapchain::releaseRetired()
+{
+    Timeline &timeline = device.getGraphicsTimeline();
+    const bool all_images_acquired = acquiredImageCount == images.size();
+
+    for (auto it = retiredSwapchains.begin(); it != retiredSwapchains.end();)
+    {
+        bool released = timeline.isComplete(it->value);
+
+        if (released && it->presentFences.empty())
+            released = all_images_acquired;
+
+        for (size_t i = 0; released && i < it->presentFences.size(); ++i)
+            released = vkGetFenceStatus(device.getLogicalDevice(), it->presentFences[i]) == VK_SUCCESS;
+
+        if (released)
+        {
+            destroyRetired(device.getLogicalDevice(), *it);
+            it = retiredSwapchains.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void vk::Swapchain::destroyRetired(VkDevice logical_device, const Retired &retired)
+{
+    for (auto image_view : retired.imageViews)
+        vkDestroyImageView(logical_device, image_view, nullptr);
+
+    vkDestroySwapchainKHR(logical_device, retired.swapchain, nullptr);
+
+    for (auto semaphore : retired.semaphores)
+        vkDestroySemaphore(logical_device, semaphore, nullptr);
+
+    for (auto fence : retired.presentFences)
+        vkDestroyFence(logical_device, fence, nullptr);
 }
 
 VkSurfaceFormatKHR vk::Swapchain::chooseSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &available_formats)
@@ -0,0 +1,194 @@
+#include "SVKE/Core/System/Timeline.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+vk::Timeline::Timeline(VkDevice device)
+    : device(device), semaphore(VK_NULL_HANDLE), submittedValue(0), completedValue(0)
+{
+    VkSemaphoreTypeCreateInfo type_info = {};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphore_info = {};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+
+    if (vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore) != VK_SUCCESS)
+        throw std::runtime_error("vk::Timeline::Timeline: FAILED TO CREATE TIMELINE SEMAPHORE");
+}
+
+vk::Timeline::~Timeline()
+{
+    flush();
+
+    vkDestroySemaphore(device, semaphore, nullptr);
+}
+
+const uint64_t vk::Timeline::submit(VkQueue queue, const VkSubmitInfo &submit_info,
+                                    const std::vector<Wait> &timeline_waits)
+{
+    // Values have to be handed out in the order the submissions reach the queue
+    std::lock_guard<std::mutex> lock(submitMutex);
+
+    const uint64_t value = submittedValue.load(std::memory_order_relaxed) + 1;
+
+    std::vector<VkSemaphore> signal_semaphores(submit_info.pSignalSemaphores,
+                                               submit_info.pSignalSemaphores + submit_info.signalSemaphoreCount);
+    signal_semaphores.push_back(semaphore);
+
+    // Ignored for the binary semaphores
+    std::vector<uint64_t> signal_values(signal_semaphores.size(), 0);
+    signal_values.back() = value;
+
+    std::vector<VkSemaphore> wait_semaphores(submit_info.pWaitSemaphores,
+                                             submit_info.pWaitSemaphores + submit_info.waitSemaphoreCount);
+    std::vector<VkPipelineStageFlags> wait_stages(submit_info.pWaitDstStageMask,
+                                                  submit_info.pWaitDstStageMask + submit_info.waitSemaphoreCount);
+    std::vector<uint64_t> wait_values(wait_semaphores.size(), 0);
+
+    for (const auto &wait : timeline_waits)
+    {
+        assert(wait.timeline != this && "A TIMELINE CANNOT WAIT FOR ITSELF");
+
+        wait_semaphores.push_back(wait.timeline->getHandle());
+        wait_stages.push_back(wait.stages);
+        wait_values.push_back(wait.value);
+    }
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(wait_values.size());
+    timeline_info.pWaitSemaphoreValues = wait_values.data();
+    timeline_info.signalSemaphoreValueCount = static_cast<uint32_t>(signal_values.size());
+    timeline_info.pSignalSemaphoreValues = signal_values.data();
+
+    VkSubmitInfo timeline_submit_info = submit_info;
+    timeline_submit_info.pNext = &timeline_info;
+    timeline_submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+    timeline_submit_info.pWaitSemaphores = wait_semaphores.data();
+    timeline_submit_info.pWaitDstStageMask = wait_stages.data();
+    timeline_submit_info.signalSemaphoreCount = static_cast<uint32_t>(signal_semaphores.size());
+    timeline_submit_info.pSignalSemaphores = signal_semaphores.data();
+
+    if (vkQueueSubmit(queue, 1, &timeline_submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("vk::Timeline::submit: FAILED TO SUBMIT COMMAND BUFFER");
+
+    submittedValue.store(value, std::memory_order_release);
+
+    return value;
+}
+
+const uint64_t vk::Timeline::getSubmittedValue() const
+{
+    return submittedValue.load(std::memory_order_acquire);
+}
+
+const uint64_t vk::Timeline::getCompletedValue()
+{
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device, semaphore, &value);
+
+    advanceCompletedValue(value);
+
+    return value;
+}
+
+const bool vk::Timeline::isComplete(const uint64_t value)
+{
+    // Only asks the driver if the last known value is not enough
+    if (value <= completedValue.load(std::memory_order_relaxed))
+        return true;
+
+    return value <= getCompletedValue();
+}
+
+void vk::Timeline::wait(const uint64_t value)
+{
+    if (isComplete(value))
+        return;
+
+    VkSemaphoreWaitInfo wait_info = {};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &semaphore;
+    wait_info.pValues = &value;
+
+    if (vkWaitSemaphores(device, &wait_info, UINT64_MAX) != VK_SUCCESS)
+        throw std::runtime_error("vk::Timeline::wait: FAILED TO WAIT FOR TIMELINE SEMAPHORE");
+
+    advanceCompletedValue(value);
+}
+
+void vk::Timeline::defer(std::function<void()> release)
+{
+    std::lock_guard<std::mutex> lock(deferredMutex);
+    deferred.emplace_back(getSubmittedValue(), std::move(release));
+}
+
+void vk::Timeline::deferPastNextSubmit(std::function<void()> release)
+{
+    // Under the submit lock, so no submission slips in between and the release waits for the one after it
+    std::lock_guard<std::mutex> submit_lock(submitMutex);
+    std::lock_guard<std::mutex> lock(deferredMutex);
+    deferred.emplace_back(submittedValue.load(std::memory_order_relaxed) + 1, std::move(release));
+}
+
+void vk::Timeline::collect()
+{
+    std::deque<std::pair<uint64_t, std::function<void()>>> released;
+
+    {
+        std::lock_guard<std::mutex> lock(deferredMutex);
+
+        // Deferred in submission order, so the values only grow, except past the next submission: a release after
+        // one of those waits for it, which is late but never early
+        while (!deferred.empty() && isComplete(deferred.front().first))
+        {
+            released.push_back(std::move(deferred.front()));
+            deferred.pop_front();
+        }
+    }
+
+    // Outside the lock, releasing may defer again
+    for (auto &[_, release] : released)
+        release();
+}
+
+void vk::Timeline::flush()
+{
+    wait(getSubmittedValue());
+
+    // Including what waits for a submission that will not come
+    while (true)
+    {
+        std::deque<std::pair<uint64_t, std::function<void()>>> released;
+
+        {
+            std::lock_guard<std::mutex> lock(deferredMutex);
+            released.swap(deferred);
+        }
+
+        if (released.empty())
+            break;
+
+        for (auto &[_, release] : released)
+            release();
+    }
+}
+
+VkSemaphore vk::Timeline::getHandle()
+{
+    return semaphore;
+}
+
+void vk::Timeline::advanceCompletedValue(const uint64_t value)
+{
+    // Several threads may wait, a smaller value they saw must not replace a larger one
+    uint64_t completed = completedValue.load(std::memory_order_relaxed);
+    while (completed < value && !completedValue.compare_exchange_weak(completed, value, std::memory_order_relaxed))
+    {
+    }
+}
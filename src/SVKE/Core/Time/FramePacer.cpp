@@ -0,0 +1,169 @@
+#include "SVKE/Core/Time/FramePacer.hpp"
+#include "SVKE/Core/Time/Profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+vk::FramePacer::FramePacer(Timeline &timeline, FrameStats &frame_stats)
+    : timeline(timeline), frameStats(frame_stats), lowLatency(false), inputSampled(false), previousValue(0),
+      lastValue(0), gpuEstimate(0.0), cpuEstimate(0.0), stopping(false)
+{
+    watcher = std::thread(&FramePacer::watcherLoop, this);
+}
+
+vk::FramePacer::~FramePacer()
+{
+    // Only submitted values are pending, so the watcher always gets to see the stop
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+    watcher.join();
+}
+
+void vk::FramePacer::wait()
+{
+    collect();
+
+    if (lowLatency && lastValue > 0)
+    {
+        SVKE_PROFILE_SCOPE("FramePacer::wait");
+
+        // Only the last frame may be left on the GPU, then it starts either now or when it was submitted
+        const bool gpu_busy = !timeline.isComplete(previousValue);
+
+        timeline.wait(previousValue);
+
+        const Clock::time_point gpu_start = gpu_busy ? Clock::now() : lastSubmitTime;
+        const double lead = gpuEstimate - cpuEstimate - SLACK_MILLISECONDS;
+
+        if (lead > 0.0)
+            sleepUntil(gpu_start + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double, std::milli>(lead)));
+    }
+
+    inputTime = Clock::now();
+    inputSampled = true;
+}
+
+void vk::FramePacer::submitted(const uint64_t timeline_value)
+{
+    const Clock::time_point now = Clock::now();
+
+    // Frames whose input was not sampled through wait have no latency to measure
+    if (inputSampled)
+    {
+        const double cpu_milliseconds = std::chrono::duration<double, std::milli>(now - inputTime).count();
+        cpuEstimate =
+            cpuEstimate == 0.0 ? cpu_milliseconds : cpuEstimate + SMOOTHING * (cpu_milliseconds - cpuEstimate);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back({timeline_value, inputTime, now});
+        }
+
+        condition.notify_one();
+    }
+
+    inputSampled = false;
+    previousValue = lastValue;
+    lastValue = timeline_value;
+    lastSubmitTime = now;
+}
+
+void vk::FramePacer::setLowLatency(const bool low_latency)
+{
+    lowLatency = low_latency;
+}
+
+const bool vk::FramePacer::isLowLatency() const
+{
+    return lowLatency;
+}
+
+const double vk::FramePacer::getGpuEstimate() const
+{
+    return gpuEstimate;
+}
+
+const double vk::FramePacer::getCpuEstimate() const
+{
+    return cpuEstimate;
+}
+
+void vk::FramePacer::watcherLoop()
+{
+    SVKE_PROFILE_THREAD("Frame pacer");
+
+    Clock::time_point previous_completion = {};
+
+    while (true)
+    {
+        PendingFrame frame;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !pending.empty(); });
+
+            if (pending.empty())
+                return;
+
+            frame = pending.front();
+        }
+
+        try
+        {
+            timeline.wait(frame.timelineValue);
+        }
+        catch (const std::runtime_error &error)
+        {
+            std::cerr << error.what() << std::endl;
+            return;
+        }
+
+        const Clock::time_point completion = Clock::now();
+
+        // The GPU started the frame when it was submitted, or when the frame before it was done if that was later
+        const Clock::time_point gpu_start = std::max(frame.submitTime, previous_completion);
+        previous_completion = completion;
+
+        CompletedFrame result = {};
+        result.gpuMilliseconds = std::chrono::duration<double, std::milli>(completion - gpu_start).count();
+        result.gpuCompletionLatencyMilliseconds =
+            std::chrono::duration<double, std::milli>(completion - frame.inputTime).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.pop_front();
+        completed.push_back(result);
+    }
+}
+
+void vk::FramePacer::collect()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &frame : completed)
+    {
+        gpuEstimate = gpuEstimate == 0.0 ? frame.gpuMilliseconds
+                                         : gpuEstimate + SMOOTHING * (frame.gpuMilliseconds - gpuEstimate);
+
+        frameStats.recordGpuCompletionLatency(frame.gpuCompletionLatencyMilliseconds);
+    }
+
+    completed.clear();
+}
+
+void vk::FramePacer::sleepUntil(const Clock::time_point &time_point)
+{
+    // Sleeping is only accurate to about a millisecond, the rest is spent yielding
+    constexpr auto spin = std::chrono::milliseconds(1);
+
+    if (time_point - Clock::now() > spin)
+        std::this_thread::sleep_until(time_point - spin);
+
+    while (Clock::now() < time_point)
+        std::this_thread::yield();
+}
@@ -0,0 +1,226 @@
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+vk::FrameStats::Counters vk::FrameStats::counters;
+
+vk::FrameStats::FrameStats() : hasPreviousFrame(false)
+{
+    frameTimes.clear();
+    gpuCompletionLatencies.clear();
+}
+
+void vk::FrameStats::beginRecording()
+{
+    recordingBegin = std::chrono::steady_clock::now();
+}
+
+void vk::FrameStats::endRecording()
+{
+    lastFrame.cpuMilliseconds = millisecondsSince(recordingBegin);
+}
+
+void vk::FrameStats::endFrame(const Timings &timings)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    lastFrame.timings = timings;
+    lastFrame.drawCalls = counters.drawCalls.exchange(0, std::memory_order_relaxed);
+    lastFrame.triangles = counters.triangles.exchange(0, std::memory_order_relaxed);
+    lastFrame.pipelineBinds = counters.pipelineBinds.exchange(0, std::memory_order_relaxed);
+    lastFrame.descriptorBinds = counters.descriptorBinds.exchange(0, std::memory_order_relaxed);
+    lastFrame.vertexBufferBinds = counters.vertexBufferBinds.exchange(0, std::memory_order_relaxed);
+    lastFrame.barriers = counters.barriers.exchange(0, std::memory_order_relaxed);
+    lastFrame.uploadBytes = counters.uploadBytes.exchange(0, std::memory_order_relaxed);
+
+    // The first frame has no previous present to measure from
+    if (!hasPreviousFrame)
+    {
+        hasPreviousFrame = true;
+        previousFrameEnd = now;
+        return;
+    }
+
+    lastFrame.frameMilliseconds = std::chrono::duration<double, std::milli>(now - previousFrameEnd).count();
+    previousFrameEnd = now;
+
+    frameTimes.add(lastFrame.frameMilliseconds);
+
+    totals.cpuMilliseconds += lastFrame.cpuMilliseconds;
+    totals.timings.fenceWait += timings.fenceWait;
+    totals.timings.acquire += timings.acquire;
+    totals.timings.submit += timings.submit;
+    totals.timings.present += timings.present;
+    totals.drawCalls += lastFrame.drawCalls;
+    totals.triangles += lastFrame.triangles;
+    totals.pipelineBinds += lastFrame.pipelineBinds;
+    totals.descriptorBinds += lastFrame.descriptorBinds;
+    totals.vertexBufferBinds += lastFrame.vertexBufferBinds;
+    totals.barriers += lastFrame.barriers;
+    totals.uploadBytes += lastFrame.uploadBytes;
+}
+
+void vk::FrameStats::recordGpuCompletionLatency(const double milliseconds)
+{
+    gpuCompletionLatencies.add(milliseconds);
+}
+
+void vk::FrameStats::reset()
+{
+    frameTimes.clear();
+    gpuCompletionLatencies.clear();
+    totals = {};
+}
+
+const vk::FrameStats::Frame &vk::FrameStats::getLastFrame() const
+{
+    return lastFrame;
+}
+
+const vk::FrameStats::Report vk::FrameStats::getReport() const
+{
+    Report report = {};
+    report.frameCount = frameTimes.count;
+
+    if (gpuCompletionLatencies.count > 0)
+    {
+        report.gpuCompletionLatencyCount = gpuCompletionLatencies.count;
+        report.gpuCompletionLatencyAverage =
+            gpuCompletionLatencies.total / static_cast<double>(gpuCompletionLatencies.count);
+        report.gpuCompletionLatencyP50 = gpuCompletionLatencies.getPercentile(.50);
+        report.gpuCompletionLatencyP99 = gpuCompletionLatencies.getPercentile(.99);
+        report.gpuCompletionLatencyMax = gpuCompletionLatencies.max;
+    }
+
+    if (frameTimes.count == 0)
+        return report;
+
+    const double count = static_cast<double>(frameTimes.count);
+
+    report.average = frameTimes.total / count;
+    report.p50 = frameTimes.getPercentile(.50);
+    report.p95 = frameTimes.getPercentile(.95);
+    report.p99 = frameTimes.getPercentile(.99);
+    report.max = frameTimes.max;
+
+    Frame &average = report.averageFrame;
+    average.frameMilliseconds = report.average;
+    average.cpuMilliseconds = totals.cpuMilliseconds / count;
+    average.timings.fenceWait = totals.timings.fenceWait / count;
+    average.timings.acquire = totals.timings.acquire / count;
+    average.timings.submit = totals.timings.submit / count;
+    average.timings.present = totals.timings.present / count;
+    average.drawCalls = static_cast<uint32_t>(std::llround(totals.drawCalls / count));
+    average.triangles = static_cast<uint64_t>(std::llround(totals.triangles / count));
+    average.pipelineBinds = static_cast<uint32_t>(std::llround(totals.pipelineBinds / count));
+    average.descriptorBinds = static_cast<uint32_t>(std::llround(totals.descriptorBinds / count));
+    average.vertexBufferBinds = static_cast<uint32_t>(std::llround(totals.vertexBufferBinds / count));
+    average.barriers = static_cast<uint32_t>(std::llround(totals.barriers / count));
+    average.uploadBytes = static_cast<uint64_t>(std::llround(totals.uploadBytes / count));
+
+    return report;
+}
+
+void vk::FrameStats::print(std::ostream &stream) const
+{
+    const Report report = getReport();
+
+    if (report.frameCount == 0)
+    {
+        stream << "No frames recorded" << std::endl;
+        return;
+    }
+
+    const Frame &average = report.averageFrame;
+
+    stream << "Frame times over " << report.frameCount << " frames: " << report.average << " ms average ("
+           << 1000.0 / report.average << " FPS), p50 " << report.p50 << " ms, p95 " << report.p95 << " ms, p99 "
+           << report.p99 << " ms, max " << report.max << " ms" << std::endl;
+
+    stream << "Average CPU time: " << average.cpuMilliseconds << " ms recording, " << average.timings.fenceWait
+           << " ms waiting for fences, " << average.timings.acquire << " ms acquiring, " << average.timings.submit
+           << " ms submitting, " << average.timings.present << " ms presenting" << std::endl;
+
+    stream << "Average per frame: " << average.drawCalls << " draw calls, " << average.triangles << " triangles, "
+           << average.pipelineBinds << " pipeline binds, " << average.descriptorBinds << " descriptor set binds, "
+           << average.vertexBufferBinds << " vertex buffer binds, " << average.barriers << " barriers, "
+           << average.uploadBytes << " bytes uploaded" << std::endl;
+
+    if (report.gpuCompletionLatencyCount > 0)
+        stream << "Input to GPU completion latency over " << report.gpuCompletionLatencyCount << " frames: "
+               << report.gpuCompletionLatencyAverage << " ms average, p50 " << report.gpuCompletionLatencyP50
+               << " ms, p99 " << report.gpuCompletionLatencyP99 << " ms, max " << report.gpuCompletionLatencyMax
+               << " ms" << std::endl;
+}
+
+void vk::FrameStats::countDraw(const uint64_t triangles)
+{
+    counters.drawCalls.fetch_add(1, std::memory_order_relaxed);
+    counters.triangles.fetch_add(triangles, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::countPipelineBind()
+{
+    counters.pipelineBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::countDescriptorBinds(const uint32_t set_count)
+{
+    counters.descriptorBinds.fetch_add(set_count, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::countVertexBufferBind()
+{
+    counters.vertexBufferBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::countBarriers(const uint32_t barrier_count)
+{
+    counters.barriers.fetch_add(barrier_count, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::countUpload(const uint64_t bytes)
+{
+    counters.uploadBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void vk::FrameStats::Histogram::add(const double milliseconds)
+{
+    const auto bucket = static_cast<size_t>(milliseconds / BUCKET_MILLISECONDS);
+    ++buckets[std::min(bucket, BUCKET_COUNT - 1)];
+
+    ++count;
+    total += milliseconds;
+    max = std::max(max, milliseconds);
+}
+
+void vk::FrameStats::Histogram::clear()
+{
+    buckets.fill(0);
+    count = 0;
+    total = 0.0;
+    max = 0.0;
+}
+
+const double vk::FrameStats::Histogram::getPercentile(const double percentile) const
+{
+    // Smallest bucket whose cumulative count reaches the percentile, reported at its upper edge
+    const auto target = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count)));
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        cumulative += buckets[i];
+
+        if (cumulative >= target)
+            return std::min(static_cast<double>(i + 1) * BUCKET_MILLISECONDS, max);
+    }
+
+    return max;
+}
+
+const double vk::FrameStats::millisecondsSince(const std::chrono::steady_clock::time_point &time_point)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_point).count();
+}
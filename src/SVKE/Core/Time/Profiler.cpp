@@ -0,0 +1,149 @@
+#include "SVKE/Core/Time/Profiler.hpp"
+
+#ifdef SVKE_PROFILING
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+vk::Profiler::Profiler()
+    : frameBegin(0), frameCount(0), startTicks(now()), startTime(std::chrono::steady_clock::now())
+{
+}
+
+vk::Profiler &vk::Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void vk::Profiler::setThreadName(const std::string &name)
+{
+    ThreadBuffer *buffer = threadBuffer ? threadBuffer : registerThread();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer->threadName = name;
+}
+
+void vk::Profiler::beginFrame()
+{
+    frameBegin = now();
+}
+
+void vk::Profiler::endFrame()
+{
+    record("Frame", frameBegin, now());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    collect();
+    ++frameCount;
+}
+
+const bool vk::Profiler::writeChromeTrace(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    collect();
+
+    std::ofstream file(path);
+
+    if (!file.is_open())
+    {
+        std::cerr << "vk::Profiler::writeChromeTrace: FAILED TO OPEN " << path << std::endl;
+        return false;
+    }
+
+    const double ticks_per_microsecond = getTicksPerMicrosecond();
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+
+    for (const auto &buffer : buffers)
+    {
+        if (buffer->threadName.empty())
+            continue;
+
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadId
+             << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+
+        first = false;
+    }
+
+    for (const auto &retained_event : retained)
+    {
+        const Event &event = retained_event.event;
+
+        // Names are string literals or __func__, they never contain characters that need escaping.
+        // A zone that was open when the profiler was created begins before startTicks.
+        const auto relative_begin = static_cast<int64_t>(event.begin - startTicks);
+        const double begin = static_cast<double>(relative_begin) / ticks_per_microsecond;
+        const double duration = static_cast<double>(event.end - event.begin) / ticks_per_microsecond;
+
+        file << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+             << retained_event.threadId << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+
+        first = false;
+    }
+
+    file << "\n]}\n";
+
+    uint64_t dropped = 0;
+    for (const auto &buffer : buffers)
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+#ifndef NDEBUG
+    std::cout << "WROTE " << retained.size() << " PROFILER ZONES OVER " << frameCount << " FRAMES TO " << path
+              << std::endl;
+#endif
+
+    if (dropped > 0)
+        std::cerr << "vk::Profiler::writeChromeTrace: " << dropped << " ZONES WERE DROPPED BECAUSE A RING WAS FULL"
+                  << std::endl;
+
+    return true;
+}
+
+vk::Profiler::ThreadBuffer *vk::Profiler::registerThread()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    buffers.push_back(std::make_unique<ThreadBuffer>());
+    threadBuffer = buffers.back().get();
+    threadBuffer->threadId = static_cast<uint32_t>(buffers.size());
+
+    return threadBuffer;
+}
+
+void vk::Profiler::collect()
+{
+    for (auto &buffer : buffers)
+    {
+        const size_t head = buffer->head.load(std::memory_order_acquire);
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+
+        for (; tail != head; ++tail)
+            retained.push_back({buffer->events[tail % RING_CAPACITY], buffer->threadId});
+
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    while (retained.size() > MAX_RETAINED_EVENTS)
+        retained.pop_front();
+}
+
+const double vk::Profiler::getTicksPerMicrosecond() const
+{
+    // Calibrated over the whole run, so the TSC frequency does not have to be known
+    const uint64_t elapsed_ticks = now() - startTicks;
+    const auto elapsed_time = std::chrono::steady_clock::now() - startTime;
+    const double elapsed_microseconds = std::chrono::duration<double, std::micro>(elapsed_time).count();
+
+    if (elapsed_ticks == 0 || elapsed_microseconds <= 0.0)
+        return 1.0;
+
+    return static_cast<double>(elapsed_ticks) / elapsed_microseconds;
+}
+
+#endif
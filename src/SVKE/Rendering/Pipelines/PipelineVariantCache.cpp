@@ -0,0 +1,57 @@
+#include "SVKE/Rendering/Pipelines/PipelineVariantCache.hpp"
+
+vk::PipelineVariantCache::PipelineVariantCache(PipelineCompiler &pipeline_compiler, ConfigPopulator populate_config)
+    : pipelineCompiler(pipeline_compiler), populateConfig(std::move(populate_config))
+{
+}
+
+const std::shared_ptr<vk::PipelineCompiler::Handle> &vk::PipelineVariantCache::get(
+    const ShaderVariant &variant, Shader &vert_shader, Shader &frag_shader,
+    std::shared_ptr<PipelineCompiler::Handle> fallback)
+{
+    auto it = variants.find(variant);
+
+    if (it != variants.end())
+        return it->second;
+
+    Pipeline::Config pipeline_config = {};
+    populateVariantConfig(variant, pipeline_config);
+
+#ifndef NDEBUG
+    std::cout << "COMPILING PIPELINE VARIANT " << variants.size() << " (LIGHT LIMIT " << variant.lightLimit
+              << ", SPECULAR " << variant.specular << ", SAMPLE SHADING " << variant.sampleShading << ", DEPTH PREPASS "
+              << variant.depthPrepass << ")" << std::endl;
+#endif
+
+    auto handle = pipelineCompiler.compile(vert_shader, frag_shader, pipeline_config, std::move(fallback));
+
+    return variants.emplace(variant, std::move(handle)).first->second;
+}
+
+void vk::PipelineVariantCache::recompileAll(Shader &vert_shader, Shader &frag_shader)
+{
+    for (auto &[variant, handle] : variants)
+    {
+        Pipeline::Config pipeline_config = {};
+        populateVariantConfig(variant, pipeline_config);
+
+        pipelineCompiler.recompile(handle, vert_shader, frag_shader, pipeline_config);
+    }
+}
+
+void vk::PipelineVariantCache::waitIdle() const
+{
+    for (auto &[_, handle] : variants)
+        handle->wait();
+}
+
+const size_t vk::PipelineVariantCache::size() const
+{
+    return variants.size();
+}
+
+void vk::PipelineVariantCache::populateVariantConfig(const ShaderVariant &variant, Pipeline::Config &config)
+{
+    populateConfig(config);
+    variant.apply(config);
+}
@@ -0,0 +1,28 @@
+#include "SVKE/Rendering/Pipelines/ShaderVariant.hpp"
+
+const bool vk::ShaderVariant::operator==(const ShaderVariant &other) const
+{
+    return lightLimit == other.lightLimit && specular == other.specular && sampleShading == other.sampleShading &&
+           depthPrepass == other.depthPrepass;
+}
+
+void vk::ShaderVariant::apply(Pipeline::Config &config) const
+{
+    assert(lightLimit >= 0 && lightLimit <= static_cast<int>(MAX_LIGHTS_PER_CLUSTER) &&
+           "SHADER VARIANT LIGHT LIMIT OUT OF RANGE");
+
+    Pipeline::setSpecializationConstant(config.fragSpecialization, LightLimit, static_cast<uint32_t>(lightLimit));
+    Pipeline::setSpecializationConstant(config.fragSpecialization, Specular, specular ? VK_TRUE : VK_FALSE);
+
+    // Shader antialiasing, smooths inner parts of shapes. Costs up to one fragment invocation per sample
+    config.multisampleInfo.sampleShadingEnable = sampleShading ? VK_TRUE : VK_FALSE;
+    config.multisampleInfo.minSampleShading = sampleShading ? .2f : 1.f;
+
+    // Otherwise the depth state of the system is kept. EQUAL needs the pre-pass to produce bit identical depth, see
+    // the invariant gl_Position of both vertex shaders
+    if (depthPrepass)
+    {
+        config.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+        config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    }
+}
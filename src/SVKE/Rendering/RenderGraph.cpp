@@ -0,0 +1,810 @@
+#include "SVKE/Rendering/RenderGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+struct UsageInfo
+{
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 readAccess;
+    VkAccessFlags2 writeAccess;
+    VkImageLayout layout;
+};
+
+const UsageInfo getUsageInfo(const vk::RenderGraph::Usage usage)
+{
+    using Usage = vk::RenderGraph::Usage;
+
+    switch (usage)
+    {
+    case Usage::ColorAttachment:
+        return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    case Usage::DepthAttachment:
+        return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+    case Usage::SampledFragment:
+        return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+    case Usage::SampledCompute:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+    case Usage::StorageFragment:
+        return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+
+    case Usage::StorageCompute:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+
+    case Usage::Indirect:
+        return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_ACCESS_2_NONE,
+                VK_IMAGE_LAYOUT_UNDEFINED};
+
+    case Usage::TransferSource:
+        return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+
+    case Usage::TransferDestination:
+        return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    }
+
+    throw std::runtime_error("getUsageInfo: UNKNOWN USAGE");
+}
+} // namespace
+
+const bool vk::RenderGraph::ImageInfo::operator==(const ImageInfo &other) const
+{
+    return format == other.format && extent.width == other.extent.width && extent.height == other.extent.height &&
+           levelCount == other.levelCount && usage == other.usage && aspect == other.aspect &&
+           samples == other.samples;
+}
+
+vk::RenderGraph::PassBuilder::PassBuilder(RenderGraph &graph, const uint32_t pass_index)
+    : graph(graph), passIndex(pass_index)
+{
+}
+
+vk::RenderGraph::PassBuilder &vk::RenderGraph::PassBuilder::read(const ResourceId resource, const Usage usage)
+{
+    graph.addAccess(passIndex, resource, usage, false);
+    return *this;
+}
+
+vk::RenderGraph::PassBuilder &vk::RenderGraph::PassBuilder::write(const ResourceId resource, const Usage usage)
+{
+    graph.addAccess(passIndex, resource, usage, true);
+    return *this;
+}
+
+vk::RenderGraph::PassBuilder &vk::RenderGraph::PassBuilder::setSideEffects()
+{
+    graph.passes[passIndex].sideEffects = true;
+    return *this;
+}
+
+vk::RenderGraph::PassBuilder &vk::RenderGraph::PassBuilder::setExecute(std::function<void(VkCommandBuffer &)> execute)
+{
+    graph.passes[passIndex].execute = std::move(execute);
+    return *this;
+}
+
+vk::RenderGraph::RenderGraph(Device &device) : device(device), transientGeneration(0)
+{
+}
+
+vk::RenderGraph::~RenderGraph()
+{
+    // Owners are responsible for the GPU no longer using the transient images
+    releaseTransientImages();
+}
+
+void vk::RenderGraph::reset()
+{
+    resources.clear();
+    passes.clear();
+    schedule.clear();
+}
+
+vk::RenderGraph::ResourceId vk::RenderGraph::importImage(const std::string &name, VkImage image, VkImageView view,
+                                                         const VkImageAspectFlags aspect, const ResourceState &state,
+                                                         const uint32_t level_count, const uint32_t layer_count)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.type = ResourceType::ImportedImage;
+    resource.image = image;
+    resource.view = view;
+    resource.aspect = aspect;
+    resource.levelCount = level_count;
+    resource.layerCount = layer_count;
+    resource.initialState = state;
+
+    resources.push_back(resource);
+
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+vk::RenderGraph::ResourceId vk::RenderGraph::importBuffer(const std::string &name, VkBuffer buffer,
+                                                          const ResourceState &state)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.type = ResourceType::ImportedBuffer;
+    resource.buffer = buffer;
+    resource.initialState = state;
+
+    resources.push_back(resource);
+
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+vk::RenderGraph::ResourceId vk::RenderGraph::createImage(const std::string &name, const ImageInfo &info)
+{
+    assert(info.extent.width > 0 && info.extent.height > 0 && info.levelCount > 0 && "INVALID TRANSIENT IMAGE");
+
+    Resource resource = {};
+    resource.name = name;
+    resource.type = ResourceType::TransientImage;
+    resource.aspect = info.aspect;
+    resource.levelCount = info.levelCount;
+    resource.info = info;
+
+    resources.push_back(resource);
+
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+vk::RenderGraph::PassBuilder vk::RenderGraph::addPass(const std::string &name)
+{
+    Pass pass = {};
+    pass.name = name;
+
+    passes.push_back(std::move(pass));
+
+    return PassBuilder(*this, static_cast<uint32_t>(passes.size() - 1));
+}
+
+void vk::RenderGraph::compile()
+{
+    schedulePasses(cullPasses());
+    reserveTransientImages();
+    computeBarriers();
+}
+
+void vk::RenderGraph::execute(VkCommandBuffer &command_buffer)
+{
+    for (const uint32_t pass_index : schedule)
+    {
+        const Pass &pass = passes[pass_index];
+
+        const size_t barrier_count = pass.imageBarriers.size() + pass.bufferBarriers.size();
+
+        // Everything the pass waits for in one call
+        if (barrier_count > 0)
+        {
+            VkDependencyInfo dependency_info = {};
+            dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(pass.imageBarriers.size());
+            dependency_info.pImageMemoryBarriers = pass.imageBarriers.data();
+            dependency_info.bufferMemoryBarrierCount = static_cast<uint32_t>(pass.bufferBarriers.size());
+            dependency_info.pBufferMemoryBarriers = pass.bufferBarriers.data();
+
+            vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+            FrameStats::countBarriers(static_cast<uint32_t>(barrier_count));
+        }
+
+        if (pass.execute)
+            pass.execute(command_buffer);
+    }
+}
+
+VkImage vk::RenderGraph::getImage(const ResourceId resource) const
+{
+    assert(resource < resources.size() && isImage(resource) && "RESOURCE IS NOT AN IMAGE");
+
+    const Resource &image = resources[resource];
+
+    if (image.type == ResourceType::TransientImage)
+        return transientImages[image.transientIndex].image;
+
+    return image.image;
+}
+
+VkImageView vk::RenderGraph::getImageView(const ResourceId resource) const
+{
+    assert(resource < resources.size() && isImage(resource) && "RESOURCE IS NOT AN IMAGE");
+
+    const Resource &image = resources[resource];
+
+    if (image.type == ResourceType::TransientImage)
+        return transientImages[image.transientIndex].view;
+
+    return image.view;
+}
+
+VkImageView vk::RenderGraph::getLevelView(const ResourceId resource, const uint32_t level) const
+{
+    assert(resource < resources.size() && resources[resource].type == ResourceType::TransientImage &&
+           "RESOURCE IS NOT A TRANSIENT IMAGE");
+    assert(level < resources[resource].levelCount && "LEVEL OUT OF RANGE");
+
+    const TransientImage &image = transientImages[resources[resource].transientIndex];
+
+    // Images with a single level have no separate level views
+    return image.levelViews.empty() ? image.view : image.levelViews[level];
+}
+
+VkBuffer vk::RenderGraph::getBuffer(const ResourceId resource) const
+{
+    assert(resource < resources.size() && resources[resource].type == ResourceType::ImportedBuffer &&
+           "RESOURCE IS NOT A BUFFER");
+
+    return resources[resource].buffer;
+}
+
+const uint64_t vk::RenderGraph::getTransientGeneration() const
+{
+    return transientGeneration;
+}
+
+const size_t vk::RenderGraph::getCulledPassCount() const
+{
+    return passes.size() - schedule.size();
+}
+
+const VkDeviceSize vk::RenderGraph::getTransientMemorySize() const
+{
+    VkDeviceSize size = 0;
+
+    for (const auto &block : memoryBlocks)
+        size += block.requirements.size;
+
+    return size;
+}
+
+const VkDeviceSize vk::RenderGraph::getUnaliasedMemorySize() const
+{
+    VkDeviceSize size = 0;
+
+    for (const auto &image : transientImages)
+        size += image.requirements.size;
+
+    return size;
+}
+
+void vk::RenderGraph::addAccess(const uint32_t pass_index, const ResourceId resource, const Usage usage,
+                                const bool write)
+{
+    assert(resource < resources.size() && "UNKNOWN RESOURCE");
+
+    const UsageInfo usage_info = getUsageInfo(usage);
+
+    assert((!write || usage_info.writeAccess != VK_ACCESS_2_NONE) && "USAGE CANNOT WRITE");
+    assert((write || usage_info.readAccess != VK_ACCESS_2_NONE) && "USAGE CANNOT READ");
+    assert((!isImage(resource) || usage_info.layout != VK_IMAGE_LAYOUT_UNDEFINED) && "USAGE CANNOT APPLY TO IMAGES");
+
+    Access access = {};
+    access.resource = resource;
+    access.stages = usage_info.stages;
+    access.readAccess = usage_info.readAccess;
+    access.writeAccess = write ? usage_info.writeAccess : VK_ACCESS_2_NONE;
+    access.layout = isImage(resource) ? usage_info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+    auto &accesses = passes[pass_index].accesses;
+
+    // Several usages of the same resource by one pass are waited for together
+    auto it = std::find_if(accesses.begin(), accesses.end(),
+                           [resource](const Access &other) { return other.resource == resource; });
+
+    if (it == accesses.end())
+    {
+        accesses.push_back(access);
+        return;
+    }
+
+    assert(it->layout == access.layout && "A PASS CANNOT USE AN IMAGE IN TWO LAYOUTS");
+
+    it->stages |= access.stages;
+    it->readAccess |= access.readAccess;
+    it->writeAccess |= access.writeAccess;
+}
+
+const std::vector<bool> vk::RenderGraph::cullPasses() const
+{
+    std::vector<bool> kept_passes(passes.size(), false);
+    std::vector<bool> read_later(resources.size(), false);
+
+    // Backwards, so every pass is decided after all passes that could read what it writes
+    for (size_t i = passes.size(); i-- > 0;)
+    {
+        const Pass &pass = passes[i];
+        bool kept = pass.sideEffects;
+
+        for (const auto &access : pass.accesses)
+        {
+            const bool imported = resources[access.resource].type != ResourceType::TransientImage;
+
+            if (access.writeAccess != VK_ACCESS_2_NONE && (imported || read_later[access.resource]))
+                kept = true;
+        }
+
+        if (!kept)
+            continue;
+
+        kept_passes[i] = true;
+
+        for (const auto &access : pass.accesses)
+            if (access.readAccess != VK_ACCESS_2_NONE)
+                read_later[access.resource] = true;
+    }
+
+    return kept_passes;
+}
+
+void vk::RenderGraph::schedulePasses(const std::vector<bool> &kept_passes)
+{
+    const size_t pass_count = passes.size();
+
+    std::vector<std::vector<uint32_t>> dependents(pass_count);
+    std::vector<std::vector<uint32_t>> dependencies(pass_count);
+    std::vector<uint32_t> dependency_counts(pass_count, 0);
+
+    std::vector<int64_t> last_writers(resources.size(), -1);
+    std::vector<std::vector<uint32_t>> readers(resources.size());
+
+    auto add_dependency = [&](const uint32_t pass, const int64_t dependency) {
+        if (dependency < 0 || dependency == pass)
+            return;
+
+        auto &pass_dependencies = dependencies[pass];
+        if (std::find(pass_dependencies.begin(), pass_dependencies.end(), dependency) != pass_dependencies.end())
+            return;
+
+        pass_dependencies.push_back(static_cast<uint32_t>(dependency));
+        dependents[dependency].push_back(pass);
+        ++dependency_counts[pass];
+    };
+
+    // Reads wait for the last write, writes for the last write and every read since
+    for (uint32_t i = 0; i < pass_count; ++i)
+    {
+        if (!kept_passes[i])
+            continue;
+
+        for (const auto &access : passes[i].accesses)
+        {
+            add_dependency(i, last_writers[access.resource]);
+
+            if (access.writeAccess == VK_ACCESS_2_NONE)
+            {
+                readers[access.resource].push_back(i);
+                continue;
+            }
+
+            for (const uint32_t reader : readers[access.resource])
+                add_dependency(i, reader);
+
+            readers[access.resource].clear();
+            last_writers[access.resource] = i;
+        }
+    }
+
+    std::vector<uint32_t> ready;
+    for (uint32_t i = 0; i < pass_count; ++i)
+        if (kept_passes[i] && dependency_counts[i] == 0)
+            ready.push_back(i);
+
+    schedule.clear();
+
+    while (!ready.empty())
+    {
+        // A pass that does not wait for the one just recorded goes first, so the GPU has work to overlap the
+        // barrier with. Otherwise, and among those, declaration order is kept.
+        auto next = ready.end();
+
+        if (!schedule.empty())
+        {
+            const uint32_t previous = schedule.back();
+
+            for (auto it = ready.begin(); it != ready.end(); ++it)
+            {
+                const auto &pass_dependencies = dependencies[*it];
+                const bool waits = std::find(pass_dependencies.begin(), pass_dependencies.end(), previous) !=
+                                   pass_dependencies.end();
+
+                if (!waits && (next == ready.end() || *it < *next))
+                    next = it;
+            }
+        }
+
+        if (next == ready.end())
+            next = std::min_element(ready.begin(), ready.end());
+
+        const uint32_t pass = *next;
+        ready.erase(next);
+        schedule.push_back(pass);
+
+        for (const uint32_t dependent : dependents[pass])
+            if (--dependency_counts[dependent] == 0)
+                ready.push_back(dependent);
+    }
+}
+
+void vk::RenderGraph::reserveTransientImages()
+{
+    std::vector<TransientImage> images;
+    std::vector<int64_t> image_indices(resources.size(), -1);
+
+    // Numbered in the order they are first used, their lifetimes are positions in the schedule
+    for (uint32_t position = 0; position < schedule.size(); ++position)
+    {
+        for (const auto &access : passes[schedule[position]].accesses)
+        {
+            Resource &resource = resources[access.resource];
+
+            if (resource.type != ResourceType::TransientImage)
+                continue;
+
+            int64_t &image_index = image_indices[access.resource];
+
+            if (image_index >= 0)
+            {
+                images[image_index].lastPass = position;
+                continue;
+            }
+
+            TransientImage image = {};
+            image.info = resource.info;
+            image.firstPass = position;
+            image.lastPass = position;
+
+            image_index = static_cast<int64_t>(images.size());
+            resource.transientIndex = static_cast<uint32_t>(image_index);
+            images.push_back(image);
+        }
+    }
+
+    bool unchanged = images.size() == transientImages.size();
+
+    for (size_t i = 0; unchanged && i < images.size(); ++i)
+        unchanged = images[i].info == transientImages[i].info && images[i].firstPass == transientImages[i].firstPass &&
+                    images[i].lastPass == transientImages[i].lastPass;
+
+    if (unchanged)
+        return;
+
+    // Frames in flight may still use the previous images
+    if (!transientImages.empty())
+    {
+        const VkDevice logical_device = device.getLogicalDevice();
+        const VmaAllocator allocator = device.getAllocator();
+
+        device.getGraphicsTimeline().defer(
+            [logical_device, allocator, &memory_tracker = device.getMemoryTracker(),
+             previous_images = std::move(transientImages), previous_blocks = std::move(memoryBlocks)] {
+                for (const auto &image : previous_images)
+                {
+                    for (auto level_view : image.levelViews)
+                        vkDestroyImageView(logical_device, level_view, nullptr);
+
+                    vkDestroyImageView(logical_device, image.view, nullptr);
+                    vkDestroyImage(logical_device, image.image, nullptr);
+                }
+
+                for (const auto &block : previous_blocks)
+                {
+                    memory_tracker.untrack(block.allocation);
+                    vmaFreeMemory(allocator, block.allocation);
+                }
+            });
+    }
+
+    transientImages = std::move(images);
+    memoryBlocks.clear();
+
+    for (auto &image : transientImages)
+    {
+        VkImageCreateInfo image_info = {};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = image.info.extent.width;
+        image_info.extent.height = image.info.extent.height;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = image.info.levelCount;
+        image_info.arrayLayers = 1;
+        image_info.format = image.info.format;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = image.info.usage;
+        image_info.samples = image.info.samples;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.flags = 0;
+
+        if (vkCreateImage(device.getLogicalDevice(), &image_info, nullptr, &image.image) != VK_SUCCESS)
+            throw std::runtime_error("vk::RenderGraph::reserveTransientImages: FAILED TO CREATE IMAGE");
+
+        vkGetImageMemoryRequirements(device.getLogicalDevice(), image.image, &image.requirements);
+    }
+
+    // Largest first, every image goes into the first block it fits in without overlapping the lifetime of an image
+    // already placed there
+    std::vector<uint32_t> order(transientImages.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [this](const uint32_t a, const uint32_t b) {
+        return transientImages[a].requirements.size > transientImages[b].requirements.size;
+    });
+
+    std::vector<std::vector<uint32_t>> block_images;
+
+    for (const uint32_t index : order)
+    {
+        TransientImage &image = transientImages[index];
+
+        auto overlaps = [&](const uint32_t other) {
+            return image.firstPass <= transientImages[other].lastPass &&
+                   transientImages[other].firstPass <= image.lastPass;
+        };
+
+        uint32_t block = 0;
+        for (; block < memoryBlocks.size(); ++block)
+        {
+            const VkMemoryRequirements &requirements = memoryBlocks[block].requirements;
+
+            if ((requirements.memoryTypeBits & image.requirements.memoryTypeBits) == 0)
+                continue;
+
+            if (std::none_of(block_images[block].begin(), block_images[block].end(), overlaps))
+                break;
+        }
+
+        if (block == memoryBlocks.size())
+        {
+            MemoryBlock memory_block = {};
+            memory_block.requirements = image.requirements;
+
+            memoryBlocks.push_back(memory_block);
+            block_images.emplace_back();
+        }
+
+        // Every image of a block starts at its beginning
+        VkMemoryRequirements &requirements = memoryBlocks[block].requirements;
+        requirements.size = std::max(requirements.size, image.requirements.size);
+        requirements.alignment = std::max(requirements.alignment, image.requirements.alignment);
+        requirements.memoryTypeBits &= image.requirements.memoryTypeBits;
+
+        image.block = block;
+        block_images[block].push_back(index);
+    }
+
+    for (auto &block : memoryBlocks)
+    {
+        VmaAllocationCreateInfo allocation_info = {};
+        allocation_info.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        if (vmaAllocateMemory(device.getAllocator(), &block.requirements, &allocation_info, &block.allocation,
+                              nullptr) != VK_SUCCESS)
+            throw std::runtime_error("vk::RenderGraph::reserveTransientImages: FAILED TO ALLOCATE MEMORY");
+
+        device.getMemoryTracker().track(block.allocation, MemoryTracker::Category::Attachment);
+    }
+
+    for (auto &image : transientImages)
+    {
+        if (vmaBindImageMemory(device.getAllocator(), memoryBlocks[image.block].allocation, image.image) !=
+            VK_SUCCESS)
+            throw std::runtime_error("vk::RenderGraph::reserveTransientImages: FAILED TO BIND IMAGE MEMORY");
+
+        VkImageViewCreateInfo view_info = {};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = image.image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = image.info.format;
+        view_info.subresourceRange.aspectMask = image.info.aspect;
+        view_info.subresourceRange.baseMipLevel = 0;
+        view_info.subresourceRange.levelCount = image.info.levelCount;
+        view_info.subresourceRange.baseArrayLayer = 0;
+        view_info.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &image.view) != VK_SUCCESS)
+            throw std::runtime_error("vk::RenderGraph::reserveTransientImages: FAILED TO CREATE IMAGE VIEW");
+
+        if (image.info.levelCount == 1)
+            continue;
+
+        image.levelViews.resize(image.info.levelCount, VK_NULL_HANDLE);
+
+        for (uint32_t level = 0; level < image.info.levelCount; ++level)
+        {
+            view_info.subresourceRange.baseMipLevel = level;
+            view_info.subresourceRange.levelCount = 1;
+
+            if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &image.levelViews[level]) !=
+                VK_SUCCESS)
+                throw std::runtime_error("vk::RenderGraph::reserveTransientImages: FAILED TO CREATE IMAGE VIEW");
+        }
+    }
+
+    ++transientGeneration;
+
+#ifndef NDEBUG
+    std::cout << "RENDER GRAPH: " << transientImages.size() << " TRANSIENT IMAGES IN " << memoryBlocks.size()
+              << " MEMORY BLOCKS, " << getTransientMemorySize() << " BYTES INSTEAD OF " << getUnaliasedMemorySize()
+              << std::endl;
+#endif
+}
+
+void vk::RenderGraph::releaseTransientImages()
+{
+    for (const auto &image : transientImages)
+    {
+        for (auto level_view : image.levelViews)
+            vkDestroyImageView(device.getLogicalDevice(), level_view, nullptr);
+
+        vkDestroyImageView(device.getLogicalDevice(), image.view, nullptr);
+        vkDestroyImage(device.getLogicalDevice(), image.image, nullptr);
+    }
+
+    for (const auto &block : memoryBlocks)
+    {
+        device.getMemoryTracker().untrack(block.allocation);
+        vmaFreeMemory(device.getAllocator(), block.allocation);
+    }
+
+    transientImages.clear();
+    memoryBlocks.clear();
+}
+
+void vk::RenderGraph::computeBarriers()
+{
+    std::vector<State> states(resources.size());
+
+    // Imported resources wait for whatever accessed them last as if it had written them
+    for (size_t i = 0; i < resources.size(); ++i)
+    {
+        if (resources[i].type == ResourceType::TransientImage)
+            continue;
+
+        states[i].writeStages = resources[i].initialState.stages;
+        states[i].writeAccess = resources[i].initialState.access;
+        states[i].layout = resources[i].initialState.layout;
+    }
+
+    for (const uint32_t pass_index : schedule)
+    {
+        Pass &pass = passes[pass_index];
+        pass.imageBarriers.clear();
+        pass.bufferBarriers.clear();
+
+        for (const auto &access : pass.accesses)
+        {
+            const Resource &resource = resources[access.resource];
+            State &state = states[access.resource];
+
+            const bool image = isImage(access.resource);
+            const bool write = access.writeAccess != VK_ACCESS_2_NONE;
+            const bool transient = resource.type == ResourceType::TransientImage;
+            const bool layout_change = image && state.layout != access.layout;
+
+            VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+            VkAccessFlags2 src_access = VK_ACCESS_2_NONE;
+            VkImageLayout old_layout = state.layout;
+            bool needed = false;
+
+            if (transient && !state.used)
+            {
+                // Contents are undefined, but the memory may still be in use by the image placed there before
+                MemoryBlock &block = memoryBlocks[transientImages[resource.transientIndex].block];
+
+                src_stages = block.stages;
+                src_access = block.writeAccess;
+                old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                needed = true;
+
+                block.stages = VK_PIPELINE_STAGE_2_NONE;
+                block.writeAccess = VK_ACCESS_2_NONE;
+            }
+            else if (write || layout_change)
+            {
+                // Layout transitions write the image, so they wait for earlier reads like any write
+                src_stages = state.writeStages | state.readStages;
+                src_access = state.writeAccess;
+                needed = src_stages != VK_PIPELINE_STAGE_2_NONE || layout_change;
+            }
+            else
+            {
+                // Reads already made to wait for the last write need no barrier of their own
+                const bool covered = (access.stages & ~state.readStages) == 0 &&
+                                     (access.readAccess & ~state.readAccess) == 0;
+
+                src_stages = state.writeStages;
+                src_access = state.writeAccess;
+                needed = state.writeStages != VK_PIPELINE_STAGE_2_NONE && !covered;
+            }
+
+            if (needed && image)
+            {
+                VkImageMemoryBarrier2 barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = src_stages;
+                barrier.srcAccessMask = src_access;
+                barrier.dstStageMask = access.stages;
+                barrier.dstAccessMask = access.readAccess | access.writeAccess;
+                barrier.oldLayout = old_layout;
+                barrier.newLayout = access.layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = getImage(access.resource);
+                barrier.subresourceRange.aspectMask = resource.aspect;
+                barrier.subresourceRange.baseMipLevel = 0;
+                barrier.subresourceRange.levelCount = resource.levelCount;
+                barrier.subresourceRange.baseArrayLayer = 0;
+                barrier.subresourceRange.layerCount = resource.layerCount;
+
+                pass.imageBarriers.push_back(barrier);
+            }
+            else if (needed)
+            {
+                VkBufferMemoryBarrier2 barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                barrier.srcStageMask = src_stages;
+                barrier.srcAccessMask = src_access;
+                barrier.dstStageMask = access.stages;
+                barrier.dstAccessMask = access.readAccess | access.writeAccess;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = resource.buffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+
+                pass.bufferBarriers.push_back(barrier);
+            }
+
+            if (write)
+            {
+                state.writeStages = access.stages;
+                state.writeAccess = access.writeAccess;
+                state.readStages = VK_PIPELINE_STAGE_2_NONE;
+                state.readAccess = VK_ACCESS_2_NONE;
+            }
+            else if (layout_change || (transient && !state.used))
+            {
+                // Later reads in other stages have to wait for the transition as well
+                state.writeStages |= access.stages;
+                state.readStages = access.stages;
+                state.readAccess = access.readAccess;
+            }
+            else
+            {
+                state.readStages |= access.stages;
+                state.readAccess |= access.readAccess;
+            }
+
+            state.layout = image ? access.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+            state.used = true;
+
+            if (transient)
+            {
+                MemoryBlock &block = memoryBlocks[transientImages[resource.transientIndex].block];
+                block.stages |= access.stages;
+                block.writeAccess |= access.writeAccess;
+            }
+        }
+    }
+}
+
+const bool vk::RenderGraph::isImage(const ResourceId resource) const
+{
+    return resources[resource].type != ResourceType::ImportedBuffer;
+}
@@ -0,0 +1,92 @@
+#include "SVKE/Rendering/Resources/DrawList.hpp"
+
+#include "SVKE/Core/Time/FrameStats.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+void vk::DrawList::clear()
+{
+    draws.clear();
+    items.clear();
+    descriptorSetNumbers.clear();
+    modelNumbers.clear();
+}
+
+void vk::DrawList::add(const Mat4f &view, Object &object, const uint32_t object_index, VkDescriptorSet descriptor_set)
+{
+    assert(object.getModel() && "CANNOT DRAW AN OBJECT WITHOUT MODEL");
+    assert(object_index != NO_OBJECT_INDEX && "OBJECT HAS NO ELEMENT IN THE OBJECT BUFFER");
+
+    Model *model = object.getModel().get();
+
+    // Numbered from 1, objects without a set come first
+    uint32_t descriptor_set_number = 0;
+    if (descriptor_set != VK_NULL_HANDLE)
+        descriptor_set_number =
+            descriptorSetNumbers.emplace(descriptor_set, static_cast<uint32_t>(descriptorSetNumbers.size()) + 1)
+                .first->second;
+
+    const uint32_t model_number =
+        modelNumbers.emplace(model, static_cast<uint32_t>(modelNumbers.size())).first->second;
+
+    items.emplace_back(makeKey(descriptor_set_number, model_number, viewDepthKey(view, object)),
+                       static_cast<uint32_t>(draws.size()));
+    draws.push_back({model, descriptor_set, object_index});
+}
+
+void vk::DrawList::sort()
+{
+    // Bytes every key shares, e.g. the descriptor set of a system without any, are skipped by the sort
+    radixSort(items, scratch);
+}
+
+void vk::DrawList::record(VkCommandBuffer &command_buffer, VkPipelineLayout layout,
+                          const uint32_t descriptor_set_index) const
+{
+    // Last draw recorded, its descriptor set and model are still bound
+    const Draw *previous = nullptr;
+
+    for (const auto &[_, index] : items)
+    {
+        const Draw &draw = draws[index];
+
+        if (draw.descriptorSet != VK_NULL_HANDLE && (!previous || draw.descriptorSet != previous->descriptorSet))
+        {
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, descriptor_set_index, 1,
+                                    &draw.descriptorSet, 0, nullptr);
+            FrameStats::countDescriptorBinds(1);
+        }
+
+        if (!previous || draw.model != previous->model)
+            draw.model->bind(command_buffer);
+
+        ObjectPushConstantData push = {};
+        push.objectIndex = draw.objectIndex;
+
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ObjectPushConstantData),
+                           &push);
+
+        draw.model->draw(command_buffer);
+
+        previous = &draw;
+    }
+}
+
+const size_t vk::DrawList::size() const
+{
+    return draws.size();
+}
+
+const bool vk::DrawList::empty() const
+{
+    return draws.empty();
+}
+
+const uint64_t vk::DrawList::makeKey(const uint32_t descriptor_set, const uint32_t model, const uint32_t depth)
+{
+    const uint64_t descriptor_set_field = std::min(descriptor_set, (1u << DESCRIPTOR_SET_BITS) - 1);
+    const uint64_t model_field = std::min(model, (1u << MODEL_BITS) - 1);
+
+    return (descriptor_set_field << (MODEL_BITS + DEPTH_BITS)) | (model_field << DEPTH_BITS) | depth;
+}
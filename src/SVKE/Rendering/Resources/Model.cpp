@@ -1,6 +1,7 @@
 #include "SVKE/Rendering/Resources/Model.hpp"
 
-vk::Model::Model(Device &device) : device(device), vertexCount(0), loaded(false), hasIndexBuffer(false)
+vk::Model::Model(Device &device)
+    : device(device), vertexCount(0), indexCount(0), boundingSphere(0.f), loaded(false), hasIndexBuffer(false)
 {
 }
 
@@ -13,6 +14,7 @@ void vk::Model::loadFromData(const VertexArray &vertices)
     loaded = true;
     hasIndexBuffer = false;
     createVertexBuffers(vertices);
+    computeBoundingSphere(vertices);
 }
 
 void vk::Model::loadFromData(const VertexArray &vertices, const IndexArray &indices)
@@ -21,6 +23,7 @@ void vk::Model::loadFromData(const VertexArray &vertices, const IndexArray &indi
     hasIndexBuffer = true;
     createVertexBuffers(vertices);
     createIndexBuffers(indices);
+    computeBoundingSphere(vertices);
 }
 
 const bool vk::Model::loadFromFile(const std::string &path)
@@ -107,6 +110,8 @@ void vk::Model::bind(VkCommandBuffer &command_buffer)
 
     if (hasIndexBuffer)
         vkCmdBindIndexBuffer(command_buffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+    FrameStats::countVertexBufferBind();
 }
 
 void vk::Model::draw(VkCommandBuffer &command_buffer)
@@ -118,6 +123,28 @@ void vk::Model::draw(VkCommandBuffer &command_buffer)
 
     else
         vkCmdDraw(command_buffer, vertexCount, 1, 0, 0);
+
+    FrameStats::countDraw((hasIndexBuffer ? indexCount : vertexCount) / 3);
+}
+
+const vk::Vec4f vk::Model::getBoundingSphere() const
+{
+    return boundingSphere;
+}
+
+const uint32_t vk::Model::getVertexCount() const
+{
+    return vertexCount;
+}
+
+const uint32_t vk::Model::getIndexCount() const
+{
+    return indexCount;
+}
+
+const bool vk::Model::isIndexed() const
+{
+    return hasIndexBuffer;
 }
 
 std::unique_ptr<vk::Model> vk::Model::createCubeModel(Device &device, const glm::vec3 &offset)
@@ -191,7 +218,7 @@ void vk::Model::createVertexBuffers(const VertexArray &vertices)
                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
                                             VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
 
-    staging_buffer.copyTo(*vertexBuffer, buffer_size);
+    staging_buffer.copyTo(*vertexBuffer, buffer_size, "Vertex upload");
 }
 
 void vk::Model::createIndexBuffers(const IndexArray &indices)
@@ -213,5 +240,29 @@ void vk::Model::createIndexBuffers(const IndexArray &indices)
                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                                            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
 
-    staging_buffer.copyTo(*indexBuffer, buffer_size);
+    staging_buffer.copyTo(*indexBuffer, buffer_size, "Index upload");
+}
+
+void vk::Model::computeBoundingSphere(const VertexArray &vertices)
+{
+    // Centered on the bounding box, not minimal but good enough for culling and cheap to compute
+    Vec3f min = vertices[0].position;
+    Vec3f max = vertices[0].position;
+
+    for (auto &vertex : vertices)
+    {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    const Vec3f center = (min + max) * .5f;
+    float radius_squared = 0.f;
+
+    for (auto &vertex : vertices)
+    {
+        const Vec3f offset = vertex.position - center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+
+    boundingSphere = Vec4f(center, std::sqrt(radius_squared));
 }
@@ -70,6 +70,11 @@ const vk::Vec3f &vk::Object::getRotation() const
     return transformComponent.rotation;
 }
 
+const bool vk::Object::isTransparent() const
+{
+    return model && !textureImage && color.getAlphaComponent() < 255;
+}
+
 const vk::Color &vk::Object::getColor() const
 {
     return color;
@@ -0,0 +1,107 @@
+#include "SVKE/Rendering/Systems/DepthPrepassSystem.hpp"
+
+vk::DepthPrepassSystem::DepthPrepassSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                                           DescriptorSetLayout &global_set_layout)
+    : device(device), colorFormat(renderer.getImageFormat()), depthFormat(renderer.getDepthFormat()),
+      pipelineLayout(VK_NULL_HANDLE), pipelineCompiler(pipeline_compiler)
+{
+    loadShaders();
+    createPipelineLayout(global_set_layout);
+
+    Pipeline::Config pipeline_config = {};
+    populatePipelineConfig(pipeline_config);
+
+    pipeline = pipelineCompiler.compile(*vertShader, pipeline_config);
+}
+
+vk::DepthPrepassSystem::~DepthPrepassSystem()
+{
+    // The layout is referenced by the pending compilation, so it has to finish first
+    pipeline->wait();
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
+}
+
+void vk::DepthPrepassSystem::render(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("DepthPrepassSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "DepthPrepassSystem");
+
+    if (!pipeline->bind(frame_info.commandBuffer))
+        return;
+
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
+
+    // Whatever the RenderSystem and TextureRenderSystem shade, a depth without a surface would stay unlit
+    const bool has_object_sets = !frame_info.objectDescriptorSets.empty();
+    drawList.clear();
+
+    for (auto &[id, object] : frame_info.objects)
+        if (object.getModel() && !object.isTransparent() && (!object.getTextureImage() || has_object_sets))
+            drawList.add(frame_info.camera.getViewMatrix(), object, frame_info.objectIndices[id]);
+
+    // Grouped by model only, this pipeline does not read the texture sets
+    drawList.sort();
+
+    drawList.record(frame_info.commandBuffer, pipelineLayout, 1);
+}
+
+void vk::DepthPrepassSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH}))
+        return;
+
+    // A queued compilation may still reference the current shader module, the compiler keeps it until it is done
+    pipelineCompiler.retire(std::move(vertShader));
+
+    loadShaders();
+
+    Pipeline::Config pipeline_config = {};
+    populatePipelineConfig(pipeline_config);
+
+    pipelineCompiler.recompile(pipeline, *vertShader, pipeline_config);
+}
+
+void vk::DepthPrepassSystem::loadShaders()
+{
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+}
+
+void vk::DepthPrepassSystem::createPipelineLayout(DescriptorSetLayout &global_set_layout)
+{
+    const VkPushConstantRange push_constant_range = ObjectDataSystem::getPushConstantRange();
+
+    std::vector<VkDescriptorSetLayout> global_set_layouts{global_set_layout.getDescriptorSetLayout()};
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(global_set_layouts.size());
+    pipeline_layout_info.pSetLayouts = global_set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::DepthPrepassSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
+}
+
+void vk::DepthPrepassSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    Pipeline::defaultPipelineConfig(pipeline_config);
+
+    // Same interleaved vertex buffer as the surfaces, only the position is fetched
+    pipeline_config.attributeDescriptions.resize(1);
+
+    // Nothing runs per fragment, the color attachment must not be written
+    pipeline_config.colorBlendAttachment.colorWriteMask = 0;
+
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
+    pipeline_config.pipelineLayout = pipelineLayout;
+    pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
+    pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipeline_config.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+}
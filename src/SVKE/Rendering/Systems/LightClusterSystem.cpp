@@ -0,0 +1,184 @@
+#include "SVKE/Rendering/Systems/LightClusterSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+vk::LightClusterSystem::LightClusterSystem(Device &device, PipelineCompiler &pipeline_compiler,
+                                           DescriptorSetLayout &global_set_layout, DescriptorPool &global_pool,
+                                           std::vector<VkDescriptorSet> &global_descriptor_sets)
+    : device(device), pipelineCompiler(pipeline_compiler), globalSetLayout(global_set_layout),
+      globalPool(global_pool), pipelineLayout(VK_NULL_HANDLE),
+      lightBuffers(device, "LIGHT", sizeof(PointLight), MIN_LIGHT_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+{
+    assert(!global_descriptor_sets.empty() && global_descriptor_sets.size() <= Swapchain::MAX_FRAMES_IN_FLIGHT &&
+           "LIGHT CLUSTER SYSTEM NEEDS ONE GLOBAL DESCRIPTOR SET PER FRAME IN FLIGHT");
+
+    createPipelineLayout();
+    createPipeline();
+    createBuffers(global_descriptor_sets);
+}
+
+vk::LightClusterSystem::~LightClusterSystem()
+{
+    // Released with the pipeline, once the frames in flight that dispatch it have finished
+    device.getGraphicsTimeline().defer([logical_device = device.getLogicalDevice(), pipeline_layout = pipelineLayout,
+                                        shader = std::shared_ptr<Shader>(std::move(compShader)),
+                                        pipeline = std::shared_ptr<ComputePipeline>(std::move(pipeline))] {
+        vkDestroyPipelineLayout(logical_device, pipeline_layout, nullptr);
+    });
+}
+
+void vk::LightClusterSystem::update(const FrameInfo &frame_info, GlobalUBO &ubo,
+                                    const std::unordered_map<Object::objid_t, int> &shadow_slots)
+{
+    SVKE_PROFILE_SCOPE("LightClusterSystem::update");
+
+    lights.clear();
+
+    for (auto &[id, object] : frame_info.objects)
+    {
+        if (!object.getPointLightComponent())
+            continue;
+
+        const Vec3f color = object.getColor().toVec3();
+        const float intensity = object.getPointLightComponent()->lightIntensity;
+
+        PointLight light = {};
+        light.position = Vec4f{object.getTranslation(), getLightRange(object)};
+        light.color = Vec4f{color, intensity};
+
+        const auto slot = shadow_slots.find(id);
+        if (slot != shadow_slots.end())
+            light.shadowSlot = slot->second;
+
+        lights.push_back(light);
+    }
+
+    reserveLights(frame_info.frameIndex, frame_info.globalDescriptorSet, lights.size());
+
+    if (!lights.empty())
+        lightBuffers.getBuffer(frame_info.frameIndex).write(lights.data(), lights.size() * sizeof(PointLight));
+
+    ubo.numLights = static_cast<int>(lights.size());
+}
+
+const float vk::LightClusterSystem::getLightRange(const Object &light)
+{
+    assert(light.getPointLightComponent() && "OBJECT IS NOT A POINT LIGHT");
+
+    const Vec3f color = light.getColor().toVec3();
+    const float intensity = light.getPointLightComponent()->lightIntensity;
+
+    // Attenuation is 1 / d², so the brightest channel reaches the cutoff at d = sqrt(brightest / cutoff)
+    const float brightest = std::max({color.r, color.g, color.b}) * intensity;
+
+    return std::sqrt(brightest / LIGHT_CUTOFF);
+}
+
+void vk::LightClusterSystem::cull(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("LightClusterSystem::cull");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "Light culling");
+
+    pipeline->bind(frame_info.commandBuffer);
+
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
+
+    vkCmdDispatch(frame_info.commandBuffer, (CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+}
+
+const vk::RenderGraph::ResourceId vk::LightClusterSystem::addCullPass(RenderGraph &render_graph,
+                                                                      const FrameInfo &frame_info)
+{
+    // Its previous contents were read by the frame that last had this index, which has finished
+    const RenderGraph::ResourceId clusters = render_graph.importBuffer(
+        "Light clusters", clusterBuffers[frame_info.frameIndex]->getBuffer());
+
+    render_graph.addPass("Light culling")
+        .write(clusters, RenderGraph::Usage::StorageCompute)
+        .setExecute([this, &frame_info](VkCommandBuffer &) { cull(frame_info); });
+
+    return clusters;
+}
+
+void vk::LightClusterSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {COMP_SHADER_PATH}))
+        return;
+
+    try
+    {
+        auto comp_shader = std::make_unique<Shader>(device, COMP_SHADER_PATH);
+        auto compute_pipeline = std::make_unique<ComputePipeline>(device, *comp_shader, pipelineLayout,
+                                                                  pipelineCompiler.getPipelineCache());
+
+        // Frames in flight may still dispatch the previous pipeline, it is released once they have finished
+        device.getGraphicsTimeline().defer(
+            [previous_shader = std::shared_ptr<Shader>(std::move(compShader)),
+             previous_pipeline = std::shared_ptr<ComputePipeline>(std::move(pipeline))] {});
+
+        compShader = std::move(comp_shader);
+        pipeline = std::move(compute_pipeline);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << std::endl;
+        std::cerr << "vk::LightClusterSystem::reloadShaders: KEEPING THE PREVIOUS PIPELINE" << std::endl;
+    }
+}
+
+void vk::LightClusterSystem::createPipelineLayout()
+{
+    std::vector<VkDescriptorSetLayout> global_set_layouts{globalSetLayout.getDescriptorSetLayout()};
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(global_set_layouts.size());
+    pipeline_layout_info.pSetLayouts = global_set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::LightClusterSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
+}
+
+void vk::LightClusterSystem::createPipeline()
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    compShader = std::make_unique<Shader>(device, COMP_SHADER_PATH);
+    pipeline = std::make_unique<ComputePipeline>(device, *compShader, pipelineLayout,
+                                                 pipelineCompiler.getPipelineCache());
+}
+
+void vk::LightClusterSystem::createBuffers(std::vector<VkDescriptorSet> &global_descriptor_sets)
+{
+    // Per cluster: the light count followed by a fixed number of light index slots
+    const VkDeviceSize cluster_buffer_size = CLUSTER_COUNT * (1 + MAX_LIGHTS_PER_CLUSTER) * sizeof(uint32_t);
+
+    for (int i = 0; i < global_descriptor_sets.size(); ++i)
+    {
+        clusterBuffers[i] = std::make_unique<Buffer>(device, cluster_buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                     VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+
+        auto cluster_buffer_info = clusterBuffers[i]->getDescriptorInfo();
+        DescriptorWriter(globalSetLayout, globalPool)
+            .writeBuffer(2, cluster_buffer_info)
+            .overwrite(global_descriptor_sets[i]);
+
+        reserveLights(i, global_descriptor_sets[i], MIN_LIGHT_CAPACITY);
+    }
+}
+
+void vk::LightClusterSystem::reserveLights(const int frame_index, VkDescriptorSet &global_descriptor_set,
+                                           const size_t light_count)
+{
+    if (!lightBuffers.reserve(frame_index, light_count))
+        return;
+
+    auto light_buffer_info = lightBuffers.getBuffer(frame_index).getDescriptorInfo();
+    DescriptorWriter(globalSetLayout, globalPool).writeBuffer(1, light_buffer_info).overwrite(global_descriptor_set);
+}
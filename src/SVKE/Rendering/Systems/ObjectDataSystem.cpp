@@ -0,0 +1,76 @@
+#include "SVKE/Rendering/Systems/ObjectDataSystem.hpp"
+
+#include <algorithm>
+
+vk::ObjectDataSystem::ObjectDataSystem(Device &device, DescriptorSetLayout &global_set_layout,
+                                       DescriptorPool &global_pool,
+                                       std::vector<VkDescriptorSet> &global_descriptor_sets)
+    : device(device), globalSetLayout(global_set_layout), globalPool(global_pool),
+      objectBuffers(device, "OBJECT", sizeof(ObjectData), MIN_OBJECT_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+{
+    assert(!global_descriptor_sets.empty() && global_descriptor_sets.size() <= Swapchain::MAX_FRAMES_IN_FLIGHT &&
+           "OBJECT DATA SYSTEM NEEDS ONE GLOBAL DESCRIPTOR SET PER FRAME IN FLIGHT");
+
+    for (int i = 0; i < global_descriptor_sets.size(); ++i)
+        reserveObjects(i, global_descriptor_sets[i], MIN_OBJECT_CAPACITY);
+}
+
+void vk::ObjectDataSystem::update(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("ObjectDataSystem::update");
+
+    // Lights without a model are left out, so the objects always fit
+    reserveObjects(frame_info.frameIndex, frame_info.globalDescriptorSet, frame_info.objects.size());
+
+    auto *object_data = static_cast<ObjectData *>(objectBuffers.getBuffer(frame_info.frameIndex).getMappedMemory());
+    std::fill(objectIndices.begin(), objectIndices.end(), NO_OBJECT_INDEX);
+
+    // Written in order and never read back, the buffer may be write-combined memory
+    uint32_t object_count = 0;
+    for (auto &[id, object] : frame_info.objects)
+    {
+        if (!object.getModel())
+            continue;
+
+        const Mat3f normal_matrix = object.normalMatrix();
+
+        ObjectData &data = object_data[object_count];
+        data.modelMatrix = object.transform();
+        data.normalMatrix[0] = Vec4f{normal_matrix[0], 0.f};
+        data.normalMatrix[1] = Vec4f{normal_matrix[1], 0.f};
+        data.normalMatrix[2] = Vec4f{normal_matrix[2], 0.f};
+        data.color = object.getColor().toVec4();
+
+        if (id >= objectIndices.size())
+            objectIndices.resize(id + 1, NO_OBJECT_INDEX);
+
+        objectIndices[id] = object_count++;
+    }
+
+    FrameStats::countUpload(object_count * sizeof(ObjectData));
+}
+
+const std::vector<uint32_t> &vk::ObjectDataSystem::getObjectIndices() const
+{
+    return objectIndices;
+}
+
+const VkPushConstantRange vk::ObjectDataSystem::getPushConstantRange()
+{
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(ObjectPushConstantData);
+
+    return push_constant_range;
+}
+
+void vk::ObjectDataSystem::reserveObjects(const int frame_index, VkDescriptorSet &global_descriptor_set,
+                                          const size_t object_count)
+{
+    if (!objectBuffers.reserve(frame_index, object_count))
+        return;
+
+    auto object_buffer_info = objectBuffers.getBuffer(frame_index).getDescriptorInfo();
+    DescriptorWriter(globalSetLayout, globalPool).writeBuffer(4, object_buffer_info).overwrite(global_descriptor_set);
+}
@@ -0,0 +1,782 @@
+#include "SVKE/Rendering/Systems/OcclusionCullingSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+vk::OcclusionCullingSystem::OcclusionCullingSystem(Device &device, Renderer &renderer,
+                                                   PipelineCompiler &pipeline_compiler,
+                                                   DescriptorSetLayout &global_set_layout)
+    : device(device), renderer(renderer), colorFormat(renderer.getImageFormat()),
+      depthFormat(renderer.getDepthFormat()), pipelineCompiler(pipeline_compiler), globalSetLayout(global_set_layout),
+      drawPipelineLayout(VK_NULL_HANDLE), cullPipelineLayout(VK_NULL_HANDLE), pyramidPipelineLayout(VK_NULL_HANDLE),
+      visibilityGeneration(0), pyramidExtent{0, 0}, pyramidLevelCount(0), commandResource(0), countResource(0),
+      visibilityResource(0), pyramidResource(0), visibilitySlotCount(0), frameCounter(0)
+{
+    // Every object is drawn as its own instance of an indirect draw, found through firstInstance
+    if (!device.getEnabledFeatures().drawIndirectFirstInstance || !device.getEnabledFeatures().multiDrawIndirect)
+        throw std::runtime_error("vk::OcclusionCullingSystem::OcclusionCullingSystem: DEVICE DOES NOT SUPPORT MULTI "
+                                 "DRAW INDIRECT WITH FIRST INSTANCE");
+
+    loadShaders();
+    createDescriptors();
+    createPipelineLayouts();
+    createComputePipelines();
+    createPyramidSampler();
+
+    Pipeline::Config pipeline_config = {};
+    populatePipelineConfig(pipeline_config);
+
+    drawPipeline = pipelineCompiler.compile(*vertShader, *fragShader, pipeline_config);
+}
+
+vk::OcclusionCullingSystem::~OcclusionCullingSystem()
+{
+    // The layout is referenced by the pending compilation, so it has to finish first
+    drawPipeline->wait();
+
+    vkDestroyPipelineLayout(device.getLogicalDevice(), drawPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device.getLogicalDevice(), cullPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pyramidPipelineLayout, nullptr);
+}
+
+void vk::OcclusionCullingSystem::update(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("OcclusionCullingSystem::update");
+
+    gatherObjects(frame_info);
+
+    if (culledObjects.empty())
+        return;
+
+    auto &frame = frames[frame_info.frameIndex];
+
+    reserveFrameBuffers(frame_info.frameIndex, culledObjects.size(), groupData.size());
+    reserveVisibility(frame_info.commandBuffer);
+
+    frame.objectBuffer->write(culledObjects.data(), culledObjects.size() * sizeof(CulledObjectData));
+    frame.groupBuffer->write(groupData.data(), groupData.size() * sizeof(GroupData));
+
+    // The first level is half the size of the depth attachment, rounded up so no pixel is left out
+    const VkExtent2D extent = renderer.getExtent();
+    pyramidExtent = {std::max((extent.width + 1) / 2, 1u), std::max((extent.height + 1) / 2, 1u)};
+    pyramidLevelCount = std::min(
+        static_cast<uint32_t>(std::floor(std::log2(std::max(pyramidExtent.width, pyramidExtent.height)))) + 1,
+        MAX_PYRAMID_LEVELS);
+}
+
+void vk::OcclusionCullingSystem::addEarlyPasses(RenderGraph &render_graph, const FrameInfo &frame_info)
+{
+    if (culledObjects.empty())
+        return;
+
+    auto &frame = frames[frame_info.frameIndex];
+
+    // Written by the late phase of the previous frame, and maybe grown by update since
+    RenderGraph::ResourceState visibility_state = {};
+    visibility_state.stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    visibility_state.access = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    commandResource = render_graph.importBuffer("Occlusion culling commands", frame.commandBuffer->getBuffer());
+    countResource = render_graph.importBuffer("Occlusion culling counts", frame.countBuffer->getBuffer());
+    visibilityResource =
+        render_graph.importBuffer("Occlusion culling visibility", visibilityBuffer->getBuffer(), visibility_state);
+
+    RenderGraph::ImageInfo pyramid_info = {};
+    pyramid_info.format = VK_FORMAT_R32_SFLOAT;
+    pyramid_info.extent = pyramidExtent;
+    pyramid_info.levelCount = pyramidLevelCount;
+    pyramid_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    pyramidResource = render_graph.createImage("Depth pyramid", pyramid_info);
+
+    render_graph.addPass("Occlusion culling (clear)")
+        .write(commandResource, RenderGraph::Usage::TransferDestination)
+        .write(countResource, RenderGraph::Usage::TransferDestination)
+        .setExecute([this, &frame_info](VkCommandBuffer &) { clearCommands(frame_info); });
+
+    // The pyramid is not tested against in this phase, it is only bound
+    render_graph.addPass("Occlusion culling (early)")
+        .write(commandResource, RenderGraph::Usage::StorageCompute)
+        .write(countResource, RenderGraph::Usage::StorageCompute)
+        .read(visibilityResource, RenderGraph::Usage::StorageCompute)
+        .read(pyramidResource, RenderGraph::Usage::SampledCompute)
+        .setExecute([this, &render_graph, &frame_info](VkCommandBuffer &command_buffer) {
+            GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, command_buffer, "Occlusion culling (early)");
+
+            // The sets are bound from here on, so the transient pyramid has to be written into them first
+            updateDescriptorSets(frame_info.frameIndex, render_graph);
+            dispatchCull(frame_info, Phase::Early);
+        });
+}
+
+void vk::OcclusionCullingSystem::addLatePasses(RenderGraph &render_graph, const FrameInfo &frame_info,
+                                               const RenderGraph::ResourceId depth)
+{
+    if (culledObjects.empty())
+        return;
+
+    render_graph.addPass("Depth pyramid")
+        .read(depth, RenderGraph::Usage::SampledCompute)
+        .write(pyramidResource, RenderGraph::Usage::StorageCompute)
+        .setExecute([this, &render_graph, &frame_info](VkCommandBuffer &) { buildPyramid(frame_info, render_graph); });
+
+    render_graph.addPass("Occlusion culling (late)")
+        .write(commandResource, RenderGraph::Usage::StorageCompute)
+        .write(countResource, RenderGraph::Usage::StorageCompute)
+        .write(visibilityResource, RenderGraph::Usage::StorageCompute)
+        .read(pyramidResource, RenderGraph::Usage::SampledCompute)
+        .setExecute([this, &frame_info](VkCommandBuffer &command_buffer) {
+            GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, command_buffer, "Occlusion culling (late)");
+
+            dispatchCull(frame_info, Phase::Late);
+        });
+}
+
+void vk::OcclusionCullingSystem::readDrawCommands(RenderGraph::PassBuilder &pass)
+{
+    if (culledObjects.empty())
+        return;
+
+    pass.read(commandResource, RenderGraph::Usage::Indirect).read(countResource, RenderGraph::Usage::Indirect);
+}
+
+void vk::OcclusionCullingSystem::renderEarly(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("OcclusionCullingSystem::renderEarly");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer,
+                                      "OcclusionCullingSystem (early)");
+
+    drawIndirect(frame_info, Phase::Early);
+}
+
+void vk::OcclusionCullingSystem::renderLate(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("OcclusionCullingSystem::renderLate");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer,
+                                      "OcclusionCullingSystem (late)");
+
+    drawIndirect(frame_info, Phase::Late);
+}
+
+void vk::OcclusionCullingSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH, FRAG_SHADER_PATH}))
+    {
+        // Queued compilations still reference the current shader modules, the compiler keeps them until they are done
+        pipelineCompiler.retire(std::move(vertShader));
+        pipelineCompiler.retire(std::move(fragShader));
+
+        vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+        fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
+
+        Pipeline::Config pipeline_config = {};
+        populatePipelineConfig(pipeline_config);
+
+        pipelineCompiler.recompile(drawPipeline, *vertShader, *fragShader, pipeline_config);
+    }
+
+    if (!Shader::isAnyChanged(spv_paths, {CULL_SHADER_PATH, PYRAMID_SHADER_PATH, PYRAMID_MS_SHADER_PATH}))
+        return;
+
+    try
+    {
+        auto cull_shader = std::make_unique<Shader>(device, CULL_SHADER_PATH);
+        auto pyramid_shader = std::make_unique<Shader>(device, PYRAMID_SHADER_PATH);
+        auto cull_pipeline = std::make_unique<ComputePipeline>(device, *cull_shader, cullPipelineLayout,
+                                                               pipelineCompiler.getPipelineCache());
+        auto pyramid_pipeline = std::make_unique<ComputePipeline>(device, *pyramid_shader, pyramidPipelineLayout,
+                                                                  pipelineCompiler.getPipelineCache());
+
+        std::unique_ptr<Shader> pyramid_ms_shader;
+        std::unique_ptr<ComputePipeline> pyramid_ms_pipeline;
+
+        if (pyramidMsPipeline)
+        {
+            pyramid_ms_shader = std::make_unique<Shader>(device, PYRAMID_MS_SHADER_PATH);
+            pyramid_ms_pipeline = std::make_unique<ComputePipeline>(device, *pyramid_ms_shader, pyramidPipelineLayout,
+                                                                    pipelineCompiler.getPipelineCache());
+        }
+
+        // Frames in flight may still dispatch the previous pipelines, they are released once they have finished
+        device.getGraphicsTimeline().defer(
+            [previous_cull_shader = std::shared_ptr<Shader>(std::move(cullShader)),
+             previous_pyramid_shader = std::shared_ptr<Shader>(std::move(pyramidShader)),
+             previous_pyramid_ms_shader = std::shared_ptr<Shader>(std::move(pyramidMsShader)),
+             previous_cull_pipeline = std::shared_ptr<ComputePipeline>(std::move(cullPipeline)),
+             previous_pyramid_pipeline = std::shared_ptr<ComputePipeline>(std::move(pyramidPipeline)),
+             previous_pyramid_ms_pipeline = std::shared_ptr<ComputePipeline>(std::move(pyramidMsPipeline))] {});
+
+        cullShader = std::move(cull_shader);
+        pyramidShader = std::move(pyramid_shader);
+        pyramidMsShader = std::move(pyramid_ms_shader);
+        cullPipeline = std::move(cull_pipeline);
+        pyramidPipeline = std::move(pyramid_pipeline);
+        pyramidMsPipeline = std::move(pyramid_ms_pipeline);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << std::endl;
+        std::cerr << "vk::OcclusionCullingSystem::reloadShaders: KEEPING THE PREVIOUS PIPELINES" << std::endl;
+    }
+}
+
+void vk::OcclusionCullingSystem::loadShaders()
+{
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+    fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
+    cullShader = std::make_unique<Shader>(device, CULL_SHADER_PATH);
+    pyramidShader = std::make_unique<Shader>(device, PYRAMID_SHADER_PATH);
+
+    // A multisampled depth attachment needs its own first level, it cannot be read through a sampler2D
+    if (device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT)
+        pyramidMsShader = std::make_unique<Shader>(device, PYRAMID_MS_SHADER_PATH);
+}
+
+void vk::OcclusionCullingSystem::createDescriptors()
+{
+    const VkShaderStageFlags object_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Objects, groups, commands, counts, visibility and the depth pyramid
+    cullSetLayout = DescriptorSetLayout::Builder(device)
+                        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, object_stages)
+                        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                        .addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+                        .build();
+
+    // Level to reduce from and level to write
+    pyramidSetLayout = DescriptorSetLayout::Builder(device)
+                           .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+                           .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                           .build();
+
+    const uint32_t frames_in_flight = static_cast<uint32_t>(renderer.getFramesInFlight());
+
+    descriptorPool = DescriptorPool::Builder(device)
+                         .setMaxSets(frames_in_flight * (1 + MAX_PYRAMID_LEVELS))
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * frames_in_flight)
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                      frames_in_flight * (1 + MAX_PYRAMID_LEVELS))
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, frames_in_flight * MAX_PYRAMID_LEVELS)
+                         .build();
+
+    for (uint32_t i = 0; i < frames_in_flight; ++i)
+    {
+        if (!descriptorPool->allocateDescriptorSet(cullSetLayout->getDescriptorSetLayout(),
+                                                   frames[i].cullDescriptorSet))
+            throw std::runtime_error(
+                "vk::OcclusionCullingSystem::createDescriptors: FAILED TO ALLOCATE DESCRIPTOR SET");
+
+        for (auto &pyramid_descriptor_set : frames[i].pyramidDescriptorSets)
+            if (!descriptorPool->allocateDescriptorSet(pyramidSetLayout->getDescriptorSetLayout(),
+                                                       pyramid_descriptor_set))
+                throw std::runtime_error(
+                    "vk::OcclusionCullingSystem::createDescriptors: FAILED TO ALLOCATE DESCRIPTOR SET");
+    }
+}
+
+void vk::OcclusionCullingSystem::createPipelineLayouts()
+{
+    std::vector<VkDescriptorSetLayout> set_layouts{globalSetLayout.getDescriptorSetLayout(),
+                                                   cullSetLayout->getDescriptorSetLayout()};
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+    pipeline_layout_info.pSetLayouts = set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &drawPipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::OcclusionCullingSystem::createPipelineLayouts: FAILED TO CREATE PIPELINE LAYOUT");
+
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(CullPushConstantData);
+
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &cullPipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::OcclusionCullingSystem::createPipelineLayouts: FAILED TO CREATE PIPELINE LAYOUT");
+
+    std::vector<VkDescriptorSetLayout> pyramid_set_layouts{pyramidSetLayout->getDescriptorSetLayout()};
+
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(pyramid_set_layouts.size());
+    pipeline_layout_info.pSetLayouts = pyramid_set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pyramidPipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::OcclusionCullingSystem::createPipelineLayouts: FAILED TO CREATE PIPELINE LAYOUT");
+}
+
+void vk::OcclusionCullingSystem::createComputePipelines()
+{
+    assert(cullPipelineLayout != VK_NULL_HANDLE && pyramidPipelineLayout != VK_NULL_HANDLE &&
+           "CANNOT CREATE PIPELINES BEFORE PIPELINE LAYOUTS");
+
+    cullPipeline = std::make_unique<ComputePipeline>(device, *cullShader, cullPipelineLayout,
+                                                     pipelineCompiler.getPipelineCache());
+    pyramidPipeline = std::make_unique<ComputePipeline>(device, *pyramidShader, pyramidPipelineLayout,
+                                                        pipelineCompiler.getPipelineCache());
+
+    if (pyramidMsShader)
+        pyramidMsPipeline = std::make_unique<ComputePipeline>(device, *pyramidMsShader, pyramidPipelineLayout,
+                                                              pipelineCompiler.getPipelineCache());
+}
+
+void vk::OcclusionCullingSystem::createPyramidSampler()
+{
+    // Only read with texelFetch, the sampler is there because the bindings are combined image samplers
+    TextureSampler::Config sampler_config = {};
+    TextureSampler::defaultTextureSamplerConfig(sampler_config);
+    sampler_config.magnificationFilter = VK_FILTER_NEAREST;
+    sampler_config.minificationFilter = VK_FILTER_NEAREST;
+    sampler_config.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_config.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.maxLod = static_cast<float>(MAX_PYRAMID_LEVELS);
+
+    pyramidSampler = std::make_unique<TextureSampler>(device, sampler_config);
+}
+
+void vk::OcclusionCullingSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
+{
+    assert(drawPipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    Pipeline::defaultPipelineConfig(pipeline_config);
+
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
+    pipeline_config.pipelineLayout = drawPipelineLayout;
+    pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
+    pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipeline_config.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    // Shaded like the default variant of the RenderSystem
+    ShaderVariant variant = {};
+    variant.sampleShading = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+    variant.apply(pipeline_config);
+}
+
+void vk::OcclusionCullingSystem::gatherObjects(const FrameInfo &frame_info)
+{
+    ++frameCounter;
+
+    drawObjects.clear();
+    culledObjects.clear();
+    groupData.clear();
+    groups.clear();
+
+    // Same objects as the RenderSystem draws
+    for (auto &[_, object] : frame_info.objects)
+        if (object.getModel() && !object.getTextureImage() && !object.isTransparent())
+            drawObjects.emplace_back(object.getModel().get(), &object);
+
+    std::sort(drawObjects.begin(), drawObjects.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    for (auto &[model, object] : drawObjects)
+    {
+        if (groups.empty() || groups.back().model != model)
+        {
+            Group group = {};
+            group.model = model;
+            group.firstObject = static_cast<uint32_t>(culledObjects.size());
+            groups.push_back(group);
+
+            // Every object of the group gets a command slot per phase, in case they are all visible
+            GroupData group_data = {};
+            group_data.firstCommand = group.firstObject;
+            group_data.elementCount = model->isIndexed() ? model->getIndexCount() : model->getVertexCount();
+            group_data.indexed = model->isIndexed() ? 1 : 0;
+            groupData.push_back(group_data);
+        }
+
+        ++groups.back().objectCount;
+
+        const Mat4f transform = object->transform();
+        const Vec4f sphere = model->getBoundingSphere();
+
+        // The radius grows with the largest scale, so the sphere still encloses a non-uniformly scaled model
+        const float scale = std::max({glm::length(Vec3f(transform[0])), glm::length(Vec3f(transform[1])),
+                                      glm::length(Vec3f(transform[2]))});
+
+        CulledObjectData data = {};
+        data.boundingSphere = Vec4f(Vec3f(transform * Vec4f(Vec3f(sphere), 1.f)), sphere.w * scale);
+        data.objectIndex = frame_info.objectIndices[object->getId()];
+        data.group = static_cast<uint32_t>(groups.size() - 1);
+        data.visibilitySlot = acquireVisibilitySlot(object->getId());
+
+        culledObjects.push_back(data);
+    }
+
+    // Slots of objects that are gone can be reused, whatever they held is treated as visible once
+    for (auto it = visibilitySlots.begin(); it != visibilitySlots.end();)
+    {
+        if (it->second.lastSeen == frameCounter)
+        {
+            ++it;
+            continue;
+        }
+
+        freeVisibilitySlots.push_back(it->second.index);
+        it = visibilitySlots.erase(it);
+    }
+}
+
+const uint32_t vk::OcclusionCullingSystem::acquireVisibilitySlot(const Object::objid_t id)
+{
+    auto it = visibilitySlots.find(id);
+
+    if (it == visibilitySlots.end())
+    {
+        VisibilitySlot slot = {};
+
+        if (!freeVisibilitySlots.empty())
+        {
+            slot.index = freeVisibilitySlots.back();
+            freeVisibilitySlots.pop_back();
+        }
+        else
+        {
+            slot.index = visibilitySlotCount++;
+        }
+
+        it = visibilitySlots.emplace(id, slot).first;
+    }
+
+    it->second.lastSeen = frameCounter;
+
+    return it->second.index;
+}
+
+void vk::OcclusionCullingSystem::reserveFrameBuffers(const int frame_index, const size_t object_count,
+                                                     const size_t group_count)
+{
+    auto &frame = frames[frame_index];
+
+    // The previous buffers of this frame index are no longer in use: its submission has finished before it began
+    if (!frame.objectBuffer || frame.objectBuffer->getSize() < object_count * sizeof(CulledObjectData))
+    {
+        size_t capacity =
+            frame.objectBuffer ? frame.objectBuffer->getSize() / sizeof(CulledObjectData) : MIN_OBJECT_CAPACITY;
+
+        while (capacity < object_count)
+            capacity *= 2;
+
+        frame.objectBuffer = std::make_unique<Buffer>(device, capacity * sizeof(CulledObjectData),
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO,
+                                                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+        frame.objectBuffer->map();
+
+        // Early and late commands
+        frame.commandBuffer = std::make_unique<Buffer>(
+            device, 2 * capacity * COMMAND_STRIDE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+
+        auto object_buffer_info = frame.objectBuffer->getDescriptorInfo();
+        auto command_buffer_info = frame.commandBuffer->getDescriptorInfo();
+        DescriptorWriter(*cullSetLayout, *descriptorPool)
+            .writeBuffer(0, object_buffer_info)
+            .writeBuffer(2, command_buffer_info)
+            .overwrite(frame.cullDescriptorSet);
+
+#ifndef NDEBUG
+        std::cout << "OCCLUSION CULLING BUFFERS " << frame_index << " RESIZED TO " << capacity << " OBJECTS"
+                  << std::endl;
+#endif
+    }
+
+    if (!frame.groupBuffer || frame.groupBuffer->getSize() < group_count * sizeof(GroupData))
+    {
+        size_t capacity = frame.groupBuffer ? frame.groupBuffer->getSize() / sizeof(GroupData) : MIN_GROUP_CAPACITY;
+
+        while (capacity < group_count)
+            capacity *= 2;
+
+        frame.groupBuffer = std::make_unique<Buffer>(device, capacity * sizeof(GroupData),
+                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO,
+                                                     VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+        frame.groupBuffer->map();
+
+        // Early and late counts
+        frame.countBuffer = std::make_unique<Buffer>(
+            device, 2 * capacity * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+
+        auto group_buffer_info = frame.groupBuffer->getDescriptorInfo();
+        auto count_buffer_info = frame.countBuffer->getDescriptorInfo();
+        DescriptorWriter(*cullSetLayout, *descriptorPool)
+            .writeBuffer(1, group_buffer_info)
+            .writeBuffer(3, count_buffer_info)
+            .overwrite(frame.cullDescriptorSet);
+    }
+}
+
+void vk::OcclusionCullingSystem::reserveVisibility(VkCommandBuffer &command_buffer)
+{
+    // Copied from in the previous frame, which has been submitted since
+    if (retiredVisibilityBuffer)
+        device.getGraphicsTimeline().defer(
+            [previous_buffer = std::shared_ptr<Buffer>(std::move(retiredVisibilityBuffer))] {});
+
+    const VkDeviceSize required_size = std::max<VkDeviceSize>(visibilitySlotCount, 1) * sizeof(uint32_t);
+
+    if (visibilityBuffer && visibilityBuffer->getSize() >= required_size)
+        return;
+
+    VkDeviceSize capacity = visibilityBuffer ? visibilityBuffer->getSize() : MIN_OBJECT_CAPACITY * sizeof(uint32_t);
+
+    while (capacity < required_size)
+        capacity *= 2;
+
+    auto visibility_buffer = std::make_unique<Buffer>(
+        device, capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+
+    // New slots start out hidden, so they are only drawn once the late phase has tested them
+    VkDeviceSize kept_size = 0;
+
+    if (visibilityBuffer)
+    {
+        kept_size = visibilityBuffer->getSize();
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             1, &barrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy region = {};
+        region.srcOffset = 0;
+        region.dstOffset = 0;
+        region.size = kept_size;
+
+        vkCmdCopyBuffer(command_buffer, visibilityBuffer->getBuffer(), visibility_buffer->getBuffer(), 1, &region);
+
+        // Other frames in flight may still read it and this one copies from it, so it is only released once the
+        // frame was submitted
+        retiredVisibilityBuffer = std::move(visibilityBuffer);
+    }
+
+    vkCmdFillBuffer(command_buffer, visibility_buffer->getBuffer(), kept_size, capacity - kept_size, 0);
+
+    visibilityBuffer = std::move(visibility_buffer);
+    ++visibilityGeneration;
+}
+
+void vk::OcclusionCullingSystem::updateDescriptorSets(const int frame_index, const RenderGraph &render_graph)
+{
+    auto &frame = frames[frame_index];
+
+    // Shared resources are rewritten into the sets of a frame index once it is free, after they changed
+    if (frame.visibilityGeneration != visibilityGeneration)
+    {
+        auto visibility_buffer_info = visibilityBuffer->getDescriptorInfo();
+        DescriptorWriter(*cullSetLayout, *descriptorPool)
+            .writeBuffer(4, visibility_buffer_info)
+            .overwrite(frame.cullDescriptorSet);
+
+        frame.visibilityGeneration = visibilityGeneration;
+    }
+
+    if (frame.pyramidGeneration == render_graph.getTransientGeneration())
+        return;
+
+    VkDescriptorImageInfo pyramid_info = {};
+    pyramid_info.sampler = pyramidSampler->getSampler();
+    pyramid_info.imageView = render_graph.getImageView(pyramidResource);
+    pyramid_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    DescriptorWriter(*cullSetLayout, *descriptorPool).writeImage(5, pyramid_info).overwrite(frame.cullDescriptorSet);
+
+    // Levels stay in GENERAL while the pyramid is built. The source of the first level is the depth attachment,
+    // written every frame by buildPyramid.
+    for (uint32_t level = 0; level < pyramidLevelCount; ++level)
+    {
+        VkDescriptorImageInfo destination_info = {};
+        destination_info.imageView = render_graph.getLevelView(pyramidResource, level);
+        destination_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo source_info = {};
+        source_info.sampler = pyramidSampler->getSampler();
+        source_info.imageView = level > 0 ? render_graph.getLevelView(pyramidResource, level - 1) : VK_NULL_HANDLE;
+        source_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        DescriptorWriter writer(*pyramidSetLayout, *descriptorPool);
+        writer.writeImage(1, destination_info);
+
+        if (level > 0)
+            writer.writeImage(0, source_info);
+
+        writer.overwrite(frame.pyramidDescriptorSets[level]);
+    }
+
+    frame.pyramidGeneration = render_graph.getTransientGeneration();
+}
+
+void vk::OcclusionCullingSystem::clearCommands(const FrameInfo &frame_info)
+{
+    auto &frame = frames[frame_info.frameIndex];
+
+    vkCmdFillBuffer(frame_info.commandBuffer, frame.commandBuffer->getBuffer(), 0,
+                    2 * culledObjects.size() * COMMAND_STRIDE, 0);
+    vkCmdFillBuffer(frame_info.commandBuffer, frame.countBuffer->getBuffer(), 0,
+                    2 * groupData.size() * sizeof(uint32_t), 0);
+}
+
+void vk::OcclusionCullingSystem::buildPyramid(const FrameInfo &frame_info, const RenderGraph &render_graph)
+{
+    SVKE_PROFILE_SCOPE("OcclusionCullingSystem::buildPyramid");
+
+    auto &frame = frames[frame_info.frameIndex];
+    VkCommandBuffer &command_buffer = frame_info.commandBuffer;
+
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, command_buffer, "Depth pyramid");
+
+    // The attachment changes with the image of the frame, so the first level reads a different one every time
+    VkDescriptorImageInfo depth_info = {};
+    depth_info.sampler = pyramidSampler->getSampler();
+    depth_info.imageView = renderer.getDepthImageView();
+    depth_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    DescriptorWriter(*pyramidSetLayout, *descriptorPool)
+        .writeImage(0, depth_info)
+        .overwrite(frame.pyramidDescriptorSets[0]);
+
+    for (uint32_t level = 0; level < pyramidLevelCount; ++level)
+    {
+        // Only the first level may read a multisampled image
+        if (level == 0)
+            (pyramidMsPipeline ? pyramidMsPipeline : pyramidPipeline)->bind(command_buffer);
+        else if (level == 1 && pyramidMsPipeline)
+            pyramidPipeline->bind(command_buffer);
+
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramidPipelineLayout, 0, 1,
+                                &frame.pyramidDescriptorSets[level], 0, nullptr);
+        FrameStats::countDescriptorBinds(1);
+
+        const uint32_t width = std::max(pyramidExtent.width >> level, 1u);
+        const uint32_t height = std::max(pyramidExtent.height >> level, 1u);
+
+        vkCmdDispatch(command_buffer, (width + PYRAMID_WORKGROUP_SIZE - 1) / PYRAMID_WORKGROUP_SIZE,
+                      (height + PYRAMID_WORKGROUP_SIZE - 1) / PYRAMID_WORKGROUP_SIZE, 1);
+
+        // Each level is reduced from the previous one, the graph orders the last one before the late culling
+        if (level + 1 == pyramidLevelCount)
+            break;
+
+        VkImageMemoryBarrier2 barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = render_graph.getImage(pyramidResource);
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        VkDependencyInfo dependency_info = {};
+        dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency_info.imageMemoryBarrierCount = 1;
+        dependency_info.pImageMemoryBarriers = &barrier;
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        FrameStats::countBarriers(1);
+    }
+}
+
+void vk::OcclusionCullingSystem::dispatchCull(const FrameInfo &frame_info, const Phase phase)
+{
+    auto &frame = frames[frame_info.frameIndex];
+    const VkExtent2D extent = renderer.getExtent();
+
+    cullPipeline->bind(frame_info.commandBuffer);
+
+    std::array<VkDescriptorSet, 2> descriptor_sets = {frame_info.globalDescriptorSet, frame.cullDescriptorSet};
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0,
+                            static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(), 0, nullptr);
+    FrameStats::countDescriptorBinds(2);
+
+    CullPushConstantData push = {};
+    push.depthSize = Vec2f{static_cast<float>(extent.width), static_cast<float>(extent.height)};
+    push.objectCount = static_cast<uint32_t>(culledObjects.size());
+    push.groupCount = static_cast<uint32_t>(groupData.size());
+    push.phase = phase;
+    push.pyramidLevelCount = pyramidLevelCount;
+
+    vkCmdPushConstants(frame_info.commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(CullPushConstantData), &push);
+
+    vkCmdDispatch(frame_info.commandBuffer, (push.objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+void vk::OcclusionCullingSystem::drawIndirect(const FrameInfo &frame_info, const Phase phase)
+{
+    if (culledObjects.empty() || !drawPipeline->bind(frame_info.commandBuffer))
+        return;
+
+    auto &frame = frames[frame_info.frameIndex];
+
+    std::array<VkDescriptorSet, 2> descriptor_sets = {frame_info.globalDescriptorSet, frame.cullDescriptorSet};
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipelineLayout, 0,
+                            static_cast<uint32_t>(descriptor_sets.size()), descriptor_sets.data(), 0, nullptr);
+    FrameStats::countDescriptorBinds(2);
+
+    // Without drawIndirectCount every slot of the group is drawn, the unused ones have no instances
+    const bool indirect_count = device.getEnabledVulkan12Features().drawIndirectCount;
+
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const Group &group = groups[i];
+
+        const VkDeviceSize command_offset = (phase * culledObjects.size() + group.firstObject) * COMMAND_STRIDE;
+        const VkDeviceSize count_offset = (phase * groupData.size() + i) * sizeof(uint32_t);
+
+        group.model->bind(frame_info.commandBuffer);
+
+        if (group.model->isIndexed() && indirect_count)
+            vkCmdDrawIndexedIndirectCount(frame_info.commandBuffer, frame.commandBuffer->getBuffer(), command_offset,
+                                          frame.countBuffer->getBuffer(), count_offset, group.objectCount,
+                                          static_cast<uint32_t>(COMMAND_STRIDE));
+
+        else if (group.model->isIndexed())
+            vkCmdDrawIndexedIndirect(frame_info.commandBuffer, frame.commandBuffer->getBuffer(), command_offset,
+                                     group.objectCount, static_cast<uint32_t>(COMMAND_STRIDE));
+
+        else if (indirect_count)
+            vkCmdDrawIndirectCount(frame_info.commandBuffer, frame.commandBuffer->getBuffer(), command_offset,
+                                   frame.countBuffer->getBuffer(), count_offset, group.objectCount,
+                                   static_cast<uint32_t>(COMMAND_STRIDE));
+
+        else
+            vkCmdDrawIndirect(frame_info.commandBuffer, frame.commandBuffer->getBuffer(), command_offset,
+                              group.objectCount, static_cast<uint32_t>(COMMAND_STRIDE));
+
+        // The GPU decides how many objects are drawn, so their triangles are not counted
+        FrameStats::countDraw(0);
+    }
+}
@@ -1,127 +1,176 @@
 #include "SVKE/Rendering/Systems/PointLightSystem.hpp"
 
-vk::PointLightSystem::PointLightSystem(Device &device, Renderer &renderer, DescriptorSetLayout &global_set_layout)
-    : device(device), pipelineLayout(VK_NULL_HANDLE)
+vk::PointLightSystem::PointLightSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                                       DescriptorSetLayout &global_set_layout)
+    : device(device), colorFormat(renderer.getImageFormat()), depthFormat(renderer.getDepthFormat()),
+      pipelineLayout(VK_NULL_HANDLE), pipelineCompiler(pipeline_compiler),
+      variants(pipeline_compiler,
+               [this](Pipeline::Config &pipeline_config) { populatePipelineConfig(pipeline_config); }),
+      instanceBuffers(device, "POINT LIGHT INSTANCE", sizeof(PointLightInstance), MIN_INSTANCE_CAPACITY,
+                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
 {
     loadShaders();
     createPipelineLayout(global_set_layout);
-    createPipeline(renderer.getRenderPass());
+
+    ShaderVariant default_variant = {};
+    default_variant.sampleShading = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+    setVariant(default_variant);
 }
 
 vk::PointLightSystem::~PointLightSystem()
 {
+    // The layout is referenced by the pending compilations, so they have to finish first
+    variants.waitIdle();
     vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
 }
 
-void vk::PointLightSystem::update(const FrameInfo &frame_info, GlobalUBO &ubo)
+void vk::PointLightSystem::update(const FrameInfo &frame_info)
 {
-    auto rotate_light = Matrix::rotate(Matrix::identityMat4f(), frame_info.dt, {0.f, -1.f, 0.f});
+    SVKE_PROFILE_SCOPE("PointLightSystem::update");
 
-    int light_index = 0;
+    auto rotate_light = Matrix::rotate(Matrix::identityMat4f(), frame_info.dt, {0.f, -1.f, 0.f});
 
     for (auto &[_, object] : frame_info.objects)
     {
         if (!object.getPointLightComponent())
             continue;
 
-        assert(light_index < MAX_LIGHTS && "POINT LIGHTS EXCEEDED MAXIMUM SPECIFIED");
-
-        // Update
         object.setTranslation(Vec3f{rotate_light * Vec4f{object.getTranslation(), 1.0}});
-
-        // Copy data to UBO
-        ubo.pointLights[light_index].position = object.getTranslation();
-        ubo.pointLights[light_index].color =
-            Vec4f{object.getColor().toVec3(), object.getPointLightComponent()->lightIntensity};
-
-        ++light_index;
     }
-
-    ubo.numLights = light_index;
 }
 
 void vk::PointLightSystem::render(const FrameInfo &frame_info)
 {
-    // Sort lights
-    std::map<float, Object::objid_t> sorted;
+    SVKE_PROFILE_SCOPE("PointLightSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "PointLightSystem");
+
+    unsortedInstances.clear();
+    sortItems.clear();
+
+    const Vec3f camera_position = frame_info.camera.getPosition();
 
     for (auto &[_, object] : frame_info.objects)
     {
         if (!object.getPointLightComponent())
             continue;
 
-        // calculate distance
-        Vec3f offset = frame_info.camera.getPosition() - object.getTranslation();
-        float dis_squared = Vector::dot(offset, offset);
-        sorted[dis_squared] = object.getId();
+        const Vec3f offset = camera_position - object.getTranslation();
+        const float distance_squared = Vector::dot(offset, offset);
+
+        // Inverted key: the farthest light comes first, as required for blending. Equal distances are all kept.
+        const uint32_t key = ~floatToSortableKey(distance_squared);
+        sortItems.emplace_back(key, static_cast<uint32_t>(unsortedInstances.size()));
+
+        PointLightInstance instance = {};
+        instance.position = Vec4f{object.getTranslation(), object.getScale().x};
+        instance.color = Vec4f{object.getColor().toVec3(), object.getPointLightComponent()->lightIntensity};
+
+        unsortedInstances.push_back(instance);
     }
 
-    pipeline->bind(frame_info.commandBuffer);
+    if (unsortedInstances.empty())
+        return;
+
+    radixSort(sortItems, sortScratch);
+
+    sortedInstances.resize(unsortedInstances.size());
+
+    for (size_t i = 0; i < sortItems.size(); ++i)
+        sortedInstances[i] = unsortedInstances[sortItems[i].second];
+
+    instanceBuffers.reserve(frame_info.frameIndex, sortedInstances.size());
+
+    Buffer &instance_buffer = instanceBuffers.getBuffer(frame_info.frameIndex);
+    instance_buffer.write(sortedInstances.data(), sortedInstances.size() * sizeof(PointLightInstance));
+
+    if (!pipeline->bind(frame_info.commandBuffer))
+        return;
 
     vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
                             &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
 
-    for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
-    {
-        auto &object = frame_info.objects.at(it->second);
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(frame_info.commandBuffer, 0, 1, &instance_buffer.getBuffer(), &offset);
+
+    vkCmdDraw(frame_info.commandBuffer, 6, static_cast<uint32_t>(sortedInstances.size()), 0, 0);
+    FrameStats::countDraw(2 * sortedInstances.size());
+}
 
-        PointLightPushConstant push = {};
-        push.position = object.getTranslation();
-        push.color = Vec4f{object.getColor().toVec3(), object.getPointLightComponent()->lightIntensity};
-        push.radius = object.getScale().x;
+void vk::PointLightSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH, FRAG_SHADER_PATH}))
+        return;
 
-        vkCmdPushConstants(frame_info.commandBuffer, pipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PointLightPushConstant),
-                           &push);
+    // Queued compilations still reference the current shader modules, the compiler keeps them until they are done
+    pipelineCompiler.retire(std::move(vertShader));
+    pipelineCompiler.retire(std::move(fragShader));
 
-        vkCmdDraw(frame_info.commandBuffer, 6, 1, 0, 0);
-    }
+    loadShaders();
+    variants.recompileAll(*vertShader, *fragShader);
+}
+
+void vk::PointLightSystem::setVariant(const ShaderVariant &shader_variant)
+{
+    pipeline = variants.get(shader_variant, *vertShader, *fragShader, pipeline);
+    variant = shader_variant;
+}
+
+const vk::ShaderVariant &vk::PointLightSystem::getVariant() const
+{
+    return variant;
 }
 
 void vk::PointLightSystem::loadShaders()
 {
-    vertShader = std::make_unique<Shader>(device, "assets/shaders/point_light_system.vert.spv");
-    fragShader = std::make_unique<Shader>(device, "assets/shaders/point_light_system.frag.spv");
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+    fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
 }
 
 void vk::PointLightSystem::createPipelineLayout(DescriptorSetLayout &global_set_layout)
 {
-    VkPushConstantRange push_constant_range = {};
-    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_constant_range.offset = 0;
-    push_constant_range.size = sizeof(PointLightPushConstant);
-
     std::vector<VkDescriptorSetLayout> global_set_layouts{global_set_layout.getDescriptorSetLayout()};
 
     VkPipelineLayoutCreateInfo pipeline_layout_info = {};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(global_set_layouts.size());
     pipeline_layout_info.pSetLayouts = global_set_layouts.data();
-    pipeline_layout_info.pushConstantRangeCount = 1;
-    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
 
     if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pipelineLayout) !=
         VK_SUCCESS)
         throw std::runtime_error("vk::PointLightSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
 }
 
-void vk::PointLightSystem::createPipeline(VkRenderPass render_pass)
+void vk::PointLightSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
 {
     assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
 
-    Pipeline::Config pipeline_config = {};
     Pipeline::defaultPipelineConfig(pipeline_config);
     Pipeline::enableAlphaBlending(pipeline_config);
 
-    pipeline_config.attributeDescriptions.clear();
-    pipeline_config.bindingDescriptions.clear();
-    pipeline_config.renderPass = render_pass;
+    // The quad corners come from gl_VertexIndex, only the per-light data is read from the instance buffer
+    VkVertexInputBindingDescription binding_description = {};
+    binding_description.binding = 0;
+    binding_description.stride = sizeof(PointLightInstance);
+    binding_description.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    std::vector<VkVertexInputAttributeDescription> attribute_descriptions(2);
+    attribute_descriptions[0].location = 0;
+    attribute_descriptions[0].binding = 0;
+    attribute_descriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute_descriptions[0].offset = offsetof(PointLightInstance, position);
+
+    attribute_descriptions[1].location = 1;
+    attribute_descriptions[1].binding = 0;
+    attribute_descriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute_descriptions[1].offset = offsetof(PointLightInstance, color);
+
+    pipeline_config.bindingDescriptions = {binding_description};
+    pipeline_config.attributeDescriptions = attribute_descriptions;
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
     pipeline_config.pipelineLayout = pipelineLayout;
     pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
-
-    // Optional: Shader antialiasing, smooths inner parts of shapes. Might cost some performance
-    pipeline_config.multisampleInfo.sampleShadingEnable = VK_TRUE;
-    pipeline_config.multisampleInfo.minSampleShading = .2f;
-
-    pipeline = std::make_unique<Pipeline>(device, *vertShader, *fragShader, pipeline_config);
 }
@@ -0,0 +1,484 @@
+#include "SVKE/Rendering/Systems/PointShadowSystem.hpp"
+#include "SVKE/Rendering/Systems/LightClusterSystem.hpp"
+#include "SVKE/Utils/HashCombine.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Position relative to the light in the space of a cube face: xy spans the face, z is the distance along its axis.
+// Must match pointShadowFaceView in point_shadows.glsl.
+const vk::Vec3f faceView(const uint32_t face, const vk::Vec3f &relative)
+{
+    switch (face)
+    {
+    case 0:
+        return {relative.y, relative.z, relative.x};
+    case 1:
+        return {relative.y, relative.z, -relative.x};
+    case 2:
+        return {relative.x, relative.z, relative.y};
+    case 3:
+        return {relative.x, relative.z, -relative.y};
+    case 4:
+        return {relative.x, relative.y, relative.z};
+    default:
+        return {relative.x, relative.y, -relative.z};
+    }
+}
+
+// Faces whose 90° frustum the sphere reaches, it is inside of a face where z >= |x| and z >= |y|
+const uint32_t sphereFaceMask(const vk::Vec3f &relative, const float radius)
+{
+    const float side_scale = 1.f / std::sqrt(2.f);
+    uint32_t mask = 0;
+
+    for (uint32_t face = 0; face < vk::PointShadowSystem::FACE_COUNT; ++face)
+    {
+        const vk::Vec3f view = faceView(face, relative);
+
+        if ((view.z - view.x) * side_scale >= -radius && (view.z + view.x) * side_scale >= -radius &&
+            (view.z - view.y) * side_scale >= -radius && (view.z + view.y) * side_scale >= -radius)
+            mask |= 1u << face;
+    }
+
+    return mask;
+}
+} // namespace
+
+vk::PointShadowSystem::PointShadowSystem(Device &device, PipelineCompiler &pipeline_compiler,
+                                         DescriptorSetLayout &global_set_layout, DescriptorPool &global_pool,
+                                         std::vector<VkDescriptorSet> &global_descriptor_sets,
+                                         const uint32_t shadowed_light_count, const uint32_t resolution)
+    : device(device), shadowedLightCount(shadowed_light_count), resolution(resolution),
+      depthFormat(VK_FORMAT_UNDEFINED), atlasImage(VK_NULL_HANDLE), atlasAllocation(VK_NULL_HANDLE),
+      atlasView(VK_NULL_HANDLE), atlasInitialized(false), pipelineLayout(VK_NULL_HANDLE),
+      pipelineCompiler(pipeline_compiler), slots(shadowed_light_count), redrawnLightCount(0)
+{
+    assert(resolution > 0 && "POINT SHADOW RESOLUTION MUST NOT BE 0");
+
+    loadShaders();
+    createAtlas();
+    createSampler();
+    writeDescriptors(global_set_layout, global_pool, global_descriptor_sets);
+    createPipelineLayout();
+
+    Pipeline::Config pipeline_config = {};
+    populatePipelineConfig(pipeline_config);
+
+    pipeline = pipelineCompiler.compile(*vertShader, pipeline_config);
+}
+
+vk::PointShadowSystem::~PointShadowSystem()
+{
+    // The layout is referenced by the pending compilation, so it has to finish first
+    pipeline->wait();
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
+
+    for (auto &slot_view : slotViews)
+        vkDestroyImageView(device.getLogicalDevice(), slot_view, nullptr);
+
+    vkDestroyImageView(device.getLogicalDevice(), atlasView, nullptr);
+    device.destroyImage(atlasImage, atlasAllocation);
+}
+
+void vk::PointShadowSystem::update(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("PointShadowSystem::update");
+
+    shadowSlots.clear();
+    redrawnLightCount = 0;
+
+    for (auto &light_draw : lightDraws)
+    {
+        light_draw.casters.clear();
+        spareCasterLists.push_back(std::move(light_draw.casters));
+    }
+
+    lightDraws.clear();
+
+    // Until the pipeline is ready no cube can be drawn, the lights are left unshadowed instead of sampling garbage
+    if (!pipeline->isReady())
+        return;
+
+    assignSlots(frame_info);
+
+    for (uint32_t i = 0; i < slots.size(); ++i)
+    {
+        Slot &slot = slots[i];
+
+        if (!slot.used)
+            continue;
+
+        const Object &light = frame_info.objects.at(slot.light);
+        const Vec4f light_data = Vec4f{light.getTranslation(), LightClusterSystem::getLightRange(light)};
+
+        casters.clear();
+        const size_t signature = gatherCasters(frame_info, light_data, casters);
+
+        shadowSlots[slot.light] = static_cast<int>(i);
+
+        if (slot.cached && slot.signature == signature)
+            continue;
+
+        slot.signature = signature;
+        slot.cached = true;
+
+        LightDraw light_draw = {};
+        light_draw.slot = i;
+        light_draw.light = light_data;
+
+        if (!spareCasterLists.empty())
+        {
+            light_draw.casters = std::move(spareCasterLists.back());
+            spareCasterLists.pop_back();
+        }
+
+        light_draw.casters.assign(casters.begin(), casters.end());
+
+        lightDraws.push_back(std::move(light_draw));
+    }
+
+    redrawnLightCount = static_cast<uint32_t>(lightDraws.size());
+}
+
+const vk::RenderGraph::ResourceId vk::PointShadowSystem::addShadowPass(RenderGraph &render_graph,
+                                                                         const FrameInfo &frame_info)
+{
+    // Cached cubes were last sampled by the lit surfaces of the previous frame, and are left where they are
+    RenderGraph::ResourceState atlas_state = {};
+    atlas_state.stages = lightDraws.empty() ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    atlas_state.access = VK_ACCESS_2_NONE;
+    atlas_state.layout = atlasInitialized ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+
+    const RenderGraph::ResourceId atlas =
+        render_graph.importImage("Point shadow atlas", atlasImage, atlasView, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                 atlas_state, 1, std::max(shadowedLightCount, 1u) * FACE_COUNT);
+
+    if (lightDraws.empty() && atlasInitialized)
+        return atlas;
+
+    render_graph.addPass("Point shadows")
+        .write(atlas, RenderGraph::Usage::DepthAttachment)
+        .setExecute([this, &frame_info](VkCommandBuffer &) { render(frame_info); });
+
+    atlasInitialized = true;
+
+    return atlas;
+}
+
+const std::unordered_map<vk::Object::objid_t, int> &vk::PointShadowSystem::getShadowSlots() const
+{
+    return shadowSlots;
+}
+
+const uint32_t vk::PointShadowSystem::getRedrawnLightCount() const
+{
+    return redrawnLightCount;
+}
+
+void vk::PointShadowSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH}))
+        return;
+
+    // A queued compilation may still reference the current shader module, the compiler keeps it until it is done
+    pipelineCompiler.retire(std::move(vertShader));
+
+    loadShaders();
+
+    Pipeline::Config pipeline_config = {};
+    populatePipelineConfig(pipeline_config);
+
+    pipelineCompiler.recompile(pipeline, *vertShader, pipeline_config);
+
+    // Drawn again, with whichever version the handle binds by then, so edits show without moving a light
+    for (auto &slot : slots)
+        slot.cached = false;
+}
+
+void vk::PointShadowSystem::loadShaders()
+{
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+}
+
+void vk::PointShadowSystem::createAtlas()
+{
+    // Filtered by the compare sampler, which gives the shadow edges four taps for free
+    depthFormat = device.findSupportedFormat(
+        {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM}, VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+
+    // An atlas without lights still has one cube, so the global descriptor sets always hold a valid image
+    const uint32_t layer_count = std::max(shadowedLightCount, 1u) * FACE_COUNT;
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent.width = resolution;
+    image_info.extent.height = resolution;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = layer_count;
+    image_info.format = depthFormat;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.flags = 0;
+
+    device.createImageWithInfo(image_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, atlasImage, atlasAllocation);
+
+    // Sampled as a plain array, the shader picks the layer of a face itself, so no cube array support is needed
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = atlasImage;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    view_info.format = depthFormat;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = layer_count;
+
+    if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &atlasView) != VK_SUCCESS)
+        throw std::runtime_error("vk::PointShadowSystem::createAtlas: FAILED TO CREATE IMAGE VIEW");
+
+    slotViews.resize(shadowedLightCount, VK_NULL_HANDLE);
+
+    for (uint32_t i = 0; i < shadowedLightCount; ++i)
+    {
+        view_info.subresourceRange.baseArrayLayer = i * FACE_COUNT;
+        view_info.subresourceRange.layerCount = FACE_COUNT;
+
+        if (vkCreateImageView(device.getLogicalDevice(), &view_info, nullptr, &slotViews[i]) != VK_SUCCESS)
+            throw std::runtime_error("vk::PointShadowSystem::createAtlas: FAILED TO CREATE SLOT IMAGE VIEW");
+    }
+}
+
+void vk::PointShadowSystem::createSampler()
+{
+    // Compares against the reference depth, past the edge of a face nothing is in shadow
+    TextureSampler::Config sampler_config = {};
+    TextureSampler::defaultTextureSamplerConfig(sampler_config);
+    sampler_config.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_config.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.compareEnable = VK_TRUE;
+    sampler_config.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    sampler = std::make_unique<TextureSampler>(device, sampler_config);
+}
+
+void vk::PointShadowSystem::writeDescriptors(DescriptorSetLayout &global_set_layout, DescriptorPool &global_pool,
+                                             std::vector<VkDescriptorSet> &global_descriptor_sets)
+{
+    VkDescriptorImageInfo image_info = {};
+    image_info.sampler = sampler->getSampler();
+    image_info.imageView = atlasView;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    for (auto &global_descriptor_set : global_descriptor_sets)
+        DescriptorWriter(global_set_layout, global_pool).writeImage(3, image_info).overwrite(global_descriptor_set);
+}
+
+void vk::PointShadowSystem::createPipelineLayout()
+{
+    VkPushConstantRange push_constant_range = {};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(PushConstantData);
+
+    // Everything the shader needs is pushed, the cubes are drawn without the camera's global set
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 0;
+    pipeline_layout_info.pSetLayouts = nullptr;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error("vk::PointShadowSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
+}
+
+void vk::PointShadowSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    Pipeline::defaultPipelineConfig(pipeline_config);
+
+    // Same interleaved vertex buffer as the surfaces, only the position is fetched
+    pipeline_config.attributeDescriptions.resize(1);
+
+    // Depth only, the atlas is the sole attachment
+    pipeline_config.colorBlendInfo.attachmentCount = 0;
+    pipeline_config.colorBlendInfo.pAttachments = nullptr;
+
+    pipeline_config.depthAttachmentFormat = depthFormat;
+    pipeline_config.viewMask = ALL_FACES_MASK;
+    pipeline_config.pipelineLayout = pipelineLayout;
+
+    // The faces do not share a handedness, so no winding can be culled
+    pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+    pipeline_config.rasterizationInfo.depthBiasEnable = VK_TRUE;
+    pipeline_config.rasterizationInfo.depthBiasConstantFactor = DEPTH_BIAS_CONSTANT;
+    pipeline_config.rasterizationInfo.depthBiasSlopeFactor = DEPTH_BIAS_SLOPE;
+}
+
+void vk::PointShadowSystem::assignSlots(const FrameInfo &frame_info)
+{
+    // The lights whose range reaches closest to the camera get shadows
+    const Vec3f camera_position = frame_info.camera.getPosition();
+    candidates.clear();
+
+    for (auto &[id, object] : frame_info.objects)
+    {
+        if (!object.getPointLightComponent())
+            continue;
+
+        const float reach = glm::distance(camera_position, object.getTranslation()) -
+                            LightClusterSystem::getLightRange(object);
+        candidates.emplace_back(reach, id);
+    }
+
+    const size_t chosen_count = std::min<size_t>(candidates.size(), shadowedLightCount);
+    std::partial_sort(candidates.begin(), candidates.begin() + chosen_count, candidates.end());
+    candidates.resize(chosen_count);
+
+    auto is_chosen = [this](const Object::objid_t light) {
+        return std::any_of(candidates.begin(), candidates.end(),
+                           [light](const auto &candidate) { return candidate.second == light; });
+    };
+
+    // Lights keep their cube while they stay chosen, so its cached contents stay valid
+    for (auto &slot : slots)
+        if (slot.used && !is_chosen(slot.light))
+            slot = {};
+
+    for (const auto &[_, light] : candidates)
+    {
+        if (std::any_of(slots.begin(), slots.end(),
+                        [light](const Slot &slot) { return slot.used && slot.light == light; }))
+            continue;
+
+        auto slot = std::find_if(slots.begin(), slots.end(), [](const Slot &slot) { return !slot.used; });
+        assert(slot != slots.end() && "NO FREE POINT SHADOW SLOT");
+
+        slot->light = light;
+        slot->used = true;
+        slot->cached = false;
+    }
+}
+
+const size_t vk::PointShadowSystem::gatherCasters(const FrameInfo &frame_info, const Vec4f &light,
+                                                  std::vector<Caster> &casters)
+{
+    const Vec3f light_position = Vec3f(light);
+
+    size_t signature = 0;
+    hashCombine(signature, light_position, light.w);
+
+    // Summed, so the order the objects are iterated in does not matter
+    size_t caster_signatures = 0;
+
+    for (auto &[id, object] : frame_info.objects)
+    {
+        const auto &model = object.getModel();
+
+        // Transparent objects would cast a shadow as dark as an opaque one
+        if (!model || object.getPointLightComponent() || object.isTransparent())
+            continue;
+
+        const Mat4f transform = object.transform();
+        const Vec4f sphere = model->getBoundingSphere();
+
+        // The radius grows with the largest scale, so the sphere still encloses a non-uniformly scaled model
+        const float scale = std::max({glm::length(Vec3f(transform[0])), glm::length(Vec3f(transform[1])),
+                                      glm::length(Vec3f(transform[2]))});
+        const float radius = sphere.w * scale;
+        const Vec3f relative = Vec3f(transform * Vec4f(Vec3f(sphere), 1.f)) - light_position;
+
+        if (glm::length(relative) - radius > light.w)
+            continue;
+
+        const uint32_t face_mask = sphereFaceMask(relative, radius);
+        if (face_mask == 0)
+            continue;
+
+        size_t caster_signature = 0;
+        hashCombine(caster_signature, id, object.getTranslation(), object.getRotation(), object.getScale(),
+                    model.get());
+        caster_signatures += caster_signature;
+
+        casters.push_back({&object, face_mask});
+    }
+
+    hashCombine(signature, caster_signatures);
+
+    return signature;
+}
+
+void vk::PointShadowSystem::render(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("PointShadowSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "PointShadowSystem");
+
+    if (lightDraws.empty() || !pipeline->bind(frame_info.commandBuffer))
+        return;
+
+    VkViewport viewport = {};
+    viewport.x = 0.f;
+    viewport.y = 0.f;
+    viewport.width = static_cast<float>(resolution);
+    viewport.height = static_cast<float>(resolution);
+    viewport.minDepth = 0.f;
+    viewport.maxDepth = 1.f;
+
+    VkRect2D scissor = {{0, 0}, {resolution, resolution}};
+
+    for (auto &light_draw : lightDraws)
+    {
+        VkRenderingAttachmentInfo depth_attachment = {};
+        depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        depth_attachment.imageView = slotViews[light_draw.slot];
+        depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depth_attachment.clearValue.depthStencil = {1.f, 0};
+
+        // Every draw goes to all six faces, gl_ViewIndex is the face
+        VkRenderingInfo rendering_info = {};
+        rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        rendering_info.renderArea = scissor;
+        rendering_info.layerCount = 1;
+        rendering_info.viewMask = ALL_FACES_MASK;
+        rendering_info.colorAttachmentCount = 0;
+        rendering_info.pDepthAttachment = &depth_attachment;
+
+        vkCmdBeginRendering(frame_info.commandBuffer, &rendering_info);
+
+        vkCmdSetViewport(frame_info.commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(frame_info.commandBuffer, 0, 1, &scissor);
+
+        for (auto &[object, face_mask] : light_draw.casters)
+        {
+            PushConstantData push = {};
+            push.modelMatrix = object->transform();
+            push.light = light_draw.light;
+            push.faceMask = face_mask;
+
+            vkCmdPushConstants(frame_info.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                               sizeof(PushConstantData), &push);
+
+            object->bind(frame_info.commandBuffer);
+            object->draw(frame_info.commandBuffer);
+        }
+
+        vkCmdEndRendering(frame_info.commandBuffer);
+    }
+}
@@ -1,55 +1,89 @@
 #include "SVKE/Rendering/Systems/RenderSystem.hpp"
 
-vk::RenderSystem::RenderSystem(Device &device, Renderer &renderer, DescriptorSetLayout &global_set_layout)
-    : device(device), pipelineLayout(VK_NULL_HANDLE)
+vk::RenderSystem::RenderSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                               DescriptorSetLayout &global_set_layout)
+    : device(device), colorFormat(renderer.getImageFormat()), depthFormat(renderer.getDepthFormat()),
+      pipelineLayout(VK_NULL_HANDLE), pipelineCompiler(pipeline_compiler),
+      variants(pipeline_compiler,
+               [this](Pipeline::Config &pipeline_config) { populatePipelineConfig(pipeline_config); })
 {
     loadShaders();
     createPipelineLayout(global_set_layout);
-    createPipeline(renderer.getRenderPass());
+
+    ShaderVariant default_variant = {};
+    default_variant.sampleShading = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+    setVariant(default_variant);
 }
 
 vk::RenderSystem::~RenderSystem()
 {
+    // The layout is referenced by the pending compilations, so they have to finish first
+    variants.waitIdle();
     vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
 }
 
 void vk::RenderSystem::render(const FrameInfo &frame_info)
 {
-    pipeline->bind(frame_info.commandBuffer);
+    SVKE_PROFILE_SCOPE("RenderSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "RenderSystem");
+
+    if (!pipeline->bind(frame_info.commandBuffer))
+        return;
 
     vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
                             &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
 
-    for (auto &[_, object] : frame_info.objects)
-    {
-        if (object.getTextureImage())
-            continue;
+    // Objects sharing a model are drawn together, nearest first within each of them
+    drawList.clear();
 
-        PushConstantData push = {};
-        push.modelMatrix = object.transform();
-        push.normalMatrix = object.normalMatrix();
+    for (auto &[id, object] : frame_info.objects)
+        if (object.getModel() && !object.getTextureImage() && !object.isTransparent())
+            drawList.add(frame_info.camera.getViewMatrix(), object, frame_info.objectIndices[id]);
 
-        vkCmdPushConstants(frame_info.commandBuffer, pipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantData),
-                           &push);
+    drawList.sort();
 
-        object.bind(frame_info.commandBuffer);
-        object.draw(frame_info.commandBuffer);
-    }
+    drawList.record(frame_info.commandBuffer, pipelineLayout, 1);
+}
+
+const std::shared_ptr<vk::PipelineCompiler::Handle> &vk::RenderSystem::getPipelineHandle() const
+{
+    return pipeline;
+}
+
+void vk::RenderSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH, FRAG_SHADER_PATH}))
+        return;
+
+    // Queued compilations still reference the current shader modules, the compiler keeps them until they are done
+    pipelineCompiler.retire(std::move(vertShader));
+    pipelineCompiler.retire(std::move(fragShader));
+
+    loadShaders();
+    variants.recompileAll(*vertShader, *fragShader);
+}
+
+void vk::RenderSystem::setVariant(const ShaderVariant &shader_variant)
+{
+    pipeline = variants.get(shader_variant, *vertShader, *fragShader, pipeline);
+    variant = shader_variant;
+}
+
+const vk::ShaderVariant &vk::RenderSystem::getVariant() const
+{
+    return variant;
 }
 
 void vk::RenderSystem::loadShaders()
 {
-    vertShader = std::make_unique<Shader>(device, "assets/shaders/render_system.vert.spv");
-    fragShader = std::make_unique<Shader>(device, "assets/shaders/render_system.frag.spv");
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+    fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
 }
 
 void vk::RenderSystem::createPipelineLayout(DescriptorSetLayout &global_set_layout)
 {
-    VkPushConstantRange push_constant_range = {};
-    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_constant_range.offset = 0;
-    push_constant_range.size = sizeof(PushConstantData);
+    const VkPushConstantRange push_constant_range = ObjectDataSystem::getPushConstantRange();
 
     std::vector<VkDescriptorSetLayout> global_set_layouts{global_set_layout.getDescriptorSetLayout()};
 
@@ -65,22 +99,16 @@ void vk::RenderSystem::createPipelineLayout(DescriptorSetLayout &global_set_layo
         throw std::runtime_error("vk::RenderSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
 }
 
-void vk::RenderSystem::createPipeline(VkRenderPass render_pass)
+void vk::RenderSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
 {
     assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
 
-    Pipeline::Config pipeline_config = {};
     Pipeline::defaultPipelineConfig(pipeline_config);
 
-    pipeline_config.renderPass = render_pass;
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
     pipeline_config.pipelineLayout = pipelineLayout;
     pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
     pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
     pipeline_config.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-
-    // Optional: Shader antialiasing, smooths inner parts of shapes. Might cost some performance
-    pipeline_config.multisampleInfo.sampleShadingEnable = VK_TRUE;
-    pipeline_config.multisampleInfo.minSampleShading = .2f;
-
-    pipeline = std::make_unique<Pipeline>(device, *vertShader, *fragShader, pipeline_config);
 }
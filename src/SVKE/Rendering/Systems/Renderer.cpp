@@ -1,24 +1,60 @@
 #include "SVKE/Rendering/Systems/Renderer.hpp"
 
 vk::Renderer::Renderer(Device &device, Window &window, const Swapchain::PresentMode &preferred_present_mode,
-                       const Color &clear_color)
-    : device(device), window(window), preferredPresentMode(preferred_present_mode), clearColor(clear_color),
-      currentImageIndex(0), currentFrameIndex(0), frameInProgress(false)
+                       const Color &clear_color, const int frames_in_flight)
+    : device(device), window(&window), preferredPresentMode(preferred_present_mode), clearColor(clear_color),
+      renderTarget(nullptr), currentImageIndex(0), frameNumber(0), framesInFlight(frames_in_flight),
+      currentFrameIndex(0), frameInProgress(false), swapchainOutOfDate(false)
 {
+    assert(frames_in_flight >= 1 && frames_in_flight <= Swapchain::MAX_FRAMES_IN_FLIGHT &&
+           "FRAMES IN FLIGHT ARE OUT OF BOUNDS");
+
     recreateSwapchain();
     createCommandBuffers();
+
+    gpuProfiler = std::make_unique<GpuProfiler>(device);
+    framePacer = std::make_unique<FramePacer>(device.getGraphicsTimeline(), frameStats);
 }
 
-vk::Renderer::~Renderer()
+vk::Renderer::Renderer(Device &device, const VkExtent2D &extent, const Color &clear_color,
+                       const int frames_in_flight)
+    : device(device), window(nullptr), preferredPresentMode(Swapchain::PresentMode::VSync), clearColor(clear_color),
+      renderTarget(nullptr), currentImageIndex(0), frameNumber(0), framesInFlight(frames_in_flight),
+      currentFrameIndex(0), frameInProgress(false), swapchainOutOfDate(false)
 {
-    freeCommandBuffers();
+    assert(device.isHeadless() && "CANNOT RENDER HEADLESS WITH A DEVICE CREATED FOR A WINDOW");
+    assert(frames_in_flight >= 1 && frames_in_flight <= Swapchain::MAX_FRAMES_IN_FLIGHT &&
+           "FRAMES IN FLIGHT ARE OUT OF BOUNDS");
+
+    offscreenTarget = std::make_unique<OffscreenTarget>(device, extent, framesInFlight);
+    renderTarget = offscreenTarget.get();
+
+    createCommandBuffers();
+
+    gpuProfiler = std::make_unique<GpuProfiler>(device);
+    framePacer = std::make_unique<FramePacer>(device.getGraphicsTimeline(), frameStats);
 }
 
 VkCommandBuffer vk::Renderer::beginFrame()
 {
     assert(!frameInProgress && "CANNOT BEGIN FRAME WHEN ANOTHER FRAME IS IN PROGRESS");
 
-    auto result = swapchain->acquireNextImage(currentImageIndex);
+    if (swapchainOutOfDate)
+    {
+        recreateSwapchain();
+
+        if (swapchainOutOfDate)
+            return VK_NULL_HANDLE;
+    }
+
+    SVKE_PROFILE_FRAME_BEGIN();
+
+    VkResult result;
+    {
+        // Includes waiting for the submission that last used this frame index
+        SVKE_PROFILE_SCOPE("Renderer::acquireNextImage");
+        result = renderTarget->acquireNextImage(currentImageIndex);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -29,17 +65,35 @@ VkCommandBuffer vk::Renderer::beginFrame()
     if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
         throw std::runtime_error("vk::Renderer::beginFrame: FAILED TO ACQUIRE SWAPCHAIN IMAGE");
 
+    // Everything deferred until a submission that has finished by now is released, without waiting for more
+    device.getGraphicsTimeline().collect();
+
+    if (frameCapture)
+        frameCapture->collect();
+
+    // After the releases, so the budget callback only sees memory that is still held
+    device.getMemoryTracker().update();
+
     frameInProgress = true;
+
+    // The buffers of the previous frame with this index are reset with their pools, it has finished by now
+    commandBufferManager->beginFrame(currentFrameIndex);
+    commandBuffers[currentFrameIndex] = commandBufferManager->acquirePrimary();
+
     auto &command_buffer = getCurrentCommandBuffer();
 
     /* BEGIN COMMAND BUFFER --------------------------------------------------------------------------------- */
 
     VkCommandBufferBeginInfo begin = {};
     begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     if (vkBeginCommandBuffer(command_buffer, &begin) != VK_SUCCESS)
         throw std::runtime_error("vk::Renderer::beginFrame: FAILED TO BEGIN RECORDING COMMAND BUFFER");
 
+    frameStats.beginRecording();
+    gpuProfiler->beginFrame(command_buffer, currentFrameIndex);
+
     return command_buffer;
 }
 
@@ -51,14 +105,46 @@ void vk::Renderer::endFrame()
 
     auto &command_buffer = getCurrentCommandBuffer();
 
+    // What reads the image after the frame waits for color attachment output, which chains with this barrier
+    VkImageMemoryBarrier2 barrier = {};
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_NONE;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = renderTarget->getImageLayout();
+
+    recordColorBarrier(command_buffer, barrier, false);
+
+    if (frameCapture)
+        frameCapture->record(command_buffer, renderTarget->getImage(currentImageIndex), renderTarget->getImageLayout(),
+                             frameNumber);
+
+    renderTarget->recordEndOfFrame(command_buffer, currentImageIndex);
+
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
         throw std::runtime_error("vk::Renderer::endFrame: FAILED TO END COMMAND BUFFER");
 
-    auto result = swapchain->submitCommandBuffers(command_buffer, currentImageIndex);
+    frameStats.endRecording();
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || window.wasResized())
+    VkResult result;
     {
-        window.setResized(false);
+        SVKE_PROFILE_SCOPE("Renderer::submitAndPresent");
+        result = renderTarget->submitCommandBuffers(command_buffer, currentImageIndex);
+    }
+
+    const uint64_t submitted_value = device.getGraphicsTimeline().getSubmittedValue();
+    commandBufferManager->endFrame(submitted_value);
+    framePacer->submitted(submitted_value);
+
+    if (frameCapture)
+        frameCapture->submitted(submitted_value);
+
+    frameStats.endFrame(renderTarget->getFrameTimings());
+
+    if (window && (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || window->wasResized()))
+    {
+        window->setResized(false);
         recreateSwapchain();
     }
     else if (result != VK_SUCCESS)
@@ -67,7 +153,10 @@ void vk::Renderer::endFrame()
     }
 
     frameInProgress = false;
-    currentFrameIndex = (currentFrameIndex + 1) % Swapchain::MAX_FRAMES_IN_FLIGHT;
+    currentFrameIndex = (currentFrameIndex + 1) % framesInFlight;
+    ++frameNumber;
+
+    SVKE_PROFILE_FRAME_END();
 }
 
 void vk::Renderer::beginRenderPass(VkCommandBuffer &command_buffer)
@@ -76,39 +165,106 @@ void vk::Renderer::beginRenderPass(VkCommandBuffer &command_buffer)
     assert(command_buffer == getCurrentCommandBuffer() &&
            "CANNOT BEGIN RENDER PASS ON A COMMAND BUFFER FROM A DIFFERENT FRAME");
 
-    /* RENDER PASS BEGIN ------------------------------------------------------------------------------------ */
+    recordBeginRenderPass(command_buffer, false, "Render pass");
+}
+
+void vk::Renderer::resumeRenderPass(VkCommandBuffer &command_buffer)
+{
+    assert(frameInProgress && "CANNOT RESUME RENDER PASS WHEN NO FRAME IS IN PROGRESS");
+    assert(command_buffer == getCurrentCommandBuffer() &&
+           "CANNOT RESUME RENDER PASS ON A COMMAND BUFFER FROM A DIFFERENT FRAME");
+
+    recordBeginRenderPass(command_buffer, true, "Resumed render pass");
+}
+
+void vk::Renderer::recordBeginRenderPass(VkCommandBuffer &command_buffer, const bool resume,
+                                         const char *scope_name)
+{
+    /* COLOR LAYOUT ----------------------------------------------------------------------------------------- */
+
+    // A new pass discards what is left from the previous frame, which may still be copied out of the image. A
+    // resumed pass loads what the previous one wrote.
+    VkImageMemoryBarrier2 barrier = {};
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    if (resume)
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+    else
+    {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    recordColorBarrier(command_buffer, barrier, true);
+
+    /* ATTACHMENTS ------------------------------------------------------------------------------------------ */
 
-    VkRenderPassBeginInfo render_pass_begin = {};
-    render_pass_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_begin.renderPass = swapchain->getRenderPass();
-    render_pass_begin.framebuffer = swapchain->getFramebuffer(currentImageIndex);
-    render_pass_begin.renderArea.offset = {0, 0};
-    render_pass_begin.renderArea.extent = swapchain->getExtent();
+    // With MSAA the multisampled image is rendered and resolved into the target's image
+    VkRenderingAttachmentInfo color_attachment = {};
+    color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.clearValue.color = clearColor.toVkClearColorValue();
 
-    /* CLEAR COLOR AND DEPTH -------------------------------------------------------------------------------- */
+    if (renderTarget->getColorImage() != VK_NULL_HANDLE)
+    {
+        color_attachment.imageView = renderTarget->getColorImageView();
+        color_attachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        color_attachment.resolveImageView = renderTarget->getImageView(currentImageIndex);
+        color_attachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+    else
+    {
+        color_attachment.imageView = renderTarget->getImageView(currentImageIndex);
+    }
+
+    // Depth is stored for whatever reads it after the pass, e.g. a depth pyramid or the transparent surfaces
+    VkRenderingAttachmentInfo depth_attachment = {};
+    depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depth_attachment.imageView = renderTarget->getDepthImageView(currentImageIndex);
+    depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_attachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depth_attachment.clearValue.depthStencil = {1.f, 0};
 
-    std::array<VkClearValue, 2> clear_values;
-    clear_values[0].color = clearColor.toVkClearColorValue();
-    clear_values[1].depthStencil = {1.f, 0};
+    /* RENDERING BEGIN -------------------------------------------------------------------------------------- */
 
-    render_pass_begin.clearValueCount = static_cast<uint32_t>(clear_values.size());
-    render_pass_begin.pClearValues = clear_values.data();
+    VkRenderingInfo rendering_info = {};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    rendering_info.renderArea.offset = {0, 0};
+    rendering_info.renderArea.extent = renderTarget->getExtent();
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachments = &color_attachment;
+    rendering_info.pDepthAttachment = &depth_attachment;
 
-    vkCmdBeginRenderPass(command_buffer, &render_pass_begin, VK_SUBPASS_CONTENTS_INLINE);
+    // No statistics for the whole pass, so the systems drawn inside can collect their own
+    gpuProfiler->beginScope(command_buffer, scope_name, false);
+
+    vkCmdBeginRendering(command_buffer, &rendering_info);
 
     /* VIEWPORT AND SCISSOR --------------------------------------------------------------------------------- */
 
     VkViewport viewport = {};
     viewport.x = 0;
     viewport.y = 0;
-    viewport.width = static_cast<float>(swapchain->getWidth());
-    viewport.height = static_cast<float>(swapchain->getHeight());
+    viewport.width = static_cast<float>(renderTarget->getWidth());
+    viewport.height = static_cast<float>(renderTarget->getHeight());
     viewport.minDepth = 0.f;
     viewport.maxDepth = 1.f;
 
     VkRect2D scissor = {};
     scissor.offset = {0, 0};
-    scissor.extent = swapchain->getExtent();
+    scissor.extent = renderTarget->getExtent();
 
     vkCmdSetViewport(command_buffer, 0, 1, &viewport);
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
@@ -122,7 +278,9 @@ void vk::Renderer::endRenderPass(VkCommandBuffer &command_buffer)
 
     /* END RENDER PASS -------------------------------------------------------------------------------------- */
 
-    vkCmdEndRenderPass(command_buffer);
+    vkCmdEndRendering(command_buffer);
+
+    gpuProfiler->endScope(command_buffer);
 }
 
 const bool vk::Renderer::isFrameInProgress() const
@@ -137,6 +295,28 @@ const int vk::Renderer::getCurrentFrameIndex() const
     return currentFrameIndex;
 }
 
+const int vk::Renderer::getFramesInFlight() const
+{
+    return framesInFlight;
+}
+
+void vk::Renderer::paceFrame()
+{
+    assert(!frameInProgress && "CANNOT PACE A FRAME THAT IS ALREADY IN PROGRESS");
+
+    framePacer->wait();
+}
+
+void vk::Renderer::setLowLatency(const bool low_latency)
+{
+    framePacer->setLowLatency(low_latency);
+}
+
+const bool vk::Renderer::isLowLatency() const
+{
+    return framePacer->isLowLatency();
+}
+
 VkCommandBuffer &vk::Renderer::getCurrentCommandBuffer()
 {
     assert(frameInProgress && "CANNOT GET CURRENT BUFFER WHILE NO FRAME IS IN PROGRESS");
@@ -145,60 +325,195 @@ VkCommandBuffer &vk::Renderer::getCurrentCommandBuffer()
     return commandBuffers.at(currentFrameIndex);
 }
 
-VkRenderPass vk::Renderer::getRenderPass()
+vk::CommandBufferManager &vk::Renderer::getCommandBufferManager()
+{
+    return *commandBufferManager;
+}
+
+VkFormat vk::Renderer::getImageFormat()
+{
+    return renderTarget->getImageFormat();
+}
+
+VkImage vk::Renderer::getDepthImage()
+{
+    assert(frameInProgress && "CANNOT GET DEPTH IMAGE WHILE NO FRAME IS IN PROGRESS");
+
+    return renderTarget->getDepthImage(currentImageIndex);
+}
+
+VkImageView vk::Renderer::getDepthImageView()
+{
+    assert(frameInProgress && "CANNOT GET DEPTH IMAGE VIEW WHILE NO FRAME IS IN PROGRESS");
+
+    return renderTarget->getDepthImageView(currentImageIndex);
+}
+
+VkFormat vk::Renderer::getDepthFormat()
+{
+    return renderTarget->getDepthFormat();
+}
+
+const VkImageAspectFlags vk::Renderer::getDepthAspect()
 {
-    return swapchain->getRenderPass();
+    const VkFormat depth_format = getDepthFormat();
+
+    if (depth_format == VK_FORMAT_D32_SFLOAT_S8_UINT || depth_format == VK_FORMAT_D24_UNORM_S8_UINT)
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    return VK_IMAGE_ASPECT_DEPTH_BIT;
 }
 
 const float vk::Renderer::getAspectRatio() const
 {
-    return swapchain->getExtentAspectRatio();
+    return renderTarget->getExtentAspectRatio();
 }
 
-void vk::Renderer::createCommandBuffers()
+VkExtent2D vk::Renderer::getExtent() const
+{
+    return renderTarget->getExtent();
+}
+
+vk::GpuProfiler &vk::Renderer::getGpuProfiler()
+{
+    return *gpuProfiler;
+}
+
+vk::FrameStats &vk::Renderer::getFrameStats()
+{
+    return frameStats;
+}
+
+const vk::FrameStats &vk::Renderer::getFrameStats() const
+{
+    return frameStats;
+}
+
+const bool vk::Renderer::isHeadless() const
+{
+    return window == nullptr;
+}
+
+vk::OffscreenTarget *vk::Renderer::getOffscreenTarget()
+{
+    return offscreenTarget.get();
+}
+
+void vk::Renderer::startCapture(const FrameCapture::Options &options)
+{
+    assert(!frameInProgress && "CANNOT START CAPTURE WHILE A FRAME IS IN PROGRESS");
+
+    if (!renderTarget->supportsImageCopy())
+        throw std::runtime_error("vk::Renderer::startCapture: RENDER TARGET IMAGES CANNOT BE COPIED");
+
+    frameCapture.reset();
+    frameCapture = std::make_unique<FrameCapture>(device, renderTarget->getExtent(), renderTarget->getImageFormat(),
+                                                  options);
+}
+
+void vk::Renderer::stopCapture()
 {
-    commandBuffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
+    assert(!frameInProgress && "CANNOT STOP CAPTURE WHILE A FRAME IS IN PROGRESS");
 
-    VkCommandBufferAllocateInfo alloc_info = {};
-    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandPool = device.getCommandPool();
-    alloc_info.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    frameCapture.reset();
+}
+
+const bool vk::Renderer::isCapturing() const
+{
+    return frameCapture != nullptr;
+}
 
-    if (vkAllocateCommandBuffers(device.getLogicalDevice(), &alloc_info, commandBuffers.data()) != VK_SUCCESS)
-        throw std::runtime_error("vk::Renderer::createCommandBuffers: FAILED TO ALLOCATE COMMAND BUFFERS");
+void vk::Renderer::recordColorBarrier(VkCommandBuffer &command_buffer, const VkImageMemoryBarrier2 &barrier,
+                                      const bool include_multisampled)
+{
+    std::array<VkImageMemoryBarrier2, 2> barriers = {barrier, barrier};
+    uint32_t barrier_count = 0;
+
+    const auto add_barrier = [&](VkImage image) {
+        auto &image_barrier = barriers[barrier_count++];
+        image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image = image;
+        image_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        image_barrier.subresourceRange.baseMipLevel = 0;
+        image_barrier.subresourceRange.levelCount = 1;
+        image_barrier.subresourceRange.baseArrayLayer = 0;
+        image_barrier.subresourceRange.layerCount = 1;
+    };
+
+    add_barrier(renderTarget->getImage(currentImageIndex));
+
+    if (include_multisampled && renderTarget->getColorImage() != VK_NULL_HANDLE)
+        add_barrier(renderTarget->getColorImage());
+
+    VkDependencyInfo dependency_info = {};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.imageMemoryBarrierCount = barrier_count;
+    dependency_info.pImageMemoryBarriers = barriers.data();
+
+    vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+    FrameStats::countBarriers(barrier_count);
 }
 
-void vk::Renderer::freeCommandBuffers()
+void vk::Renderer::createCommandBuffers()
 {
-    vkFreeCommandBuffers(device.getLogicalDevice(), device.getCommandPool(),
-                         static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    // Acquired from the manager when their frame begins
+    commandBuffers.assign(framesInFlight, VK_NULL_HANDLE);
 
-    commandBuffers.clear();
+    commandBufferManager = std::make_unique<CommandBufferManager>(
+        device, *device.getQueueFamilyIndices().graphicsFamily, device.getGraphicsTimeline(), framesInFlight);
 }
 
 void vk::Renderer::recreateSwapchain()
 {
-    auto extent = window.getExtent();
+    auto extent = window->getExtent();
 
-    while (extent.width == 0 || extent.height == 0)
+    // Nothing can be rendered before the first swapchain exists, later ones are put off while the window is
+    // minimized instead of blocking the frame loop
+    while (!swapchain && (extent.width == 0 || extent.height == 0))
     {
-        extent = window.getExtent();
         glfwWaitEvents();
+        extent = window->getExtent();
+    }
+
+    if (extent.width == 0 || extent.height == 0)
+    {
+        swapchainOutOfDate = true;
+
+        // No frames are drawn, so the loop does not have to poll at full speed
+        glfwWaitEventsTimeout(MINIMIZED_WAIT_SECONDS);
+        return;
     }
 
-    vkDeviceWaitIdle(device.getLogicalDevice());
+    swapchainOutOfDate = false;
+
+    // The old swapchain is not waited for, its resources are released through the graphics timeline
 
     if (!swapchain)
     {
-        swapchain = std::make_unique<Swapchain>(device, window, preferredPresentMode);
+        swapchain = std::make_unique<Swapchain>(device, *window, preferredPresentMode, framesInFlight);
     }
     else
     {
         std::shared_ptr<Swapchain> old_swapchain = std::move(swapchain);
-        swapchain = std::make_unique<Swapchain>(device, window, old_swapchain, preferredPresentMode);
+        swapchain =
+            std::make_unique<Swapchain>(device, *window, old_swapchain, preferredPresentMode, framesInFlight);
 
         if (!old_swapchain->compatibleWith(*swapchain))
             throw std::runtime_error("vk::Renderer::recreateSwapchain: SWAPCHAIN IMAGE OR DEPTH FORMAT HAS CHANGED");
     }
+
+    renderTarget = swapchain.get();
+
+    // The capture buffers are sized for the old extent, so it only restarts if that changed. Frames so far are written
+    // before it does.
+    if (frameCapture && !frameCapture->fits(renderTarget->getExtent(), renderTarget->getImageFormat()))
+    {
+        const FrameCapture::Options capture_options = frameCapture->getOptions();
+
+        frameCapture.reset();
+        frameCapture = std::make_unique<FrameCapture>(device, renderTarget->getExtent(),
+                                                      renderTarget->getImageFormat(), capture_options);
+    }
 }
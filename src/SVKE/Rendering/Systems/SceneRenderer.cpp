@@ -0,0 +1,308 @@
+#include "SVKE/Rendering/Systems/SceneRenderer.hpp"
+
+vk::SceneRenderer::SceneRenderer(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                                 DescriptorPool &global_pool, DescriptorPool &object_texture_pool,
+                                 TextureSampler &texture_sampler, Object::Map &objects, const Options &options)
+    : device(device), renderer(renderer), pipelineCompiler(pipeline_compiler), objects(objects), renderGraph(device)
+{
+    createGlobalDescriptorSets(global_pool);
+    createObjectDescriptorSets(object_texture_pool, texture_sampler);
+    createSystems(global_pool, options);
+}
+
+const bool vk::SceneRenderer::renderFrame(Camera &camera, const float dt)
+{
+    auto command_buffer = renderer.beginFrame();
+
+    if (!command_buffer)
+        return false;
+
+    auto current_frame_index = renderer.getCurrentFrameIndex();
+
+    FrameInfo frame_info{current_frame_index,
+                         dt,
+                         command_buffer,
+                         camera,
+                         globalDescriptorSets[current_frame_index],
+                         objectDescriptorSets,
+                         objects,
+                         objectDataSystem->getObjectIndices(),
+                         renderer.getGpuProfiler()};
+
+    update(frame_info);
+    addPasses(frame_info);
+
+    renderGraph.compile();
+    renderGraph.execute(command_buffer);
+
+    renderer.endFrame();
+
+    return true;
+}
+
+void vk::SceneRenderer::setDepthPrepass(const bool enabled)
+{
+    ShaderVariant render_variant = renderSystem->getVariant();
+    render_variant.depthPrepass = enabled;
+    renderSystem->setVariant(render_variant);
+
+    ShaderVariant texture_variant = textureRenderSystem->getVariant();
+    texture_variant.depthPrepass = enabled;
+    textureRenderSystem->setVariant(texture_variant);
+
+    pipelineCompiler.waitIdle();
+}
+
+const bool vk::SceneRenderer::isDepthPrepass() const
+{
+    return renderSystem->getVariant().depthPrepass;
+}
+
+void vk::SceneRenderer::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    renderSystem->reloadShaders(spv_paths);
+    textureRenderSystem->reloadShaders(spv_paths);
+    pointLightSystem->reloadShaders(spv_paths);
+    lightClusterSystem->reloadShaders(spv_paths);
+    depthPrepassSystem->reloadShaders(spv_paths);
+    pointShadowSystem->reloadShaders(spv_paths);
+    transparentRenderSystem->reloadShaders(spv_paths);
+
+    if (occlusionCullingSystem)
+        occlusionCullingSystem->reloadShaders(spv_paths);
+}
+
+const bool vk::SceneRenderer::hasOcclusionCulling() const
+{
+    return occlusionCullingSystem != nullptr;
+}
+
+vk::TransparentRenderSystem &vk::SceneRenderer::getTransparentRenderSystem()
+{
+    return *transparentRenderSystem;
+}
+
+const vk::PointShadowSystem &vk::SceneRenderer::getPointShadowSystem() const
+{
+    return *pointShadowSystem;
+}
+
+void vk::SceneRenderer::createGlobalDescriptorSets(DescriptorPool &global_pool)
+{
+    globalUboBuffers.resize(renderer.getFramesInFlight());
+    for (auto &buffer : globalUboBuffers)
+    {
+        buffer = std::make_unique<Buffer>(device, sizeof(GlobalUBO),
+                                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                          VMA_MEMORY_USAGE_AUTO,
+                                          VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                                              VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+        buffer->map();
+    }
+
+    // Global Descriptor Set Layout: global UBO, point lights and light clusters (see LightClusterSystem), the point
+    // shadow atlas (see PointShadowSystem) and the objects (see ObjectDataSystem)
+    const VkShaderStageFlags ubo_stages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+    const VkShaderStageFlags light_stages = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    globalSetLayout = DescriptorSetLayout::Builder(device)
+                          .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, ubo_stages)
+                          .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, light_stages)
+                          .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, light_stages)
+                          .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                          .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+                          .build();
+
+    globalDescriptorSets.resize(renderer.getFramesInFlight());
+    for (int i = 0; i < globalDescriptorSets.size(); ++i)
+    {
+        auto buffer_info = globalUboBuffers[i]->getDescriptorInfo();
+        DescriptorWriter(*globalSetLayout, global_pool).writeBuffer(0, buffer_info).build(globalDescriptorSets[i]);
+    }
+}
+
+void vk::SceneRenderer::createObjectDescriptorSets(DescriptorPool &object_texture_pool,
+                                                   TextureSampler &texture_sampler)
+{
+    // Object Descriptor Set Layout
+    objectSetLayout = DescriptorSetLayout::Builder(device)
+                          .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                          .build();
+
+    std::unordered_map<const TextureImage *, VkDescriptorSet> texture_descriptor_sets;
+    for (auto &[id, object] : objects)
+    {
+        if (!object.getTextureImage())
+            continue;
+
+        auto [texture_set, inserted] = texture_descriptor_sets.try_emplace(object.getTextureImage().get());
+
+        if (inserted)
+        {
+            auto image_info = object.getTextureImage()->getDescriptorInfo(texture_sampler);
+            DescriptorWriter(*objectSetLayout, object_texture_pool)
+                .writeImage(0, image_info)
+                .build(texture_set->second);
+        }
+
+        objectDescriptorSets[id] = texture_set->second;
+    }
+}
+
+void vk::SceneRenderer::createSystems(DescriptorPool &global_pool, const Options &options)
+{
+    std::vector<VkDescriptorSetLayout> set_layouts = {globalSetLayout->getDescriptorSetLayout(),
+                                                      objectSetLayout->getDescriptorSetLayout()};
+
+    // Pipelines compile in the background. Textured objects are drawn with the plain pipeline until theirs is ready.
+    renderSystem = std::make_unique<RenderSystem>(device, renderer, pipelineCompiler, *globalSetLayout);
+    textureRenderSystem = std::make_unique<TextureRenderSystem>(device, renderer, pipelineCompiler, set_layouts,
+                                                                renderSystem->getPipelineHandle());
+    pointLightSystem = std::make_unique<PointLightSystem>(device, renderer, pipelineCompiler, *globalSetLayout);
+    lightClusterSystem = std::make_unique<LightClusterSystem>(device, pipelineCompiler, *globalSetLayout,
+                                                              global_pool, globalDescriptorSets);
+    objectDataSystem =
+        std::make_unique<ObjectDataSystem>(device, *globalSetLayout, global_pool, globalDescriptorSets);
+    depthPrepassSystem = std::make_unique<DepthPrepassSystem>(device, renderer, pipelineCompiler, *globalSetLayout);
+    pointShadowSystem = std::make_unique<PointShadowSystem>(device, pipelineCompiler, *globalSetLayout, global_pool,
+                                                            globalDescriptorSets, options.shadowedLights);
+    transparentRenderSystem = std::make_unique<TransparentRenderSystem>(device, renderer, pipelineCompiler,
+                                                                        *globalSetLayout, options.transparency);
+
+    if (options.occlusionCulling)
+        occlusionCullingSystem =
+            std::make_unique<OcclusionCullingSystem>(device, renderer, pipelineCompiler, *globalSetLayout);
+}
+
+void vk::SceneRenderer::update(FrameInfo &frame_info)
+{
+    GlobalUBO ubo = {};
+    ubo.projectionMatrix = frame_info.camera.getProjectionMatrix();
+    ubo.viewMatrix = frame_info.camera.getViewMatrix();
+    ubo.inverseViewMatrix = frame_info.camera.getInverseViewMatrix();
+
+    const auto extent = renderer.getExtent();
+    ubo.screenSize = Vec2f{static_cast<float>(extent.width), static_cast<float>(extent.height)};
+
+    objectDataSystem->update(frame_info);
+    pointLightSystem->update(frame_info);
+    pointShadowSystem->update(frame_info);
+    lightClusterSystem->update(frame_info, ubo, pointShadowSystem->getShadowSlots());
+
+    globalUboBuffers[frame_info.frameIndex]->write((void *)&ubo, sizeof(ubo));
+
+    if (occlusionCullingSystem)
+        occlusionCullingSystem->update(frame_info);
+}
+
+void vk::SceneRenderer::addPasses(FrameInfo &frame_info)
+{
+    renderGraph.reset();
+
+    // Discarded every frame, the first pass only waits for the depth tests of earlier frames. Imported with their
+    // stages and write access rather than the default state, which would leave that write after write unsynchronized.
+    RenderGraph::ResourceState depth_state = {};
+    depth_state.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+    depth_state.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depth_state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    const auto depth = renderGraph.importImage("Depth", renderer.getDepthImage(), renderer.getDepthImageView(),
+                                               renderer.getDepthAspect(), depth_state);
+    const auto light_clusters = lightClusterSystem->addCullPass(renderGraph, frame_info);
+    const auto point_shadows = pointShadowSystem->addShadowPass(renderGraph, frame_info);
+
+    if (occlusionCullingSystem)
+        occlusionCullingSystem->addEarlyPasses(renderGraph, frame_info);
+
+    const bool weighted_blended =
+        transparentRenderSystem->getMode() == TransparentRenderSystem::Mode::WeightedBlended;
+
+    auto render_pass = renderGraph.addPass("Render pass")
+                           .read(light_clusters, RenderGraph::Usage::StorageFragment)
+                           .read(point_shadows, RenderGraph::Usage::SampledFragment)
+                           .write(depth, RenderGraph::Usage::DepthAttachment)
+                           .setSideEffects();
+
+    // The passes are executed before frame_info goes out of scope, see renderFrame
+    if (occlusionCullingSystem)
+    {
+        occlusionCullingSystem->readDrawCommands(render_pass);
+
+        // What was hidden by the depth drawn so far is tested again between both halves of the render pass
+        render_pass.setExecute([this, &frame_info](VkCommandBuffer &command_buffer) {
+            renderer.beginRenderPass(command_buffer);
+            occlusionCullingSystem->renderEarly(frame_info);
+            renderer.endRenderPass(command_buffer);
+        });
+
+        occlusionCullingSystem->addLatePasses(renderGraph, frame_info, depth);
+
+        auto resumed_render_pass = renderGraph.addPass("Resumed render pass")
+                                       .read(light_clusters, RenderGraph::Usage::StorageFragment)
+                                       .read(point_shadows, RenderGraph::Usage::SampledFragment)
+                                       .write(depth, RenderGraph::Usage::DepthAttachment)
+                                       .setSideEffects();
+
+        occlusionCullingSystem->readDrawCommands(resumed_render_pass);
+
+        resumed_render_pass.setExecute([this, &frame_info, weighted_blended](VkCommandBuffer &command_buffer) {
+            renderer.resumeRenderPass(command_buffer);
+
+            // Order matters!
+            occlusionCullingSystem->renderLate(frame_info);
+            textureRenderSystem->render(frame_info);
+
+            // Otherwise both are drawn after the transparent composite
+            if (!weighted_blended)
+            {
+                transparentRenderSystem->render(frame_info);
+                pointLightSystem->render(frame_info);
+            }
+
+            renderer.endRenderPass(command_buffer);
+        });
+    }
+    else
+    {
+        render_pass.setExecute([this, &frame_info, weighted_blended](VkCommandBuffer &command_buffer) {
+            renderer.beginRenderPass(command_buffer);
+
+            // Order matters!
+            if (isDepthPrepass())
+                depthPrepassSystem->render(frame_info);
+
+            renderSystem->render(frame_info);
+            textureRenderSystem->render(frame_info);
+
+            // Otherwise both are drawn after the transparent composite
+            if (!weighted_blended)
+            {
+                transparentRenderSystem->render(frame_info);
+                pointLightSystem->render(frame_info);
+            }
+
+            renderer.endRenderPass(command_buffer);
+        });
+    }
+
+    // The point lights are blended in order too, so they are drawn over the composited objects
+    if (weighted_blended)
+    {
+        transparentRenderSystem->addAccumulationPass(renderGraph, frame_info, depth, light_clusters, point_shadows);
+
+        auto composite_pass = renderGraph.addPass("Transparent composite")
+                                  .write(depth, RenderGraph::Usage::DepthAttachment)
+                                  .setSideEffects();
+
+        transparentRenderSystem->readAccumulation(composite_pass);
+
+        composite_pass.setExecute([this, &frame_info](VkCommandBuffer &command_buffer) {
+            renderer.resumeRenderPass(command_buffer);
+
+            transparentRenderSystem->composite(frame_info);
+            pointLightSystem->render(frame_info);
+
+            renderer.endRenderPass(command_buffer);
+        });
+    }
+}
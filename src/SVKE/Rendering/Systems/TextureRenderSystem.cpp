@@ -1,59 +1,97 @@
 #include "SVKE/Rendering/Systems/TextureRenderSystem.hpp"
 
-vk::TextureRenderSystem::TextureRenderSystem(Device &device, Renderer &renderer,
-                                             std::vector<VkDescriptorSetLayout> &set_layouts)
-    : device(device), pipelineLayout(VK_NULL_HANDLE)
+vk::TextureRenderSystem::TextureRenderSystem(Device &device, Renderer &renderer, PipelineCompiler &pipeline_compiler,
+                                             std::vector<VkDescriptorSetLayout> &set_layouts,
+                                             std::shared_ptr<PipelineCompiler::Handle> fallback_pipeline)
+    : device(device), colorFormat(renderer.getImageFormat()), depthFormat(renderer.getDepthFormat()),
+      pipelineLayout(VK_NULL_HANDLE), pipelineCompiler(pipeline_compiler),
+      fallbackPipeline(std::move(fallback_pipeline)),
+      variants(pipeline_compiler,
+               [this](Pipeline::Config &pipeline_config) { populatePipelineConfig(pipeline_config); })
 {
     loadShaders();
     createPipelineLayout(set_layouts);
-    createPipeline(renderer.getRenderPass());
+
+    ShaderVariant default_variant = {};
+    default_variant.sampleShading = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+    setVariant(default_variant);
 }
 
 vk::TextureRenderSystem::~TextureRenderSystem()
 {
+    // The layout is referenced by the pending compilations, so they have to finish first
+    variants.waitIdle();
     vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
 }
 
 void vk::TextureRenderSystem::render(const FrameInfo &frame_info)
 {
-    pipeline->bind(frame_info.commandBuffer);
+    SVKE_PROFILE_SCOPE("TextureRenderSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "TextureRenderSystem");
+
+    // While compiling, the fallback (if any) must have a layout compatible with set 0 and the push constant range
+    if (!pipeline->bind(frame_info.commandBuffer))
+        return;
 
     vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
                             &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
 
-    for (auto &[_, object] : frame_info.objects)
-    {
-        if (!object.getTextureImage() || frame_info.objectDescriptorSets.size() == 0)
-            continue;
+    if (frame_info.objectDescriptorSets.size() == 0)
+        return;
 
-        vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1,
-                                &frame_info.objectDescriptorSets[object.getId()], 0, nullptr);
+    // Objects sharing a texture set and then a model are drawn together, nearest first within each of them.
+    // Sets are only shared by objects whose textures are, see App::run.
+    drawList.clear();
 
-        PushConstantData push = {};
-        push.modelMatrix = object.transform();
-        push.normalMatrix = object.normalMatrix();
+    for (auto &[id, object] : frame_info.objects)
+        if (object.getModel() && object.getTextureImage())
+            drawList.add(frame_info.camera.getViewMatrix(), object, frame_info.objectIndices[id],
+                         frame_info.objectDescriptorSets[id]);
 
-        vkCmdPushConstants(frame_info.commandBuffer, pipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantData),
-                           &push);
+    drawList.sort();
 
-        object.bind(frame_info.commandBuffer);
-        object.draw(frame_info.commandBuffer);
-    }
+    drawList.record(frame_info.commandBuffer, pipelineLayout, 1);
+}
+
+const std::shared_ptr<vk::PipelineCompiler::Handle> &vk::TextureRenderSystem::getPipelineHandle() const
+{
+    return pipeline;
+}
+
+void vk::TextureRenderSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (!Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH, FRAG_SHADER_PATH}))
+        return;
+
+    // Queued compilations still reference the current shader modules, the compiler keeps them until they are done
+    pipelineCompiler.retire(std::move(vertShader));
+    pipelineCompiler.retire(std::move(fragShader));
+
+    loadShaders();
+    variants.recompileAll(*vertShader, *fragShader);
+}
+
+void vk::TextureRenderSystem::setVariant(const ShaderVariant &shader_variant)
+{
+    pipeline = variants.get(shader_variant, *vertShader, *fragShader, pipeline ? pipeline : fallbackPipeline);
+    variant = shader_variant;
+}
+
+const vk::ShaderVariant &vk::TextureRenderSystem::getVariant() const
+{
+    return variant;
 }
 
 void vk::TextureRenderSystem::loadShaders()
 {
-    vertShader = std::make_unique<Shader>(device, "assets/shaders/texture_render_system.vert.spv");
-    fragShader = std::make_unique<Shader>(device, "assets/shaders/texture_render_system.frag.spv");
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+    fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
 }
 
 void vk::TextureRenderSystem::createPipelineLayout(std::vector<VkDescriptorSetLayout> &set_layouts)
 {
-    VkPushConstantRange push_constant_range = {};
-    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    push_constant_range.offset = 0;
-    push_constant_range.size = sizeof(PushConstantData);
+    const VkPushConstantRange push_constant_range = ObjectDataSystem::getPushConstantRange();
 
     VkPipelineLayoutCreateInfo pipeline_layout_info = {};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -67,22 +105,16 @@ void vk::TextureRenderSystem::createPipelineLayout(std::vector<VkDescriptorSetLa
         throw std::runtime_error("vk::TextureRenderSystem::createPipelineLayout: FAILED TO CREATE PIPELINE LAYOUT");
 }
 
-void vk::TextureRenderSystem::createPipeline(VkRenderPass render_pass)
+void vk::TextureRenderSystem::populatePipelineConfig(Pipeline::Config &pipeline_config)
 {
     assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
 
-    Pipeline::Config pipeline_config = {};
     Pipeline::defaultPipelineConfig(pipeline_config);
 
-    pipeline_config.renderPass = render_pass;
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
     pipeline_config.pipelineLayout = pipelineLayout;
     pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
     pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
     pipeline_config.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-
-    // Optional: Shader antialiasing, smooths inner parts of shapes. Might cost some performance
-    pipeline_config.multisampleInfo.sampleShadingEnable = VK_TRUE;
-    pipeline_config.multisampleInfo.minSampleShading = .2f;
-
-    pipeline = std::make_unique<Pipeline>(device, *vertShader, *fragShader, pipeline_config);
 }
@@ -0,0 +1,480 @@
+#include "SVKE/Rendering/Systems/TransparentRenderSystem.hpp"
+
+vk::TransparentRenderSystem::TransparentRenderSystem(Device &device, Renderer &renderer,
+                                                     PipelineCompiler &pipeline_compiler,
+                                                     DescriptorSetLayout &global_set_layout, const Mode mode)
+    : device(device), renderer(renderer), colorFormat(renderer.getImageFormat()),
+      depthFormat(renderer.getDepthFormat()), mode(mode), pipelineLayout(VK_NULL_HANDLE),
+      compositePipelineLayout(VK_NULL_HANDLE), pipelineCompiler(pipeline_compiler), accumulationResource(0),
+      revealageResource(0), accumulationMsResource(0), revealageMsResource(0), accumulated(false)
+{
+    loadShaders();
+    createDescriptors();
+    createPipelineLayouts(global_set_layout);
+    createPipelines();
+}
+
+vk::TransparentRenderSystem::~TransparentRenderSystem()
+{
+    // The layouts are referenced by the pending compilations, so they have to finish first
+    sortedPipeline->wait();
+    accumulationPipeline->wait();
+    compositePipeline->wait();
+
+    vkDestroyPipelineLayout(device.getLogicalDevice(), pipelineLayout, nullptr);
+    vkDestroyPipelineLayout(device.getLogicalDevice(), compositePipelineLayout, nullptr);
+}
+
+void vk::TransparentRenderSystem::render(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("TransparentRenderSystem::render");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer, "TransparentRenderSystem");
+
+    assert(mode == Mode::Sorted && "CANNOT RENDER SORTED TRANSPARENT OBJECTS IN WEIGHTED BLENDED MODE");
+
+    // Farthest first, every object is blended over what is behind it
+    sortBackToFront(
+        frame_info.camera, frame_info.objects, [](const Object &object) { return object.isTransparent(); },
+        drawItems, drawScratch);
+
+    if (drawItems.empty() || !sortedPipeline->bind(frame_info.commandBuffer))
+        return;
+
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &frame_info.globalDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
+
+    for (auto &[_, object] : drawItems)
+    {
+        ObjectPushConstantData push = {};
+        push.objectIndex = frame_info.objectIndices[object->getId()];
+
+        vkCmdPushConstants(frame_info.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                           sizeof(ObjectPushConstantData), &push);
+
+        object->bind(frame_info.commandBuffer);
+        object->draw(frame_info.commandBuffer);
+    }
+}
+
+void vk::TransparentRenderSystem::addAccumulationPass(RenderGraph &render_graph, const FrameInfo &frame_info,
+                                                      const RenderGraph::ResourceId depth,
+                                                      const RenderGraph::ResourceId light_clusters,
+                                                      const RenderGraph::ResourceId point_shadows)
+{
+    assert(mode == Mode::WeightedBlended && "CANNOT ACCUMULATE TRANSPARENT OBJECTS IN SORTED MODE");
+
+    accumulationList.clear();
+
+    for (auto &[id, object] : frame_info.objects)
+        if (object.isTransparent())
+            accumulationList.add(frame_info.camera.getViewMatrix(), object, frame_info.objectIndices[id]);
+
+    accumulationList.sort();
+
+    accumulated = !accumulationList.empty();
+
+    if (!accumulated)
+        return;
+
+    const VkSampleCountFlagBits samples = device.getCurrentMsaaSamples();
+
+    RenderGraph::ImageInfo accumulation_info = {};
+    accumulation_info.format = ACCUMULATION_FORMAT;
+    accumulation_info.extent = renderer.getExtent();
+    accumulation_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    RenderGraph::ImageInfo revealage_info = accumulation_info;
+    revealage_info.format = REVEALAGE_FORMAT;
+
+    accumulationResource = render_graph.createImage("Transparent accumulation", accumulation_info);
+    revealageResource = render_graph.createImage("Transparent revealage", revealage_info);
+
+    auto pass = render_graph.addPass("Transparent accumulation")
+                    .read(light_clusters, RenderGraph::Usage::StorageFragment)
+                    .read(point_shadows, RenderGraph::Usage::SampledFragment)
+                    .read(depth, RenderGraph::Usage::DepthAttachment)
+                    .write(accumulationResource, RenderGraph::Usage::ColorAttachment)
+                    .write(revealageResource, RenderGraph::Usage::ColorAttachment);
+
+    // Drawn with the samples of the depth attachment and resolved at the end of the pass
+    if (samples != VK_SAMPLE_COUNT_1_BIT)
+    {
+        accumulation_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        accumulation_info.samples = samples;
+
+        revealage_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        revealage_info.samples = samples;
+
+        accumulationMsResource = render_graph.createImage("Transparent accumulation (MSAA)", accumulation_info);
+        revealageMsResource = render_graph.createImage("Transparent revealage (MSAA)", revealage_info);
+
+        pass.write(accumulationMsResource, RenderGraph::Usage::ColorAttachment)
+            .write(revealageMsResource, RenderGraph::Usage::ColorAttachment);
+    }
+
+    pass.setExecute([this, &render_graph, &frame_info](VkCommandBuffer &) { accumulate(frame_info, render_graph); });
+}
+
+void vk::TransparentRenderSystem::readAccumulation(RenderGraph::PassBuilder &pass)
+{
+    if (!accumulated)
+        return;
+
+    pass.read(accumulationResource, RenderGraph::Usage::SampledFragment)
+        .read(revealageResource, RenderGraph::Usage::SampledFragment);
+}
+
+void vk::TransparentRenderSystem::composite(const FrameInfo &frame_info)
+{
+    SVKE_PROFILE_SCOPE("TransparentRenderSystem::composite");
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer,
+                                      "TransparentRenderSystem (composite)");
+
+    if (!accumulated || !compositePipeline->bind(frame_info.commandBuffer))
+        return;
+
+    vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipelineLayout, 0, 1,
+                            &frames[frame_info.frameIndex].compositeDescriptorSet, 0, nullptr);
+    FrameStats::countDescriptorBinds(1);
+
+    // A single triangle covering the screen, its corners come from gl_VertexIndex
+    vkCmdDraw(frame_info.commandBuffer, 3, 1, 0, 0);
+    FrameStats::countDraw(1);
+}
+
+void vk::TransparentRenderSystem::reloadShaders(const std::vector<std::string> &spv_paths)
+{
+    if (Shader::isAnyChanged(spv_paths, {VERT_SHADER_PATH, FRAG_SHADER_PATH}))
+    {
+        // Queued compilations still reference the current shader modules, the compiler keeps them until they are done
+        pipelineCompiler.retire(std::move(vertShader));
+        pipelineCompiler.retire(std::move(fragShader));
+
+        vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+        fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
+
+        Pipeline::Config sorted_config = {};
+        populateSortedConfig(sorted_config);
+        pipelineCompiler.recompile(sortedPipeline, *vertShader, *fragShader, sorted_config);
+
+        Pipeline::Config accumulation_config = {};
+        populateAccumulationConfig(accumulation_config);
+        pipelineCompiler.recompile(accumulationPipeline, *vertShader, *fragShader, accumulation_config);
+    }
+
+    if (Shader::isAnyChanged(spv_paths, {COMPOSITE_VERT_SHADER_PATH, COMPOSITE_FRAG_SHADER_PATH}))
+    {
+        pipelineCompiler.retire(std::move(compositeVertShader));
+        pipelineCompiler.retire(std::move(compositeFragShader));
+
+        compositeVertShader = std::make_unique<Shader>(device, COMPOSITE_VERT_SHADER_PATH);
+        compositeFragShader = std::make_unique<Shader>(device, COMPOSITE_FRAG_SHADER_PATH);
+
+        Pipeline::Config composite_config = {};
+        populateCompositeConfig(composite_config);
+        pipelineCompiler.recompile(compositePipeline, *compositeVertShader, *compositeFragShader, composite_config);
+    }
+}
+
+void vk::TransparentRenderSystem::setMode(const Mode mode)
+{
+    this->mode = mode;
+}
+
+const vk::TransparentRenderSystem::Mode vk::TransparentRenderSystem::getMode() const
+{
+    return mode;
+}
+
+const size_t vk::TransparentRenderSystem::getTransparentObjectCount() const
+{
+    return mode == Mode::Sorted ? drawItems.size() : accumulationList.size();
+}
+
+void vk::TransparentRenderSystem::loadShaders()
+{
+    vertShader = std::make_unique<Shader>(device, VERT_SHADER_PATH);
+    fragShader = std::make_unique<Shader>(device, FRAG_SHADER_PATH);
+    compositeVertShader = std::make_unique<Shader>(device, COMPOSITE_VERT_SHADER_PATH);
+    compositeFragShader = std::make_unique<Shader>(device, COMPOSITE_FRAG_SHADER_PATH);
+}
+
+void vk::TransparentRenderSystem::createDescriptors()
+{
+    // Accumulation and revealage
+    compositeSetLayout = DescriptorSetLayout::Builder(device)
+                             .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                             .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+                             .build();
+
+    const uint32_t frames_in_flight = static_cast<uint32_t>(renderer.getFramesInFlight());
+
+    descriptorPool = DescriptorPool::Builder(device)
+                         .setMaxSets(frames_in_flight)
+                         .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * frames_in_flight)
+                         .build();
+
+    for (uint32_t i = 0; i < frames_in_flight; ++i)
+        if (!descriptorPool->allocateDescriptorSet(compositeSetLayout->getDescriptorSetLayout(),
+                                                   frames[i].compositeDescriptorSet))
+            throw std::runtime_error(
+                "vk::TransparentRenderSystem::createDescriptors: FAILED TO ALLOCATE DESCRIPTOR SET");
+
+    // Only read with texelFetch, the sampler is there because the bindings are combined image samplers
+    TextureSampler::Config sampler_config = {};
+    TextureSampler::defaultTextureSamplerConfig(sampler_config);
+    sampler_config.magnificationFilter = VK_FILTER_NEAREST;
+    sampler_config.minificationFilter = VK_FILTER_NEAREST;
+    sampler_config.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_config.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_config.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+    compositeSampler = std::make_unique<TextureSampler>(device, sampler_config);
+}
+
+void vk::TransparentRenderSystem::createPipelineLayouts(DescriptorSetLayout &global_set_layout)
+{
+    const VkPushConstantRange push_constant_range = ObjectDataSystem::getPushConstantRange();
+
+    std::vector<VkDescriptorSetLayout> global_set_layouts{global_set_layout.getDescriptorSetLayout()};
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(global_set_layouts.size());
+    pipeline_layout_info.pSetLayouts = global_set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr, &pipelineLayout) !=
+        VK_SUCCESS)
+        throw std::runtime_error(
+            "vk::TransparentRenderSystem::createPipelineLayouts: FAILED TO CREATE PIPELINE LAYOUT");
+
+    std::vector<VkDescriptorSetLayout> composite_set_layouts{compositeSetLayout->getDescriptorSetLayout()};
+
+    pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(composite_set_layouts.size());
+    pipeline_layout_info.pSetLayouts = composite_set_layouts.data();
+    pipeline_layout_info.pushConstantRangeCount = 0;
+    pipeline_layout_info.pPushConstantRanges = nullptr;
+
+    if (vkCreatePipelineLayout(device.getLogicalDevice(), &pipeline_layout_info, nullptr,
+                               &compositePipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error(
+            "vk::TransparentRenderSystem::createPipelineLayouts: FAILED TO CREATE PIPELINE LAYOUT");
+}
+
+void vk::TransparentRenderSystem::createPipelines()
+{
+    // Both modes are compiled up front, so switching between them does not stall
+    Pipeline::Config sorted_config = {};
+    populateSortedConfig(sorted_config);
+    sortedPipeline = pipelineCompiler.compile(*vertShader, *fragShader, sorted_config);
+
+    Pipeline::Config accumulation_config = {};
+    populateAccumulationConfig(accumulation_config);
+    accumulationPipeline = pipelineCompiler.compile(*vertShader, *fragShader, accumulation_config);
+
+    Pipeline::Config composite_config = {};
+    populateCompositeConfig(composite_config);
+    compositePipeline = pipelineCompiler.compile(*compositeVertShader, *compositeFragShader, composite_config);
+}
+
+void vk::TransparentRenderSystem::populateSurfaceConfig(Pipeline::Config &pipeline_config)
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    Pipeline::defaultPipelineConfig(pipeline_config);
+
+    pipeline_config.depthAttachmentFormat = depthFormat;
+    pipeline_config.pipelineLayout = pipelineLayout;
+    pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
+    pipeline_config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    pipeline_config.rasterizationInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    // Shaded like the default variant of the RenderSystem
+    ShaderVariant variant = {};
+    variant.sampleShading = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+    variant.apply(pipeline_config);
+
+    // Hidden by the opaque objects, but never hiding each other
+    pipeline_config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+}
+
+void vk::TransparentRenderSystem::populateSortedConfig(Pipeline::Config &pipeline_config)
+{
+    populateSurfaceConfig(pipeline_config);
+    Pipeline::enableAlphaBlending(pipeline_config);
+
+    pipeline_config.colorAttachmentFormat = colorFormat;
+
+    Pipeline::setSpecializationConstant(pipeline_config.fragSpecialization, WEIGHTED_BLENDED_CONSTANT_ID, VK_FALSE);
+}
+
+void vk::TransparentRenderSystem::populateAccumulationConfig(Pipeline::Config &pipeline_config)
+{
+    populateSurfaceConfig(pipeline_config);
+
+    // Weighted, premultiplied colors and their weights are summed
+    pipeline_config.colorAttachmentFormat = ACCUMULATION_FORMAT;
+    pipeline_config.colorBlendAttachment.colorWriteMask =
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    pipeline_config.colorBlendAttachment.blendEnable = VK_TRUE;
+    pipeline_config.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    pipeline_config.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    pipeline_config.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    // The revealage is multiplied by the transparency of every object, what is left shows through all of them
+    VkPipelineColorBlendAttachmentState revealage_blend_attachment = {};
+    revealage_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+    revealage_blend_attachment.blendEnable = VK_TRUE;
+    revealage_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    revealage_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+    revealage_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+    revealage_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    revealage_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    revealage_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    pipeline_config.extraColorAttachmentFormats = {REVEALAGE_FORMAT};
+    pipeline_config.extraColorBlendAttachments = {revealage_blend_attachment};
+
+    Pipeline::setSpecializationConstant(pipeline_config.fragSpecialization, WEIGHTED_BLENDED_CONSTANT_ID, VK_TRUE);
+}
+
+void vk::TransparentRenderSystem::populateCompositeConfig(Pipeline::Config &pipeline_config)
+{
+    assert(compositePipelineLayout != VK_NULL_HANDLE && "CANNOT CREATE PIPELINE BEFORE PIPELINE LAYOUT");
+
+    Pipeline::defaultPipelineConfig(pipeline_config);
+    Pipeline::enableAlphaBlending(pipeline_config);
+
+    // The triangle comes from gl_VertexIndex and covers the transparent objects, which are already depth tested
+    pipeline_config.bindingDescriptions.clear();
+    pipeline_config.attributeDescriptions.clear();
+    pipeline_config.depthStencilInfo.depthTestEnable = VK_FALSE;
+    pipeline_config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+
+    pipeline_config.colorAttachmentFormat = colorFormat;
+    pipeline_config.depthAttachmentFormat = depthFormat;
+    pipeline_config.pipelineLayout = compositePipelineLayout;
+    pipeline_config.multisampleInfo.rasterizationSamples = device.getCurrentMsaaSamples();
+}
+
+void vk::TransparentRenderSystem::updateDescriptorSet(const int frame_index, const RenderGraph &render_graph)
+{
+    auto &frame = frames[frame_index];
+
+    if (frame.transientGeneration == render_graph.getTransientGeneration())
+        return;
+
+    VkDescriptorImageInfo accumulation_info = {};
+    accumulation_info.sampler = compositeSampler->getSampler();
+    accumulation_info.imageView = render_graph.getImageView(accumulationResource);
+    accumulation_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkDescriptorImageInfo revealage_info = {};
+    revealage_info.sampler = compositeSampler->getSampler();
+    revealage_info.imageView = render_graph.getImageView(revealageResource);
+    revealage_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    DescriptorWriter(*compositeSetLayout, *descriptorPool)
+        .writeImage(0, accumulation_info)
+        .writeImage(1, revealage_info)
+        .overwrite(frame.compositeDescriptorSet);
+
+    frame.transientGeneration = render_graph.getTransientGeneration();
+}
+
+void vk::TransparentRenderSystem::accumulate(const FrameInfo &frame_info, const RenderGraph &render_graph)
+{
+    SVKE_PROFILE_SCOPE("TransparentRenderSystem::accumulate");
+
+    // The composite set is bound after this pass, in the same frame
+    updateDescriptorSet(frame_info.frameIndex, render_graph);
+
+    const bool multisampled = device.getCurrentMsaaSamples() != VK_SAMPLE_COUNT_1_BIT;
+
+    // Nothing accumulated yet: no color, and everything behind is fully revealed
+    std::array<VkRenderingAttachmentInfo, 2> color_attachments = {};
+    const std::array<RenderGraph::ResourceId, 2> resolved = {accumulationResource, revealageResource};
+    const std::array<RenderGraph::ResourceId, 2> multisampled_resources = {accumulationMsResource,
+                                                                           revealageMsResource};
+
+    for (size_t i = 0; i < color_attachments.size(); ++i)
+    {
+        auto &color_attachment = color_attachments[i];
+        color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color_attachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+
+        if (multisampled)
+        {
+            color_attachment.imageView = render_graph.getImageView(multisampled_resources[i]);
+            color_attachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            color_attachment.resolveImageView = render_graph.getImageView(resolved[i]);
+            color_attachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+        else
+        {
+            color_attachment.imageView = render_graph.getImageView(resolved[i]);
+        }
+    }
+
+    color_attachments[0].clearValue.color = {{0.f, 0.f, 0.f, 0.f}};
+    color_attachments[1].clearValue.color = {{1.f, 0.f, 0.f, 0.f}};
+
+    // Tested against the opaque objects, left as it is for the composite
+    VkRenderingAttachmentInfo depth_attachment = {};
+    depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depth_attachment.imageView = renderer.getDepthImageView();
+    depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_NONE;
+
+    const VkExtent2D extent = renderer.getExtent();
+
+    VkRenderingInfo rendering_info = {};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    rendering_info.renderArea.offset = {0, 0};
+    rendering_info.renderArea.extent = extent;
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = static_cast<uint32_t>(color_attachments.size());
+    rendering_info.pColorAttachments = color_attachments.data();
+    rendering_info.pDepthAttachment = &depth_attachment;
+
+    GpuProfiler::Scope profiler_scope(frame_info.gpuProfiler, frame_info.commandBuffer,
+                                      "TransparentRenderSystem (accumulation)");
+
+    vkCmdBeginRendering(frame_info.commandBuffer, &rendering_info);
+
+    VkViewport viewport = {};
+    viewport.x = 0;
+    viewport.y = 0;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.f;
+    viewport.maxDepth = 1.f;
+
+    VkRect2D scissor = {};
+    scissor.offset = {0, 0};
+    scissor.extent = extent;
+
+    vkCmdSetViewport(frame_info.commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(frame_info.commandBuffer, 0, 1, &scissor);
+
+    if (accumulationPipeline->bind(frame_info.commandBuffer))
+    {
+        vkCmdBindDescriptorSets(frame_info.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                                &frame_info.globalDescriptorSet, 0, nullptr);
+        FrameStats::countDescriptorBinds(1);
+
+        accumulationList.record(frame_info.commandBuffer, pipelineLayout, 1);
+    }
+
+    vkCmdEndRendering(frame_info.commandBuffer);
+}
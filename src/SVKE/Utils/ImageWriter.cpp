@@ -0,0 +1,143 @@
+#include "SVKE/Utils/ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+constexpr size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+const std::array<uint32_t, 256> makeCrcTable()
+{
+    std::array<uint32_t, 256> table = {};
+
+    for (uint32_t i = 0; i < table.size(); ++i)
+    {
+        uint32_t crc = i;
+
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+
+        table[i] = crc;
+    }
+
+    return table;
+}
+
+uint32_t crc32(const uint8_t *data, const size_t size, uint32_t crc = 0xFFFFFFFFu)
+{
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+void appendBigEndian(std::vector<uint8_t> &bytes, const uint32_t value)
+{
+    bytes.push_back(static_cast<uint8_t>(value >> 24));
+    bytes.push_back(static_cast<uint8_t>(value >> 16));
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void writeChunk(std::ofstream &file, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(data.size()));
+    header.insert(header.end(), type, type + 4);
+
+    // The CRC covers the chunk type and data, not the length
+    uint32_t crc = crc32(header.data() + 4, 4);
+    crc = crc32(data.data(), data.size(), crc) ^ 0xFFFFFFFFu;
+
+    std::vector<uint8_t> footer;
+    appendBigEndian(footer, crc);
+
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    file.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+}
+} // namespace
+
+const bool vk::writePng(const std::string &path, const uint32_t width, const uint32_t height, const uint8_t *pixels)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    static const uint8_t SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char *>(SIGNATURE), sizeof(SIGNATURE));
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header.push_back(8); // Bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0); // Deflate
+    header.push_back(0); // Adaptive filtering
+    header.push_back(0); // Not interlaced
+    writeChunk(file, "IHDR", header);
+
+    // Every row starts with its filter type, 0 leaves the pixels as they are
+    const size_t row_size = static_cast<size_t>(width) * BYTES_PER_PIXEL;
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve((row_size + 1) * height);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), pixels + y * row_size, pixels + (y + 1) * row_size);
+    }
+
+    // zlib stream of stored blocks followed by the Adler-32 of the uncompressed data
+    std::vector<uint8_t> data;
+    data.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK_SIZE * 5 + 16);
+    data.push_back(0x78);
+    data.push_back(0x01);
+
+    size_t offset = 0;
+    do
+    {
+        const size_t block_size = std::min(MAX_STORED_BLOCK_SIZE, scanlines.size() - offset);
+        const bool last = offset + block_size == scanlines.size();
+
+        data.push_back(last ? 1 : 0);
+        data.push_back(static_cast<uint8_t>(block_size));
+        data.push_back(static_cast<uint8_t>(block_size >> 8));
+        data.push_back(static_cast<uint8_t>(~block_size));
+        data.push_back(static_cast<uint8_t>(~block_size >> 8));
+        data.insert(data.end(), scanlines.begin() + offset, scanlines.begin() + offset + block_size);
+
+        offset += block_size;
+    } while (offset < scanlines.size());
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (const uint8_t byte : scanlines)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(data, (b << 16) | a);
+
+    writeChunk(file, "IDAT", data);
+    writeChunk(file, "IEND", {});
+
+    return static_cast<bool>(file);
+}
+
+const bool vk::writeRaw(const std::string &path, const uint32_t width, const uint32_t height, const uint8_t *pixels)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    file.write(reinterpret_cast<const char *>(pixels), static_cast<std::streamsize>(width) * height * BYTES_PER_PIXEL);
+
+    return static_cast<bool>(file);
+}
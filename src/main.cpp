@@ -1,12 +1,86 @@
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 #include "App.hpp"
 
-int main()
+int main(int argc, char **argv)
 {
-    vk::App app = vk::App();
+    vk::App::Options options = {};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--light-stress") == 0 && i + 1 < argc)
+        {
+            options.stressLights = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+        {
+            options.headlessFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            options.headlessOutput = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            options.captureDirectory = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+        {
+            options.framesInFlight = std::clamp(std::stoi(argv[++i]), 1, vk::Swapchain::MAX_FRAMES_IN_FLIGHT);
+        }
+        else if (std::strcmp(argv[i], "--low-latency") == 0)
+        {
+            options.lowLatency = true;
+        }
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+        {
+            options.depthPrepass = true;
+        }
+        else if (std::strcmp(argv[i], "--occlusion-culling") == 0)
+        {
+            options.occlusionCulling = true;
+        }
+        else if (std::strcmp(argv[i], "--shadowed-lights") == 0 && i + 1 < argc)
+        {
+            options.shadowedLights = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--transparency") == 0 && i + 1 < argc)
+        {
+            const char *mode = argv[++i];
+
+            if (std::strcmp(mode, "sorted") == 0)
+                options.transparency = vk::TransparentRenderSystem::Mode::Sorted;
+            else if (std::strcmp(mode, "weighted") == 0)
+                options.transparency = vk::TransparentRenderSystem::Mode::WeightedBlended;
+            else
+            {
+                std::cerr << "Unknown transparency mode " << mode << ", expected sorted or weighted" << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--light-stress <light count>] [--headless <frame count> [--output <file.ppm>]]"
+                      << " [--capture <directory>] [--frames-in-flight <1-3>] [--low-latency] [--depth-prepass]"
+                      << " [--occlusion-culling] [--shadowed-lights <light count>] [--transparency <sorted|weighted>]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.depthPrepass && options.occlusionCulling)
+    {
+        std::cerr << "--depth-prepass and --occlusion-culling cannot be combined" << std::endl;
+        return 1;
+    }
+
+    vk::App app = vk::App(options);
 
     try
     {